@@ -96,6 +96,8 @@ SOURCE_FILES=(
     # 核心运行时
     "${SRC_DIR}/xc/xc.c"
     "${SRC_DIR}/xc/xc_gc.c"
+    "${SRC_DIR}/xc/xc_simd.c"
+    "${SRC_DIR}/xc/xc_parallel.c"
     "${SRC_DIR}/xc/xc_types/xc_exception.c"
     "${SRC_DIR}/xc/xc_types/xc_null.c"
     "${SRC_DIR}/xc/xc_types/xc_boolean.c"
@@ -104,7 +106,9 @@ SOURCE_FILES=(
     "${SRC_DIR}/xc/xc_types/xc_function.c"
     "${SRC_DIR}/xc/xc_types/xc_array.c"
     "${SRC_DIR}/xc/xc_types/xc_object.c"
-    # "${SRC_DIR}/xc/xc_types/xc_vm.c" # higher runtime concepts like JIT/IR/FFI/AST/VM etc...
+    "${SRC_DIR}/xc/xc_types/xc_buffer.c"
+    "${SRC_DIR}/xc/xc_types/xc_iterator.c"
+    "${SRC_DIR}/xc/xc_types/xc_vm.c"
     
     # 标准库
     "${SRC_DIR}/xc/xc_std/xc_std_console.c"
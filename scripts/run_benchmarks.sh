@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# 编译并运行XC性能基准（test/bench/bench_*.c）
+# 用法: run_benchmarks.sh [基准名...]，例如 run_benchmarks.sh method_cache
+
+# 确保脚本在错误时退出
+set -e
+
+# 获取脚本所在目录的上级目录（项目根目录）
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "${SCRIPT_DIR}/.." && pwd)"
+
+# 设置目录
+SRC_DIR="${PROJECT_ROOT}/src"
+INCLUDE_DIR="${PROJECT_ROOT}/include"
+LIB_DIR="${PROJECT_ROOT}/lib"
+BIN_DIR="${PROJECT_ROOT}/bin"
+BENCH_DIR="${PROJECT_ROOT}/test/bench"
+
+# 设置编译器，允许通过环境变量覆盖，并在缺少cosmocc时退回gcc/cc
+COSMOCC=${COSMOCC:-~/cosmocc/bin/cosmocc}
+if [ ! -x "$COSMOCC" ]; then
+    if command -v cosmocc >/dev/null 2>&1; then
+        COSMOCC=$(command -v cosmocc)
+    elif command -v gcc >/dev/null 2>&1; then
+        COSMOCC=$(command -v gcc)
+    else
+        COSMOCC=$(command -v cc)
+    fi
+fi
+
+# 基准使用与库相同的优化级别（build_libxc.sh 的 -Os），可通过 BENCH_OPT 覆盖；
+# 库按 -fno-pie 编译，基准也链接成非 PIE 可执行文件
+BENCH_OPT=${BENCH_OPT:--Os}
+CFLAGS="${BENCH_OPT} -g -fno-pie -no-pie -I${SRC_DIR} -I${SRC_DIR}/infrax -I${INCLUDE_DIR} -I~/cosmocc/include"
+
+mkdir -p "${BIN_DIR}"
+
+if [ $# -gt 0 ]; then
+    BENCH_FILES=()
+    for NAME in "$@"; do
+        BENCH_FILES+=("${BENCH_DIR}/bench_${NAME}.c")
+    done
+else
+    BENCH_FILES=("${BENCH_DIR}"/bench_*.c)
+fi
+
+for BENCH_FILE in "${BENCH_FILES[@]}"; do
+    BENCH_BASENAME=$(basename "${BENCH_FILE}" .c)
+    echo "run_benchmarks.sh: 编译 ${BENCH_FILE}"
+    ${COSMOCC} ${CFLAGS} -o "${BIN_DIR}/${BENCH_BASENAME}.exe" "${BENCH_FILE}" \
+        "${LIB_DIR}/libxc.a" -lpthread -lm
+    echo -e "\nrun_benchmarks.sh: 运行 ${BIN_DIR}/${BENCH_BASENAME}.exe\n"
+    "${BIN_DIR}/${BENCH_BASENAME}.exe"
+    echo
+done
+
+echo "run_benchmarks.sh: 基准测试结束!"
@@ -70,7 +70,7 @@ ${COSMOCC} -o "${BIN_DIR}/test_external.exe" \
     "${EXTERNAL_TEST_DIR}/test_xc_function.o" \
     "${EXTERNAL_TEST_DIR}/test_xc_exception.o" \
     "${EXTERNAL_TEST_DIR}/test_xc_main.o" \
-    -L${LIB_DIR} -lxc
+    -L${LIB_DIR} -lxc -lm
 
 # 显示编译结果
 echo -e "\nrun_external_tests.sh: 生成的外部测试可执行文件:"
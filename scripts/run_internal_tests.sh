@@ -68,7 +68,7 @@ ${COSMOCC} -o "${BIN_DIR}/test_internal.exe" \
     "${INTERNAL_TEST_DIR}/test_xc.o" \
     "${INTERNAL_TEST_DIR}/test_xc_array.o" \
     "${INTERNAL_TEST_DIR}/test_xc_object.o" \
-    "${LIB_DIR}/libxc.a"
+    "${LIB_DIR}/libxc.a" -lm
 
 # 显示编译结果
 echo -e "\nrun_internal_tests.sh: 生成的内部测试可执行文件:"
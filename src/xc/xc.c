@@ -3,6 +3,18 @@
 
 static xc_runtime_t* rt = NULL;
 
+/* 线程状态与栈帧跟踪开关 */
+__thread xc_thread_state_t _xc_thread_state = {0};
+bool xc_stack_frames_enabled = true;
+
+/* 静态栈帧描述符 */
+static const xc_frame_desc_t frame_function_call = {"function_call", __FILE__, __LINE__};
+static const xc_frame_desc_t frame_try_catch_finally = {"try_catch_finally", __FILE__, __LINE__};
+static const xc_frame_desc_t frame_catch_handler = {"catch_handler", __FILE__, __LINE__};
+static const xc_frame_desc_t frame_finally_handler = {"finally_handler", __FILE__, __LINE__};
+static const xc_frame_desc_t frame_invoke = {"<function>", __FILE__, __LINE__};
+static const xc_frame_desc_t frame_call = {"Object.call", __FILE__, __LINE__};
+
 // 函数声明
 void init_method_cache(void);
 void clear_method_cache(void);
@@ -49,7 +61,7 @@ static xc_type_entry_t* find_type_by_id(int type_id) {
 
 //tool for creator
 static xc_val xc_alloc(int type, size_t size) {
-    if (type < 0 || type >= 16) return NULL;
+    if (type < 0 || type >= XC_METHOD_TYPES) return NULL;
     
     /* 获取类型注册项 */
     xc_type_entry_t* entry = find_type_by_id(type);
@@ -146,6 +158,8 @@ int xc_register_type(const char* name, xc_type_lifecycle_t* lifecycle) {
     else if (strcmp(name, "object") == 0) type_id = XC_TYPE_OBJECT;
     else if (strcmp(name, "vm") == 0) type_id = XC_TYPE_VM;
     else if (strcmp(name, "error") == 0) type_id = XC_TYPE_EXCEPTION;
+    else if (strcmp(name, "buffer") == 0) type_id = XC_TYPE_BUFFER;
+    else if (strcmp(name, "iterator") == 0) type_id = XC_TYPE_ITERATOR;
     else {
         // 根据类型名称前缀决定分配区间
         if (strncmp(name, "internal.", 9) == 0) {
@@ -174,6 +188,10 @@ int xc_register_type(const char* name, xc_type_lifecycle_t* lifecycle) {
     
     entry->id = type_id;
     memcpy(&entry->lifecycle, lifecycle, sizeof(xc_type_lifecycle_t));
+    /* GC 和 equal/compare 等通过 get_type_handler 找到这份生命周期 */
+    if (type_id >= 0 && type_id < MAX_TYPE_ID) {
+        xc_type_handlers[type_id] = &entry->lifecycle;
+    }
     /* 打印调试信息时使用指针格式，避免格式警告 */
     XC_LOG_DEBUG("xc_register_type(\"%s\"), lifecycle=%p, type_id=%d", name,
                  (void*)lifecycle, type_id);
@@ -199,14 +217,34 @@ int xc_register_type(const char* name, xc_type_lifecycle_t* lifecycle) {
     return type_id;
 }
 
-/* 注册方法 */
+/* 方法名哈希（完整32位FNV-1a，用于方法缓存） */
+static inline unsigned int method_name_hash(const char* str) {
+    unsigned int hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* 方法表版本号：注册方法或清理缓存时递增，各线程发现版本变化后清空自己的缓存 */
+static unsigned int method_epoch = 1;
+
+/* 注册方法
+ * Registration is expected to happen during type setup. Readers on other
+ * threads only see a method once its chain head is published. */
 static char register_method(int type, const char* name, xc_method_func func) {
     XC_LOG_DEBUG("register_method: type=%d, name=%s, func=%p", type, name, func);
-    if (type < 0 || type >= 16 || !name || !func) {
+    if (type < 0 || type >= XC_METHOD_TYPES || !name || !func) {
         XC_LOG_DEBUG("register_method: invalid parameters");
         return 0;
     }
     
+    /* 索引0是链表结束标记，不能存放方法 */
+    if (_state.method_count == 0) {
+        _state.method_count = 1;
+    }
+    
     if (_state.method_count >= 256) {
         XC_LOG_DEBUG("register_method: method table full");
         return 0;
@@ -216,43 +254,43 @@ static char register_method(int type, const char* name, xc_method_func func) {
     _state.methods[method_idx].name = name;
     _state.methods[method_idx].func = (xc_val (*)(xc_val, ...))func;
     _state.methods[method_idx].next = _state.method_heads[type];
-    _state.method_heads[type] = method_idx;
+    __atomic_store_n(&_state.method_heads[type], method_idx, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&method_epoch, 1, __ATOMIC_RELEASE);
     XC_LOG_DEBUG("register_method: registered method at index %d, next=%d, head=%d",
            method_idx, _state.methods[method_idx].next, _state.method_heads[type]);
     
     return 1;
 }
 
-// 全局缓存数组
-#ifndef METHOD_CACHE_SIZE
-#define METHOD_CACHE_SIZE 32  // 增加默认缓存大小
-#endif
-
-static method_cache_entry_t method_cache[METHOD_CACHE_SIZE] = {0};
-static int cache_age_counter = 0;
+/* 线程本地方法缓存：命中时不写任何共享内存 */
+static __thread method_cache_entry_t method_cache[METHOD_CACHE_SIZE];
+static __thread unsigned int method_cache_epoch = 0;
 
 // 缓存统计信息
 #ifdef XC_ENABLE_CACHE_STATS
-static struct {
+static __thread struct {
     unsigned int hits;
     unsigned int misses;
     unsigned int collisions;
 } cache_stats = {0};
 #endif
 
-/* 原始的方法查找函数（无缓存） */
-static xc_method_func find_method_original(int type, const char* name) {
-    if (type < 0 || type >= 16 || !name) {
+/* 原始的方法查找函数（无缓存），found_name 返回注册时的方法名指针 */
+static xc_method_func find_method_original(int type, const char* name, const char** found_name) {
+    if (type < 0 || type >= XC_METHOD_TYPES || !name) {
         return NULL;
     }
     
-    int method_idx = _state.method_heads[type];
+    int method_idx = __atomic_load_n(&_state.method_heads[type], __ATOMIC_ACQUIRE);
     XC_LOG_DEBUG("find_method_original: method_idx=%d", method_idx);
     
     while (method_idx != 0) {
         XC_LOG_DEBUG("find_method_original: checking method at index %d, name=%s", method_idx, _state.methods[method_idx].name);
         if (strcmp(_state.methods[method_idx].name, name) == 0) {
             XC_LOG_DEBUG("find_method_original: found method at index %d, func=%p", method_idx, _state.methods[method_idx].func);
+            if (found_name) {
+                *found_name = _state.methods[method_idx].name;
+            }
             return (xc_method_func)_state.methods[method_idx].func;
         }
         method_idx = _state.methods[method_idx].next;
@@ -263,17 +301,29 @@ static xc_method_func find_method_original(int type, const char* name) {
     return NULL;
 }
 
+/* 线程本地属性访问解析缓存 */
+static __thread dot_cache_entry_t dot_cache[DOT_CACHE_SIZE];
+
+/* 方法表版本变化时清空当前线程的缓存 */
+static inline void method_cache_sync(void) {
+    unsigned int epoch = __atomic_load_n(&method_epoch, __ATOMIC_ACQUIRE);
+    if (method_cache_epoch != epoch) {
+        memset(method_cache, 0, sizeof(method_cache));
+        memset(dot_cache, 0, sizeof(dot_cache));
+        method_cache_epoch = epoch;
+    }
+}
+
 /* 批量查找多个方法 */
 static void find_methods_batch(int type, const char** names, int count, xc_method_func* results) {
-    if (type < 0 || type >= 16) {
+    if (type < 0 || type >= XC_METHOD_TYPES) {
         for (int i = 0; i < count; i++) {
             results[i] = NULL;
         }
         return;
     }
     
-    // 优化：一次性计算类型部分的键
-    unsigned int type_key = ((unsigned int)type << 16);
+    method_cache_sync();
     
     for (int i = 0; i < count; i++) {
         const char* name = names[i];
@@ -282,83 +332,52 @@ static void find_methods_batch(int type, const char** names, int count, xc_metho
             continue;
         }
         
-        // 计算完整缓存键
-        unsigned int name_hash = hash_string(name);
-        unsigned int key = type_key | (name_hash & 0xFFFF);
-        
-        // 查找缓存 - 添加安全检查
-        bool cache_hit = false;
-        for (int j = 0; j < METHOD_CACHE_SIZE; j++) {
-            // 检查缓存条目是否有效
-            if (method_cache[j].key == key && method_cache[j].value) {
-                // 更新访问时间 - 使用原子操作避免多线程问题
-                method_cache[j].age = ++cache_age_counter;
-                results[i] = method_cache[j].value;
-                cache_hit = true;
-                
-                #ifdef XC_ENABLE_CACHE_STATS
-                cache_stats.hits++;
-                #endif
-                
-                XC_LOG_DEBUG("find_methods_batch: cache hit for type=%d, name=%s", type, name);
-                break;
-            }
-        }
+        // 直接映射：槽位由类型和完整名称哈希决定
+        unsigned int hash = method_name_hash(name);
+        unsigned int slot = (hash ^ ((unsigned int)type * 0x9E3779B1u)) & (METHOD_CACHE_SIZE - 1);
+        method_cache_entry_t* entry = &method_cache[slot];
         
-        if (!cache_hit) {
+        // 命中必须同时校验类型和名称，避免哈希冲突返回错误的方法
+        if (entry->value && entry->type == type && entry->hash == hash &&
+            (entry->name == name || strcmp(entry->name, name) == 0)) {
+            results[i] = entry->value;
+            
             #ifdef XC_ENABLE_CACHE_STATS
-            cache_stats.misses++;
+            cache_stats.hits++;
             #endif
             
-            XC_LOG_DEBUG("find_methods_batch: cache miss for type=%d, name=%s", type, name);
-            
-            // 缓存未命中，调用原始查找函数
-            xc_method_func method = find_method_original(type, name);
-            results[i] = method;
-            
-            if (method) {
-                // 添加到缓存，只有当方法不为空时才缓存
-                int oldest_idx = 0;
-                int empty_idx = -1;
-                
-                // 首先尝试找空槽位
-                for (int j = 0; j < METHOD_CACHE_SIZE; j++) {
-                    if (!method_cache[j].value) {
-                        empty_idx = j;
-                        break;
-                    }
-                    if (method_cache[j].age < method_cache[oldest_idx].age) {
-                        oldest_idx = j;
-                    }
-                }
-                
-                int target_idx = (empty_idx >= 0) ? empty_idx : oldest_idx;
-                
-                // 检查是否有冲突（相同键但不同值）
-                #ifdef XC_ENABLE_CACHE_STATS
-                if (method_cache[target_idx].key == key && 
-                    method_cache[target_idx].value != method) {
-                    cache_stats.collisions++;
-                }
-                #endif
-                
-                // 安全地更新缓存条目
-                method_cache_entry_t new_entry = {
-                    .key = key,
-                    .value = method,
-                    .age = ++cache_age_counter
-                };
-                method_cache[target_idx] = new_entry;
-                
-                XC_LOG_DEBUG("find_methods_batch: added to cache at index %d", target_idx);
-            }
+            XC_LOG_DEBUG("find_methods_batch: cache hit for type=%d, name=%s", type, name);
+            continue;
+        }
+        
+        #ifdef XC_ENABLE_CACHE_STATS
+        cache_stats.misses++;
+        if (entry->value) {
+            cache_stats.collisions++;
+        }
+        #endif
+        
+        XC_LOG_DEBUG("find_methods_batch: cache miss for type=%d, name=%s", type, name);
+        
+        // 缓存未命中，调用原始查找函数
+        const char* found_name = NULL;
+        xc_method_func method = find_method_original(type, name, &found_name);
+        results[i] = method;
+        
+        // 只有当方法不为空时才缓存，名称使用注册时的稳定指针
+        if (method) {
+            entry->name = found_name;
+            entry->hash = hash;
+            entry->type = type;
+            entry->value = method;
+            XC_LOG_DEBUG("find_methods_batch: added to cache at index %u", slot);
         }
     }
 }
 
 /* 查找方法（带缓存） - 优化版本，直接使用批量查找 */
 static xc_method_func find_method(int type, const char *name) {
-    if (type < 0 || type >= 16 || !name) {
+    if (type < 0 || type >= XC_METHOD_TYPES || !name) {
         return NULL;
     }
     
@@ -367,6 +386,84 @@ static xc_method_func find_method(int type, const char *name) {
     return result;
 }
 
+/* 一次遍历类型的方法链，找出 "get_<key>"、"set_<key>" 和 "<key>" */
+static void resolve_property(int type, const char* key, dot_cache_entry_t* entry) {
+    entry->getter = NULL;
+    entry->setter = NULL;
+    entry->method = NULL;
+    
+    /* 链表按注册顺序倒序，先匹配到的就是最新注册的方法 */
+    int method_idx = __atomic_load_n(&_state.method_heads[type], __ATOMIC_ACQUIRE);
+    while (method_idx != 0) {
+        const char* name = _state.methods[method_idx].name;
+        xc_method_func func = (xc_method_func)_state.methods[method_idx].func;
+        
+        if (name[0] == 'g' && strncmp(name, "get_", 4) == 0 && strcmp(name + 4, key) == 0) {
+            if (!entry->getter) entry->getter = func;
+        } else if (name[0] == 's' && strncmp(name, "set_", 4) == 0 && strcmp(name + 4, key) == 0) {
+            if (!entry->setter) entry->setter = func;
+        } else if (strcmp(name, key) == 0) {
+            if (!entry->method) entry->method = func;
+        }
+        method_idx = _state.methods[method_idx].next;
+    }
+}
+
+/* 查找属性访问器，命中时不分配、不拼接字符串 */
+static const dot_cache_entry_t* find_property_accessors(int type, const char* key, dot_cache_entry_t* scratch) {
+    if (type < 0 || type >= XC_METHOD_TYPES) {
+        memset(scratch, 0, sizeof(*scratch));
+        return scratch;
+    }
+    
+    method_cache_sync();
+    
+    unsigned int hash = method_name_hash(key);
+    dot_cache_entry_t* entry = &dot_cache[(hash ^ ((unsigned int)type * 0x9E3779B1u)) & (DOT_CACHE_SIZE - 1)];
+    if (entry->type == type && entry->hash == hash && strcmp(entry->key, key) == 0) {
+        return entry;
+    }
+    
+    /* 过长的属性名不进入缓存 */
+    size_t len = strlen(key);
+    if (len >= DOT_CACHE_KEY_MAX) {
+        resolve_property(type, key, scratch);
+        return scratch;
+    }
+    
+    resolve_property(type, key, entry);
+    memcpy(entry->key, key, len + 1);
+    entry->hash = hash;
+    entry->type = type;
+    return entry;
+}
+
+/* 线程本地绑定方法缓存，槽位注册为GC根，保证缓存的函数和对象不会被回收 */
+static __thread xc_object_t* bound_method_cache[BOUND_METHOD_CACHE_SIZE];
+static __thread bool bound_method_cache_rooted = false;
+
+/* 获取 obj 与 method 绑定的函数对象，同一对象同一方法重复读取时返回同一个函数 */
+static xc_val get_bound_method(xc_val obj, xc_method_func method) {
+    uintptr_t h = ((uintptr_t)obj >> 4) ^ ((uintptr_t)method >> 2);
+    h ^= h >> 17;
+    xc_object_t** slot = &bound_method_cache[h & (BOUND_METHOD_CACHE_SIZE - 1)];
+    
+    xc_function_t* cached = (xc_function_t*)*slot;
+    if (cached && cached->this_obj == obj && cached->method == method) {
+        return *slot;
+    }
+    
+    if (!bound_method_cache_rooted) {
+        for (int i = 0; i < BOUND_METHOD_CACHE_SIZE; i++) {
+            xc_gc_add_root(rt, &bound_method_cache[i]);
+        }
+        bound_method_cache_rooted = true;
+    }
+    
+    *slot = xc_function_bind_method(rt, method, obj);
+    return *slot;
+}
+
 xc_val xc_dot(xc_val obj, const char* key, ...) {
     if (!obj || !key) return NULL;
     
@@ -376,99 +473,58 @@ xc_val xc_dot(xc_val obj, const char* key, ...) {
     
     /* 获取第一个额外参数 */
     xc_val value = va_arg(args, xc_val);
+    va_end(args);
     
     /* 获取对象类型 */
     int type = xc_typeof(obj);
     
+    /* 预先解析的访问器 */
+    dot_cache_entry_t scratch;
+    const dot_cache_entry_t* accessors = find_property_accessors(type, key, &scratch);
+    
     /* 如果有额外参数，则是设置操作 */
     if (value) {
-        /* 首先尝试找类型特定的属性设置器，格式为 "set_属性名" */
-        char setter_name[128] = "set_";
-        strncat(setter_name, key, sizeof(setter_name) - 5); // 5 = 长度"set_" + 1防止溢出
+        /* 首先尝试类型特定的属性设置器 "set_属性名" */
+        if (accessors->setter) {
+            return accessors->setter(obj, value);
+        }
         
-        xc_method_func specific_setter = find_method(type, setter_name);
-        if (specific_setter) {
-            va_end(args);
-            return specific_setter(obj, value);
+        /* 对象类型直接写入属性 */
+        if (type == XC_TYPE_OBJECT) {
+            xc_object_set(rt, obj, key, value);
+            return value;
         }
         
         /* 如果没有特定的设置器，尝试通用的设置方法 */
         xc_method_func general_setter = find_method(type, "set");
         if (general_setter) {
-            /* 直接传递属性名和值，避免创建临时字符串和数组 */
-            va_list setter_args;
-            va_copy(setter_args, args);
-            va_arg(setter_args, xc_val); // 跳过value参数，因为已经读取了
-            xc_val result = general_setter(obj, rt->new(XC_TYPE_STRING, key));
-            va_end(setter_args);
-            va_end(args);
-            return result;
+            return general_setter(obj, xc_string_intern(rt, key));
         }
         
-        /* 如果这是对象类型，直接设置属性 */
-        if (type == XC_TYPE_OBJECT) {
-            /* 对于对象类型，我们使用特定的对象操作函数 */
-            /* 在实际代码中，应该通过结构体访问或函数指针访问 object_set */
-            /* 假设有一个合适的API，例如 */
-            xc_val key_obj = rt->new(XC_TYPE_STRING, key);
-            /* 注意：这里我们应该直接访问对象系统的API，而不是直接调用内部函数 */
-            /* 假设有一个合适的API，例如 */
-            xc_method_func obj_set = find_method(XC_TYPE_OBJECT, "set");
-            if (obj_set) {
-                xc_val args_array = rt->new(XC_TYPE_ARRAY, 2, key_obj, value);
-                obj_set(obj, args_array);
-            }
-            va_end(args);
-            return value;
-        }
-        
-        va_end(args);
         return value;
     }
     
-    va_end(args);
-    
     /* 这是获取操作 */
     
-    /* 准备方法名数组 */
-    const char* method_names[3];
-    xc_method_func methods[3];
-    
-    /* 设置特定getter名称 */
-    char getter_name[128] = "get_";
-    strncat(getter_name, key, sizeof(getter_name) - 5); // 5 = 长度"get_" + 1防止溢出
-    
-    method_names[0] = getter_name;  // "get_xxx"
-    method_names[1] = key;          // 直接方法名
-    method_names[2] = "get";        // 通用getter
-    
-    /* 批量查找 */
-    find_methods_batch(type, method_names, 3, methods);
-    
-    /* 使用结果 */
-    if (methods[0]) {
-        return methods[0](obj, NULL);
+    /* 特定getter "get_属性名" */
+    if (accessors->getter) {
+        return accessors->getter(obj, NULL);
     }
     
-    if (methods[1]) {
-        // return methods[1];  // 返回方法函数本身，以便后续调用
-        return rt->new(XC_TYPE_FUNC, method_names[1], methods[1]);
+    /* 方法：返回缓存的绑定函数，而不是每次创建新的函数对象 */
+    if (accessors->method) {
+        return get_bound_method(obj, accessors->method);
     }
     
-    if (methods[2]) {
-        return methods[2](obj, rt->new(XC_TYPE_STRING, key));
+    /* 对象类型直接读取属性（包括原型链） */
+    if (type == XC_TYPE_OBJECT) {
+        return xc_object_get(rt, obj, key);
     }
     
-    /* 如果这是对象类型，直接获取属性 */
-    if (type == XC_TYPE_OBJECT) {
-        /* 对于对象类型，我们使用特定的对象操作函数 */
-        xc_val key_obj = rt->new(XC_TYPE_STRING, key);
-        /* 注意：这里我们应该直接访问对象系统的API，而不是直接调用内部函数 */
-        /* 假设有一个合适的API，例如 */
-        xc_method_func obj_get = find_method(XC_TYPE_OBJECT, "get");
-        if (obj_get) {
-            return obj_get(obj, key_obj);
-        }
+    /* 通用getter */
+    xc_method_func general_getter = find_method(type, "get");
+    if (general_getter) {
+        return general_getter(obj, xc_string_intern(rt, key));
     }
     
     return NULL;
@@ -486,14 +542,14 @@ static xc_val function_handler(xc_val this_obj, int argc, xc_val* argv, xc_val c
     method_closure_t* method_closure = (method_closure_t*)closure;
     
     /* 添加栈帧 */
-    push_stack_frame("function_call", __FILE__, __LINE__);
+    int depth = push_stack_frame(&frame_function_call, NULL);
     
     /* 调用方法函数 */
     xc_val arg = (argc > 0) ? argv[0] : NULL;
     xc_val result = method_closure->func(method_closure->obj, arg);
     
     /* 移除栈帧 */
-    pop_stack_frame();
+    pop_stack_frame(depth);
     
     return result;
 }
@@ -548,13 +604,14 @@ static void throw_internal(xc_val error, bool allow_rethrow) {
             printf("%s\n", exc->message ? exc->message : "<无消息>");
             
             /* 打印栈跟踪 */
-            if (exc->stack_trace) {
+            xc_stack_trace_t *stack_trace = xc_exception_get_stack_trace(rt, error);
+            if (stack_trace) {
                 printf("异常堆栈:\n");
-                for (size_t i = 0; i < exc->stack_trace->count; i++) {
+                for (size_t i = 0; i < stack_trace->count; i++) {
                     printf("  %s at %s:%d\n", 
-                           exc->stack_trace->entries[i].function ? exc->stack_trace->entries[i].function : "<unknown>",
-                           exc->stack_trace->entries[i].file ? exc->stack_trace->entries[i].file : "<unknown>",
-                           exc->stack_trace->entries[i].line);
+                           stack_trace->entries[i].function ? stack_trace->entries[i].function : "<unknown>",
+                           stack_trace->entries[i].file ? stack_trace->entries[i].file : "<unknown>",
+                           stack_trace->entries[i].line);
                 }
             }
         } else {
@@ -563,13 +620,13 @@ static void throw_internal(xc_val error, bool allow_rethrow) {
         
         /* 打印栈跟踪 */
         printf("栈跟踪:\n");
-        xc_stack_frame_t* frame = _xc_thread_state.top;
-        while (frame) {
+        int depth = _xc_thread_state.depth < XC_MAX_STACK_FRAMES ?
+                    _xc_thread_state.depth : XC_MAX_STACK_FRAMES;
+        for (int i = depth - 1; i >= 0; i--) {
+            xc_stack_frame_t* frame = &_xc_thread_state.frames[i];
             printf("  %s at %s:%d\n", 
-                   frame->func_name ? frame->func_name : "<unknown>",
-                   frame->file_name ? frame->file_name : "<unknown>",
-                   frame->line_number);
-            frame = frame->prev;
+                   frame->name ? frame->name : frame->desc->func_name,
+                   frame->desc->file_name, frame->desc->line_number);
         }
         
         /* 终止程序 */
@@ -620,51 +677,58 @@ static xc_val try_catch_finally(xc_val try_func, xc_val catch_func, xc_val final
     xc_val error = NULL;
     bool exception_occurred = false;
     
-    /* 记录当前栈帧 */
-    push_stack_frame("try_catch_finally", __FILE__, __LINE__);
-    
-    printf("DEBUG: 开始执行try块\n");
+    /* 记录当前栈帧和正在执行的函数，longjmp 回来后恢复 */
+    int depth = push_stack_frame(&frame_try_catch_finally, NULL);
+    xc_object_t *function = xc_function_current(rt);
     
     /* 尝试执行try块 */
     if (setjmp(frame.jmp) == 0) {
         /* 正常执行路径 */
-        printf("DEBUG: 正常执行try块\n");
         result = xc_invoke(try_func, 0);
-        printf("DEBUG: try块执行完成，结果=%p\n", result);
+        /* 以错误结果返回的异常与 longjmp 抛出的走同一条处理路径 */
+        if (XC_IS_ERROR(result)) {
+            exception_occurred = true;
+            error = xc_take_pending_exception(rt);
+            result = NULL;
+        }
     } else {
         /* 异常处理路径 */
-        printf("DEBUG: 捕获到异常，进入异常处理路径\n");
+        xc_function_set_current(rt, function);
         exception_occurred = true;
         error = frame.exception;
         frame.exception = NULL;
+    }
+    
+    /* 恢复异常帧 */
+    xc_exception_frame = frame.prev;
+    
+    /* 如果有catch处理器，调用它；否则保持异常状态，稍后重新抛出 */
+    if (exception_occurred && catch_func && rt->is(catch_func, XC_TYPE_FUNC)) {
+        int catch_depth = push_stack_frame(&frame_catch_handler, NULL);
         
-        printf("DEBUG: 异常对象=%p，类型=%d\n", error, xc_typeof(error));
+        /* 创建临时异常帧来捕获catch中可能的异常 */
+        xc_exception_frame_t catch_frame;
+        catch_frame.prev = xc_exception_frame;
+        catch_frame.exception = NULL;
+        catch_frame.handled = false;
+        catch_frame.file = __FILE__;
+        catch_frame.line = __LINE__;
+        catch_frame.finally_handler = NULL;
+        catch_frame.finally_context = NULL;
         
-        /* 如果有catch处理器，调用它 */
-        if (catch_func && rt->is(catch_func, XC_TYPE_FUNC)) {
-            printf("DEBUG: 调用catch处理器\n");
-            push_stack_frame("catch_handler", __FILE__, __LINE__);
-            
-            /* 创建临时异常帧来捕获catch中可能的异常 */
-            xc_exception_frame_t catch_frame;
-            catch_frame.prev = xc_exception_frame;
-            catch_frame.exception = NULL;
-            catch_frame.handled = false;
-            catch_frame.file = __FILE__;
-            catch_frame.line = __LINE__;
-            catch_frame.finally_handler = NULL;
-            catch_frame.finally_context = NULL;
-            
-            xc_exception_frame = &catch_frame;
+        xc_exception_frame = &catch_frame;
+        
+        /* 使用setjmp捕获catch中可能抛出的异常 */
+        if (setjmp(catch_frame.jmp) == 0) {
+            /* 确保参数合法 */
+            xc_val args[1] = {error ? error : rt->new(XC_TYPE_NULL)};
+            result = xc_invoke_argv(catch_func, 1, args);
             
-            /* 使用setjmp捕获catch中可能抛出的异常 */
-            if (setjmp(catch_frame.jmp) == 0) {
-                /* 确保参数合法 */
-                xc_val args[1] = {error ? error : rt->new(XC_TYPE_NULL)};
-                printf("DEBUG: 准备调用catch处理器，参数=%p\n", args[0]);
-                result = xc_invoke(catch_func, 1, args);
-                printf("DEBUG: catch处理器执行完成，结果=%p\n", result);
-                
+            if (XC_IS_ERROR(result)) {
+                /* catch以错误结果返回 */
+                error = xc_take_pending_exception(rt);
+                result = NULL;
+            } else {
                 /* 标记异常已处理 */
                 exception_occurred = false;
                 
@@ -672,35 +736,24 @@ static xc_val try_catch_finally(xc_val try_func, xc_val catch_func, xc_val final
                 if (result == NULL) {
                     result = rt->new(XC_TYPE_STRING, "Caught");
                 }
-            } else {
-                /* catch中抛出了异常 */
-                printf("DEBUG: catch处理器中抛出了异常\n");
-                error = catch_frame.exception;
-                catch_frame.exception = NULL;
-                
-                /* 标记为需要重新抛出 */
-                exception_occurred = true;
             }
-            
-            /* 恢复异常帧 */
-            xc_exception_frame = catch_frame.prev;
-            
-            /* 弹出栈帧 */
-            pop_stack_frame();
         } else {
-            /* 没有catch处理器，保持异常状态 */
-            printf("DEBUG: 没有提供catch处理器，将重新抛出异常\n");
+            /* catch中抛出了异常，标记为需要重新抛出 */
+            xc_function_set_current(rt, function);
+            error = catch_frame.exception;
+            catch_frame.exception = NULL;
         }
+        
+        /* 恢复异常帧 */
+        xc_exception_frame = catch_frame.prev;
+        
+        /* 弹出栈帧 */
+        pop_stack_frame(catch_depth);
     }
     
-    /* 恢复异常帧 */
-    xc_exception_frame = frame.prev;
-    
     /* 尝试执行finally块 */
-    xc_val finally_result = NULL;
     if (finally_func && rt->is(finally_func, XC_TYPE_FUNC)) {
-        printf("DEBUG: 调用finally处理器\n");
-        push_stack_frame("finally_handler", __FILE__, __LINE__);
+        int finally_depth = push_stack_frame(&frame_finally_handler, NULL);
         
         /* 创建临时异常帧来捕获finally中可能的异常 */
         xc_exception_frame_t finally_frame;
@@ -714,21 +767,19 @@ static xc_val try_catch_finally(xc_val try_func, xc_val catch_func, xc_val final
         
         xc_exception_frame = &finally_frame;
         
-        /* 清理方法缓存，防止在finally执行过程中访问无效的缓存条目 */
-        clear_method_cache();
-        
         /* 使用setjmp捕获finally中可能抛出的异常 */
         if (setjmp(finally_frame.jmp) == 0) {
             xc_val args[1] = {exception_occurred ? (error ? error : rt->new(XC_TYPE_NULL)) : rt->new(XC_TYPE_NULL)};
-            finally_result = xc_invoke(finally_func, 1, args);
-            printf("DEBUG: finally处理器执行完成，结果=%p\n", finally_result);
+            if (XC_IS_ERROR(xc_invoke_argv(finally_func, 1, args))) {
+                /* finally抛出的异常总是优先的 */
+                error = xc_take_pending_exception(rt);
+                exception_occurred = true;
+            }
         } else {
-            /* finally中抛出了异常 */
-            printf("DEBUG: finally处理器中抛出了异常\n");
+            /* finally中抛出了异常，总是优先 */
+            xc_function_set_current(rt, function);
             error = finally_frame.exception;
             finally_frame.exception = NULL;
-            
-            /* finally抛出的异常总是优先的 */
             exception_occurred = true;
         }
         
@@ -736,24 +787,62 @@ static xc_val try_catch_finally(xc_val try_func, xc_val catch_func, xc_val final
         xc_exception_frame = finally_frame.prev;
         
         /* 弹出栈帧 */
-        pop_stack_frame();
+        pop_stack_frame(finally_depth);
     }
     
     /* 弹出栈帧 */
-    pop_stack_frame();
+    pop_stack_frame(depth);
     
     /* 如果有未处理的异常，重新抛出 */
     if (exception_occurred) {
-        printf("DEBUG: 重新抛出未处理的异常\n");
         throw_with_rethrow(error);
         return NULL;
     }
     
     /* 返回结果，优先返回try/catch的结果，忽略finally的结果 */
-    printf("DEBUG: try_catch_finally执行完成，返回结果=%p\n", result);
     return result;
 }
 
+/*
+ * try/catch/finally over error results: no setjmp frame is pushed, a block
+ * fails by returning XC_ERROR (xc_raise). An unhandled error is returned
+ * to the caller as XC_ERROR with the exception still pending. Throws via
+ * longjmp inside the blocks unwind past this call to the nearest
+ * try_catch_finally frame.
+ */
+xc_val xc_try_result(xc_runtime_t *rt, xc_val try_func, xc_val catch_func, xc_val finally_func) {
+    int depth = push_stack_frame(&frame_try_catch_finally, NULL);
+    
+    xc_val result = xc_invoke_argv(try_func, 0, NULL);
+    xc_val error = NULL;
+    if (XC_IS_ERROR(result)) {
+        error = xc_take_pending_exception(rt);
+        result = NULL;
+        if (catch_func) {
+            int catch_depth = push_stack_frame(&frame_catch_handler, NULL);
+            result = xc_invoke_argv(catch_func, 1, &error);
+            pop_stack_frame(catch_depth);
+            if (XC_IS_ERROR(result)) {
+                error = xc_take_pending_exception(rt);
+                result = NULL;
+            } else {
+                error = NULL;
+            }
+        }
+    }
+    
+    if (finally_func) {
+        int finally_depth = push_stack_frame(&frame_finally_handler, NULL);
+        if (XC_IS_ERROR(xc_invoke_argv(finally_func, 1, &error))) {
+            error = xc_take_pending_exception(rt);
+        }
+        pop_stack_frame(finally_depth);
+    }
+    
+    pop_stack_frame(depth);
+    return error ? xc_raise(rt, error) : result;
+}
+
 static int get_type_id(const char* name) {
     if (!name) return -1;
     
@@ -770,47 +859,47 @@ static int get_type_id(const char* name) {
     return -1;  /* 未找到 */
 }
 
+/* 调用函数（argc/argv 调用约定，无可变参数） */
+xc_val xc_invoke_argv(xc_val func, int argc, xc_val* argv) {
+    if (!func || func->type_id != XC_TYPE_FUNC) {
+        return NULL;
+    }
+    
+    /* 添加栈帧 */
+    int depth = push_stack_frame(&frame_invoke, NULL);
+    
+    /* 直接调用函数，异常处理由try_catch_finally函数统一处理 */
+    xc_val result = xc_function_invoke(func, NULL, argc, argv);
+    
+    /* 移除栈帧 */
+    pop_stack_frame(depth);
+    
+    return result;
+}
+
 /* 调用函数 */
 xc_val xc_invoke(xc_val func, int argc, ...) {
     if (!func) return NULL;
     
-    /* 检查类型 */
-    if (!rt->is(func, XC_TYPE_FUNC)) {
-        return NULL;
-    }
-    
-    /* 获取函数名（如果存在） */
-    const char* func_name = "<function>";
-    /* 尝试通过属性获取函数名 */
-    xc_val name_prop = xc_dot(func, "name");
-    if (name_prop && rt->is(name_prop, XC_TYPE_STRING)) {
-        func_name = (const char*)name_prop;
+    if (argc > XC_INVOKE_MAX_ARGS) {
+        return xc_raise(rt, xc_exception_create(rt, XC_EXCEPTION_TYPE_RANGE,
+                                                "invoke: too many arguments, use invoke_argv"));
     }
     
-    /* 添加栈帧 */
-    push_stack_frame(func_name, __FILE__, __LINE__);
-    
     /* 收集参数 */
     va_list args;
     va_start(args, argc);
     
-    xc_val argv[16]; /* 最多支持16个参数 */
+    xc_val argv[XC_INVOKE_MAX_ARGS];
     
     /* 从可变参数列表中收集参数 */
-    for (int i = 0; i < argc && i < 16; i++) {
+    for (int i = 0; i < argc; i++) {
         argv[i] = va_arg(args, xc_val);
     }
     
     va_end(args);
     
-    /* 直接调用函数，不再处理catch和finally */
-    /* 异常处理现在由try_catch_finally函数统一处理 */
-    xc_val result = xc_function_invoke(func, NULL, argc, argv);
-    
-    /* 移除栈帧 */
-    pop_stack_frame();
-    
-    return result;
+    return xc_invoke_argv(func, argc, argv);
 }
 
 int xc_typeof(xc_val val) {
@@ -837,28 +926,39 @@ int xc_is(xc_val val, int type) {
     return obj_type == type;
 }
 
-xc_val xc_call(xc_val obj, const char* method, ...) {
-    XC_LOG_DEBUG("call: obj=%p, method=%s", obj, method);
+/* 调用方法（argc/argv 调用约定，无可变参数） */
+xc_val xc_call_argv(xc_val obj, const char* method, int argc, xc_val* argv) {
     if (!obj || !method) {
-        XC_LOG_DEBUG("call: invalid parameters");
         return NULL;
     }
     
     /* 查找方法 */
-    int type = xc_typeof(obj);
-    XC_LOG_DEBUG("call: type=%d", type);
-    xc_method_func func = find_method(type, method);
+    xc_method_func func = find_method(obj->type_id, method);
     if (!func) {
         /* 方法未找到 */
-        XC_LOG_DEBUG("call: method not found");
+        XC_LOG_DEBUG("call: method not found: %s", method);
         return NULL;
     }
+    /* 方法签名是 (self, arg)，不能悄悄丢掉多余的参数 */
+    if (argc > 1) {
+        return xc_raise(rt, xc_exception_create(rt, XC_EXCEPTION_TYPE_TYPE,
+                                                "call: methods take one argument, pass an array"));
+    }
     
-    /* 添加栈帧 */
-    char method_desc[128];
-    snprintf(method_desc, sizeof(method_desc), "%s.%s",
-             (type >= 0 && type < 16) ? "Object" : "Unknown", method);
-    push_stack_frame(method_desc, __FILE__, __LINE__);
+    /* 添加栈帧：只保存描述符和方法名指针 */
+    int depth = push_stack_frame(&frame_call, method);
+    
+    /* 调用方法 */
+    xc_val result = func(obj, argc > 0 ? argv[0] : NULL);
+    
+    /* 移除栈帧 */
+    pop_stack_frame(depth);
+    
+    return result;
+}
+
+xc_val xc_call(xc_val obj, const char* method, ...) {
+    XC_LOG_DEBUG("call: obj=%p, method=%s", obj, method);
     
     /* 收集参数 */
     va_list args;
@@ -866,15 +966,7 @@ xc_val xc_call(xc_val obj, const char* method, ...) {
     xc_val arg = va_arg(args, xc_val); /* 获取单个参数 */
     va_end(args);
     
-    /* 调用方法 */
-    XC_LOG_DEBUG("call: calling method func=%p, obj=%p, arg=%p", func, obj, arg);
-    xc_val result = func(obj, arg);
-    XC_LOG_DEBUG("call: method returned result=%p", result);
-    
-    /* 移除栈帧 */
-    pop_stack_frame();
-    
-    return result;
+    return xc_call_argv(obj, method, 1, &arg);
 }
 
 static xc_val catch_handler(xc_val this_obj, int argc, xc_val* argv, xc_val closure) {
@@ -978,7 +1070,7 @@ static xc_val try_func(xc_val func) {
 // }
 
 xc_val xc_new(int type, ...) {
-    if (type < 0 || type >= 16) {
+    if (type < 0 || type >= XC_METHOD_TYPES) {
         char error_msg[128];
         snprintf(error_msg, sizeof(error_msg), "无效的类型ID: %d", type);
         // 避免递归调用xc_new，直接返回NULL
@@ -1015,61 +1107,38 @@ xc_object_t *xc_error_get_stack_trace(xc_runtime_t *rt, xc_object_t *error) {
         return NULL;
     }
     
-    /* 遍历当前线程的堆栈帧 */
-    xc_stack_frame_t* frame = _xc_thread_state.top;
-    while (frame != NULL) {
+    /* 从栈顶开始遍历当前线程的堆栈帧 */
+    int depth = _xc_thread_state.depth < XC_MAX_STACK_FRAMES ?
+                _xc_thread_state.depth : XC_MAX_STACK_FRAMES;
+    for (int i = depth - 1; i >= 0; i--) {
+        xc_stack_frame_t* frame = &_xc_thread_state.frames[i];
         /* 为每一帧创建一个包含信息的对象（这里简化为字符串） */
         char frame_info[256];
         snprintf(frame_info, sizeof(frame_info), "%s (%s:%d)",
-                 frame->func_name ? frame->func_name : "unknown",
-                 frame->file_name ? frame->file_name : "unknown",
-                 frame->line_number);
+                 frame->name ? frame->name : frame->desc->func_name,
+                 frame->desc->file_name, frame->desc->line_number);
         
         /* 创建字符串对象并添加到数组 */
         xc_val frame_str = rt->new(XC_TYPE_STRING, frame_info);
         if (frame_str) {
             /* 调用数组的push方法添加元素 */
             xc_val args[1] = {frame_str};
-            xc_call(stack_array, "push", 1, args);
+            xc_call_argv(stack_array, "push", 1, args);
             /* 这里不需要释放frame_str，因为它已经被添加到数组中 */
         }
-        
-        /* 移动到上一帧 */
-        frame = frame->prev;
     }
     
     return (xc_object_t *)stack_array;
 }
 
 
-/* 添加栈帧 */
-static void push_stack_frame(const char* func_name, const char* file_name, int line_number) {
-    xc_stack_frame_t* frame = (xc_stack_frame_t*)malloc(sizeof(xc_stack_frame_t));
-    if (!frame) {
-        /* 内存分配失败，但这是辅助功能，不应中断执行 */
-        return;
-    }
-    
-    frame->func_name = func_name;
-    frame->file_name = file_name;
-    frame->line_number = line_number;
-    frame->prev = _xc_thread_state.top;
-    
-    _xc_thread_state.top = frame;
-    _xc_thread_state.depth++;
+/* 开启/关闭运行时栈帧跟踪 */
+void xc_stack_frames_enable(xc_runtime_t *rt) {
+    __atomic_store_n(&xc_stack_frames_enabled, true, __ATOMIC_RELAXED);
 }
 
-/* 移除栈帧 */
-static void pop_stack_frame(void) {
-    if (_xc_thread_state.top == NULL) {
-        return;
-    }
-    
-    xc_stack_frame_t* frame = _xc_thread_state.top;
-    _xc_thread_state.top = frame->prev;
-    _xc_thread_state.depth--;
-    
-    free(frame);
+void xc_stack_frames_disable(xc_runtime_t *rt) {
+    __atomic_store_n(&xc_stack_frames_enabled, false, __ATOMIC_RELAXED);
 }
 
 /* 
@@ -1169,6 +1238,16 @@ xc_val xc_function_invoke(xc_val func, xc_val this_obj, int argc, xc_val* argv)
     /* 获取函数对象 */
     xc_function_t* function = (xc_function_t*)func;
     
+    /* 绑定的原生方法：以绑定的对象作为self调用，和 call_argv 一样只接收一个参数 */
+    if (function->method) {
+        if (argc > 1) {
+            return xc_raise(rt, xc_exception_create(rt, XC_EXCEPTION_TYPE_TYPE,
+                                                    "invoke: bound methods take one argument"));
+        }
+        return function->method(this_obj ? this_obj : function->this_obj,
+                                argc > 0 ? argv[0] : NULL);
+    }
+    
     /* 检查处理器 */
     if (!function->handler) {
         printf("DEBUG: 函数对象没有 handler\n");
@@ -1176,7 +1255,7 @@ xc_val xc_function_invoke(xc_val func, xc_val this_obj, int argc, xc_val* argv)
     }
     
     /* 准备参数 */
-    xc_val result = function->handler(rt, this_obj, argc, argv);
+    xc_val result = xc_function_apply_handler(rt, function, this_obj, argc, argv);
     
     /* 返回结果 */
     return result;
@@ -1223,6 +1302,8 @@ xc_runtime_t xc = {
     .call = xc_call,
     .dot = xc_dot,
     .invoke = xc_invoke,
+    .call_argv = xc_call_argv,
+    .invoke_argv = xc_invoke_argv,
     
     .try_catch_finally = try_catch_finally,
     .throw = throw,
@@ -1244,6 +1325,7 @@ rt = &xc;
     // 初始化方法缓存
     init_method_cache();
 
+    xc_register_null_type(rt);
     xc_register_string_type(rt);
     xc_register_boolean_type(rt);
     xc_register_number_type(rt);
@@ -1251,6 +1333,9 @@ rt = &xc;
     xc_register_object_type(rt);
     xc_register_function_type(rt);
     xc_register_error_type(rt);
+    xc_register_buffer_type(rt);
+    xc_register_iterator_type(rt);
+    xc_register_vm_type(rt);
     return rt;
 }
 
@@ -1267,13 +1352,9 @@ XC_REQUIRES(xc_init);
 XC_REQUIRES(xc_auto_shutdown);
 
 void init_method_cache(void) {
-    // 使用安全的方式初始化缓存
-    for (int i = 0; i < METHOD_CACHE_SIZE; i++) {
-        method_cache[i].key = 0;
-        method_cache[i].value = NULL;
-        method_cache[i].age = 0;
-    }
-    cache_age_counter = 0;
+    // 只清空当前线程的缓存，其他线程在首次查找时按版本号自行清空
+    memset(method_cache, 0, sizeof(method_cache));
+    method_cache_epoch = __atomic_load_n(&method_epoch, __ATOMIC_ACQUIRE);
     
     #ifdef XC_ENABLE_CACHE_STATS
     memset(&cache_stats, 0, sizeof(cache_stats));
@@ -1283,12 +1364,8 @@ void init_method_cache(void) {
 }
 
 void clear_method_cache(void) {
-    // 使用安全的方式清理缓存
-    for (int i = 0; i < METHOD_CACHE_SIZE; i++) {
-        method_cache[i].key = 0;
-        method_cache[i].value = NULL;
-        method_cache[i].age = 0;
-    }
+    // 递增版本号，使所有线程的缓存在下次查找时失效
+    __atomic_add_fetch(&method_epoch, 1, __ATOMIC_RELEASE);
     
     XC_LOG_DEBUG("方法缓存已清理");
 }
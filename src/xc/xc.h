@@ -147,7 +147,7 @@ typedef struct xc_runtime_t {
     char (*register_method)(int type, const char* func_name, xc_method_func native_func);
     xc_val (*call)(xc_val obj, const char* method, ...);
     xc_val (*dot)(xc_val obj, const char* key, ...);
-    xc_val (*invoke)(xc_val func, int argc, ...);
+    xc_val (*invoke)(xc_val func, int argc, ...);  /* 最多 16 个参数，超出返回 XC_ERROR */
     
     //exception handling
     xc_val (*try_catch_finally)(xc_val try_func, xc_val catch_func, xc_val finally_func);
@@ -156,6 +156,11 @@ typedef struct xc_runtime_t {
     void (*set_uncaught_exception_handler)(xc_val handler);
     xc_val (*get_current_error)(void);
     void (*clear_error)(void);
+
+    //fast calling convention: argc/argv, no va_list
+    //方法只接收一个参数 (self, arg)：argc > 1 返回 XC_ERROR，多个值请打包成数组
+    xc_val (*call_argv)(xc_val obj, const char* method, int argc, xc_val* argv);
+    xc_val (*invoke_argv)(xc_val func, int argc, xc_val* argv);
 } xc_runtime_t;
 
 // extern xc_runtime_t xc;//TODO remove for nameing conflicts
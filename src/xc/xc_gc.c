@@ -14,6 +14,7 @@ notes
 #define XC_GC_GRAY       1   /* Object is reachable but its children haven't been scanned */
 #define XC_GC_BLACK      2   /* Object is reachable and its children have been scanned */
 #define XC_GC_PERMANENT  3   /* Object is permanently reachable (never collected) */
+#define XC_GC_PERMANENT_SCANNED 4 /* Permanent object whose references were marked this cycle */
 
 void ensure_rt(void) {
     if (!rt) {
@@ -74,8 +75,8 @@ void xc_gc_init_auto(xc_runtime_t *rt, const xc_gc_config_t *config) {
     
     // 初始化对象列表
     xc_gc_context->white_list = NULL;
-    xc_gc_context->gray_list = NULL;
-    xc_gc_context->black_list = NULL;
+    xc_gc_context->mark_stack = NULL;
+    xc_gc_context->permanent_seen = NULL;
     xc_gc_context->roots = NULL;
     xc_gc_context->root_count = 0;
     xc_gc_context->root_capacity = 0;
@@ -93,35 +94,73 @@ void xc_gc_shutdown(xc_runtime_t *rt) {
         return;
     }
     
-    // 释放根集合
+    // 释放根集合和标记栈
     if (gc->roots) {
         free(gc->roots);
         gc->roots = NULL;
     }
+    free(gc->mark_stack);
+    free(gc->permanent_seen);
     
     // 释放 GC 上下文
     free(gc);
     xc_gc_context = NULL;
 }
 
-/* Mark phase of GC - traverse object and mark all reachable objects */
+void _xc_gc_mark_val(xc_val val);
+
+/* Push an object onto one of the context's growable object stacks */
+static bool xc_gc_push(xc_object_t ***stack, size_t *count, size_t *capacity, xc_object_t *obj) {
+    if (*count >= *capacity) {
+        size_t new_capacity = *capacity == 0 ? 256 : *capacity * 2;
+        xc_object_t **grown = (xc_object_t **)realloc(*stack, new_capacity * sizeof(xc_object_t *));
+        if (!grown) {
+            return false;
+        }
+        *stack = grown;
+        *capacity = new_capacity;
+    }
+    (*stack)[(*count)++] = obj;
+    return true;
+}
+
+/* Call the type's marker on an object whose own mark is set */
+static void xc_gc_scan(xc_object_t *obj) {
+    xc_type_lifecycle_t *type_handler = get_type_handler(obj->type_id);
+    if (type_handler && type_handler->marker) {
+        type_handler->marker((xc_val)obj, _xc_gc_mark_val);
+    }
+}
+
+/* Mark phase of GC - mark an object reachable and queue it for scanning */
 void xc_gc_mark(xc_runtime_t *rt, xc_object_t *obj) {
-    if (!obj || obj->gc_color != XC_GC_WHITE) {
-        return;  // 已经标记过或不需要标记
+    if (!obj) {
+        return;
     }
     
-    // 将对象标记为灰色
-    obj->gc_color = XC_GC_GRAY;
-    
     // 获取GC上下文
     xc_gc_context_t *gc = (xc_gc_context_t *)xc_gc_context;
     if (!gc) {
         return;
     }
     
-    // 将对象添加到灰色列表
-    obj->gc_next = gc->gray_list;
-    gc->gray_list = obj;
+    if (obj->gc_color == XC_GC_WHITE) {
+        // 将对象标记为灰色，等待扫描它引用的对象
+        obj->gc_color = XC_GC_GRAY;
+    } else if (obj->gc_color == XC_GC_PERMANENT) {
+        // 永久对象不回收，但它引用的对象仍要标记；每轮只扫描一次
+        obj->gc_color = XC_GC_PERMANENT_SCANNED;
+        if (!xc_gc_push(&gc->permanent_seen, &gc->permanent_count, &gc->permanent_capacity, obj)) {
+            obj->gc_color = XC_GC_PERMANENT;
+        }
+    } else {
+        return;  // 已经标记过
+    }
+    
+    // 放入标记栈；栈无法增长时直接扫描
+    if (!xc_gc_push(&gc->mark_stack, &gc->mark_count, &gc->mark_capacity, obj)) {
+        xc_gc_scan(obj);
+    }
 }
 
 /* 标记值为可达（用于 marker 函数） */
@@ -135,39 +174,26 @@ void _xc_gc_mark_val(xc_val val) {
     xc_gc_mark(rt, obj);
 }
 
-/* Process gray list and mark all reachable objects */
+/* Drain the mark stack: scan gray objects until everything reachable is marked */
 static void xc_gc_process_gray_list(xc_runtime_t *rt) {
     xc_gc_context_t *gc = (xc_gc_context_t *)xc_gc_context;
     
-    // 处理灰色对象列表
-    xc_object_t *obj = gc->gray_list;
-    gc->gray_list = NULL;
-    
-    while (obj) {
-        // 将对象标记为黑色
-        obj->gc_color = XC_GC_BLACK;
-        
-        // 将对象从灰色列表移到黑色列表
-        xc_object_t *next = obj->gc_next;
-        obj->gc_next = gc->black_list;
-        gc->black_list = obj;
-        
-        // 标记对象引用的其他对象
-        xc_type_lifecycle_t *type_handler = get_type_handler(obj->type_id);
-        if (type_handler && type_handler->marker) {
-            type_handler->marker((xc_val)obj, _xc_gc_mark_val);
+    while (gc->mark_count > 0) {
+        xc_object_t *obj = gc->mark_stack[--gc->mark_count];
+        if (obj->gc_color == XC_GC_GRAY) {
+            obj->gc_color = XC_GC_BLACK;
         }
         
-        obj = next;
+        // 标记对象引用的其他对象（可能继续压栈）
+        xc_gc_scan(obj);
     }
 }
 
-/* Sweep phase of GC - detect and free unreachable objects */
+/* Sweep phase of GC - free unmarked objects and clear the marks of the rest */
 static size_t xc_gc_sweep(xc_runtime_t *rt) {
     xc_gc_context_t *gc = (xc_gc_context_t *)xc_gc_context;
     size_t freed_count = 0;
     
-    // 遍历白色对象列表，释放未标记的对象
     xc_object_t *curr = gc->white_list;
     xc_object_t *prev = NULL;
     
@@ -190,16 +216,27 @@ static size_t xc_gc_sweep(xc_runtime_t *rt) {
             }
             
             // 释放内存
+            gc->used_memory -= curr->size;
+            gc->total_freed++;
             free(curr);
             freed_count++;
         } else {
-            // 保留对象
+            // 保留对象，下一轮重新从白色开始
+            if (curr->gc_color == XC_GC_BLACK) {
+                curr->gc_color = XC_GC_WHITE;
+            }
             prev = curr;
         }
         
         curr = next;
     }
     
+    /* Permanent objects go back to their unscanned state */
+    for (size_t i = 0; i < gc->permanent_count; i++) {
+        gc->permanent_seen[i]->gc_color = XC_GC_PERMANENT;
+    }
+    gc->permanent_count = 0;
+    
     return freed_count;
 }
 
@@ -216,29 +253,6 @@ static void xc_gc_mark_roots(xc_runtime_t *rt) {
     }
 }
 
-/* Reset object colors for next GC cycle */
-static void xc_gc_reset_colors(xc_runtime_t *rt) {
-    xc_gc_context_t *gc = xc_gc_get_context(rt);
-    
-    /* Move all black objects to white list */
-    while (gc->black_list) {
-        xc_object_t *obj = gc->black_list;
-        gc->black_list = obj->gc_next;
-        
-        /* Skip permanent objects */
-        if (obj->gc_color == XC_GC_PERMANENT) {
-            continue;
-        }
-        
-        /* Reset color to white */
-        obj->gc_color = XC_GC_WHITE;
-        
-        /* Add to white list */
-        obj->gc_next = gc->white_list;
-        gc->white_list = obj;
-    }
-}
-
 void xc_gc_run(xc_runtime_t *rt) {
     xc_gc_context_t *gc = xc_gc_get_context(rt);
     
@@ -249,9 +263,6 @@ void xc_gc_run(xc_runtime_t *rt) {
     struct timespec start, end;
     clock_gettime(CLOCK_MONOTONIC, &start);
     
-    /* Reset object colors */
-    xc_gc_reset_colors(rt);
-    
     /* Mark phase */
     xc_gc_mark_roots(rt);
     xc_gc_process_gray_list(rt);
@@ -259,6 +270,13 @@ void xc_gc_run(xc_runtime_t *rt) {
     /* Sweep phase */
     size_t freed = xc_gc_sweep(rt);
     
+    /* Grow the heap when live data alone is over the threshold,
+     * so the next allocation does not start another collection */
+    if (gc->used_memory >= gc->heap_size * gc->config.gc_threshold) {
+        size_t grown = (size_t)(gc->used_memory / gc->config.gc_threshold * gc->config.growth_factor);
+        gc->heap_size = grown < gc->config.max_heap_size ? grown : gc->config.max_heap_size;
+    }
+    
     /* Record end time and calculate pause time */
     clock_gettime(CLOCK_MONOTONIC, &end);
     double pause_time_ms = (end.tv_sec - start.tv_sec) * 1000.0 +
@@ -351,7 +369,7 @@ xc_object_t *xc_gc_alloc(xc_runtime_t *rt, size_t size, int type_id) {
 //TODO 不对，应该 root.dot(name, XC_FLAG_CONST, val)?
 void xc_gc_mark_permanent(xc_runtime_t *rt, xc_object_t *obj) {
     if (!obj) return;
-    obj->gc_color = XC_GC_BLACK;
+    obj->gc_color = XC_GC_PERMANENT;
 }
 
 // /* Add a reference to an object */
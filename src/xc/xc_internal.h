@@ -62,8 +62,10 @@ bool xc_gc_is_enabled(xc_runtime_t *rt);
 xc_object_t *xc_gc_alloc(xc_runtime_t *rt, size_t size, int type_id);
 // void xc_gc_free(xc_runtime_t *rt, xc_object_t *obj);
 //TODO 不对，应该 root.dot(name, XC_FLAG_CONST, val)?
-// void xc_gc_mark_permanent(xc_runtime_t *rt, xc_object_t *obj);
+void xc_gc_mark_permanent(xc_runtime_t *rt, xc_object_t *obj);
 void xc_gc_mark(xc_runtime_t *rt, xc_object_t *obj);
+void xc_gc_add_root(xc_runtime_t *rt, xc_object_t **root_ptr);
+void xc_gc_remove_root(xc_runtime_t *rt, xc_object_t **root_ptr);
 // void xc_gc_mark_val(xc_val obj);//innerl
 
 
@@ -104,19 +106,87 @@ typedef struct xc_type {
     int (*compare)(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);  /* Ordering comparison */
 } xc_type_t;
 
-/* Object property structure */
-typedef struct xc_property {
-    xc_object_t *key;    /* String key */
-    xc_object_t *value;  /* Any value */
-} xc_property_t;
+/*
+ * Hidden class (shape) for objects.
+ * Shapes form a transition tree rooted at the empty shape: adding a key to
+ * an object moves it to the child shape for that key. Objects built with
+ * the same key sequence share one shape, so keys are stored once in the
+ * shape and each object only keeps an array of slot values.
+ * Shapes are never freed. To keep the tree bounded, a shape takes at most
+ * XC_SHAPE_MAX_TRANSITIONS children and the tree at most XC_SHAPE_MAX_COUNT
+ * shapes; an object whose next key would exceed either moves to dictionary
+ * mode, as does any object that deletes a key.
+ */
+typedef struct xc_shape {
+    struct xc_shape *parent;       /* Shape before the last key was added */
+    struct xc_shape *children;     /* First transition out of this shape */
+    struct xc_shape *sibling;      /* Next transition out of the parent */
+    uint32_t child_count;          /* Number of transitions out of this shape */
+    const char *key;               /* Key added by this transition */
+    unsigned int hash;             /* Hash of key */
+    uint32_t slot_count;           /* Number of keys (slots) */
+    const char **keys;             /* keys[i] is the key of slot i */
+    unsigned int *hashes;          /* hashes[i] is the hash of keys[i] */
+} xc_shape_t;
+
+/* Inline cache for one property access site */
+typedef struct xc_inline_cache {
+    xc_shape_t *shape;             /* Shape last seen at this site */
+    xc_shape_t *transition;        /* Shape after adding the key (set sites only) */
+    uint32_t slot;                 /* Slot of the key */
+} xc_inline_cache_t;
+
+/* Dictionary-mode entry, kept in insertion order */
+typedef struct xc_dict_entry {
+    char *key;                     /* Owned key copy, NULL for a deleted entry */
+    unsigned int hash;             /* Cached hash of key */
+    xc_object_t *value;            /* Property value */
+} xc_dict_entry_t;
+
+/*
+ * Dictionary mode for objects with many keys.
+ * An open-addressing index (one control byte per bucket holding 7 bits of
+ * the hash, probed a group at a time) maps keys to positions in a dense
+ * insertion-ordered entry array. Deletion shifts later buckets back
+ * instead of leaving tombstones in the index.
+ */
+typedef struct xc_dict {
+    xc_dict_entry_t *entries;      /* Entries in insertion order */
+    uint32_t entry_count;          /* Used entries, including deleted ones */
+    uint32_t entry_capacity;       /* Allocated entries */
+    uint32_t live;                 /* Entries that are not deleted */
+    uint32_t bucket_mask;          /* Number of buckets - 1 */
+    uint8_t *ctrl;                 /* Control bytes, mirrored for wrap-around */
+    uint32_t *index;               /* Entry position for each bucket */
+} xc_dict_t;
+
+/* Own-property count above which an object switches to dictionary mode */
+#ifndef XC_OBJECT_DICT_THRESHOLD
+#define XC_OBJECT_DICT_THRESHOLD 64
+#endif
+
+/* Transitions out of one shape, and shapes in the whole tree */
+#ifndef XC_SHAPE_MAX_TRANSITIONS
+#define XC_SHAPE_MAX_TRANSITIONS 32
+#endif
+#ifndef XC_SHAPE_MAX_COUNT
+#define XC_SHAPE_MAX_COUNT 16384
+#endif
+
+/* Number of property slots stored inside the object itself */
+#ifndef XC_OBJECT_INLINE_SLOTS
+#define XC_OBJECT_INLINE_SLOTS 4
+#endif
 
 /* Object data structure */
 typedef struct xc_object_data_t {
     xc_object_t base;          /* Must be first */
-    xc_property_t *properties; /* Array of properties */
-    size_t count;             /* Number of properties */
-    size_t capacity;          /* Allocated capacity */
-    xc_object_t *prototype;   /* Prototype object */
+    xc_shape_t *shape;         /* Hidden class mapping keys to slots */
+    xc_object_t **slots;       /* Property values indexed by shape slot */
+    size_t capacity;           /* Allocated slots */
+    xc_object_t *prototype;    /* Prototype object */
+    xc_dict_t *dict;           /* Dictionary storage, NULL while using shapes */
+    xc_object_t *inline_slots[XC_OBJECT_INLINE_SLOTS]; /* Slots for small objects */
 } xc_object_data_t;
 
 /* 
@@ -127,16 +197,302 @@ typedef struct xc_function_t {
     xc_function_ptr_t handler; /* Function handler */
     xc_object_t *closure;      /* Closure environment */
     xc_object_t *this_obj;     /* Bound this value */
+    xc_method_func method;     /* Bound native method, called as method(this_obj, argv[0]) */
+    size_t capture_count;      /* Number of captured-variable slots */
+    xc_object_t *captures[];   /* Captured variables, allocated with the function */
 } xc_function_t;
 
+/* Captured variable `slot` of a closure, an indexed load with no bounds check */
+#define XC_CAPTURE(func, slot) (((xc_function_t *)(func))->captures[(slot)])
+
+/* Slices and concats at least this long share storage instead of copying */
+#ifndef XC_ARRAY_VIEW_MIN
+#define XC_ARRAY_VIEW_MIN 32
+#endif
+
+/* Slot block behind one or more arrays; shared blocks are copied before a write */
+typedef struct xc_array_store {
+    size_t refs;          /* Arrays whose items point into this block */
+    xc_object_t *slots[]; /* Element pointers */
+} xc_array_store_t;
+
 /* Array object structure */
 typedef struct xc_array_t {
     xc_object_t base;     /* Must be first */
-    xc_object_t **items;  /* Array of object pointers */
-    size_t length;        /* Current number of items */
-    size_t capacity;      /* Allocated capacity */
+    xc_object_t **items;  /* Array of object pointers (first element) */
+    size_t length;        /* Current number of items, tail included */
+    size_t capacity;      /* Slots available from items onward */
+    size_t head;          /* Slots before items; items == store->slots + head */
+    xc_array_store_t *store;      /* Block holding items, NULL while empty */
+    /* Chunked concat view: the last tail_length elements live in another block */
+    xc_array_store_t *tail_store;
+    xc_object_t **tail_items;
+    size_t tail_length;
 } xc_array_t;
 
+/* 类型化数组的元素类型 */
+#define XC_BUFFER_FLOAT64 0
+#define XC_BUFFER_FLOAT32 1
+#define XC_BUFFER_INT64   2
+#define XC_BUFFER_INT32   3
+#define XC_BUFFER_UINT8   4
+
+/* Typed array (XC_TYPE_BUFFER): unboxed elements in one contiguous block */
+typedef struct xc_buffer_t {
+    xc_object_t base;     /* Must be first */
+    int kind;             /* XC_BUFFER_* */
+    size_t length;        /* Current number of elements */
+    size_t capacity;      /* Allocated elements */
+    void *data;           /* length * element size bytes, malloc'd */
+} xc_buffer_t;
+
+/* Lazy pipeline stages (XC_TYPE_ITERATOR) */
+#define XC_ITER_MAP           0
+#define XC_ITER_FILTER        1
+#define XC_ITER_MAP_NATIVE    2
+#define XC_ITER_FILTER_NATIVE 3
+#define XC_ITER_MAP_F64       4
+#define XC_ITER_FILTER_F64    5
+#define XC_ITER_SKIP          6
+#define XC_ITER_TAKE          7
+
+/* Native stage callbacks; the f64 forms work on unboxed numbers */
+typedef xc_object_t *(*xc_iter_map_func)(xc_runtime_t *rt, xc_object_t *value, void *data);
+typedef bool (*xc_iter_filter_func)(xc_runtime_t *rt, xc_object_t *value, void *data);
+typedef double (*xc_iter_map_f64_func)(double value, void *data);
+typedef bool (*xc_iter_filter_f64_func)(double value, void *data);
+typedef xc_object_t *(*xc_iter_reduce_func)(xc_runtime_t *rt, xc_object_t *acc, xc_object_t *value, void *data);
+
+typedef struct xc_iter_stage {
+    int kind;                  /* XC_ITER_* */
+    xc_object_t *fn;           /* xc function for MAP/FILTER */
+    union {
+        xc_iter_map_func map;
+        xc_iter_filter_func filter;
+        xc_iter_map_f64_func map_f64;
+        xc_iter_filter_f64_func filter_f64;
+    };
+    void *data;                /* Passed to native callbacks */
+    size_t count;              /* SKIP/TAKE limit */
+    size_t seen;               /* SKIP/TAKE progress within the current run */
+} xc_iter_stage_t;
+
+/* Iterator: a source plus stages that a terminal runs in one fused pass */
+typedef struct xc_iterator_t {
+    xc_object_t base;          /* Must be first */
+    xc_object_t *source;       /* Array or typed array */
+    xc_iter_stage_t *stages;   /* Applied in order to every element */
+    size_t stage_count;
+    size_t stage_capacity;
+    xc_object_t *value;        /* Element in flight (boxed form) */
+    xc_object_t *acc;          /* Terminal state: reduce accumulator or result array */
+    xc_object_t *outer;        /* Iterator that was running when this run started */
+} xc_iterator_t;
+
+/*
+ * Bytecode VM (XC_TYPE_VM)
+ */
+/* 字节码指令类型 */
+typedef enum {
+    /* 基础栈操作 */
+    OP_NOP,            // 空操作
+    OP_PUSH_VAL,       // 压入值（胖指针类型）
+    OP_POP,            // 弹出栈顶
+    OP_DUP,            // 复制栈顶值
+    OP_SWAP,           // 交换栈顶两个值
+    
+    /* 算术运算 */
+    OP_ADD,            // 加法
+    OP_SUB,            // 减法
+    OP_MUL,            // 乘法
+    OP_DIV,            // 除法
+    OP_MOD,            // 取模
+    OP_NEG,            // 取负
+    
+    /* 位运算 */
+    OP_BIT_AND,        // 按位与
+    OP_BIT_OR,         // 按位或
+    OP_BIT_XOR,        // 按位异或
+    OP_BIT_NOT,        // 按位取反
+    OP_SHL,            // 左移
+    OP_SHR,            // 右移
+    
+    /* 比较运算 */
+    OP_EQ,             // 相等
+    OP_NE,             // 不等
+    OP_LT,             // 小于
+    OP_LE,             // 小于等于
+    OP_GT,             // 大于
+    OP_GE,             // 大于等于
+    
+    /* 逻辑运算 */
+    OP_AND,            // 逻辑与
+    OP_OR,             // 逻辑或
+    OP_NOT,            // 逻辑非
+    
+    /* 变量操作 */
+    OP_STORE,          // 存储变量
+    OP_LOAD,           // 加载变量
+    OP_LOAD_GLOBAL,    // 加载全局变量
+    OP_STORE_GLOBAL,   // 存储全局变量
+    
+    /* 属性操作 - 用于JSON和对象 */
+    OP_GET_PROP,       // 获取属性
+    OP_SET_PROP,       // 设置属性
+    OP_HAS_PROP,       // 检查属性是否存在
+    OP_DEL_PROP,       // 删除属性
+    
+    /* 数组操作 */
+    OP_NEW_ARRAY,      // 创建新数组
+    OP_GET_ELEM,       // 获取数组元素
+    OP_SET_ELEM,       // 设置数组元素
+    OP_ARRAY_LEN,      // 获取数组长度
+    OP_ARRAY_PUSH,     // 数组末尾添加元素
+    OP_ARRAY_POP,      // 弹出数组末尾元素
+    
+    /* 对象操作 */
+    OP_NEW_OBJECT,     // 创建新对象
+    OP_KEYS,           // 获取对象键列表
+    
+    /* 函数操作 */
+    OP_CALL,           // 调用函数，参数: [arg_count]
+    OP_TAIL_CALL,      // 尾调用优化
+    OP_RET,            // 返回，将栈顶值作为返回值
+    OP_RET_VOID,       // 返回void
+    OP_MAKE_CLOSURE,   // 创建闭包函数
+    
+    /* 控制流 */
+    OP_JMP,            // 无条件跳转
+    OP_JMP_IF_TRUE,    // 条件为真时跳转
+    OP_JMP_IF_FALSE,   // 条件为假时跳转
+    
+    /* 异常处理 */
+    OP_TRY_BEGIN,      // 开始try块，参数: [catch_addr, finally_addr]
+    OP_TRY_END,        // 结束try块
+    OP_THROW,          // 抛出异常
+    OP_RETHROW,        // 重新抛出当前异常
+    
+    /* 作用域操作 */
+    OP_ENTER_SCOPE,    // 进入新作用域
+    OP_LEAVE_SCOPE,    // 离开当前作用域
+    
+    /* 类LISP语言特性支持 */
+    OP_CONS,           // 创建cons单元 (a . b)
+    OP_CAR,            // 获取cons单元的第一个元素
+    OP_CDR,            // 获取cons单元的第二个元素
+    OP_IS_SYMBOL,      // 检查是否为符号
+    OP_IS_LIST,        // 检查是否为列表
+    
+    /* 异步支持 */
+    OP_AWAIT,          // 等待Promise完成
+    OP_YIELD,          // 生成器yield
+    OP_RESUME,         // 恢复生成器执行
+    
+    /* 调试支持 */
+    OP_BREAKPOINT,     // 断点
+    OP_LINE_NUM,       // 源代码行号，用于调试和错误报告
+    OP_SOURCE_POS,     // 源代码位置信息
+    
+    /* 内存和GC相关操作 */
+    OP_GC_HINT,        // 提示GC可能是个好时机（优化用）
+    
+    /* JIT优化支持 */
+    OP_JIT_HINT_LOOP,  // 提示JIT编译器这是循环开始（用于热点检测）
+    OP_JIT_HINT_END,   // 提示JIT编译器循环结束
+    
+    OP_COUNT           // 操作码数量；解释器内部用作代码末尾的哨兵
+} xc_opcode_t;
+
+/* 字节码指令结构：构建用的形式，执行前编码为紧凑字节流。
+ * xc_vm_emit 之后 PUSH_VAL 和名字操作数的 operand.i32 是常量池/名字池下标 */
+typedef struct {
+    xc_opcode_t op;     // 操作码
+    union {
+        xc_val val;     // 值（胖指针）
+        double num;     // 数字常量
+        char* str;      // 字符串常量
+        int32_t i32;    // 32位整数
+        int64_t i64;    // 64位整数
+        struct {
+            int32_t addr1;  // 第一个地址参数（用于try/catch等）
+            int32_t addr2;  // 第二个地址参数
+        } addr_pair;
+        struct {
+            uint16_t index;  // 变量或属性索引
+            uint16_t scope;  // 作用域深度
+        } var;
+    } operand;
+} xc_instruction_t;
+
+/* try 处理器：catch 地址和进入 try 时的栈深度 */
+typedef struct xc_vm_handler {
+    int catch_pc;
+    int stack_top;
+} xc_vm_handler_t;
+
+/* GCC/Clang 使用 computed goto 直接线程化，其他编译器退回 switch */
+#ifndef XC_VM_THREADED
+#if defined(__GNUC__)
+#define XC_VM_THREADED 1
+#else
+#define XC_VM_THREADED 0
+#endif
+#endif
+
+/* 执行模式：栈字节码或由它翻译出的三地址寄存器代码 */
+#define XC_VM_MODE_REGISTER 0
+#define XC_VM_MODE_STACK 1
+
+#ifndef XC_VM_MAX_HANDLERS
+#define XC_VM_MAX_HANDLERS 32
+#endif
+
+/* VM 类型数据结构 */
+typedef struct xc_vm_t {
+    xc_object_t base;       // Must be first
+    
+    xc_val* stack;          // 操作数栈
+    int stack_size;         // 栈大小
+    int stack_top;          // 栈顶指针
+    
+    xc_instruction_t* code; // 构建中的指令
+    int code_size;          // 指令数量
+    int code_capacity;      // 指令容量
+    int pc;                 // 程序计数器（字节流偏移）
+    
+    xc_val* constants;      // 常量池，GC 只标记这里
+    int constant_count;     // 常量数量
+    int constant_capacity;  // 常量池容量
+    char** names;           // 名字池（全局变量名和属性名）
+    int name_count;         // 名字数量
+    
+    xc_val* locals;         // 寄存器文件 [局部变量 | 临时寄存器 | 常量]，OP_LOAD/OP_STORE 按 var.index 访问
+    int local_count;        // 局部变量槽数量
+    int reg_count;          // 寄存器文件大小
+    
+    xc_vm_handler_t handlers[XC_VM_MAX_HANDLERS]; // try 处理器栈
+    int handler_count;      // 活动的 try 处理器数量
+    
+    xc_val global;          // 全局作用域
+    xc_val exception;       // 当前异常，如果有
+    
+    xc_val result;          // 最后执行结果
+    
+    /* 执行前的准备结果，code 变化后重建 */
+    uint8_t* bytecode;      // 编码后的字节流，末尾是 OP_COUNT 哨兵
+    int bytecode_size;      // 字节流长度（不含哨兵）
+    uint8_t* regcode;       // 翻译出的寄存器代码（同样的字节编码）
+    int regcode_size;       // 寄存器代码长度
+    int reg_instr_count;    // 寄存器指令数量
+    int mode;               // XC_VM_MODE_REGISTER 或 XC_VM_MODE_STACK
+    xc_inline_cache_t* caches; // 每个属性访问点的内联缓存
+    int cache_count;        // 内联缓存数量
+    int prepared_size;      // 已准备的 code_size，-1 表示需要重建
+    int max_stack;          // 校验得到的最大栈深度
+    
+    xc_object_t* outer;     // 本次运行开始时正在运行的 VM
+} xc_vm_t;
+
 /* 错误代码定义 */
 #define XC_ERR_NONE 0
 #define XC_ERR_GENERIC 1        /* 通用错误 */
@@ -187,6 +543,7 @@ xc_object_t *xc_error_get_cause(xc_runtime_t *rt, xc_object_t *error);
 #define XC_EXCEPTION_TYPE_RANGE       4   /* Range Error */
 #define XC_EXCEPTION_TYPE_MEMORY      5   /* Memory Error */
 #define XC_EXCEPTION_TYPE_INTERNAL    6   /* Internal Error */
+#define XC_EXCEPTION_TYPE_STACK_OVERFLOW 7 /* Stack Overflow */
 #define XC_EXCEPTION_TYPE_USER        100 /* User-defined Exceptions start here */
 
 /* Exception frame structure */
@@ -201,6 +558,19 @@ typedef struct xc_exception_frame {
     void *finally_context;              /* Context for finally handler */
 } xc_exception_frame_t;
 
+/* 静态栈帧描述符：在调用点定义为 static const，压栈时只保存指针 */
+typedef struct xc_frame_desc {
+    const char* func_name;         /* 函数名称 */
+    const char* file_name;         /* 文件名称 */
+    int line_number;               /* 行号 */
+} xc_frame_desc_t;
+
+/* 执行栈帧结构 */
+typedef struct xc_stack_frame {
+    const xc_frame_desc_t* desc;   /* 调用点描述符 */
+    const char* name;              /* 方法名（可选，调用期间有效） */
+} xc_stack_frame_t;
+
 /* Stack trace entry structure */
 typedef struct xc_stack_trace_entry {
     const char *function;               /* Function name */
@@ -215,13 +585,36 @@ typedef struct xc_stack_trace {
     size_t capacity;                    /* Capacity of entries array */
 } xc_stack_trace_t;
 
+/* Innermost call frames an exception snapshots when it is created */
+#ifndef XC_EXCEPTION_TRACE_FRAMES
+#define XC_EXCEPTION_TRACE_FRAMES 16
+#endif
+
+/* Messages up to this length (with the NUL) are stored inside the exception */
+#ifndef XC_EXCEPTION_MESSAGE_INLINE
+#define XC_EXCEPTION_MESSAGE_INLINE 64
+#endif
+
+/* Per-thread pool of recycled exceptions */
+#ifndef XC_EXCEPTION_POOL_SIZE
+#define XC_EXCEPTION_POOL_SIZE 32
+#endif
+
+/* Exception flags */
+#define XC_EXCEPTION_POOLED   1   /* Outside the GC heap, returned to the pool on release */
+#define XC_EXCEPTION_RESERVED 2   /* Per-thread preallocated, never freed */
+
 /* Exception object structure (extends xc_object_t) */
 typedef struct xc_exception {
     xc_object_t base;                   /* Base object header */
     int type;                           /* Exception type */
-    char *message;                      /* Exception message */
-    xc_stack_trace_t *stack_trace;      /* Stack trace */
+    int flags;                          /* XC_EXCEPTION_POOLED / XC_EXCEPTION_RESERVED */
+    char *message;                      /* Exception message, inline_message when it fits */
+    char inline_message[XC_EXCEPTION_MESSAGE_INLINE];
+    xc_stack_trace_t *stack_trace;      /* Stack trace, formatted on first request */
     struct xc_exception *cause;         /* Cause exception (if chained) */
+    int trace_depth;                    /* Call depth at creation, 0 when traces are off */
+    xc_stack_frame_t trace_frames[];    /* Snapshot of up to XC_EXCEPTION_TRACE_FRAMES frames, innermost first */
 } xc_exception_t;
 
 /*
@@ -235,6 +628,9 @@ void xc_register_array_type(xc_runtime_t *rt);
 void xc_register_object_type(xc_runtime_t *rt);
 void xc_register_function_type(xc_runtime_t *rt);
 void xc_register_error_type(xc_runtime_t *rt);
+void xc_register_buffer_type(xc_runtime_t *rt);
+void xc_register_iterator_type(xc_runtime_t *rt);
+void xc_register_vm_type(xc_runtime_t *rt);
 
 /* Type registration helper */
 int xc_register_type(const char *name, xc_type_lifecycle_t *lifecycle);
@@ -245,14 +641,56 @@ int xc_register_type(const char *name, xc_type_lifecycle_t *lifecycle);
 xc_object_t *xc_null_create(xc_runtime_t *rt);
 xc_object_t *xc_boolean_create(xc_runtime_t *rt, bool value);
 xc_object_t *xc_number_create(xc_runtime_t *rt, double value);
+xc_object_t *xc_number_box(xc_runtime_t *rt, double value);
 xc_object_t *xc_string_create(xc_runtime_t *rt, const char *value);
 xc_object_t *xc_string_create_len(xc_runtime_t *rt, const char *value, size_t len);
+xc_object_t *xc_string_intern(xc_runtime_t *rt, const char *value);
+xc_object_t *xc_string_intern_len(xc_runtime_t *rt, const char *value, size_t len);
+xc_object_t *xc_string_concat(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+xc_object_t *xc_string_slice(xc_runtime_t *rt, xc_object_t *str, size_t start, size_t len);
+int64_t xc_string_index_of(xc_runtime_t *rt, xc_object_t *str, xc_object_t *needle);
+bool xc_string_includes(xc_runtime_t *rt, xc_object_t *str, xc_object_t *needle);
+xc_object_t *xc_string_split(xc_runtime_t *rt, xc_object_t *str, xc_object_t *separator);
+xc_object_t *xc_string_to_lower(xc_runtime_t *rt, xc_object_t *str);
+xc_object_t *xc_string_to_upper(xc_runtime_t *rt, xc_object_t *str);
+bool xc_string_is_valid_utf8(xc_runtime_t *rt, xc_object_t *str);
+size_t xc_string_code_point_length(xc_runtime_t *rt, xc_object_t *str);
 xc_object_t *xc_array_create(xc_runtime_t *rt);
+xc_object_t *xc_buffer_create(xc_runtime_t *rt, int kind, size_t length);
+xc_object_t *xc_buffer_from_array(xc_runtime_t *rt, int kind, xc_object_t *arr);
+xc_object_t *xc_buffer_to_array(xc_runtime_t *rt, xc_object_t *buf);
 xc_object_t *xc_array_create_with_capacity(xc_runtime_t *rt, size_t capacity);
 xc_object_t *xc_array_create_with_values(xc_runtime_t *rt, xc_object_t **values, size_t count);
 xc_object_t *xc_object_create(xc_runtime_t *rt);
 xc_object_t *xc_function_create(xc_runtime_t *rt, xc_function_ptr_t fn, xc_object_t *closure);
+xc_object_t *xc_function_bind_method(xc_runtime_t *rt, xc_method_func method, xc_object_t *this_obj);
 xc_object_t *xc_function_get_closure(xc_runtime_t *rt, xc_object_t *func);
+xc_object_t *xc_function_create_closure(xc_runtime_t *rt, xc_function_ptr_t fn, size_t capture_count,
+                                        xc_object_t **captures);
+size_t xc_function_capture_count(xc_runtime_t *rt, xc_object_t *func);
+xc_object_t *xc_function_get_capture(xc_runtime_t *rt, xc_object_t *func, size_t slot);
+void xc_function_set_capture(xc_runtime_t *rt, xc_object_t *func, size_t slot, xc_object_t *value);
+xc_object_t *xc_function_current(xc_runtime_t *rt);
+void xc_function_set_current(xc_runtime_t *rt, xc_object_t *func);
+xc_val xc_function_apply_handler(xc_runtime_t *rt, xc_function_t *function, xc_val this_obj, int argc, xc_val *argv);
+
+/*
+ * String builder: appends into one geometrically growing buffer, which
+ * xc_string_builder_finish hands to the resulting string without copying.
+ */
+typedef struct xc_string_builder {
+    char *data;                /* Buffer (capacity + 1 bytes), NULL until first append */
+    size_t length;             /* Bytes written */
+    size_t capacity;           /* Bytes available, excluding the terminator */
+} xc_string_builder_t;
+
+void xc_string_builder_init(xc_string_builder_t *sb, size_t capacity);
+bool xc_string_builder_append(xc_string_builder_t *sb, const char *value);
+bool xc_string_builder_append_len(xc_string_builder_t *sb, const char *value, size_t len);
+bool xc_string_builder_append_char(xc_string_builder_t *sb, char c);
+bool xc_string_builder_append_string(xc_runtime_t *rt, xc_string_builder_t *sb, xc_object_t *str);
+xc_object_t *xc_string_builder_finish(xc_runtime_t *rt, xc_string_builder_t *sb);
+void xc_string_builder_free(xc_string_builder_t *sb);
 
 /*
  * Type conversion functions
@@ -271,6 +709,8 @@ bool xc_is_string(xc_runtime_t *rt, xc_object_t *obj);
 bool xc_is_array(xc_runtime_t *rt, xc_object_t *obj);
 bool xc_is_object(xc_runtime_t *rt, xc_object_t *obj);
 bool xc_is_function(xc_runtime_t *rt, xc_object_t *obj);
+bool xc_is_buffer(xc_runtime_t *rt, xc_object_t *obj);
+bool xc_is_iterator(xc_runtime_t *rt, xc_object_t *obj);
 bool xc_is_error(xc_runtime_t *rt, xc_object_t *obj);
 
 /*
@@ -280,6 +720,10 @@ bool xc_boolean_value(xc_runtime_t *rt, xc_object_t *obj);
 double xc_number_value(xc_runtime_t *rt, xc_object_t *obj);
 const char *xc_string_value(xc_runtime_t *rt, xc_object_t *obj);
 size_t xc_string_length(xc_runtime_t *rt, xc_object_t *obj);
+const char *xc_string_data(xc_runtime_t *rt, xc_object_t *obj);
+uint64_t xc_string_hash(xc_runtime_t *rt, xc_object_t *obj);
+bool xc_string_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+bool xc_string_is_interned(xc_runtime_t *rt, xc_object_t *obj);
 size_t xc_array_length(xc_runtime_t *rt, xc_object_t *obj);
 xc_object_t *xc_array_get(xc_runtime_t *rt, xc_object_t *arr, size_t index);
 void xc_array_set(xc_runtime_t *rt, xc_object_t *arr, size_t index, xc_object_t *value);
@@ -289,13 +733,68 @@ void xc_array_unshift(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *value);
 xc_object_t *xc_array_shift(xc_runtime_t *rt, xc_object_t *arr);
 xc_object_t *xc_array_slice(xc_runtime_t *rt, xc_object_t *arr, int start, int end);
 xc_object_t *xc_array_concat(xc_runtime_t *rt, xc_object_t *arr1, xc_object_t *arr2);
+xc_object_t **xc_array_items(xc_runtime_t *rt, xc_object_t *arr);
+bool xc_array_is_shared(xc_runtime_t *rt, xc_object_t *arr);
 xc_object_t *xc_array_join(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *separator);
 int xc_array_index_of(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *value);
 int xc_array_index_of_from(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *value, int from_index);
+void xc_array_sort(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *comparator);
+void xc_array_sort_stable(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *comparator);
+xc_object_t *xc_array_top_k(xc_runtime_t *rt, xc_object_t *arr, size_t k, xc_object_t *comparator);
+size_t xc_buffer_length(xc_runtime_t *rt, xc_object_t *buf);
+int xc_buffer_kind(xc_runtime_t *rt, xc_object_t *buf);
+size_t xc_buffer_element_size(int kind);
+void *xc_buffer_data(xc_runtime_t *rt, xc_object_t *buf);
+double xc_buffer_get_number(xc_runtime_t *rt, xc_object_t *buf, size_t index);
+void xc_buffer_set_number(xc_runtime_t *rt, xc_object_t *buf, size_t index, double value);
+xc_object_t *xc_buffer_get(xc_runtime_t *rt, xc_object_t *buf, size_t index);
+void xc_buffer_set(xc_runtime_t *rt, xc_object_t *buf, size_t index, xc_object_t *value);
+void xc_buffer_push(xc_runtime_t *rt, xc_object_t *buf, double value);
+double xc_buffer_sum(xc_runtime_t *rt, xc_object_t *buf);
+double xc_buffer_mean(xc_runtime_t *rt, xc_object_t *buf);
+double xc_buffer_min(xc_runtime_t *rt, xc_object_t *buf);
+double xc_buffer_max(xc_runtime_t *rt, xc_object_t *buf);
+int64_t xc_buffer_argmin(xc_runtime_t *rt, xc_object_t *buf);
+int64_t xc_buffer_argmax(xc_runtime_t *rt, xc_object_t *buf);
+double xc_buffer_dot(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+xc_object_t *xc_buffer_add(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+xc_object_t *xc_buffer_mul(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+xc_object_t *xc_buffer_scale(xc_runtime_t *rt, xc_object_t *buf, double factor);
+xc_object_t *xc_buffer_clamp(xc_runtime_t *rt, xc_object_t *buf, double lo, double hi);
+xc_object_t *xc_buffer_prefix_sum(xc_runtime_t *rt, xc_object_t *buf);
+xc_object_t *xc_buffer_compare(xc_runtime_t *rt, xc_object_t *buf, int op, double value);
+void xc_buffer_sort(xc_runtime_t *rt, xc_object_t *buf);
+xc_object_t *xc_iter(xc_runtime_t *rt, xc_object_t *source);
+xc_object_t *xc_iter_map(xc_runtime_t *rt, xc_object_t *it, xc_object_t *fn);
+xc_object_t *xc_iter_filter(xc_runtime_t *rt, xc_object_t *it, xc_object_t *fn);
+xc_object_t *xc_iter_map_native(xc_runtime_t *rt, xc_object_t *it, xc_iter_map_func fn, void *data);
+xc_object_t *xc_iter_filter_native(xc_runtime_t *rt, xc_object_t *it, xc_iter_filter_func fn, void *data);
+xc_object_t *xc_iter_map_f64(xc_runtime_t *rt, xc_object_t *it, xc_iter_map_f64_func fn, void *data);
+xc_object_t *xc_iter_filter_f64(xc_runtime_t *rt, xc_object_t *it, xc_iter_filter_f64_func fn, void *data);
+xc_object_t *xc_iter_skip(xc_runtime_t *rt, xc_object_t *it, size_t count);
+xc_object_t *xc_iter_take(xc_runtime_t *rt, xc_object_t *it, size_t count);
+xc_object_t *xc_iter_reduce(xc_runtime_t *rt, xc_object_t *it, xc_object_t *fn, xc_object_t *initial);
+xc_object_t *xc_iter_reduce_native(xc_runtime_t *rt, xc_object_t *it, xc_iter_reduce_func fn,
+                                   xc_object_t *initial, void *data);
+xc_object_t *xc_iter_to_array(xc_runtime_t *rt, xc_object_t *it);
+size_t xc_iter_count(xc_runtime_t *rt, xc_object_t *it);
+double xc_iter_sum(xc_runtime_t *rt, xc_object_t *it);
+xc_object_t *xc_vm_create(int stack_size);
+int xc_vm_emit(xc_runtime_t *rt, xc_object_t *vm, xc_instruction_t instr);
+void xc_vm_set_jump(xc_runtime_t *rt, xc_object_t *vm, int at, int target);
+xc_val xc_vm_run(xc_runtime_t *rt, xc_object_t *vm);
+xc_val xc_vm_result(xc_runtime_t *rt, xc_object_t *vm);
+const uint8_t *xc_vm_bytecode(xc_runtime_t *rt, xc_object_t *vm, size_t *size);
+void xc_vm_set_mode(xc_runtime_t *rt, xc_object_t *vm, int mode);
+void xc_vm_set_global(xc_runtime_t *rt, xc_object_t *vm, const char *name, xc_val value);
+void xc_vm_reset(xc_runtime_t *rt, xc_object_t *vm);
 xc_object_t *xc_object_get(xc_runtime_t *rt, xc_object_t *obj, const char *key);
 void xc_object_set(xc_runtime_t *rt, xc_object_t *obj, const char *key, xc_object_t *value);
 bool xc_object_has(xc_runtime_t *rt, xc_object_t *obj, const char *key);
 bool xc_object_delete(xc_runtime_t *rt, xc_object_t *obj, const char *key);
+size_t xc_object_count(xc_runtime_t *rt, xc_object_t *obj);
+xc_object_t *xc_object_get_cached(xc_runtime_t *rt, xc_object_t *obj, const char *key, xc_inline_cache_t *ic);
+void xc_object_set_cached(xc_runtime_t *rt, xc_object_t *obj, const char *key, xc_object_t *value, xc_inline_cache_t *ic);
 xc_object_t *xc_function_call(xc_runtime_t *rt, xc_object_t *func, xc_object_t *this_obj, size_t argc, xc_object_t **argv);
 
 /*
@@ -352,6 +851,19 @@ void xc_exception_shutdown(xc_runtime_t *rt);
 
 xc_object_t *xc_exception_create(xc_runtime_t *rt, int type, const char *message);
 xc_object_t *xc_exception_create_with_cause(xc_runtime_t *rt, int type, const char *message, xc_object_t *cause);
+
+/*
+ * Pooled and reserved exceptions live outside the GC heap, so creating them
+ * cannot fail under memory pressure and does not churn the collector. The
+ * GC does not trace them: a cause set on one must be kept alive elsewhere.
+ * A pooled exception goes back to the pool only on xc_exception_release:
+ * try handlers never release it, since the handler may still hold it (as a
+ * result or as the cause of a new error). Release it once nothing refers
+ * to it.
+ */
+xc_object_t *xc_exception_create_pooled(xc_runtime_t *rt, int type, const char *message);
+xc_object_t *xc_exception_reserved(xc_runtime_t *rt, int type);
+void xc_exception_release(xc_runtime_t *rt, xc_object_t *exception);
 void xc_exception_throw(xc_runtime_t *rt, xc_object_t *exception);
 
 int xc_exception_get_type(xc_runtime_t *rt, xc_object_t *exception);
@@ -359,12 +871,30 @@ const char *xc_exception_get_message(xc_runtime_t *rt, xc_object_t *exception);
 xc_object_t *xc_exception_get_cause(xc_runtime_t *rt, xc_object_t *exception);
 
 xc_stack_trace_t *xc_exception_get_stack_trace(xc_runtime_t *rt, xc_object_t *exception);
+void xc_exception_set_trace_enabled(xc_runtime_t *rt, int type, bool enabled);
+bool xc_exception_trace_enabled(xc_runtime_t *rt, int type);
 void xc_stack_trace_print(xc_runtime_t *rt, xc_stack_trace_t *stack_trace);
 char *xc_stack_trace_to_string(xc_runtime_t *rt, xc_stack_trace_t *stack_trace);
 
 void xc_exception_rethrow(xc_runtime_t *rt);
 void xc_exception_clear(xc_runtime_t *rt);
 
+/*
+ * Error results: a native fails by returning XC_ERROR with the exception
+ * parked in _xc_thread_state.pending_exception (xc_raise). Callers test the
+ * result and return XC_ERROR again to propagate, so no jmp_buf is involved;
+ * xc_exception_throw (longjmp) stays for deep non-local unwinds.
+ */
+extern xc_object_t xc_error_sentinel;
+#define XC_ERROR ((xc_val)&xc_error_sentinel)
+#define XC_IS_ERROR(val) ((xc_val)(val) == XC_ERROR)
+
+xc_val xc_raise(xc_runtime_t *rt, xc_object_t *exception);
+xc_object_t *xc_pending_exception(xc_runtime_t *rt);
+xc_object_t *xc_take_pending_exception(xc_runtime_t *rt);
+void xc_throw_pending(xc_runtime_t *rt);
+xc_val xc_try_result(xc_runtime_t *rt, xc_val try_func, xc_val catch_func, xc_val finally_func);
+
 /* 未捕获异常处理器API */
 void xc_set_uncaught_exception_handler(xc_runtime_t *rt, xc_val handler);
 xc_val xc_get_uncaught_exception_handler(xc_runtime_t *rt);
@@ -419,6 +949,80 @@ typedef struct xc_gc_stats {
     double last_pause_time_ms;  /* Last GC pause time in milliseconds */
 } xc_gc_stats_t;
 
+xc_gc_stats_t xc_gc_get_stats(xc_runtime_t *rt);
+
+/*
+ * SIMD kernels (xc_simd.c), dispatched on the CPU at first use
+ */
+#define XC_SIMD_SCALAR 0
+#define XC_SIMD_SSE2   1
+#define XC_SIMD_AVX2   2
+
+int xc_simd_set_level(int level);
+int xc_simd_get_level(void);
+int64_t xc_simd_find_byte(const char *s, size_t len, char c);
+int64_t xc_simd_find(const char *hay, size_t hay_len, const char *needle, size_t needle_len);
+size_t xc_simd_mismatch(const char *a, const char *b, size_t len);
+bool xc_simd_utf8_validate(const char *s, size_t len);
+size_t xc_simd_utf8_length(const char *s, size_t len);
+void xc_simd_case_map(char *dst, const char *src, size_t len, bool upper);
+
+/* Comparison operators for xc_simd_compare_f64 */
+#define XC_SIMD_LT 0
+#define XC_SIMD_LE 1
+#define XC_SIMD_GT 2
+#define XC_SIMD_GE 3
+#define XC_SIMD_EQ 4
+#define XC_SIMD_NE 5
+
+double xc_simd_sum_f64(const double *a, size_t n);
+double xc_simd_dot_f64(const double *a, const double *b, size_t n);
+double xc_simd_min_f64(const double *a, size_t n);
+double xc_simd_max_f64(const double *a, size_t n);
+int64_t xc_simd_find_f64(const double *a, size_t n, double value);
+int64_t xc_simd_argmin_f64(const double *a, size_t n);
+int64_t xc_simd_argmax_f64(const double *a, size_t n);
+void xc_simd_add_f64(double *dst, const double *a, const double *b, size_t n);
+void xc_simd_mul_f64(double *dst, const double *a, const double *b, size_t n);
+void xc_simd_scale_f64(double *dst, const double *a, double s, size_t n);
+void xc_simd_clamp_f64(double *dst, const double *a, double lo, double hi, size_t n);
+void xc_simd_prefix_sum_f64(double *dst, const double *a, size_t n);
+size_t xc_simd_compare_f64(uint8_t *mask, const double *a, size_t n, double value, int op);
+
+/*
+ * Data-parallel operations (xc_parallel.c) on a shared worker pool.
+ * Callbacks run on worker threads: they see unboxed doubles and must not
+ * allocate xc objects, since each thread has its own xc_gc_context.
+ */
+typedef void (*xc_parallel_task_func)(size_t chunk, size_t begin, size_t end, void *data);
+typedef double (*xc_parallel_reduce_func)(double acc, double value, void *data);
+typedef void (*xc_parallel_merge_func)(const void *a, size_t na, const void *b, size_t nb, void *out, void *data);
+
+int xc_parallel_set_threads(int threads);
+int xc_parallel_get_threads(void);
+size_t xc_parallel_chunk_count(size_t n, size_t grain);
+void xc_parallel_for(size_t n, size_t grain, xc_parallel_task_func fn, void *data);
+xc_object_t *xc_parallel_map(xc_runtime_t *rt, xc_object_t *source, xc_iter_map_f64_func fn, void *data);
+xc_object_t *xc_parallel_filter(xc_runtime_t *rt, xc_object_t *source, xc_iter_filter_f64_func fn, void *data);
+double xc_parallel_reduce(xc_runtime_t *rt, xc_object_t *source, xc_parallel_reduce_func fn,
+                          double initial, void *data);
+double xc_parallel_sum(xc_runtime_t *rt, xc_object_t *source);
+int64_t xc_parallel_index_of(xc_runtime_t *rt, xc_object_t *source, double value);
+void *xc_parallel_sort_runs(void *a, void *tmp, size_t n, size_t size, xc_parallel_task_func sort_chunk,
+                            xc_parallel_merge_func merge, void *data);
+void xc_parallel_sort(xc_runtime_t *rt, xc_object_t *obj);
+void xc_array_sort_parallel(xc_runtime_t *rt, xc_object_t *arr);
+void xc_buffer_sort_parallel(xc_runtime_t *rt, xc_object_t *buf);
+
+/*
+ * Number text conversion (xc_number.c): shortest round-trip formatting and
+ * fast decimal parsing
+ */
+#define XC_NUMBER_FORMAT_SIZE 32   /* Enough for "-1.2345678901234567e-308" */
+
+size_t xc_number_format(double value, char *out);
+size_t xc_number_parse(const char *str, size_t len, double *value);
+
 /* Forward declarations of internal type structures */
 typedef struct xc_array_t xc_array_t;
 typedef struct xc_object_data_t xc_object_data_t;
@@ -442,10 +1046,16 @@ typedef struct xc_gc_context {
     size_t root_count;               /* Number of roots */
     size_t root_capacity;            /* Capacity of roots array */
     
-    /* Object lists for tri-color marking */
-    xc_object_t *white_list;         /* White objects (candidates for collection) */
-    xc_object_t *gray_list;          /* Gray objects (reachable but not scanned) */
-    xc_object_t *black_list;         /* Black objects (reachable and scanned) */
+    /* Every object of this heap, linked through gc_next; colors carry the marks */
+    xc_object_t *white_list;
+
+    /* Gray objects waiting for their marker, and permanent objects scanned this cycle */
+    xc_object_t **mark_stack;
+    size_t mark_count;
+    size_t mark_capacity;
+    xc_object_t **permanent_seen;
+    size_t permanent_count;
+    size_t permanent_capacity;
 } xc_gc_context_t;
 
 
@@ -467,16 +1077,41 @@ typedef struct xc_gc_context {
 #define XC_ERR_ASSERTION 14     /* 断言错误 */
 #define XC_ERR_USER 15          /* 用户自定义错误 */
 
-/* 方法查找缓存结构 */
+/* 方法查找缓存结构
+ * Each thread owns a direct-mapped cache, so a hit is a pure read.
+ * The entry is verified by type and name, never by hash alone. */
 typedef struct {
-    unsigned int key;      // 哈希键（type_id和method_name的组合）
+    const char* name;      // 方法名（注册时的指针或调用方的指针）
+    unsigned int hash;     // 方法名的完整哈希
+    int type;              // 类型ID
     xc_method_func value;  // 方法函数指针
-    int age;               // 用于LRU替换策略
 } method_cache_entry_t;
 
-// 缓存大小定义
+// 缓存大小定义（必须是2的幂）
 #ifndef METHOD_CACHE_SIZE
-#define METHOD_CACHE_SIZE 16
+#define METHOD_CACHE_SIZE 64
+#endif
+
+/* 属性访问解析缓存结构（xc_dot）
+ * Resolves a key once to its "get_<key>", "set_<key>" and "<key>"
+ * methods so property access never builds selector strings. */
+#define DOT_CACHE_KEY_MAX 32
+typedef struct {
+    char key[DOT_CACHE_KEY_MAX]; // 属性名副本（调用方的key可能是临时缓冲区）
+    unsigned int hash;     // 属性名的完整哈希
+    int type;              // 类型ID，0表示空槽位
+    xc_method_func getter; // "get_<key>"
+    xc_method_func setter; // "set_<key>"
+    xc_method_func method; // "<key>"
+} dot_cache_entry_t;
+
+#ifndef DOT_CACHE_SIZE
+#define DOT_CACHE_SIZE 64
+#endif
+
+/* 绑定方法缓存大小（必须是2的幂） */
+#ifndef BOUND_METHOD_CACHE_SIZE
+#define BOUND_METHOD_CACHE_SIZE 64
 #endif
 
 /* 日志级别常量 */
@@ -506,13 +1141,15 @@ enum {
 /* 函数处理器类型定义 */
 typedef xc_val (*xc_function_handler)(xc_val this_obj, int argc, xc_val* argv, xc_val closure);
 
-/* 执行栈帧结构 */
-typedef struct xc_stack_frame {
-    const char* func_name;         /* 函数名称 */
-    const char* file_name;         /* 文件名称 */
-    int line_number;               /* 行号 */
-    struct xc_stack_frame* prev;   /* 上一帧 */
-} xc_stack_frame_t;
+/* 栈帧跟踪开关：编译期可用 -DXC_ENABLE_STACK_FRAMES=0 彻底关闭 */
+#ifndef XC_ENABLE_STACK_FRAMES
+#define XC_ENABLE_STACK_FRAMES 1
+#endif
+
+/* 栈帧最大记录深度，更深的调用只计数不记录 */
+#ifndef XC_MAX_STACK_FRAMES
+#define XC_MAX_STACK_FRAMES 256
+#endif
 
 /* 异常处理器结构 - 内部增强版本 */
 typedef struct xc_exception_handler_internal {
@@ -525,16 +1162,47 @@ typedef struct xc_exception_handler_internal {
 } xc_exception_handler_internal_t;
 
 /* 统一线程本地状态 */
-static __thread struct {
+typedef struct {
     /* 栈相关 */
-    xc_stack_frame_t* top;         /* 栈顶 */
+    xc_stack_frame_t frames[XC_MAX_STACK_FRAMES]; /* 栈帧数组 */
     int depth;                     /* 栈深度 */
     /* 异常相关 */
     xc_exception_handler_internal_t* current;  /* 当前异常处理器 */
     xc_val current_error;          /* 当前错误 */
+    xc_val pending_exception;      /* 以 XC_ERROR 返回时挂起的异常 */
     bool in_try_block;             /* 是否在try块中 */
     xc_val uncaught_handler;       /* 未捕获异常处理器 */
-} _xc_thread_state = {0};
+} xc_thread_state_t;
+
+/* 所有编译单元共享同一份线程状态（定义在 xc.c） */
+extern __thread xc_thread_state_t _xc_thread_state;
+
+/* 运行时栈帧跟踪开关（默认开启），可能被其他线程切换，用原子读写 */
+extern bool xc_stack_frames_enabled;
+void xc_stack_frames_enable(xc_runtime_t *rt);
+void xc_stack_frames_disable(xc_runtime_t *rt);
+
+/* 压入栈帧，返回压栈前的深度，弹出时恢复该深度 */
+static inline int push_stack_frame(const xc_frame_desc_t* desc, const char* name) {
+    int depth = _xc_thread_state.depth;
+#if XC_ENABLE_STACK_FRAMES
+    if (__atomic_load_n(&xc_stack_frames_enabled, __ATOMIC_RELAXED)) {
+        if (depth < XC_MAX_STACK_FRAMES) {
+            _xc_thread_state.frames[depth].desc = desc;
+            _xc_thread_state.frames[depth].name = name;
+        }
+        _xc_thread_state.depth = depth + 1;
+    }
+#endif
+    return depth;
+}
+
+/* 弹出栈帧 */
+static inline void pop_stack_frame(int depth) {
+#if XC_ENABLE_STACK_FRAMES
+    _xc_thread_state.depth = depth;
+#endif
+}
 
 /* 类型注册表结构 */
 #define TYPE_HASH_SIZE 64
@@ -566,6 +1234,9 @@ static __thread xc_gc_context_t *xc_gc_context = NULL;
 void xc_gc_thread_exit(void);
 void xc_gc_thread_init_auto(void);
 
+/* 可以注册方法的类型ID上限：核心类型和内部类型 (0-63) */
+#define XC_METHOD_TYPES (XC_TYPE_INTERNAL_END + 1)
+
 /* 全局状态结构 */
 typedef struct {
     //char initialized;
@@ -576,15 +1247,13 @@ typedef struct {
         int next;  /* 链表下一个方法索引 */
     } methods[256];  /* 方法池 */
     int method_count;
-    int method_heads[16];  /* 每个类型的方法链表头 */
+    int method_heads[XC_METHOD_TYPES];  /* 每个类型的方法链表头 */
     xc_type_registry_t type_registry;
 } xc_state_t;
 
 /* 全局状态 */
 static xc_state_t _state = {0};
 
-static void push_stack_frame(const char* func_name, const char* file_name, int line_number);
-static void pop_stack_frame(void);
 static void thread_cleanup(void);
 static void throw_internal(xc_val error, bool allow_rethrow);
 static void throw(xc_val error);
@@ -593,7 +1262,10 @@ static void throw_with_rethrow(xc_val error);
 xc_val xc_new(int type, ...);
 int xc_typeof(xc_val val);
 int xc_is(xc_val val, int type);
+#define XC_INVOKE_MAX_ARGS 16   /* xc_invoke 的可变参数上限，更多参数用 xc_invoke_argv */
 xc_val xc_invoke(xc_val func, int argc, ...);
+xc_val xc_call_argv(xc_val obj, const char* method, int argc, xc_val* argv);
+xc_val xc_invoke_argv(xc_val func, int argc, xc_val* argv);
 xc_val xc_dot(xc_val obj, const char* key, ...);
 xc_val xc_call(xc_val obj, const char* method, ...);
 
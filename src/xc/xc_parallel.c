@@ -0,0 +1,529 @@
+#include "xc.h"
+#include "xc_internal.h"
+
+/*
+ * Data-parallel layer: a persistent worker pool and chunked map / filter /
+ * reduce / index_of over arrays and typed arrays.
+ *
+ * The Infrax thread pool is not part of libxc yet (see build_libxc.sh), so
+ * this is a small pthread pool with the same create-once, submit-many
+ * shape. xc_parallel_for splits [0, n) into at most threads * 4 chunks
+ * that workers and the calling thread claim from a shared counter, so an
+ * uneven chunk does not stall the others. Chunk boundaries depend only on
+ * n, the grain and the thread count, which keeps reductions deterministic.
+ *
+ * Callback contract: callbacks run on worker threads and must not allocate
+ * xc objects or call xc functions. Each thread has its own xc_gc_context,
+ * and an object allocated on a worker lives in a heap whose GC never sees
+ * the caller's roots. Callbacks therefore get unboxed doubles (the
+ * xc_iter_*_f64 signatures) and may only read the source; results that
+ * need boxing are boxed on the calling thread afterwards. Array elements
+ * that are not numbers read as NaN.
+ */
+
+#define PARALLEL_CHUNKS_PER_THREAD 4
+#define PARALLEL_GRAIN 16384
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;          /* Signalled when a job is posted or on shutdown */
+    pthread_cond_t done;          /* Signalled when the last chunk of a job finishes */
+    pthread_mutex_t submit;       /* One job at a time; busy callers run inline */
+    pthread_t *workers;
+    int worker_count;             /* Threads besides the caller */
+    bool started;                 /* Workers created; a short pool is kept as is */
+    int threads;                  /* Configured total, 0 until first use; atomic reads */
+    bool shutdown;
+    unsigned long generation;     /* Bumped per job so workers wake once */
+
+    /* Current job */
+    xc_parallel_task_func fn;
+    void *data;
+    size_t n;
+    size_t chunk_size;
+    size_t chunk_count;
+    atomic_size_t next_chunk;
+    atomic_size_t pending;
+} parallel_pool_t;
+
+static parallel_pool_t pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .submit = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* Set on pool threads so nested parallel calls run inline */
+static __thread bool parallel_in_worker = false;
+
+static int parallel_core_count(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+/* Claims and runs chunks of the current job until none are left */
+static void parallel_drain(void) {
+    for (;;) {
+        size_t chunk = atomic_fetch_add(&pool.next_chunk, 1);
+        if (chunk >= pool.chunk_count) {
+            return;
+        }
+        size_t begin = chunk * pool.chunk_size;
+        size_t end = begin + pool.chunk_size < pool.n ? begin + pool.chunk_size : pool.n;
+        pool.fn(chunk, begin, end, pool.data);
+        if (atomic_fetch_sub(&pool.pending, 1) == 1) {
+            pthread_mutex_lock(&pool.lock);
+            pthread_cond_signal(&pool.done);
+            pthread_mutex_unlock(&pool.lock);
+        }
+    }
+}
+
+static void *parallel_worker(void *arg) {
+    parallel_in_worker = true;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (!pool.shutdown && pool.generation == seen) {
+            pthread_cond_wait(&pool.work, &pool.lock);
+        }
+        if (pool.shutdown) {
+            break;
+        }
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+        parallel_drain();
+        pthread_mutex_lock(&pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+static void parallel_stop_workers(void) {
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = true;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 0; i < pool.worker_count; i++) {
+        pthread_join(pool.workers[i], NULL);
+    }
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.worker_count = 0;
+    pool.started = false;
+    pool.shutdown = false;
+}
+
+/* Called with pool.submit held. Runs once per configuration: if malloc or
+ * pthread_create fails the pool keeps the workers it got (possibly none)
+ * and the caller's drain covers the missing ones. */
+static void parallel_start_workers(void) {
+    if (pool.started) {
+        return;
+    }
+    if (pool.threads == 0) {
+        __atomic_store_n(&pool.threads, parallel_core_count(), __ATOMIC_RELAXED);
+    }
+    pool.started = true;
+    pool.workers = malloc(sizeof(pthread_t) * (pool.threads - 1));
+    for (int i = 0; pool.workers && i < pool.threads - 1; i++) {
+        if (pthread_create(&pool.workers[i], NULL, parallel_worker, NULL) != 0) {
+            break;
+        }
+        pool.worker_count++;
+    }
+}
+
+/* Total threads used, the caller included; 0 means one per core */
+int xc_parallel_set_threads(int threads) {
+    threads = threads > 0 ? threads : parallel_core_count();
+    pthread_mutex_lock(&pool.submit);
+    if (pool.started) {
+        parallel_stop_workers();
+    }
+    __atomic_store_n(&pool.threads, threads, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&pool.submit);
+    return threads;
+}
+
+/* Lock-free: nested calls from workers ask while the submitter holds pool.submit */
+int xc_parallel_get_threads(void) {
+    int threads = __atomic_load_n(&pool.threads, __ATOMIC_RELAXED);
+    return threads > 0 ? threads : parallel_core_count();
+}
+
+/* Number of chunks xc_parallel_for will use for n items; at least 1 */
+size_t xc_parallel_chunk_count(size_t n, size_t grain) {
+    if (grain == 0) {
+        grain = PARALLEL_GRAIN;
+    }
+    size_t max_chunks = (size_t)xc_parallel_get_threads() * PARALLEL_CHUNKS_PER_THREAD;
+    size_t chunks = (n + grain - 1) / grain;
+    if (max_chunks == PARALLEL_CHUNKS_PER_THREAD || chunks <= 1) {
+        return 1;
+    }
+    return chunks < max_chunks ? chunks : max_chunks;
+}
+
+/* Runs fn over [0, n) in chunks of at least grain items (0: default) and waits */
+void xc_parallel_for(size_t n, size_t grain, xc_parallel_task_func fn, void *data) {
+    if (n == 0) {
+        return;
+    }
+    size_t chunks = xc_parallel_chunk_count(n, grain);
+    size_t chunk_size = (n + chunks - 1) / chunks;
+    if (chunks == 1 || parallel_in_worker || pthread_mutex_trylock(&pool.submit) != 0) {
+        /* Inline fallback still honours the chunk layout callers sized for */
+        for (size_t c = 0; c < chunks; c++) {
+            size_t begin = c * chunk_size;
+            fn(c, begin, begin + chunk_size < n ? begin + chunk_size : n, data);
+        }
+        return;
+    }
+
+    parallel_start_workers();
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.data = data;
+    pool.n = n;
+    pool.chunk_size = chunk_size;
+    pool.chunk_count = chunks;
+    atomic_store(&pool.next_chunk, 0);
+    atomic_store(&pool.pending, chunks);
+    pool.generation++;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+
+    parallel_drain();
+
+    pthread_mutex_lock(&pool.lock);
+    while (atomic_load(&pool.pending) > 0) {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.submit);
+}
+
+/* ------------------------------------------------------------ sources */
+
+/* Element reads that are safe on any thread: no allocation, no flattening */
+static inline double parallel_load(xc_runtime_t *rt, xc_object_t *source, size_t i) {
+    if (source->type_id == XC_TYPE_BUFFER) {
+        xc_buffer_t *buf = (xc_buffer_t *)source;
+        return buf->kind == XC_BUFFER_FLOAT64 ? ((const double *)buf->data)[i]
+                                              : xc_buffer_get_number(rt, source, i);
+    }
+    xc_object_t *item = ((xc_array_t *)source)->items[i];
+    return item && item->type_id == XC_TYPE_NUMBER ? xc_number_value(rt, item) : __builtin_nan("");
+}
+
+static inline size_t parallel_length(xc_object_t *source) {
+    return source->type_id == XC_TYPE_BUFFER ? ((xc_buffer_t *)source)->length
+                                             : ((xc_array_t *)source)->length;
+}
+
+/* Checks the source and, for a concat view, joins its segments before workers read items */
+static inline bool parallel_source_valid(xc_runtime_t *rt, xc_object_t *source) {
+    if (xc_is_array(rt, source)) {
+        xc_array_items(rt, source);
+        return true;
+    }
+    return xc_is_buffer(rt, source);
+}
+
+typedef struct {
+    xc_runtime_t *rt;
+    xc_object_t *source;
+    double *out;
+    uint8_t *mask;
+    size_t *counts;
+    double *partials;
+    union {
+        xc_iter_map_f64_func map;
+        xc_iter_filter_f64_func filter;
+        xc_parallel_reduce_func reduce;
+    };
+    void *data;
+    double value;
+    atomic_size_t found;
+} parallel_job_t;
+
+/* ------------------------------------------------------------ map */
+
+static void parallel_map_chunk(size_t chunk, size_t begin, size_t end, void *arg) {
+    parallel_job_t *job = arg;
+    for (size_t i = begin; i < end; i++) {
+        job->out[i] = job->map(parallel_load(job->rt, job->source, i), job->data);
+    }
+}
+
+/*
+ * fn over every element. A typed array gives a float64 typed array; an
+ * array gives an array of numbers, boxed on the calling thread.
+ */
+xc_object_t *xc_parallel_map(xc_runtime_t *rt, xc_object_t *source, xc_iter_map_f64_func fn, void *data) {
+    if (!parallel_source_valid(rt, source) || !fn) {
+        return NULL;
+    }
+    size_t n = parallel_length(source);
+    bool to_buffer = xc_is_buffer(rt, source);
+    xc_object_t *result = to_buffer ? xc_buffer_create(rt, XC_BUFFER_FLOAT64, n)
+                                    : xc_array_create_with_capacity(rt, n);
+    double *out = to_buffer ? xc_buffer_data(rt, result) : malloc((n ? n : 1) * sizeof(double));
+    if (!result || !out) {
+        if (!to_buffer) free(out);
+        return result;
+    }
+    parallel_job_t job = { .rt = rt, .source = source, .out = out, .map = fn, .data = data };
+    xc_parallel_for(n, 0, parallel_map_chunk, &job);
+    if (!to_buffer) {
+        /* 装箱会分配、可能触发回收；result 只在局部变量里，装箱期间登记为根 */
+        xc_gc_add_root(rt, &result);
+        for (size_t i = 0; i < n; i++) {
+            xc_array_push(rt, result, xc_number_box(rt, out[i]));
+        }
+        xc_gc_remove_root(rt, &result);
+        free(out);
+    }
+    return result;
+}
+
+/* ------------------------------------------------------------ filter */
+
+static void parallel_filter_chunk(size_t chunk, size_t begin, size_t end, void *arg) {
+    parallel_job_t *job = arg;
+    size_t kept = 0;
+    for (size_t i = begin; i < end; i++) {
+        bool keep = job->filter(parallel_load(job->rt, job->source, i), job->data);
+        job->mask[i] = keep;
+        kept += keep;
+    }
+    job->counts[chunk] = kept;
+}
+
+/*
+ * Elements for which fn is true, in order: a typed array of the source's
+ * kind, or an array of the source's own element objects.
+ */
+xc_object_t *xc_parallel_filter(xc_runtime_t *rt, xc_object_t *source, xc_iter_filter_f64_func fn, void *data) {
+    if (!parallel_source_valid(rt, source) || !fn) {
+        return NULL;
+    }
+    size_t n = parallel_length(source);
+    size_t chunks = xc_parallel_chunk_count(n, 0);
+    uint8_t *mask = malloc(n ? n : 1);
+    size_t *counts = calloc(chunks, sizeof(size_t));
+    if (!mask || !counts) {
+        free(mask);
+        free(counts);
+        return NULL;
+    }
+    parallel_job_t job = { .rt = rt, .source = source, .mask = mask, .counts = counts, .filter = fn, .data = data };
+    xc_parallel_for(n, 0, parallel_filter_chunk, &job);
+
+    size_t total = 0;
+    for (size_t c = 0; c < chunks; c++) {
+        total += counts[c];
+    }
+    xc_object_t *result;
+    if (xc_is_buffer(rt, source)) {
+        int kind = xc_buffer_kind(rt, source);
+        size_t size = xc_buffer_element_size(kind);
+        result = xc_buffer_create(rt, kind, total);
+        if (result) {
+            const char *from = xc_buffer_data(rt, source);
+            char *to = xc_buffer_data(rt, result);
+            for (size_t i = 0; i < n; i++) {
+                if (mask[i]) {
+                    memcpy(to, from + i * size, size);
+                    to += size;
+                }
+            }
+        }
+    } else {
+        result = xc_array_create_with_capacity(rt, total);
+        if (result) {
+            xc_object_t **items = ((xc_array_t *)source)->items;
+            for (size_t i = 0; i < n; i++) {
+                if (mask[i]) {
+                    xc_array_push(rt, result, items[i]);
+                }
+            }
+        }
+    }
+    free(mask);
+    free(counts);
+    return result;
+}
+
+/* ------------------------------------------------------------ reduce */
+
+static void parallel_reduce_chunk(size_t chunk, size_t begin, size_t end, void *arg) {
+    parallel_job_t *job = arg;
+    double acc = job->value;
+    for (size_t i = begin; i < end; i++) {
+        acc = job->reduce(acc, parallel_load(job->rt, job->source, i), job->data);
+    }
+    job->partials[chunk] = acc;
+}
+
+/*
+ * Folds fn over the elements. fn must be associative and initial its
+ * identity (0 for +, 1 for *): each chunk starts from initial and the chunk
+ * results are folded with fn in order.
+ */
+double xc_parallel_reduce(xc_runtime_t *rt, xc_object_t *source, xc_parallel_reduce_func fn,
+                          double initial, void *data) {
+    if (!parallel_source_valid(rt, source) || !fn) {
+        return initial;
+    }
+    size_t n = parallel_length(source);
+    size_t chunks = xc_parallel_chunk_count(n, 0);
+    double *partials = malloc(chunks * sizeof(double));
+    if (!partials) {
+        return initial;
+    }
+    for (size_t c = 0; c < chunks; c++) {
+        partials[c] = initial;
+    }
+    parallel_job_t job = { .rt = rt, .source = source, .partials = partials, .reduce = fn, .value = initial, .data = data };
+    xc_parallel_for(n, 0, parallel_reduce_chunk, &job);
+    double acc = partials[0];
+    for (size_t c = 1; c < chunks; c++) {
+        acc = fn(acc, partials[c], data);
+    }
+    free(partials);
+    return acc;
+}
+
+static void parallel_sum_chunk(size_t chunk, size_t begin, size_t end, void *arg) {
+    parallel_job_t *job = arg;
+    xc_buffer_t *buf = (xc_buffer_t *)job->source;
+    if (job->source->type_id == XC_TYPE_BUFFER && buf->kind == XC_BUFFER_FLOAT64) {
+        job->partials[chunk] = xc_simd_sum_f64((const double *)buf->data + begin, end - begin);
+        return;
+    }
+    double acc = 0;
+    for (size_t i = begin; i < end; i++) {
+        acc += parallel_load(job->rt, job->source, i);
+    }
+    job->partials[chunk] = acc;
+}
+
+/* Sum with the SIMD kernel per chunk for float64 typed arrays */
+double xc_parallel_sum(xc_runtime_t *rt, xc_object_t *source) {
+    if (!parallel_source_valid(rt, source)) {
+        return 0;
+    }
+    size_t n = parallel_length(source);
+    size_t chunks = xc_parallel_chunk_count(n, 0);
+    double *partials = calloc(chunks, sizeof(double));
+    if (!partials) {
+        return 0;
+    }
+    parallel_job_t job = { .rt = rt, .source = source, .partials = partials };
+    xc_parallel_for(n, 0, parallel_sum_chunk, &job);
+    double sum = 0;
+    for (size_t c = 0; c < chunks; c++) {
+        sum += partials[c];
+    }
+    free(partials);
+    return sum;
+}
+
+/* ------------------------------------------------------------ index_of */
+
+static void parallel_index_of_chunk(size_t chunk, size_t begin, size_t end, void *arg) {
+    parallel_job_t *job = arg;
+    /* A match in an earlier chunk already wins */
+    if (atomic_load(&job->found) < begin) {
+        return;
+    }
+    size_t hit = SIZE_MAX;
+    xc_buffer_t *buf = (xc_buffer_t *)job->source;
+    if (job->source->type_id == XC_TYPE_BUFFER && buf->kind == XC_BUFFER_FLOAT64) {
+        int64_t i = xc_simd_find_f64((const double *)buf->data + begin, end - begin, job->value);
+        hit = i < 0 ? SIZE_MAX : begin + (size_t)i;
+    } else {
+        for (size_t i = begin; i < end; i++) {
+            if (parallel_load(job->rt, job->source, i) == job->value) {
+                hit = i;
+                break;
+            }
+        }
+    }
+    /* Keep the smallest hit */
+    size_t current = atomic_load(&job->found);
+    while (hit < current && !atomic_compare_exchange_weak(&job->found, &current, hit)) {
+    }
+}
+
+/* First index holding a number equal to value, or -1; NaN never matches */
+int64_t xc_parallel_index_of(xc_runtime_t *rt, xc_object_t *source, double value) {
+    if (!parallel_source_valid(rt, source) || value != value) {
+        return -1;
+    }
+    parallel_job_t job = { .rt = rt, .source = source, .value = value };
+    atomic_store(&job.found, SIZE_MAX);
+    xc_parallel_for(parallel_length(source), 0, parallel_index_of_chunk, &job);
+    size_t found = atomic_load(&job.found);
+    return found == SIZE_MAX ? -1 : (int64_t)found;
+}
+
+/* ------------------------------------------------------------ sort */
+
+typedef struct {
+    char *src;
+    char *dst;
+    size_t n;
+    size_t size;
+    size_t run;
+    xc_parallel_merge_func merge;
+    void *data;
+} parallel_merge_job_t;
+
+/* Merges runs 2p and 2p + 1 of src into dst for each pair p in [begin, end) */
+static void parallel_merge_chunk(size_t chunk, size_t begin, size_t end, void *arg) {
+    parallel_merge_job_t *job = arg;
+    for (size_t p = begin; p < end; p++) {
+        size_t lo = p * 2 * job->run;
+        size_t mid = lo + job->run < job->n ? lo + job->run : job->n;
+        size_t hi = mid + job->run < job->n ? mid + job->run : job->n;
+        job->merge(job->src + lo * job->size, mid - lo, job->src + mid * job->size, hi - mid,
+                   job->dst + lo * job->size, job->data);
+    }
+}
+
+/*
+ * Chunked sort driver: sort_chunk sorts each xc_parallel_for chunk of
+ * a[0..n) in place, then rounds of pairwise merges (each pair a task)
+ * ping-pong between a and tmp. Returns whichever of the two holds the
+ * result. merge must be stable for the whole sort to keep run order.
+ */
+void *xc_parallel_sort_runs(void *a, void *tmp, size_t n, size_t size, xc_parallel_task_func sort_chunk,
+                            xc_parallel_merge_func merge, void *data) {
+    if (n == 0) {
+        return a;
+    }
+    xc_parallel_for(n, 0, sort_chunk, data);
+    size_t chunks = xc_parallel_chunk_count(n, 0);
+    parallel_merge_job_t job = { a, tmp, n, size, (n + chunks - 1) / chunks, merge, data };
+    while (job.run < n) {
+        size_t pairs = (n + 2 * job.run - 1) / (2 * job.run);
+        xc_parallel_for(pairs, 1, parallel_merge_chunk, &job);
+        char *t = job.src;
+        job.src = job.dst;
+        job.dst = t;
+        job.run *= 2;
+    }
+    return job.src;
+}
+
+/* Arrays and typed arrays sort in place; see xc_array_sort_parallel and xc_buffer_sort_parallel */
+void xc_parallel_sort(xc_runtime_t *rt, xc_object_t *obj) {
+    if (xc_is_buffer(rt, obj)) {
+        xc_buffer_sort_parallel(rt, obj);
+    } else if (xc_is_array(rt, obj)) {
+        xc_array_sort_parallel(rt, obj);
+    }
+}
@@ -0,0 +1,954 @@
+#include "xc.h"
+#include "xc_internal.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/*
+ * SIMD kernel layer.
+ * Each kernel has a scalar version and, on x86-64, SSE2 and AVX2 versions.
+ * The widest level the CPU supports is picked once at first use;
+ * xc_simd_set_level can force a lower one (tests and benchmarks).
+ */
+
+typedef struct {
+    int64_t (*find_byte)(const char *s, size_t len, char c);
+    int64_t (*find)(const char *hay, size_t hay_len, const char *needle, size_t needle_len);
+    size_t (*mismatch)(const char *a, const char *b, size_t len);
+    size_t (*ascii_prefix)(const char *s, size_t len);
+    size_t (*utf8_length)(const char *s, size_t len);
+    void (*case_map)(char *dst, const char *src, size_t len, bool upper);
+} simd_string_ops_t;
+
+typedef struct {
+    double (*sum)(const double *a, size_t n);
+    double (*dot)(const double *a, const double *b, size_t n);
+    double (*min)(const double *a, size_t n);
+    double (*max)(const double *a, size_t n);
+    int64_t (*find)(const double *a, size_t n, double value);
+    void (*add)(double *dst, const double *a, const double *b, size_t n);
+    void (*mul)(double *dst, const double *a, const double *b, size_t n);
+    void (*scale)(double *dst, const double *a, double s, size_t n);
+    void (*clamp)(double *dst, const double *a, double lo, double hi, size_t n);
+    void (*prefix_sum)(double *dst, const double *a, size_t n);
+    size_t (*compare)(uint8_t *mask, const double *a, size_t n, double value, int op);
+} simd_numeric_ops_t;
+
+/* ---------------------------------------------------------------- scalar */
+
+static int64_t scalar_find_byte(const char *s, size_t len, char c) {
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == c) {
+            return (int64_t)i;
+        }
+    }
+    return -1;
+}
+
+static int64_t scalar_find(const char *hay, size_t hay_len, const char *needle, size_t needle_len) {
+    for (size_t i = 0; i + needle_len <= hay_len; i++) {
+        size_t j = 0;
+        while (j < needle_len && hay[i + j] == needle[j]) {
+            j++;
+        }
+        if (j == needle_len) {
+            return (int64_t)i;
+        }
+    }
+    return -1;
+}
+
+static size_t scalar_mismatch(const char *a, const char *b, size_t len) {
+    size_t i = 0;
+    while (i < len && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+static size_t scalar_ascii_prefix(const char *s, size_t len) {
+    size_t i = 0;
+    while (i < len && !(s[i] & 0x80)) {
+        i++;
+    }
+    return i;
+}
+
+/* Code points = bytes that are not continuation bytes (10xxxxxx) */
+static size_t scalar_utf8_length(const char *s, size_t len) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; i++) {
+        count += ((unsigned char)s[i] & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+/* ASCII case mapping; other bytes are copied unchanged */
+static void scalar_case_map(char *dst, const char *src, size_t len, bool upper) {
+    char first = upper ? 'a' : 'A';
+    for (size_t i = 0; i < len; i++) {
+        char c = src[i];
+        dst[i] = (unsigned char)(c - first) < 26 ? (char)(c ^ 0x20) : c;
+    }
+}
+
+static const simd_string_ops_t scalar_ops = {
+    scalar_find_byte, scalar_find, scalar_mismatch,
+    scalar_ascii_prefix, scalar_utf8_length, scalar_case_map
+};
+
+/* Numeric kernels over float64 arrays */
+
+/* Four accumulators so the adds can overlap */
+static double scalar_sum_f64(const double *a, size_t n) {
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i];
+        s1 += a[i + 1];
+        s2 += a[i + 2];
+        s3 += a[i + 3];
+    }
+    for (; i < n; i++) {
+        s0 += a[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static double scalar_dot_f64(const double *a, const double *b, size_t n) {
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++) {
+        s0 += a[i] * b[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+/* min/max of an empty array are +/-Infinity; any NaN makes the result NaN */
+static double scalar_min_f64(const double *a, size_t n) {
+    double m = __builtin_inf();
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != a[i]) {
+            return a[i];
+        }
+        m = a[i] < m ? a[i] : m;
+    }
+    return m;
+}
+
+static double scalar_max_f64(const double *a, size_t n) {
+    double m = -__builtin_inf();
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != a[i]) {
+            return a[i];
+        }
+        m = a[i] > m ? a[i] : m;
+    }
+    return m;
+}
+
+/* First index holding value (NaN finds the first NaN), -1 if none */
+static int64_t scalar_find_f64(const double *a, size_t n, double value) {
+    bool nan = value != value;
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] == value || (nan && a[i] != a[i])) {
+            return (int64_t)i;
+        }
+    }
+    return -1;
+}
+
+static void scalar_add_f64(double *dst, const double *a, const double *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = a[i] + b[i];
+    }
+}
+
+static void scalar_mul_f64(double *dst, const double *a, const double *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = a[i] * b[i];
+    }
+}
+
+static void scalar_scale_f64(double *dst, const double *a, double s, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = a[i] * s;
+    }
+}
+
+static void scalar_clamp_f64(double *dst, const double *a, double lo, double hi, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        double v = a[i] < lo ? lo : a[i];
+        dst[i] = v > hi ? hi : v;
+    }
+}
+
+static void scalar_prefix_sum_f64(double *dst, const double *a, size_t n) {
+    double s = 0;
+    for (size_t i = 0; i < n; i++) {
+        s += a[i];
+        dst[i] = s;
+    }
+}
+
+static inline bool scalar_compare_one(double x, double value, int op) {
+    switch (op) {
+        case XC_SIMD_LT: return x < value;
+        case XC_SIMD_LE: return x <= value;
+        case XC_SIMD_GT: return x > value;
+        case XC_SIMD_GE: return x >= value;
+        case XC_SIMD_EQ: return x == value;
+        default:         return x != value;
+    }
+}
+
+/* mask[i] = a[i] <op> value (0 or 1); returns the number of ones */
+static size_t scalar_compare_f64(uint8_t *mask, const double *a, size_t n, double value, int op) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        mask[i] = scalar_compare_one(a[i], value, op);
+        count += mask[i];
+    }
+    return count;
+}
+
+static const simd_numeric_ops_t scalar_numeric_ops = {
+    scalar_sum_f64, scalar_dot_f64, scalar_min_f64, scalar_max_f64, scalar_find_f64,
+    scalar_add_f64, scalar_mul_f64, scalar_scale_f64, scalar_clamp_f64,
+    scalar_prefix_sum_f64, scalar_compare_f64
+};
+
+#if defined(__x86_64__)
+/* ------------------------------------------------------------------ SSE2 */
+
+static int64_t sse2_find_byte(const char *s, size_t len, char c) {
+    __m128i target = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(s + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, target));
+        if (mask) {
+            return (int64_t)(i + __builtin_ctz(mask));
+        }
+    }
+    int64_t tail = scalar_find_byte(s + i, len - i, c);
+    return tail < 0 ? -1 : (int64_t)i + tail;
+}
+
+/* Candidate positions match both the first and the last needle byte */
+static int64_t sse2_find(const char *hay, size_t hay_len, const char *needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return 0;
+    }
+    if (needle_len == 1) {
+        return sse2_find_byte(hay, hay_len, needle[0]);
+    }
+    if (needle_len > hay_len) {
+        return -1;
+    }
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    size_t i = 0;
+    for (; i + needle_len - 1 + 16 <= hay_len; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(hay + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(hay + i + needle_len - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (memcmp(hay + pos + 1, needle + 1, needle_len - 2) == 0) {
+                return (int64_t)pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    int64_t tail = scalar_find(hay + i, hay_len - i, needle, needle_len);
+    return tail < 0 ? -1 : (int64_t)i + tail;
+}
+
+static size_t sse2_mismatch(const char *a, const char *b, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xFFFF;
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + scalar_mismatch(a + i, b + i, len - i);
+}
+
+static size_t sse2_ascii_prefix(const char *s, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + scalar_ascii_prefix(s + i, len - i);
+}
+
+static size_t sse2_utf8_length(const char *s, size_t len) {
+    /* Continuation bytes are 0x80..0xBF, i.e. below -64 as signed bytes */
+    __m128i limit = _mm_set1_epi8(-64);
+    size_t continuation = 0;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(s + i));
+        continuation += __builtin_popcount((uint32_t)_mm_movemask_epi8(_mm_cmplt_epi8(block, limit)));
+    }
+    return i - continuation + scalar_utf8_length(s + i, len - i);
+}
+
+/* Bytes in [first, first + 26) get bit 0x20 flipped */
+static void sse2_case_map(char *dst, const char *src, size_t len, bool upper) {
+    char first = upper ? 'a' : 'A';
+    /* Shift the range to the bottom of the signed byte range for one compare */
+    __m128i shift = _mm_set1_epi8((char)(0x80 - first));
+    __m128i bound = _mm_set1_epi8(-128 + 26);
+    __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i in_range = _mm_cmplt_epi8(_mm_add_epi8(block, shift), bound);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(block, _mm_and_si128(in_range, flip)));
+    }
+    scalar_case_map(dst + i, src + i, len - i, upper);
+}
+
+static const simd_string_ops_t sse2_ops = {
+    sse2_find_byte, sse2_find, sse2_mismatch,
+    sse2_ascii_prefix, sse2_utf8_length, sse2_case_map
+};
+
+static double sse2_sum_f64(const double *a, size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(a + i));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(a + i + 2));
+    }
+    s0 = _mm_add_pd(s0, s1);
+    double s = _mm_cvtsd_f64(s0) + _mm_cvtsd_f64(_mm_unpackhi_pd(s0, s0));
+    return s + scalar_sum_f64(a + i, n - i);
+}
+
+static double sse2_dot_f64(const double *a, const double *b, size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    s0 = _mm_add_pd(s0, s1);
+    double s = _mm_cvtsd_f64(s0) + _mm_cvtsd_f64(_mm_unpackhi_pd(s0, s0));
+    return s + scalar_dot_f64(a + i, b + i, n - i);
+}
+
+/* NaN lanes are collected separately since minpd/maxpd drop them */
+static double sse2_min_f64(const double *a, size_t n) {
+    __m128d m = _mm_set1_pd(__builtin_inf()), nan = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(a + i);
+        nan = _mm_or_pd(nan, _mm_cmpunord_pd(v, v));
+        m = _mm_min_pd(m, v);
+    }
+    if (_mm_movemask_pd(nan)) {
+        return __builtin_nan("");
+    }
+    m = _mm_min_pd(m, _mm_unpackhi_pd(m, m));
+    double tail = scalar_min_f64(a + i, n - i);
+    double r = _mm_cvtsd_f64(m);
+    return tail != tail || tail < r ? tail : r;
+}
+
+static double sse2_max_f64(const double *a, size_t n) {
+    __m128d m = _mm_set1_pd(-__builtin_inf()), nan = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(a + i);
+        nan = _mm_or_pd(nan, _mm_cmpunord_pd(v, v));
+        m = _mm_max_pd(m, v);
+    }
+    if (_mm_movemask_pd(nan)) {
+        return __builtin_nan("");
+    }
+    m = _mm_max_pd(m, _mm_unpackhi_pd(m, m));
+    double tail = scalar_max_f64(a + i, n - i);
+    double r = _mm_cvtsd_f64(m);
+    return tail != tail || tail > r ? tail : r;
+}
+
+static int64_t sse2_find_f64(const double *a, size_t n, double value) {
+    __m128d target = _mm_set1_pd(value);
+    bool nan = value != value;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(a + i);
+        int mask = _mm_movemask_pd(nan ? _mm_cmpunord_pd(v, v) : _mm_cmpeq_pd(v, target));
+        if (mask) {
+            return (int64_t)(i + __builtin_ctz(mask));
+        }
+    }
+    int64_t tail = scalar_find_f64(a + i, n - i, value);
+    return tail < 0 ? -1 : (int64_t)i + tail;
+}
+
+static void sse2_add_f64(double *dst, const double *a, const double *b, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    scalar_add_f64(dst + i, a + i, b + i, n - i);
+}
+
+static void sse2_mul_f64(double *dst, const double *a, const double *b, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    scalar_mul_f64(dst + i, a + i, b + i, n - i);
+}
+
+static void sse2_scale_f64(double *dst, const double *a, double s, size_t n) {
+    __m128d factor = _mm_set1_pd(s);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(a + i), factor));
+    }
+    scalar_scale_f64(dst + i, a + i, s, n - i);
+}
+
+/* maxpd/minpd return the second operand for NaN, so NaN elements pass through */
+static void sse2_clamp_f64(double *dst, const double *a, double lo, double hi, size_t n) {
+    __m128d vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_max_pd(vlo, _mm_loadu_pd(a + i));
+        _mm_storeu_pd(dst + i, _mm_min_pd(vhi, v));
+    }
+    scalar_clamp_f64(dst + i, a + i, lo, hi, n - i);
+}
+
+/* In-register scan of two pairs at a time; only the carry add is serial */
+static inline __attribute__((always_inline)) void sse2_prefix_sum_f64(double *dst, const double *a, size_t n) {
+    __m128d carry = _mm_setzero_pd();
+    __m128d zero = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d x = _mm_loadu_pd(a + i);
+        __m128d y = _mm_loadu_pd(a + i + 2);
+        x = _mm_add_pd(x, _mm_unpacklo_pd(zero, x));
+        y = _mm_add_pd(y, _mm_unpacklo_pd(zero, y));
+        y = _mm_add_pd(y, _mm_unpackhi_pd(x, x));
+        _mm_storeu_pd(dst + i, _mm_add_pd(x, carry));
+        _mm_storeu_pd(dst + i + 2, _mm_add_pd(y, carry));
+        carry = _mm_add_pd(carry, _mm_unpackhi_pd(y, y));
+    }
+    double s = _mm_cvtsd_f64(carry);
+    for (; i < n; i++) {
+        s += a[i];
+        dst[i] = s;
+    }
+}
+
+/* The operator switch sits outside the loop; two lanes become two mask bytes */
+#define SSE2_COMPARE_LOOP(cmp)                                                  \
+    for (; i + 2 <= n; i += 2) {                                                \
+        uint32_t bits = (uint32_t)_mm_movemask_pd(cmp(_mm_loadu_pd(a + i), target)); \
+        uint16_t bytes = (uint16_t)((bits * 0x81u) & 0x0101u);                  \
+        memcpy(mask + i, &bytes, 2);                                            \
+        count += (bits & 1) + (bits >> 1);                                      \
+    }
+
+static size_t sse2_compare_f64(uint8_t *mask, const double *a, size_t n, double value, int op) {
+    __m128d target = _mm_set1_pd(value);
+    size_t count = 0, i = 0;
+    switch (op) {
+        case XC_SIMD_LT: SSE2_COMPARE_LOOP(_mm_cmplt_pd); break;
+        case XC_SIMD_LE: SSE2_COMPARE_LOOP(_mm_cmple_pd); break;
+        case XC_SIMD_GT: SSE2_COMPARE_LOOP(_mm_cmpgt_pd); break;
+        case XC_SIMD_GE: SSE2_COMPARE_LOOP(_mm_cmpge_pd); break;
+        case XC_SIMD_EQ: SSE2_COMPARE_LOOP(_mm_cmpeq_pd); break;
+        default:         SSE2_COMPARE_LOOP(_mm_cmpneq_pd); break;
+    }
+    return count + scalar_compare_f64(mask + i, a + i, n - i, value, op);
+}
+
+static const simd_numeric_ops_t sse2_numeric_ops = {
+    sse2_sum_f64, sse2_dot_f64, sse2_min_f64, sse2_max_f64, sse2_find_f64,
+    sse2_add_f64, sse2_mul_f64, sse2_scale_f64, sse2_clamp_f64,
+    sse2_prefix_sum_f64, sse2_compare_f64
+};
+
+/* ------------------------------------------------------------------ AVX2 */
+
+__attribute__((target("avx2")))
+static int64_t avx2_find_byte(const char *s, size_t len, char c) {
+    __m256i target = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(s + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, target));
+        if (mask) {
+            return (int64_t)(i + __builtin_ctz(mask));
+        }
+    }
+    int64_t tail = sse2_find_byte(s + i, len - i, c);
+    return tail < 0 ? -1 : (int64_t)i + tail;
+}
+
+__attribute__((target("avx2")))
+static int64_t avx2_find(const char *hay, size_t hay_len, const char *needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return 0;
+    }
+    if (needle_len == 1) {
+        return avx2_find_byte(hay, hay_len, needle[0]);
+    }
+    if (needle_len > hay_len) {
+        return -1;
+    }
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+    size_t i = 0;
+    for (; i + needle_len - 1 + 32 <= hay_len; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i *)(hay + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i *)(hay + i + needle_len - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (memcmp(hay + pos + 1, needle + 1, needle_len - 2) == 0) {
+                return (int64_t)pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    int64_t tail = sse2_find(hay + i, hay_len - i, needle, needle_len);
+    return tail < 0 ? -1 : (int64_t)i + tail;
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_mismatch(const char *a, const char *b, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + sse2_mismatch(a + i, b + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_ascii_prefix(const char *s, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(s + i)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + sse2_ascii_prefix(s + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_utf8_length(const char *s, size_t len) {
+    __m256i limit = _mm256_set1_epi8(-64);
+    size_t continuation = 0;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(s + i));
+        continuation += __builtin_popcount((uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(limit, block)));
+    }
+    return i - continuation + sse2_utf8_length(s + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_case_map(char *dst, const char *src, size_t len, bool upper) {
+    char first = upper ? 'a' : 'A';
+    __m256i shift = _mm256_set1_epi8((char)(0x80 - first));
+    __m256i bound = _mm256_set1_epi8(-128 + 26);
+    __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i in_range = _mm256_cmpgt_epi8(bound, _mm256_add_epi8(block, shift));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(block, _mm256_and_si256(in_range, flip)));
+    }
+    sse2_case_map(dst + i, src + i, len - i, upper);
+}
+
+static const simd_string_ops_t avx2_ops = {
+    avx2_find_byte, avx2_find, avx2_mismatch,
+    avx2_ascii_prefix, avx2_utf8_length, avx2_case_map
+};
+
+__attribute__((target("avx2")))
+static double avx2_sum_f64(const double *a, size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+        s2 = _mm256_add_pd(s2, _mm256_loadu_pd(a + i + 8));
+        s3 = _mm256_add_pd(s3, _mm256_loadu_pd(a + i + 12));
+    }
+    s0 = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0), _mm256_extractf128_pd(s0, 1));
+    double s = _mm_cvtsd_f64(h) + _mm_cvtsd_f64(_mm_unpackhi_pd(h, h));
+    return s + sse2_sum_f64(a + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double avx2_dot_f64(const double *a, const double *b, size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+        s2 = _mm256_add_pd(s2, _mm256_mul_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8)));
+        s3 = _mm256_add_pd(s3, _mm256_mul_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12)));
+    }
+    s0 = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0), _mm256_extractf128_pd(s0, 1));
+    double s = _mm_cvtsd_f64(h) + _mm_cvtsd_f64(_mm_unpackhi_pd(h, h));
+    return s + sse2_dot_f64(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double avx2_min_f64(const double *a, size_t n) {
+    __m256d m = _mm256_set1_pd(__builtin_inf()), nan = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(a + i);
+        nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+        m = _mm256_min_pd(m, v);
+    }
+    if (_mm256_movemask_pd(nan)) {
+        return __builtin_nan("");
+    }
+    __m128d h = _mm_min_pd(_mm256_castpd256_pd128(m), _mm256_extractf128_pd(m, 1));
+    h = _mm_min_pd(h, _mm_unpackhi_pd(h, h));
+    double tail = scalar_min_f64(a + i, n - i);
+    double r = _mm_cvtsd_f64(h);
+    return tail != tail || tail < r ? tail : r;
+}
+
+__attribute__((target("avx2")))
+static double avx2_max_f64(const double *a, size_t n) {
+    __m256d m = _mm256_set1_pd(-__builtin_inf()), nan = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(a + i);
+        nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+        m = _mm256_max_pd(m, v);
+    }
+    if (_mm256_movemask_pd(nan)) {
+        return __builtin_nan("");
+    }
+    __m128d h = _mm_max_pd(_mm256_castpd256_pd128(m), _mm256_extractf128_pd(m, 1));
+    h = _mm_max_pd(h, _mm_unpackhi_pd(h, h));
+    double tail = scalar_max_f64(a + i, n - i);
+    double r = _mm_cvtsd_f64(h);
+    return tail != tail || tail > r ? tail : r;
+}
+
+__attribute__((target("avx2")))
+static int64_t avx2_find_f64(const double *a, size_t n, double value) {
+    __m256d target = _mm256_set1_pd(value);
+    bool nan = value != value;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(a + i);
+        int mask = _mm256_movemask_pd(nan ? _mm256_cmp_pd(v, v, _CMP_UNORD_Q)
+                                          : _mm256_cmp_pd(v, target, _CMP_EQ_OQ));
+        if (mask) {
+            return (int64_t)(i + __builtin_ctz(mask));
+        }
+    }
+    int64_t tail = scalar_find_f64(a + i, n - i, value);
+    return tail < 0 ? -1 : (int64_t)i + tail;
+}
+
+__attribute__((target("avx2")))
+static void avx2_add_f64(double *dst, const double *a, const double *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    scalar_add_f64(dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_mul_f64(double *dst, const double *a, const double *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    scalar_mul_f64(dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_scale_f64(double *dst, const double *a, double s, size_t n) {
+    __m256d factor = _mm256_set1_pd(s);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+    }
+    scalar_scale_f64(dst + i, a + i, s, n - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_clamp_f64(double *dst, const double *a, double lo, double hi, size_t n) {
+    __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_max_pd(vlo, _mm256_loadu_pd(a + i));
+        _mm256_storeu_pd(dst + i, _mm256_min_pd(vhi, v));
+    }
+    scalar_clamp_f64(dst + i, a + i, lo, hi, n - i);
+}
+
+/* Four lanes -> four mask bytes, spread with a multiply */
+#define AVX2_COMPARE_LOOP(pred)                                                 \
+    for (; i + 4 <= n; i += 4) {                                                \
+        uint32_t bits = (uint32_t)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), target, pred)); \
+        uint32_t bytes = (bits * 0x00204081u) & 0x01010101u;                    \
+        memcpy(mask + i, &bytes, 4);                                            \
+        count += (bytes * 0x01010101u) >> 24;                                   \
+    }
+
+__attribute__((target("avx2")))
+static size_t avx2_compare_f64(uint8_t *mask, const double *a, size_t n, double value, int op) {
+    __m256d target = _mm256_set1_pd(value);
+    size_t count = 0, i = 0;
+    switch (op) {
+        case XC_SIMD_LT: AVX2_COMPARE_LOOP(_CMP_LT_OQ); break;
+        case XC_SIMD_LE: AVX2_COMPARE_LOOP(_CMP_LE_OQ); break;
+        case XC_SIMD_GT: AVX2_COMPARE_LOOP(_CMP_GT_OQ); break;
+        case XC_SIMD_GE: AVX2_COMPARE_LOOP(_CMP_GE_OQ); break;
+        case XC_SIMD_EQ: AVX2_COMPARE_LOOP(_CMP_EQ_OQ); break;
+        default:         AVX2_COMPARE_LOOP(_CMP_NEQ_UQ); break;
+    }
+    return count + scalar_compare_f64(mask + i, a + i, n - i, value, op);
+}
+
+/* Same scan, VEX-encoded so it does not pay SSE/AVX transitions */
+__attribute__((target("avx2")))
+static void avx2_prefix_sum_f64(double *dst, const double *a, size_t n) {
+    sse2_prefix_sum_f64(dst, a, n);
+}
+
+static const simd_numeric_ops_t avx2_numeric_ops = {
+    avx2_sum_f64, avx2_dot_f64, avx2_min_f64, avx2_max_f64, avx2_find_f64,
+    avx2_add_f64, avx2_mul_f64, avx2_scale_f64, avx2_clamp_f64,
+    avx2_prefix_sum_f64, avx2_compare_f64
+};
+#endif
+
+/* -------------------------------------------------------------- dispatch */
+
+static int simd_level = -1;
+static const simd_string_ops_t *string_ops = &scalar_ops;
+static const simd_numeric_ops_t *numeric_ops = &scalar_numeric_ops;
+
+/* Widest level supported by this CPU */
+static int simd_detect(void) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return XC_SIMD_AVX2;
+    }
+    return XC_SIMD_SSE2;
+#else
+    return XC_SIMD_SCALAR;
+#endif
+}
+
+static inline const simd_string_ops_t *simd_string_ops(void) {
+    if (__builtin_expect(__atomic_load_n(&simd_level, __ATOMIC_ACQUIRE) < 0, 0)) {
+        xc_simd_set_level(XC_SIMD_AVX2);
+    }
+    return string_ops;
+}
+
+static inline const simd_numeric_ops_t *simd_numeric_ops(void) {
+    if (__builtin_expect(__atomic_load_n(&simd_level, __ATOMIC_ACQUIRE) < 0, 0)) {
+        xc_simd_set_level(XC_SIMD_AVX2);
+    }
+    return numeric_ops;
+}
+
+/* Select a kernel level, capped at what the CPU supports; returns the level used */
+int xc_simd_set_level(int level) {
+    int supported = simd_detect();
+    if (level > supported) {
+        level = supported;
+    }
+#if defined(__x86_64__)
+    string_ops = level >= XC_SIMD_AVX2 ? &avx2_ops : level >= XC_SIMD_SSE2 ? &sse2_ops : &scalar_ops;
+    numeric_ops = level >= XC_SIMD_AVX2 ? &avx2_numeric_ops :
+                  level >= XC_SIMD_SSE2 ? &sse2_numeric_ops : &scalar_numeric_ops;
+#else
+    level = XC_SIMD_SCALAR;
+    string_ops = &scalar_ops;
+    numeric_ops = &scalar_numeric_ops;
+#endif
+    __atomic_store_n(&simd_level, level, __ATOMIC_RELEASE);
+    return level;
+}
+
+int xc_simd_get_level(void) {
+    simd_string_ops();
+    return simd_level;
+}
+
+/* --------------------------------------------------------------- kernels */
+
+int64_t xc_simd_find_byte(const char *s, size_t len, char c) {
+    return simd_string_ops()->find_byte(s, len, c);
+}
+
+int64_t xc_simd_find(const char *hay, size_t hay_len, const char *needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return 0;
+    }
+    if (needle_len > hay_len) {
+        return -1;
+    }
+    return simd_string_ops()->find(hay, hay_len, needle, needle_len);
+}
+
+size_t xc_simd_mismatch(const char *a, const char *b, size_t len) {
+    return simd_string_ops()->mismatch(a, b, len);
+}
+
+size_t xc_simd_utf8_length(const char *s, size_t len) {
+    return simd_string_ops()->utf8_length(s, len);
+}
+
+void xc_simd_case_map(char *dst, const char *src, size_t len, bool upper) {
+    simd_string_ops()->case_map(dst, src, len, upper);
+}
+
+/*
+ * UTF-8 validation: ASCII runs are skipped with the vector kernel, other
+ * sequences are checked one at a time (overlongs, surrogates and code
+ * points above U+10FFFF are rejected).
+ */
+bool xc_simd_utf8_validate(const char *s, size_t len) {
+    const simd_string_ops_t *ops = simd_string_ops();
+    const unsigned char *p = (const unsigned char *)s;
+    size_t i = 0;
+
+    while (i < len) {
+        i += ops->ascii_prefix(s + i, len - i);
+        if (i >= len) {
+            break;
+        }
+
+        unsigned char c = p[i];
+        size_t n;
+        unsigned char lo = 0x80, hi = 0xBF;  /* Allowed range of the second byte */
+        if (c >= 0xC2 && c <= 0xDF) {
+            n = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            n = 3;
+            if (c == 0xE0) lo = 0xA0;        /* Overlong */
+            else if (c == 0xED) hi = 0x9F;   /* Surrogates */
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            n = 4;
+            if (c == 0xF0) lo = 0x90;        /* Overlong */
+            else if (c == 0xF4) hi = 0x8F;   /* Above U+10FFFF */
+        } else {
+            return false;
+        }
+
+        if (len - i < n || p[i + 1] < lo || p[i + 1] > hi) {
+            return false;
+        }
+        for (size_t k = 2; k < n; k++) {
+            if ((p[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += n;
+    }
+    return true;
+}
+
+/*
+ * Numeric kernels over float64 arrays. Sums, dot products and prefix sums
+ * add in a different order at each level, so results can differ in the
+ * last bits between levels (they are exact for integer-valued data).
+ */
+double xc_simd_sum_f64(const double *a, size_t n) {
+    return simd_numeric_ops()->sum(a, n);
+}
+
+double xc_simd_dot_f64(const double *a, const double *b, size_t n) {
+    return simd_numeric_ops()->dot(a, b, n);
+}
+
+double xc_simd_min_f64(const double *a, size_t n) {
+    return simd_numeric_ops()->min(a, n);
+}
+
+double xc_simd_max_f64(const double *a, size_t n) {
+    return simd_numeric_ops()->max(a, n);
+}
+
+/* Index of the first element equal to value (NaN matches NaN), -1 if none */
+int64_t xc_simd_find_f64(const double *a, size_t n, double value) {
+    return simd_numeric_ops()->find(a, n, value);
+}
+
+/* Index of the first smallest element (first NaN if any), -1 when empty */
+int64_t xc_simd_argmin_f64(const double *a, size_t n) {
+    const simd_numeric_ops_t *ops = simd_numeric_ops();
+    return n == 0 ? -1 : ops->find(a, n, ops->min(a, n));
+}
+
+int64_t xc_simd_argmax_f64(const double *a, size_t n) {
+    const simd_numeric_ops_t *ops = simd_numeric_ops();
+    return n == 0 ? -1 : ops->find(a, n, ops->max(a, n));
+}
+
+void xc_simd_add_f64(double *dst, const double *a, const double *b, size_t n) {
+    simd_numeric_ops()->add(dst, a, b, n);
+}
+
+void xc_simd_mul_f64(double *dst, const double *a, const double *b, size_t n) {
+    simd_numeric_ops()->mul(dst, a, b, n);
+}
+
+void xc_simd_scale_f64(double *dst, const double *a, double s, size_t n) {
+    simd_numeric_ops()->scale(dst, a, s, n);
+}
+
+void xc_simd_clamp_f64(double *dst, const double *a, double lo, double hi, size_t n) {
+    simd_numeric_ops()->clamp(dst, a, lo, hi, n);
+}
+
+void xc_simd_prefix_sum_f64(double *dst, const double *a, size_t n) {
+    simd_numeric_ops()->prefix_sum(dst, a, n);
+}
+
+size_t xc_simd_compare_f64(uint8_t *mask, const double *a, size_t n, double value, int op) {
+    return simd_numeric_ops()->compare(mask, a, n, value, op);
+}
@@ -37,6 +37,9 @@ static char* format_message(int argc, xc_val* argv) {
         }
         
         const char* str = xc_string_value(rt, item_str);
+        if (!str) {
+            str = "<out of memory>";
+        }
         size_t len = strlen(str);
         
         /* 检查是否需要扩展缓冲区 */
@@ -107,6 +110,9 @@ static xc_val console_time(xc_val self, int argc, xc_val* argv, xc_val closure)
     }
     
     const char* label = xc_string_value(rt, argv[0]);
+    if (!label) {
+        return NULL;
+    }
     
     /* 存储当前时间到label属性中 */
     clock_t start_time = clock();
@@ -124,6 +130,9 @@ static xc_val console_timeEnd(xc_val self, int argc, xc_val* argv, xc_val closur
     }
     
     const char* label = xc_string_value(rt, argv[0]);
+    if (!label) {
+        return NULL;
+    }
     
     /* 获取存储的开始时间 */
     xc_val start_val = xc_object_get(rt, self, label);
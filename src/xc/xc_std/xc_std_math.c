@@ -23,34 +23,63 @@ static xc_val math_abs(xc_val self, va_list* args) {
     return rt->new(XC_TYPE_NUMBER, fabs(value));
 }
 
-/* max - 最大值 */
-static xc_val math_max(xc_val self, va_list* args) {
-    xc_val a = va_arg(*args, xc_val);
-    xc_val b = va_arg(*args, xc_val);
-    
-    if (!rt->is(a, XC_TYPE_NUMBER) || !rt->is(b, XC_TYPE_NUMBER)) {
-        return rt->new(XC_TYPE_EXCEPTION, XC_ERR_TYPE, "Math.max requires number arguments");
+/*
+ * 聚合函数：参数可以是数字、数组或类型化数组，任意个数
+ * (called as handler(rt, this, argc, argv)). Typed arrays go straight to
+ * the SIMD kernels; numbers and generic arrays are gathered first.
+ */
+
+/* Gather every number in argv into a float64 typed array */
+static xc_object_t *math_collect(xc_runtime_t *rt, int argc, xc_val *argv) {
+    if (argc == 1 && xc_is_buffer(rt, argv[0]) && xc_buffer_kind(rt, argv[0]) == XC_BUFFER_FLOAT64) {
+        return argv[0];
     }
-    
-    double value_a = *(double*)a;
-    double value_b = *(double*)b;
-    
-    return rt->new(XC_TYPE_NUMBER, value_a > value_b ? value_a : value_b);
+    xc_object_t *values = xc_buffer_create(rt, XC_BUFFER_FLOAT64, 0);
+    for (int i = 0; i < argc && values; i++) {
+        xc_val arg = argv[i];
+        if (xc_is_buffer(rt, arg)) {
+            for (size_t j = 0; j < xc_buffer_length(rt, arg); j++) {
+                xc_buffer_push(rt, values, xc_buffer_get_number(rt, arg, j));
+            }
+        } else if (xc_is_array(rt, arg)) {
+            for (size_t j = 0; j < xc_array_length(rt, arg); j++) {
+                xc_buffer_push(rt, values, xc_to_number(rt, xc_array_get(rt, arg, j)));
+            }
+        } else {
+            xc_buffer_push(rt, values, xc_to_number(rt, arg));
+        }
+    }
+    return values;
 }
 
-/* min - 最小值 */
-static xc_val math_min(xc_val self, va_list* args) {
-    xc_val a = va_arg(*args, xc_val);
-    xc_val b = va_arg(*args, xc_val);
-    
-    if (!rt->is(a, XC_TYPE_NUMBER) || !rt->is(b, XC_TYPE_NUMBER)) {
-        return rt->new(XC_TYPE_EXCEPTION, XC_ERR_TYPE, "Math.min requires number arguments");
+/* max - 最大值；没有参数时为 -Infinity，任何 NaN 使结果为 NaN */
+static xc_val math_max(xc_runtime_t *rt, xc_val self, int argc, xc_val *argv) {
+    return xc_number_box(rt, xc_buffer_max(rt, math_collect(rt, argc, argv)));
+}
+
+/* min - 最小值；没有参数时为 Infinity */
+static xc_val math_min(xc_runtime_t *rt, xc_val self, int argc, xc_val *argv) {
+    return xc_number_box(rt, xc_buffer_min(rt, math_collect(rt, argc, argv)));
+}
+
+/* sum - 求和 */
+static xc_val math_sum(xc_runtime_t *rt, xc_val self, int argc, xc_val *argv) {
+    return xc_number_box(rt, xc_buffer_sum(rt, math_collect(rt, argc, argv)));
+}
+
+/* mean - 平均值；没有参数时为 NaN */
+static xc_val math_mean(xc_runtime_t *rt, xc_val self, int argc, xc_val *argv) {
+    return xc_number_box(rt, xc_buffer_mean(rt, math_collect(rt, argc, argv)));
+}
+
+/* dot - 两个数组或类型化数组的点积 */
+static xc_val math_dot(xc_runtime_t *rt, xc_val self, int argc, xc_val *argv) {
+    if (argc < 2) {
+        return rt->new(XC_TYPE_EXCEPTION, XC_ERR_TYPE, "Math.dot requires two arrays");
     }
-    
-    double value_a = *(double*)a;
-    double value_b = *(double*)b;
-    
-    return rt->new(XC_TYPE_NUMBER, value_a < value_b ? value_a : value_b);
+    xc_object_t *a = math_collect(rt, 1, &argv[0]);
+    xc_object_t *b = math_collect(rt, 1, &argv[1]);
+    return xc_number_box(rt, xc_buffer_dot(rt, a, b));
 }
 
 /* round - 四舍五入 */
@@ -159,6 +188,15 @@ static xc_val create_math_object(void) {
     xc_object_set(rt, obj, "min", min_func);
     // xc_release(min_func);
     
+    xc_val sum_func = rt->new(XC_TYPE_FUNC, math_sum, NULL);
+    xc_object_set(rt, obj, "sum", sum_func);
+    
+    xc_val mean_func = rt->new(XC_TYPE_FUNC, math_mean, NULL);
+    xc_object_set(rt, obj, "mean", mean_func);
+    
+    xc_val dot_func = rt->new(XC_TYPE_FUNC, math_dot, NULL);
+    xc_object_set(rt, obj, "dot", dot_func);
+    
     xc_val round_func = rt->new(XC_TYPE_FUNC, math_round, NULL);
     xc_object_set(rt, obj, "round", round_func);
     // xc_release(round_func);
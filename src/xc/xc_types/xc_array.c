@@ -4,13 +4,15 @@
 static xc_runtime_t* rt = NULL;
 /* Forward declarations */
 static bool array_ensure_capacity(xc_array_t *arr, size_t needed);
+static xc_object_t **array_flatten(xc_array_t *arr);
+static void array_store_release(xc_array_store_t *store);
 static xc_object_t *xc_to_string_internal(xc_runtime_t *rt, xc_object_t *obj);
 static xc_object_t *xc_array_join_elements(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *separator);
 int xc_array_find_index_from(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *value, int from_index);
 static void array_mark(xc_object_t *obj, mark_func mark);
-static void array_free(xc_runtime_t *rt, xc_object_t *obj);
-static bool array_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
-static int array_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+static int array_free(xc_val obj);
+static bool array_equal(xc_val a, xc_val b);
+static int array_compare(xc_val a, xc_val b);
 static xc_val array_creator(int type, va_list args);
 static void array_initializer(void);
 
@@ -65,31 +67,36 @@ static int xc_compare_objects(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b)
 /* Array methods */
 static void array_mark(xc_object_t *obj, mark_func mark) {
     xc_array_t *arr = (xc_array_t *)obj;
-    for (size_t i = 0; i < arr->length; i++) {
+    /* Only this array's own range: slots of a shared block outside it belong to other arrays */
+    size_t head_length = arr->length - arr->tail_length;
+    for (size_t i = 0; i < head_length; i++) {
         if (arr->items[i]) {
             /* Mark each item in the array */
             mark(arr->items[i]);
         }
     }
+    for (size_t i = 0; i < arr->tail_length; i++) {
+        if (arr->tail_items[i]) {
+            mark(arr->tail_items[i]);
+        }
+    }
 }
 
-static void array_free(xc_runtime_t *rt, xc_object_t *obj) {
+static int array_free(xc_val obj) {
     xc_array_t *arr = (xc_array_t *)obj;
-    /* Release all items */
-    for (size_t i = 0; i < arr->length; i++) {
-        if (arr->items[i]) {
-            //xc_gc_free(rt, arr->items[i]);
-printf("TODO xc_gc_free or memmove??");
-        }
-    }
-    /* Free the items array */
-    free(arr->items);//??? not using gc??
-    arr->items = NULL;
+    /* Items are reclaimed by the GC; free the slot blocks once no other array shares them */
+    array_store_release(arr->store);
+    array_store_release(arr->tail_store);
+    arr->store = arr->tail_store = NULL;
+    arr->items = arr->tail_items = NULL;
     arr->length = 0;
     arr->capacity = 0;
+    arr->head = 0;
+    arr->tail_length = 0;
+    return 0;
 }
 
-static bool array_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static bool array_equal(xc_val a, xc_val b) {
     if (!xc_is_array(rt, b)) {
         return false;
     }
@@ -100,6 +107,8 @@ static bool array_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
     if (arr_a->length != arr_b->length) {
         return false;
     }
+    array_flatten(arr_a);
+    array_flatten(arr_b);
 
     for (size_t i = 0; i < arr_a->length; i++) {
         if (!xc_equal(rt, arr_a->items[i], arr_b->items[i])) {
@@ -110,13 +119,15 @@ static bool array_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
     return true;
 }
 
-static int array_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static int array_compare(xc_val a, xc_val b) {
     if (!xc_is_array(rt, b)) {
         return 1; /* Arrays are greater than non-arrays */
     }
     
     xc_array_t *arr_a = (xc_array_t *)a;
     xc_array_t *arr_b = (xc_array_t *)b;
+    array_flatten(arr_a);
+    array_flatten(arr_b);
 
     size_t min_len = arr_a->length < arr_b->length ? arr_a->length : arr_b->length;
 
@@ -137,13 +148,15 @@ static xc_type_lifecycle_t array_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = array_creator,
-    .destroyer = (xc_destroy_func)array_free,
+    .destroyer = array_free,
     .marker = array_mark,
     // .allocator = NULL,
     .name = "array",
-    .equal = (bool (*)(xc_val, xc_val))array_equal,
-    .compare = (int (*)(xc_val, xc_val))array_compare,
-    .flags = 0
+    .equal = array_equal,
+    .compare = array_compare,
+    .flags = 0,
+    .get_value = array_get_value,
+    .convert_to = array_convert_to
 };
 
 /* Array creator function for type system */
@@ -247,6 +260,31 @@ static xc_val array_join_method(xc_val self, xc_val arg) {
     return xc_array_join_elements(rt, (xc_object_t *)self, (xc_object_t *)arg);
 }
 
+/* sort / sortStable: 可选参数是比较函数 */
+static xc_val array_sort_method(xc_val self, xc_val arg) {
+    xc_array_sort(rt, (xc_object_t *)self, xc_is_function(rt, arg) ? (xc_object_t *)arg : NULL);
+    return self;
+}
+
+static xc_val array_sort_stable_method(xc_val self, xc_val arg) {
+    xc_array_sort_stable(rt, (xc_object_t *)self, xc_is_function(rt, arg) ? (xc_object_t *)arg : NULL);
+    return self;
+}
+
+/* topK: 参数是数字 k，或数组 [k, 比较函数] */
+static xc_val array_top_k_method(xc_val self, xc_val arg) {
+    xc_object_t *comparator = NULL;
+    if (arg && rt->is(arg, XC_TYPE_ARRAY)) {
+        comparator = xc_array_get(rt, (xc_object_t *)arg, 1);
+        arg = xc_array_get(rt, (xc_object_t *)arg, 0);
+    }
+    if (!arg || !rt->is(arg, XC_TYPE_NUMBER) || xc_number_value(rt, (xc_object_t *)arg) < 0) {
+        return NULL;
+    }
+    return xc_array_top_k(rt, (xc_object_t *)self, (size_t)xc_number_value(rt, (xc_object_t *)arg),
+                          xc_is_function(rt, comparator) ? comparator : NULL);
+}
+
 /* Array initializer function for type system */
 static void array_initializer() {
     // xc_runtime_t *rt = &xc;
@@ -269,6 +307,9 @@ static void array_initializer() {
     rt->register_method(XC_TYPE_ARRAY, "slice", array_slice_method);
     rt->register_method(XC_TYPE_ARRAY, "concat", array_concat_method);
     rt->register_method(XC_TYPE_ARRAY, "join", array_join_method);
+    rt->register_method(XC_TYPE_ARRAY, "sort", array_sort_method);
+    rt->register_method(XC_TYPE_ARRAY, "sortStable", array_sort_stable_method);
+    rt->register_method(XC_TYPE_ARRAY, "topK", array_top_k_method);
     
     //printf("DEBUG array_initializer: methods registered\n");
 }
@@ -292,43 +333,166 @@ void xc_register_array_type(xc_runtime_t *caller_rt) {
     array_type.initializer = (xc_initializer_func)array_initializer;
     array_type.cleaner = NULL;
     array_type.creator = array_creator;
-    array_type.destroyer = (xc_destroy_func)array_free;
+    array_type.destroyer = array_free;
     array_type.marker = (xc_marker_func)array_mark;
     array_type.name = "array";
-    array_type.equal = (void*)array_equal;
-    array_type.compare = (void*)array_compare;
+    array_type.equal = array_equal;
+    array_type.compare = array_compare;
     
     // 新增：值访问和类型转换
     array_type.get_value = array_get_value;
     array_type.convert_to = array_convert_to;
 }
 
-/* Ensure array has enough capacity */
+/*
+ * Storage layout: items points into a refcounted slot block after head
+ * free slots, so shift just advances items and unshift reuses the gap.
+ * Both ends are amortized O(1) and items[i] stays a plain index everywhere.
+ *
+ * Copy on write: slice and concat results of XC_ARRAY_VIEW_MIN elements or
+ * more point into their sources' blocks instead of copying. Every array on
+ * a block with refs > 1 treats it as read-only and copies its own range
+ * into a fresh block (array_unshare) before the first write; pop and shift
+ * only move its window. A concat view keeps its second operand in
+ * tail_store/tail_items until it is written or a caller needs the
+ * elements contiguous (array_flatten), so items[i] is only valid below
+ * length - tail_length for code that has not flattened.
+ */
+
+static xc_array_store_t *array_store_alloc(size_t slots) {
+    xc_array_store_t *store = calloc(1, sizeof(xc_array_store_t) + slots * sizeof(xc_object_t *));
+    if (store) {
+        store->refs = 1;
+    }
+    return store;
+}
+
+static void array_store_release(xc_array_store_t *store) {
+    if (store && --store->refs == 0) {
+        free(store);
+    }
+}
+
+static inline bool array_is_shared(const xc_array_t *arr) {
+    return (arr->store && arr->store->refs > 1) || arr->tail_store;
+}
+
+/* Copies the elements, both segments of a concat view included, to dst */
+static void array_copy_out(const xc_array_t *arr, xc_object_t **dst) {
+    size_t head_length = arr->length - arr->tail_length;
+    if (head_length > 0) {
+        memcpy(dst, arr->items, head_length * sizeof(xc_object_t *));
+    }
+    if (arr->tail_length > 0) {
+        memcpy(dst + head_length, arr->tail_items, arr->tail_length * sizeof(xc_object_t *));
+    }
+}
+
+/* Moves the elements into a block of their own with room for extra more */
+static bool array_move_to_new_store(xc_array_t *arr, size_t extra) {
+    size_t capacity = arr->length + extra < 8 ? 8 : arr->length + extra;
+    xc_array_store_t *store = array_store_alloc(capacity);
+    if (!store) {
+        return false;
+    }
+    array_copy_out(arr, store->slots);
+    array_store_release(arr->store);
+    array_store_release(arr->tail_store);
+    arr->store = store;
+    arr->items = store->slots;
+    arr->capacity = capacity;
+    arr->head = 0;
+    arr->tail_store = NULL;
+    arr->tail_items = NULL;
+    arr->tail_length = 0;
+    return true;
+}
+
+/* Makes the storage private and contiguous before a write */
+static inline bool array_unshare(xc_array_t *arr, size_t extra) {
+    return !array_is_shared(arr) || array_move_to_new_store(arr, extra);
+}
+
+/* Joins the segments of a concat view; the block may stay shared since callers only read */
+static xc_object_t **array_flatten(xc_array_t *arr) {
+    if (arr->tail_store) {
+        array_move_to_new_store(arr, 0);
+    }
+    return arr->items;
+}
+
+/* Ensure array has enough capacity at the end */
 static bool array_ensure_capacity(xc_array_t *arr, size_t needed) {
+    if (!array_unshare(arr, needed > arr->length ? needed - arr->length : 0)) {
+        return false;
+    }
     if (needed <= arr->capacity) {
         return true;
     }
 
+    /* A front gap at least as large as the contents is reclaimed before growing */
+    if (arr->head > 0 && arr->head >= arr->length && needed <= arr->capacity + arr->head) {
+        xc_object_t **base = arr->store->slots;
+        memmove(base, arr->items, arr->length * sizeof(xc_object_t *));
+        memset(base + arr->length, 0, arr->head * sizeof(xc_object_t *));
+        arr->items = base;
+        arr->capacity += arr->head;
+        arr->head = 0;
+        return true;
+    }
+
     size_t new_capacity = arr->capacity == 0 ? 8 : arr->capacity * 2;
     while (new_capacity < needed) {
         new_capacity *= 2;
     }
 
-    xc_object_t **new_items = realloc(arr->items, new_capacity * sizeof(xc_object_t *));
-    if (!new_items) {
+    xc_array_store_t *new_store = realloc(arr->store, sizeof(xc_array_store_t) +
+                                          (arr->head + new_capacity) * sizeof(xc_object_t *));
+    if (!new_store) {
         return false;
     }
+    if (!arr->store) {
+        new_store->refs = 1;
+    }
+    xc_object_t **new_items = new_store->slots + arr->head;
 
     /* Initialize new slots to NULL */
     for (size_t i = arr->capacity; i < new_capacity; i++) {
         new_items[i] = NULL;
     }
 
+    arr->store = new_store;
     arr->items = new_items;
     arr->capacity = new_capacity;
     return true;
 }
 
+/* Ensure there is a free slot before items, doubling the front gap when it runs out */
+static bool array_ensure_head(xc_array_t *arr) {
+    if (!array_unshare(arr, 0)) {
+        return false;
+    }
+    if (arr->head > 0) {
+        return true;
+    }
+
+    size_t gap = arr->length < 8 ? 8 : arr->length;
+    size_t tail = arr->capacity > arr->length ? arr->capacity : arr->length;
+    xc_array_store_t *new_store = array_store_alloc(gap + tail);
+    if (!new_store) {
+        return false;
+    }
+    if (arr->items) {
+        memcpy(new_store->slots + gap, arr->items, arr->length * sizeof(xc_object_t *));
+    }
+    array_store_release(arr->store);
+    arr->store = new_store;
+    arr->items = new_store->slots + gap;
+    arr->capacity = tail;
+    arr->head = gap;
+    return true;
+}
+
 /* Array creation */
 xc_object_t *xc_array_create(xc_runtime_t *rt) {
     //printf("DEBUG xc_array_create called\n");
@@ -367,18 +531,22 @@ xc_object_t *xc_array_create_with_capacity(xc_runtime_t *rt, size_t capacity) {
     ((xc_object_t *)arr)->type_id = XC_TYPE_ARRAY;
     arr->length = 0;
     arr->capacity = capacity;
+    arr->head = 0;
+    arr->store = NULL;
+    arr->items = NULL;
+    arr->tail_store = NULL;
+    arr->tail_items = NULL;
+    arr->tail_length = 0;
     
-    /* 分配数组内存 */
+    /* 分配数组内存（新块的槽位已清零） */
     if (capacity > 0) {
-        arr->items = (xc_object_t **)malloc(sizeof(xc_object_t *) * capacity);
-        if (!arr->items) {
+        arr->store = array_store_alloc(capacity);
+        if (!arr->store) {
             //xc_gc_free(rt, (xc_object_t *)arr);
 //TODO rt->delete(arr);
             return NULL;
         }
-        memset(arr->items, 0, sizeof(xc_object_t *) * capacity);
-    } else {
-        arr->items = NULL;
+        arr->items = arr->store->slots;
     }
     
     //printf("DEBUG xc_array_create_with_capacity: returning array at %p\n", arr);
@@ -400,16 +568,35 @@ xc_object_t *xc_array_get(xc_runtime_t *rt, xc_object_t *arr, size_t index) {
         return NULL;
     }
     
-    return array->items[index];
+    /* Concat views index into their second segment without flattening */
+    size_t head_length = array->length - array->tail_length;
+    return index < head_length ? array->items[index] : array->tail_items[index - head_length];
+}
+
+/* Contiguous elements for bulk reads, valid until the array is next written */
+xc_object_t **xc_array_items(xc_runtime_t *rt, xc_object_t *arr) {
+    assert(xc_is_array(rt, arr));
+    return array_flatten((xc_array_t *)arr);
+}
+
+/* True while arr reads another array's storage (a slice or concat view not yet written) */
+bool xc_array_is_shared(xc_runtime_t *rt, xc_object_t *arr) {
+    assert(xc_is_array(rt, arr));
+    return array_is_shared((xc_array_t *)arr);
 }
 
 void xc_array_set(xc_runtime_t *rt, xc_object_t *arr, size_t index, xc_object_t *value) {
     assert(xc_is_array(rt, arr));
     xc_array_t *array = (xc_array_t *)arr;
 
-    if (index >= array->capacity && !array_ensure_capacity(array, index + 1)) {
+    if (!array_ensure_capacity(array, index + 1)) {
         return;
     }
+    /* Slots skipped over read as null: pop on a shared block leaves the
+     * old pointers there, and the block may be ours alone by now */
+    if (index > array->length) {
+        memset(array->items + array->length, 0, (index - array->length) * sizeof(xc_object_t *));
+    }
 
     // /* 如果当前位置有值，先减少引用计数 */
     // if (array->items[index]) {
@@ -451,8 +638,18 @@ xc_object_t *xc_array_pop(xc_runtime_t *rt, xc_object_t *arr) {
         return NULL;
     }
 
-    xc_object_t *value = array->items[array->length - 1];
-    array->items[array->length - 1] = NULL;
+    xc_object_t *value = xc_array_get(rt, arr, array->length - 1);
+    if (array->tail_length > 0) {
+        /* Concat view: shrink the second segment, dropping it once empty */
+        if (--array->tail_length == 0) {
+            array_store_release(array->tail_store);
+            array->tail_store = NULL;
+            array->tail_items = NULL;
+        }
+    } else if (array->store->refs == 1) {
+        /* A shared block keeps the slot for the arrays still reading it */
+        array->items[array->length - 1] = NULL;
+    }
     array->length--;
 
     /* 不在这里减少引用计数，因为我们要返回这个对象 */
@@ -461,20 +658,19 @@ xc_object_t *xc_array_pop(xc_runtime_t *rt, xc_object_t *arr) {
     return value;
 }
 
-/* Add element to the beginning of the array */
+/* Add element to the beginning of the array (amortized O(1)) */
 void xc_array_unshift(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *value) {
     assert(xc_is_array(rt, arr));
     xc_array_t *array = (xc_array_t *)arr;
     
-    if (!array_ensure_capacity(array, array->length + 1)) {
+    if (!array_ensure_head(array)) {
         return;
     }
     
-    /* Shift all elements right by one position */
-    for (size_t i = array->length; i > 0; i--) {
-        array->items[i] = array->items[i - 1];
-    }
-    
+    /* Step back into the front gap */
+    array->items--;
+    array->head--;
+    array->capacity++;
     array->items[0] = value;
     // if (value) {
     //     xc_gc_add_ref(rt, value);
@@ -482,7 +678,7 @@ void xc_array_unshift(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *value) {
     array->length++;
 }
 
-/* Remove and return the first element of the array */
+/* Remove and return the first element of the array (O(1)) */
 xc_object_t *xc_array_shift(xc_runtime_t *rt, xc_object_t *arr) {
     assert(xc_is_array(rt, arr));
     xc_array_t *array = (xc_array_t *)arr;
@@ -490,23 +686,51 @@ xc_object_t *xc_array_shift(xc_runtime_t *rt, xc_object_t *arr) {
     if (array->length == 0) {
         return NULL;
     }
+    if (array->length == array->tail_length && !array_unshare(array, 0)) {
+        return NULL;
+    }
     
     xc_object_t *value = array->items[0];
     
-    /* Shift all elements left by one position */
-    for (size_t i = 0; i < array->length - 1; i++) {
-        array->items[i] = array->items[i + 1];
+    /* The first slot joins the front gap; a shared block keeps its value */
+    if (array->store->refs == 1) {
+        array->items[0] = NULL;
     }
-    
-    array->items[array->length - 1] = NULL;
+    array->items++;
+    array->head++;
+    array->capacity--;
     array->length--;
     
+    /* An empty array starts again at the front of its allocation */
+    if (array->length == 0) {
+        array->items -= array->head;
+        array->capacity += array->head;
+        array->head = 0;
+    }
+    
     /* 不在这里减少引用计数，因为我们要返回这个对象 */
     /* 调用者负责在使用完毕后释放 */
     
     return value;
 }
 
+/* New array reading length elements of store from items on, without copying */
+static xc_object_t *array_create_view(xc_runtime_t *rt, xc_array_store_t *store, xc_object_t **items, size_t length) {
+    xc_object_t *view = xc_array_create(rt);
+    if (!view) {
+        return NULL;
+    }
+    xc_array_t *out = (xc_array_t *)view;
+    store->refs++;
+    out->store = store;
+    out->items = items;
+    out->head = items - store->slots;
+    /* No spare capacity: the first push goes through array_unshare */
+    out->capacity = length;
+    out->length = length;
+    return view;
+}
+
 /* Create a new array with elements from start to end (exclusive) */
 xc_object_t *xc_array_slice(xc_runtime_t *rt, xc_object_t *arr, int start, int end) {
     assert(xc_is_array(rt, arr));
@@ -514,41 +738,48 @@ xc_object_t *xc_array_slice(xc_runtime_t *rt, xc_object_t *arr, int start, int e
     xc_array_t *array = (xc_array_t *)arr;
     size_t length = array->length;
     
-    if (start < 0) {
-        start = length + start;
+    /* Negative indices count from the end; clamp in a signed type so that
+     * -100 on a short array becomes 0 rather than wrapping */
+    ptrdiff_t first = start < 0 ? (ptrdiff_t)length + start : start;
+    ptrdiff_t last = end < 0 ? (ptrdiff_t)length + end : end;
+    if (first < 0) {
+        first = 0;
     }
-    
-    if (end < 0) {
-        end = length + end;
+    if (last > (ptrdiff_t)length) {
+        last = (ptrdiff_t)length;
     }
     
-    /* Clamp indices to valid range */
-    if (start < 0) {
-        start = 0;
+    /* Handle invalid range */
+    if (first >= last) {
+        return xc_array_create(rt);
     }
-    
-    if (end > length) {
-        end = length;
+    size_t lo = (size_t)first;
+    size_t hi = (size_t)last;
+    
+    /* A range inside one segment of a concat view is read in place; one across both flattens it */
+    size_t slice_length = hi - lo;
+    size_t head_length = length - array->tail_length;
+    if (lo < head_length && hi > head_length) {
+        array_flatten(array);
+        head_length = length;
     }
+    xc_array_store_t *store = lo < head_length ? array->store : array->tail_store;
+    xc_object_t **from = lo < head_length ? array->items + lo : array->tail_items + (lo - head_length);
     
-    /* Handle invalid range */
-    if (start >= length || start >= end) {
-        return xc_array_create(rt);
+    /* Long slices share the parent's storage until one side writes */
+    if (slice_length >= XC_ARRAY_VIEW_MIN) {
+        return array_create_view(rt, store, from, slice_length);
     }
     
     /* Create new array for the slice */
-    size_t slice_length = end - start;
     xc_object_t *slice = xc_array_create_with_capacity(rt, slice_length);
     if (!slice) {
         return NULL;
     }
     
-    /* Copy elements to the new array */
-    for (int i = start; i < end; i++) {
-        // 增加引用计数，因为我们要将对象添加到新数组中
-        //xc_gc_retain(rt, array->items[i]);
-        xc_array_push(rt, slice, array->items[i]);
-    }
+    /* Copy the contiguous run of elements */
+    memcpy(((xc_array_t *)slice)->items, from, slice_length * sizeof(xc_object_t *));
+    ((xc_array_t *)slice)->length = slice_length;
     
     return slice;
 }
@@ -560,27 +791,46 @@ xc_object_t *xc_array_concat(xc_runtime_t *rt, xc_object_t *arr1, xc_object_t *a
     
     xc_array_t *array1 = (xc_array_t *)arr1;
     xc_array_t *array2 = (xc_array_t *)arr2;
+    size_t total_length = array1->length + array2->length;
+    
+    /*
+     * Long results become a chunked view of both operands: items reads
+     * arr1's block and tail_items arr2's. Operands that are views of two
+     * segments themselves are flattened first, so a view has at most two.
+     */
+    if (total_length >= XC_ARRAY_VIEW_MIN) {
+        array_flatten(array1);
+        array_flatten(array2);
+        xc_array_t *shared = array2->length == 0 ? array1 : array1->length == 0 ? array2 : NULL;
+        if (shared) {
+            return array_create_view(rt, shared->store, shared->items, shared->length);
+        }
+        xc_object_t *result = array_create_view(rt, array1->store, array1->items, array1->length);
+        if (!result) {
+            return NULL;
+        }
+        xc_array_t *out = (xc_array_t *)result;
+        array2->store->refs++;
+        out->tail_store = array2->store;
+        out->tail_items = array2->items;
+        out->tail_length = array2->length;
+        out->length = total_length;
+        return result;
+    }
     
     /* Create new array with capacity for all elements */
-    size_t total_length = array1->length + array2->length;
     xc_object_t *result = xc_array_create_with_capacity(rt, total_length);
     if (!result) {
         return NULL;
     }
     
-    /* Copy elements from first array */
-    for (size_t i = 0; i < array1->length; i++) {
-        // 增加引用计数，因为我们要将对象添加到新数组中
-        //xc_gc_retain(rt, array1->items[i]);
-        xc_array_push(rt, result, array1->items[i]);
-    }
-    
-    /* Copy elements from second array */
-    for (size_t i = 0; i < array2->length; i++) {
-        // 增加引用计数，因为我们要将对象添加到新数组中
-        //xc_gc_retain(rt, array2->items[i]);
-        xc_array_push(rt, result, array2->items[i]);
+    /* Copy both operands, each one or two contiguous runs */
+    xc_array_t *out = (xc_array_t *)result;
+    if (total_length > 0) {
+        array_copy_out(array1, out->items);
+        array_copy_out(array2, out->items + array1->length);
     }
+    out->length = total_length;
     
     return result;
 }
@@ -598,6 +848,7 @@ int xc_array_find_index_from(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *va
     
     xc_array_t *array = (xc_array_t *)arr;
     size_t length = array->length;
+    array_flatten(array);
     
     if (from_index < 0) {
         from_index = 0;
@@ -622,6 +873,333 @@ int xc_array_index_of_from(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *valu
     return xc_array_find_index_from(rt, arr, value, from_index);
 }
 
+/*
+ * Sorting. Arrays holding only numbers or only strings are detected up
+ * front and sorted as (key, item) pairs compared inline, with no type
+ * dispatch per comparison. Mixed arrays use sort_compare_values; custom
+ * comparators always take the merge sort, which stays in bounds even if
+ * the comparator is inconsistent and needs the fewest calls. Every path
+ * sorts a copy of items and writes it back, so a comparator that mutates
+ * the array cannot pull storage out from under the sort.
+ */
+#define SORT_MODE_UNSTABLE 0
+#define SORT_MODE_STABLE   1
+#define SORT_MODE_TOP_K    2
+#define SORT_MODE_PARALLEL 3
+
+/* Numbers sort by a 64-bit key ordered like the double; -0 equals 0 and NaN sorts last */
+typedef struct {
+    uint64_t key;
+    xc_object_t *item;
+} sort_number_t;
+
+typedef struct {
+    const char *data;
+    size_t length;
+    xc_object_t *item;
+} sort_string_t;
+
+typedef struct {
+    xc_runtime_t *rt;
+    xc_object_t *comparator;
+} sort_context_t;
+
+static inline uint64_t sort_number_key(double value) {
+    if (value != value) {
+        return UINT64_MAX;
+    }
+    if (value == 0) {
+        value = 0;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x8000000000000000ULL) ? ~bits : bits | 0x8000000000000000ULL;
+}
+
+/* Byte order, then length, matching string_compare */
+static inline int sort_string_cmp(const sort_string_t *a, const sort_string_t *b) {
+    size_t len = a->length < b->length ? a->length : b->length;
+    int c = memcmp(a->data, b->data, len);
+    if (c != 0) {
+        return c;
+    }
+    return (a->length > b->length) - (a->length < b->length);
+}
+
+/* Mixed arrays: holes last, then by type id, then by value where the type has one */
+static int sort_compare_values(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+    if (a == b) {
+        return 0;
+    }
+    if (!a || !b) {
+        return a ? -1 : 1;
+    }
+    if (a->type_id != b->type_id) {
+        return a->type_id < b->type_id ? -1 : 1;
+    }
+    switch (a->type_id) {
+        case XC_TYPE_NUMBER: {
+            uint64_t ka = sort_number_key(xc_number_value(rt, a));
+            uint64_t kb = sort_number_key(xc_number_value(rt, b));
+            return (ka > kb) - (ka < kb);
+        }
+        case XC_TYPE_STRING: {
+            sort_string_t sa = { xc_string_data(rt, a), xc_string_length(rt, a), a };
+            sort_string_t sb = { xc_string_data(rt, b), xc_string_length(rt, b), b };
+            if (!sa.data || !sb.data) {
+                /* 无法展平的 rope（MemoryError 已挂起）：只按长度排 */
+                return (sa.length > sb.length) - (sa.length < sb.length);
+            }
+            return sort_string_cmp(&sa, &sb);
+        }
+        case XC_TYPE_BOOL:
+            return (int)xc_boolean_value(rt, a) - (int)xc_boolean_value(rt, b);
+        default:
+            /* 其他类型没有值顺序，按地址排序，与 xc_compare 的默认行为一致 */
+            return (a < b) ? -1 : 1;
+    }
+}
+
+/* comparator(a, b) < 0 means a sorts first */
+static inline bool sort_custom_less(sort_context_t *ctx, xc_object_t *a, xc_object_t *b) {
+    xc_object_t *argv[2] = { a, b };
+    xc_object_t *result = xc_function_call(ctx->rt, ctx->comparator, NULL, 2, argv);
+    return xc_to_number(ctx->rt, result) < 0;
+}
+
+#define SORT_NAME sort_number
+#define SORT_TYPE sort_number_t
+#define SORT_LESS(a, b) ((a).key < (b).key)
+#include "xc_sort.h"
+
+#define SORT_NAME sort_string
+#define SORT_TYPE sort_string_t
+#define SORT_LESS(a, b) (sort_string_cmp(&(a), &(b)) < 0)
+#include "xc_sort.h"
+
+#define SORT_NAME sort_value
+#define SORT_TYPE xc_object_t *
+#define SORT_LESS(a, b) (sort_compare_values(((sort_context_t *)ctx)->rt, (a), (b)) < 0)
+#include "xc_sort.h"
+
+#define SORT_NAME sort_custom
+#define SORT_TYPE xc_object_t *
+#define SORT_LESS(a, b) sort_custom_less((sort_context_t *)ctx, (a), (b))
+#include "xc_sort.h"
+
+/*
+ * Parallel mode: pdqsort per chunk on the worker pool, then stable merges.
+ * Number and string pairs are built on the calling thread, so the workers
+ * only compare keys and bytes and never touch the GC.
+ */
+static void sort_number_chunk(size_t chunk, size_t begin, size_t end, void *data) {
+    sort_number_sort((sort_number_t *)data + begin, end - begin, NULL);
+}
+
+static void sort_number_merge_runs(const void *a, size_t na, const void *b, size_t nb, void *out, void *data) {
+    sort_number_merge((sort_number_t *)a, na, (sort_number_t *)b, nb, out, NULL);
+}
+
+static void sort_string_chunk(size_t chunk, size_t begin, size_t end, void *data) {
+    sort_string_sort((sort_string_t *)data + begin, end - begin, NULL);
+}
+
+static void sort_string_merge_runs(const void *a, size_t na, const void *b, size_t nb, void *out, void *data) {
+    sort_string_merge((sort_string_t *)a, na, (sort_string_t *)b, nb, out, NULL);
+}
+
+/* Runs one instantiation of xc_sort.h in the requested mode */
+#define SORT_APPLY(name, a, tmp, n, k, mode, ctx)                \
+    do {                                                         \
+        if ((mode) == SORT_MODE_STABLE) {                        \
+            name##_stable(a, tmp, n, ctx);                       \
+        } else if ((mode) == SORT_MODE_TOP_K) {                  \
+            name##_select(a, n, k, ctx);                         \
+            name##_sort(a, k, ctx);                              \
+        } else {                                                 \
+            name##_sort(a, n, ctx);                              \
+        }                                                        \
+    } while (0)
+
+static bool sort_numbers(xc_runtime_t *rt, xc_object_t **items, size_t n, size_t k, int mode) {
+    sort_number_t *pairs = malloc(n * sizeof(sort_number_t) * (mode == SORT_MODE_STABLE || mode == SORT_MODE_PARALLEL ? 2 : 1));
+    if (!pairs) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        pairs[i].key = sort_number_key(xc_number_value(rt, items[i]));
+        pairs[i].item = items[i];
+    }
+    sort_number_t *sorted = pairs;
+    if (mode == SORT_MODE_PARALLEL) {
+        sorted = xc_parallel_sort_runs(pairs, pairs + n, n, sizeof(sort_number_t),
+                                       sort_number_chunk, sort_number_merge_runs, pairs);
+    } else {
+        SORT_APPLY(sort_number, pairs, pairs + n, n, k, mode, NULL);
+    }
+    for (size_t i = 0; i < n; i++) {
+        items[i] = sorted[i].item;
+    }
+    free(pairs);
+    return true;
+}
+
+static bool sort_strings(xc_runtime_t *rt, xc_object_t **items, size_t n, size_t k, int mode) {
+    sort_string_t *pairs = malloc(n * sizeof(sort_string_t) * (mode == SORT_MODE_STABLE || mode == SORT_MODE_PARALLEL ? 2 : 1));
+    if (!pairs) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        pairs[i].data = xc_string_data(rt, items[i]);
+        if (!pairs[i].data) {
+            free(pairs);
+            return false;
+        }
+        pairs[i].length = xc_string_length(rt, items[i]);
+        pairs[i].item = items[i];
+    }
+    sort_string_t *sorted = pairs;
+    if (mode == SORT_MODE_PARALLEL) {
+        sorted = xc_parallel_sort_runs(pairs, pairs + n, n, sizeof(sort_string_t),
+                                       sort_string_chunk, sort_string_merge_runs, pairs);
+    } else {
+        SORT_APPLY(sort_string, pairs, pairs + n, n, k, mode, NULL);
+    }
+    for (size_t i = 0; i < n; i++) {
+        items[i] = sorted[i].item;
+    }
+    free(pairs);
+    return true;
+}
+
+/* Bounded max-heap of the k best so far; every index stays in range whatever the comparator says */
+static void sort_custom_top_k(xc_object_t **items, size_t n, size_t k, sort_context_t *ctx) {
+    for (size_t i = k / 2; i-- > 0;) {
+        sort_custom_sift_down(items, i, k, ctx);
+    }
+    for (size_t i = k; i < n; i++) {
+        if (sort_custom_less(ctx, items[i], items[0])) {
+            sort_custom_swap(&items[i], &items[0]);
+            sort_custom_sift_down(items, 0, k, ctx);
+        }
+    }
+}
+
+/* Sorts items[0..n) per mode; for SORT_MODE_TOP_K only items[0..k) is meaningful afterwards */
+static bool array_sort_items(xc_runtime_t *rt, xc_object_t **items, size_t n, size_t k,
+                             xc_object_t *comparator, int mode) {
+    if (comparator) {
+        xc_object_t **tmp = malloc((mode == SORT_MODE_TOP_K ? k : n) * sizeof(xc_object_t *));
+        if (!tmp) {
+            return false;
+        }
+        sort_context_t ctx = { rt, comparator };
+        if (mode == SORT_MODE_TOP_K) {
+            sort_custom_top_k(items, n, k, &ctx);
+            n = k;
+        }
+        sort_custom_stable(items, tmp, n, &ctx);
+        free(tmp);
+        return true;
+    }
+
+    /* One pass decides which comparison the whole sort uses */
+    bool numbers = true, strings = true;
+    for (size_t i = 0; i < n && (numbers || strings); i++) {
+        int type = items[i] ? items[i]->type_id : XC_TYPE_UNDEFINED;
+        numbers = numbers && type == XC_TYPE_NUMBER;
+        strings = strings && type == XC_TYPE_STRING;
+    }
+    if (numbers) {
+        return sort_numbers(rt, items, n, k, mode);
+    }
+    if (strings) {
+        return sort_strings(rt, items, n, k, mode);
+    }
+
+    /* Mixed types compare through xc calls, so they stay on this thread */
+    if (mode == SORT_MODE_PARALLEL) {
+        mode = SORT_MODE_UNSTABLE;
+    }
+    sort_context_t ctx = { rt, NULL };
+    xc_object_t **tmp = NULL;
+    if (mode == SORT_MODE_STABLE && !(tmp = malloc(n * sizeof(xc_object_t *)))) {
+        return false;
+    }
+    SORT_APPLY(sort_value, items, tmp, n, k, mode, &ctx);
+    free(tmp);
+    return true;
+}
+
+static void array_sort_in_place(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *comparator, int mode) {
+    assert(xc_is_array(rt, arr));
+    xc_array_t *array = (xc_array_t *)arr;
+    size_t n = array->length;
+    if (n < 2) {
+        return;
+    }
+    xc_object_t **items = malloc(n * sizeof(xc_object_t *));
+    if (!items) {
+        return;
+    }
+    /* The GC does not scan items; a collection inside the comparator keeps the elements because arr still holds them */
+    array_copy_out(array, items);
+    if (array_sort_items(rt, items, n, 0, comparator, mode) && array->length == n && array_unshare(array, 0)) {
+        memcpy(array->items, items, n * sizeof(xc_object_t *));
+    }
+    free(items);
+}
+
+/* In-place pdqsort; comparator is an optional function returning <0, 0 or >0 */
+void xc_array_sort(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *comparator) {
+    array_sort_in_place(rt, arr, comparator, SORT_MODE_UNSTABLE);
+}
+
+/* In-place merge sort that keeps equal elements in their original order */
+void xc_array_sort_stable(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *comparator) {
+    array_sort_in_place(rt, arr, comparator, SORT_MODE_STABLE);
+}
+
+/*
+ * xc_array_sort without a comparator, spread over the xc_parallel pool for
+ * arrays of only numbers or only strings; other arrays sort sequentially
+ */
+void xc_array_sort_parallel(xc_runtime_t *rt, xc_object_t *arr) {
+    array_sort_in_place(rt, arr, NULL, SORT_MODE_PARALLEL);
+}
+
+/* New array of the k smallest elements in sorted order; arr is left unchanged */
+xc_object_t *xc_array_top_k(xc_runtime_t *rt, xc_object_t *arr, size_t k, xc_object_t *comparator) {
+    assert(xc_is_array(rt, arr));
+    xc_array_t *array = (xc_array_t *)arr;
+    size_t n = array->length;
+    if (k > n) {
+        k = n;
+    }
+    if (k == 0) {
+        return xc_array_create(rt);
+    }
+    xc_object_t **items = malloc(n * sizeof(xc_object_t *));
+    if (!items) {
+        return xc_array_create(rt);
+    }
+    array_copy_out(array, items);
+    /*
+     * The comparator can allocate and collect. items is not scanned by the
+     * GC; the elements stay alive only because arr still holds them. The
+     * result is created after the sort so it never sits unrooted across a
+     * comparator call.
+     */
+    bool sorted = array_sort_items(rt, items, n, k, comparator, SORT_MODE_TOP_K);
+    xc_object_t *result = xc_array_create_with_capacity(rt, sorted ? k : 0);
+    if (result && sorted) {
+        memcpy(((xc_array_t *)result)->items, items, k * sizeof(xc_object_t *));
+        ((xc_array_t *)result)->length = k;
+    }
+    free(items);
+    return result;
+}
+
 /* Convert an object to a string representation */
 static xc_object_t *xc_to_string_internal(xc_runtime_t *rt, xc_object_t *obj) {
     if (obj == NULL) {
@@ -634,9 +1212,9 @@ static xc_object_t *xc_to_string_internal(xc_runtime_t *rt, xc_object_t *obj) {
     }
     
     if (xc_is_number(rt, obj)) {
-        char buffer[32];
-        snprintf(buffer, sizeof(buffer), "%.14g", xc_number_value(rt, obj));
-        return xc_string_create(rt, buffer);
+        char buffer[XC_NUMBER_FORMAT_SIZE];
+        size_t len = xc_number_format(xc_number_value(rt, obj), buffer);
+        return xc_string_create_len(rt, buffer, len);
     }
     
     if (xc_is_boolean(rt, obj)) {
@@ -663,6 +1241,35 @@ static xc_object_t *xc_to_string_internal(xc_runtime_t *rt, xc_object_t *obj) {
     return xc_string_create(rt, "[object Object]");
 }
 
+/* Text of one join element; primitives are formatted into tmp without allocating.
+ * NULL (MemoryError pending) if a string element cannot be flattened. */
+static const char *join_element_text(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *item, char *tmp, size_t tmp_size, size_t *len) {
+    const char *text;
+    if (item == NULL || xc_is_null(rt, item)) {
+        text = "null";
+    } else if (xc_is_string(rt, item)) {
+        *len = xc_string_length(rt, item);
+        return xc_string_data(rt, item);
+    } else if (xc_is_number(rt, item)) {
+        *len = xc_number_format(xc_number_value(rt, item), tmp);
+        return tmp;
+    } else if (xc_is_boolean(rt, item)) {
+        text = xc_boolean_value(rt, item) ? "true" : "false";
+    } else if (item == arr) {
+        // 避免无限递归
+        text = "[Circular]";
+    } else {
+        xc_object_t *str = xc_to_string_internal(rt, item);
+        if (!str) {
+            return NULL;
+        }
+        *len = xc_string_length(rt, str);
+        return xc_string_data(rt, str);
+    }
+    *len = strlen(text);
+    return text;
+}
+
 /* Join array elements into a string */
 xc_object_t *xc_array_join_elements(xc_runtime_t *rt, xc_object_t *arr, xc_object_t *separator) {
     if (!xc_is_array(rt, arr)) {
@@ -675,75 +1282,46 @@ xc_object_t *xc_array_join_elements(xc_runtime_t *rt, xc_object_t *arr, xc_objec
     if (length == 0) {
         return xc_string_create(rt, "");
     }
+    array_flatten(array);
     
     const char *sep_str = ",";
+    size_t sep_len = 1;
     if (separator != NULL && xc_is_string(rt, separator)) {
-        sep_str = xc_string_value(rt, separator);
-    }
-    
-    // 首先将所有元素转换为字符串并存储，避免重复转换
-    xc_object_t **str_items = (xc_object_t **)malloc(length * sizeof(xc_object_t *));
-    if (str_items == NULL) {
-        return xc_string_create(rt, "");
+        sep_str = xc_string_data(rt, separator);
+        sep_len = xc_string_length(rt, separator);
+        if (!sep_str) {
+            return NULL;
+        }
     }
     
-    // 计算结果字符串的总长度
-    size_t total_length = 0;
-    size_t sep_len = strlen(sep_str);
+    char tmp[XC_NUMBER_FORMAT_SIZE];
+    size_t len;
     
+    // 第一遍：计算结果字符串的总长度（嵌套数组会被转换两次）
+    size_t total_length = sep_len * (length - 1);
     for (size_t i = 0; i < length; i++) {
-        // 避免无限递归：如果元素是数组，则用特殊表示
-        if (xc_is_array(rt, array->items[i]) && array->items[i] == arr) {
-            str_items[i] = xc_string_create(rt, "[Circular]");
-        } else {
-            str_items[i] = xc_to_string_internal(rt, array->items[i]);
-        }
-        
-        total_length += strlen(xc_string_value(rt, str_items[i]));
-        
-        if (i < length - 1) {
-            total_length += sep_len;
+        if (!join_element_text(rt, arr, array->items[i], tmp, sizeof(tmp), &len)) {
+            return NULL;
         }
+        total_length += len;
     }
     
-    // 分配结果字符串的内存
-    char *result = (char *)malloc(total_length + 1);
-    if (result == NULL) {
-        // // 释放临时字符串
-        // for (size_t i = 0; i < length; i++) {
-        //     xc_gc_release(rt, str_items[i]);
-        // }
-        free(str_items);
-        return xc_string_create(rt, "");
-    }
-    
-    // 构建结果字符串
-    char *p = result;
+    // 第二遍：直接写入最终字符串的缓冲区
+    xc_string_builder_t sb;
+    xc_string_builder_init(&sb, total_length);
     for (size_t i = 0; i < length; i++) {
-        const char *str_value = xc_string_value(rt, str_items[i]);
-        size_t str_len = strlen(str_value);
-        
-        memcpy(p, str_value, str_len);
-        p += str_len;
-        
-        // // 释放临时字符串
-        // xc_gc_release(rt, str_items[i]);
-        
+        const char *text = join_element_text(rt, arr, array->items[i], tmp, sizeof(tmp), &len);
+        if (!text) {
+            xc_string_builder_free(&sb);
+            return NULL;
+        }
+        xc_string_builder_append_len(&sb, text, len);
         if (i < length - 1) {
-            memcpy(p, sep_str, sep_len);
-            p += sep_len;
+            xc_string_builder_append_len(&sb, sep_str, sep_len);
         }
     }
     
-    *p = '\0';
-    
-    // 释放临时数组
-    free(str_items);
-    
-    xc_object_t *result_obj = xc_string_create(rt, result);
-    free(result);
-    
-    return result_obj;
+    return xc_string_builder_finish(rt, &sb);
 }
 
 /* Public join function that uses the internal join_elements function */
@@ -1,4 +1,5 @@
 #include "../xc.h"
+#include "../xc_internal.h"
 
 // /* Forward declarations */
 // // static void boolean_mark(xc_runtime_t *rt, xc_object_t *obj);
@@ -27,11 +28,12 @@ static void boolean_mark(xc_object_t *obj, mark_func mark) {
     /* Booleans don't have references to other objects */
 }
 
-static void boolean_free(xc_runtime_t *rt, xc_object_t *obj) {
+static int boolean_free(xc_val obj) {
     /* No extra resources to free */
+    return 0;
 }
 
-static bool boolean_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static bool boolean_equal(xc_val a, xc_val b) {
     if (!rt->is(b, XC_TYPE_BOOL)) {
         return false;
     }
@@ -42,7 +44,7 @@ static bool boolean_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
     return bool_a->value == bool_b->value;
 }
 
-static int boolean_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static int boolean_compare(xc_val a, xc_val b) {
     if (!rt->is(b, XC_TYPE_BOOL)) {
         return 1; /* Booleans are greater than non-booleans */
     }
@@ -60,7 +62,7 @@ static xc_val boolean_creator(int type, va_list args) {
     bool value = va_arg(args, int); /* bool在可变参数中被提升为int */
     
     /* 调用实际的创建函数 */
-    return rt->new(XC_TYPE_BOOL, value);
+    return xc_boolean_create(rt, value);
 }
 
 /* 获取布尔值 */
@@ -112,7 +114,8 @@ xc_object_t *xc_boolean_create(xc_runtime_t *rt, bool value) {
     ((xc_object_t *)obj)->type_id = XC_TYPE_BOOL;
     obj->value = value;
     
-    /* 保存单例 */
+    /* 保存单例：单例只存在静态变量里，不能被回收 */
+    xc_gc_mark_permanent(rt, (xc_object_t *)obj);
     if (value) {
         true_singleton = (xc_object_t *)obj;
     } else {
@@ -168,12 +171,12 @@ static xc_type_lifecycle_t boolean_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = boolean_creator,
-    .destroyer = (xc_destroy_func)boolean_free,
+    .destroyer = boolean_free,
     .marker = boolean_mark,
     // .allocator = NULL,
     .name = "boolean",
-    .equal = (bool (*)(xc_val, xc_val))boolean_equal,
-    .compare = (int (*)(xc_val, xc_val))boolean_compare,
+    .equal = boolean_equal,
+    .compare = boolean_compare,
     .flags = XC_TYPE_PRIMITIVE
 };
 
@@ -185,11 +188,11 @@ void xc_register_boolean_type(xc_runtime_t *caller_rt) {
     boolean_type.initializer = NULL;
     boolean_type.cleaner = NULL;
     boolean_type.creator = boolean_creator;
-    boolean_type.destroyer = (xc_destroy_func)boolean_free;
+    boolean_type.destroyer = boolean_free;
     boolean_type.marker = (xc_marker_func)boolean_mark;
     boolean_type.name = "boolean";
-    boolean_type.equal = (void*)boolean_equal;
-    boolean_type.compare = (void*)boolean_compare;
+    boolean_type.equal = boolean_equal;
+    boolean_type.compare = boolean_compare;
     
     // 新增：值访问和类型转换
     boolean_type.get_value = boolean_get_value;
@@ -0,0 +1,913 @@
+/*
+ * xc_buffer.c - 类型化数组（float64/float32/int64/int32/uint8）
+ *
+ * Elements are stored unboxed in one malloc'd block, so a million doubles
+ * cost 8 MB instead of a million heap objects, and marking a typed array
+ * is O(1): it holds no references. Reads box on demand through
+ * xc_number_box, which reuses cached boxes for small integers.
+ *
+ * Stores into integer kinds truncate toward zero and wrap to the element
+ * width like JavaScript typed arrays; NaN stores 0 and int64 saturates.
+ */
+#include "../xc.h"
+#include "../xc_internal.h"
+
+static xc_runtime_t* rt = NULL;
+
+/* Forward declarations */
+static xc_val buffer_creator(int type, va_list args);
+static void buffer_mark(xc_object_t *obj, mark_func mark);
+static int buffer_free(xc_val obj);
+static bool buffer_equal(xc_val a, xc_val b);
+static int buffer_compare(xc_val a, xc_val b);
+static xc_val buffer_convert_to(xc_val obj, int target_type);
+
+static const size_t buffer_element_sizes[] = {
+    [XC_BUFFER_FLOAT64] = sizeof(double),
+    [XC_BUFFER_FLOAT32] = sizeof(float),
+    [XC_BUFFER_INT64] = sizeof(int64_t),
+    [XC_BUFFER_INT32] = sizeof(int32_t),
+    [XC_BUFFER_UINT8] = sizeof(uint8_t),
+};
+
+static inline bool buffer_kind_valid(int kind) {
+    return kind >= XC_BUFFER_FLOAT64 && kind <= XC_BUFFER_UINT8;
+}
+
+size_t xc_buffer_element_size(int kind) {
+    return buffer_kind_valid(kind) ? buffer_element_sizes[kind] : 0;
+}
+
+/* Integer conversion shared by the integer kinds */
+static inline int64_t buffer_to_int64(double value) {
+    if (value != value) {
+        return 0;
+    }
+    if (value >= 9223372036854775807.0) {
+        return INT64_MAX;
+    }
+    if (value <= -9223372036854775808.0) {
+        return INT64_MIN;
+    }
+    return (int64_t)value;
+}
+
+static inline double buffer_load(const xc_buffer_t *buf, size_t index) {
+    switch (buf->kind) {
+        case XC_BUFFER_FLOAT64: return ((const double *)buf->data)[index];
+        case XC_BUFFER_FLOAT32: return ((const float *)buf->data)[index];
+        case XC_BUFFER_INT64:   return (double)((const int64_t *)buf->data)[index];
+        case XC_BUFFER_INT32:   return ((const int32_t *)buf->data)[index];
+        case XC_BUFFER_UINT8:   return ((const uint8_t *)buf->data)[index];
+    }
+    return 0.0;
+}
+
+static inline void buffer_store(xc_buffer_t *buf, size_t index, double value) {
+    switch (buf->kind) {
+        case XC_BUFFER_FLOAT64: ((double *)buf->data)[index] = value; break;
+        case XC_BUFFER_FLOAT32: ((float *)buf->data)[index] = (float)value; break;
+        case XC_BUFFER_INT64:   ((int64_t *)buf->data)[index] = buffer_to_int64(value); break;
+        case XC_BUFFER_INT32:   ((int32_t *)buf->data)[index] = (int32_t)(uint32_t)(uint64_t)buffer_to_int64(value); break;
+        case XC_BUFFER_UINT8:   ((uint8_t *)buf->data)[index] = (uint8_t)(uint64_t)buffer_to_int64(value); break;
+    }
+}
+
+/* Ensure the buffer can hold needed elements; new elements are zeroed */
+static bool buffer_ensure_capacity(xc_buffer_t *buf, size_t needed) {
+    if (needed <= buf->capacity) {
+        return true;
+    }
+
+    size_t new_capacity = buf->capacity == 0 ? 8 : buf->capacity * 2;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    size_t element_size = buffer_element_sizes[buf->kind];
+    void *data = realloc(buf->data, new_capacity * element_size);
+    if (!data) {
+        return false;
+    }
+    memset((char *)data + buf->capacity * element_size, 0, (new_capacity - buf->capacity) * element_size);
+    buf->data = data;
+    buf->capacity = new_capacity;
+    return true;
+}
+
+/* Lifecycle */
+static void buffer_mark(xc_object_t *obj, mark_func mark) {
+    /* Elements are unboxed: nothing to mark */
+}
+
+static int buffer_free(xc_val obj) {
+    xc_buffer_t *buf = (xc_buffer_t *)obj;
+    free(buf->data);
+    buf->data = NULL;
+    buf->length = 0;
+    buf->capacity = 0;
+    return 0;
+}
+
+static bool buffer_equal(xc_val a, xc_val b) {
+    if (!xc_is_buffer(rt, b)) {
+        return false;
+    }
+    xc_buffer_t *buf_a = (xc_buffer_t *)a;
+    xc_buffer_t *buf_b = (xc_buffer_t *)b;
+    if (buf_a->length != buf_b->length) {
+        return false;
+    }
+    /* Integer elements of the same kind compare bytewise */
+    if (buf_a->kind == buf_b->kind && buf_a->kind >= XC_BUFFER_INT64) {
+        return memcmp(buf_a->data, buf_b->data, buf_a->length * buffer_element_sizes[buf_a->kind]) == 0;
+    }
+    for (size_t i = 0; i < buf_a->length; i++) {
+        if (buffer_load(buf_a, i) != buffer_load(buf_b, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int buffer_compare(xc_val a, xc_val b) {
+    if (!xc_is_buffer(rt, b)) {
+        return 1; /* Typed arrays are greater than other values */
+    }
+    xc_buffer_t *buf_a = (xc_buffer_t *)a;
+    xc_buffer_t *buf_b = (xc_buffer_t *)b;
+    size_t min_len = buf_a->length < buf_b->length ? buf_a->length : buf_b->length;
+    for (size_t i = 0; i < min_len; i++) {
+        double x = buffer_load(buf_a, i);
+        double y = buffer_load(buf_b, i);
+        if (x < y) return -1;
+        if (x > y) return 1;
+    }
+    if (buf_a->length < buf_b->length) return -1;
+    if (buf_a->length > buf_b->length) return 1;
+    return 0;
+}
+
+/* 转换到其他类型 */
+static xc_val buffer_convert_to(xc_val obj, int target_type) {
+    xc_buffer_t *buf = (xc_buffer_t *)obj;
+
+    switch (target_type) {
+        case XC_TYPE_BOOL:
+            return rt->new(XC_TYPE_BOOL, 1);
+
+        case XC_TYPE_ARRAY:
+            return xc_buffer_to_array(rt, obj);
+
+        case XC_TYPE_STRING: {
+            /* Elements joined with "," like arrays */
+            xc_string_builder_t sb;
+            xc_string_builder_init(&sb, buf->length * 4);
+            char tmp[XC_NUMBER_FORMAT_SIZE];
+            for (size_t i = 0; i < buf->length; i++) {
+                if (i > 0) {
+                    xc_string_builder_append_char(&sb, ',');
+                }
+                size_t len = xc_number_format(buffer_load(buf, i), tmp);
+                xc_string_builder_append_len(&sb, tmp, len);
+            }
+            return xc_string_builder_finish(rt, &sb);
+        }
+
+        case XC_TYPE_BUFFER:
+            return obj;
+
+        default:
+            return NULL; // 不支持的转换
+    }
+}
+
+/* Type descriptor for typed arrays */
+static xc_type_lifecycle_t buffer_type = {
+    .initializer = NULL,
+    .cleaner = NULL,
+    .creator = buffer_creator,
+    .destroyer = buffer_free,
+    .marker = buffer_mark,
+    .name = "buffer",
+    .equal = buffer_equal,
+    .compare = buffer_compare,
+    .flags = XC_TYPE_COMPOSITE,
+    .convert_to = buffer_convert_to
+};
+
+/* rt->new(XC_TYPE_BUFFER, kind, length): int arguments, zero-filled */
+static xc_val buffer_creator(int type, va_list args) {
+    int kind = va_arg(args, int);
+    int length = va_arg(args, int);
+    return (xc_val)xc_buffer_create(rt, kind, length > 0 ? (size_t)length : 0);
+}
+
+/* float64 view of the elements: the data itself, or a converted copy in *copy */
+static const double *buffer_f64_view(const xc_buffer_t *buf, double **copy) {
+    *copy = NULL;
+    if (buf->kind == XC_BUFFER_FLOAT64) {
+        return (const double *)buf->data;
+    }
+    *copy = (double *)malloc((buf->length ? buf->length : 1) * sizeof(double));
+    if (*copy) {
+        for (size_t i = 0; i < buf->length; i++) {
+            (*copy)[i] = buffer_load(buf, i);
+        }
+    }
+    return *copy;
+}
+
+/* Output storage for an elementwise kernel writing length float64 values */
+static double *buffer_f64_output(xc_buffer_t *out) {
+    if (out->kind == XC_BUFFER_FLOAT64) {
+        return (double *)out->data;
+    }
+    return (double *)malloc((out->length ? out->length : 1) * sizeof(double));
+}
+
+/* Store kernel output into out (converting to its kind) and release scratch */
+static xc_object_t *buffer_f64_finish(xc_buffer_t *out, double *values) {
+    if (out->kind != XC_BUFFER_FLOAT64) {
+        for (size_t i = 0; i < out->length; i++) {
+            buffer_store(out, i, values[i]);
+        }
+        free(values);
+    }
+    return (xc_object_t *)out;
+}
+
+/* Reduction over one typed array; empty/invalid input gives empty_value */
+#define BUFFER_REDUCE(obj, empty_value, expr)                          \
+    do {                                                               \
+        if (!xc_is_buffer(rt, (obj))) {                                \
+            return (empty_value);                                      \
+        }                                                              \
+        xc_buffer_t *buf_ = (xc_buffer_t *)(obj);                      \
+        double *copy_;                                                 \
+        const double *a = buffer_f64_view(buf_, &copy_);               \
+        size_t n = buf_->length;                                       \
+        if (!a) {                                                      \
+            return (empty_value);                                      \
+        }                                                              \
+        __typeof__(expr) result_ = (expr);                             \
+        free(copy_);                                                   \
+        return result_;                                                \
+    } while (0)
+
+double xc_buffer_sum(xc_runtime_t *rt, xc_object_t *obj) {
+    BUFFER_REDUCE(obj, 0.0, xc_simd_sum_f64(a, n));
+}
+
+/* NaN for an empty array */
+double xc_buffer_mean(xc_runtime_t *rt, xc_object_t *obj) {
+    BUFFER_REDUCE(obj, __builtin_nan(""), xc_simd_sum_f64(a, n) / (double)n);
+}
+
+double xc_buffer_min(xc_runtime_t *rt, xc_object_t *obj) {
+    BUFFER_REDUCE(obj, __builtin_inf(), xc_simd_min_f64(a, n));
+}
+
+double xc_buffer_max(xc_runtime_t *rt, xc_object_t *obj) {
+    BUFFER_REDUCE(obj, -__builtin_inf(), xc_simd_max_f64(a, n));
+}
+
+int64_t xc_buffer_argmin(xc_runtime_t *rt, xc_object_t *obj) {
+    BUFFER_REDUCE(obj, (int64_t)-1, xc_simd_argmin_f64(a, n));
+}
+
+int64_t xc_buffer_argmax(xc_runtime_t *rt, xc_object_t *obj) {
+    BUFFER_REDUCE(obj, (int64_t)-1, xc_simd_argmax_f64(a, n));
+}
+
+/* Dot product over the common length */
+double xc_buffer_dot(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+    if (!xc_is_buffer(rt, a) || !xc_is_buffer(rt, b)) {
+        return 0.0;
+    }
+    double *copy_a, *copy_b;
+    const double *x = buffer_f64_view((xc_buffer_t *)a, &copy_a);
+    const double *y = buffer_f64_view((xc_buffer_t *)b, &copy_b);
+    size_t n = ((xc_buffer_t *)a)->length < ((xc_buffer_t *)b)->length ?
+               ((xc_buffer_t *)a)->length : ((xc_buffer_t *)b)->length;
+    double result = x && y ? xc_simd_dot_f64(x, y, n) : 0.0;
+    free(copy_a);
+    free(copy_b);
+    return result;
+}
+
+/* Elementwise a+b or a*b into a new typed array of a's kind; lengths must match */
+static xc_object_t *buffer_binary(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b, bool multiply) {
+    if (!xc_is_buffer(rt, a) || !xc_is_buffer(rt, b) ||
+        ((xc_buffer_t *)a)->length != ((xc_buffer_t *)b)->length) {
+        return NULL;
+    }
+    xc_buffer_t *out = (xc_buffer_t *)xc_buffer_create(rt, ((xc_buffer_t *)a)->kind, ((xc_buffer_t *)a)->length);
+    if (!out) {
+        return NULL;
+    }
+    double *copy_a, *copy_b;
+    const double *x = buffer_f64_view((xc_buffer_t *)a, &copy_a);
+    const double *y = buffer_f64_view((xc_buffer_t *)b, &copy_b);
+    double *values = buffer_f64_output(out);
+    if (x && y && values) {
+        if (multiply) {
+            xc_simd_mul_f64(values, x, y, out->length);
+        } else {
+            xc_simd_add_f64(values, x, y, out->length);
+        }
+        buffer_f64_finish(out, values);
+    } else if (values != out->data) {
+        free(values);
+    }
+    free(copy_a);
+    free(copy_b);
+    return (xc_object_t *)out;
+}
+
+xc_object_t *xc_buffer_add(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+    return buffer_binary(rt, a, b, false);
+}
+
+xc_object_t *xc_buffer_mul(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+    return buffer_binary(rt, a, b, true);
+}
+
+/* Elementwise kernels with scalar parameters */
+#define BUFFER_UNARY_OP_SCALE 0
+#define BUFFER_UNARY_OP_CLAMP 1
+#define BUFFER_UNARY_OP_PREFIX_SUM 2
+
+static xc_object_t *buffer_unary(xc_runtime_t *rt, xc_object_t *obj, int kind, int op, double p, double q) {
+    if (!xc_is_buffer(rt, obj)) {
+        return NULL;
+    }
+    xc_buffer_t *out = (xc_buffer_t *)xc_buffer_create(rt, kind, ((xc_buffer_t *)obj)->length);
+    if (!out) {
+        return NULL;
+    }
+    double *copy;
+    const double *a = buffer_f64_view((xc_buffer_t *)obj, &copy);
+    double *values = buffer_f64_output(out);
+    if (a && values) {
+        switch (op) {
+            case BUFFER_UNARY_OP_SCALE: xc_simd_scale_f64(values, a, p, out->length); break;
+            case BUFFER_UNARY_OP_CLAMP: xc_simd_clamp_f64(values, a, p, q, out->length); break;
+            default:                    xc_simd_prefix_sum_f64(values, a, out->length); break;
+        }
+        buffer_f64_finish(out, values);
+    } else if (values != out->data) {
+        free(values);
+    }
+    free(copy);
+    return (xc_object_t *)out;
+}
+
+xc_object_t *xc_buffer_scale(xc_runtime_t *rt, xc_object_t *obj, double factor) {
+    return buffer_unary(rt, obj, xc_buffer_kind(rt, obj), BUFFER_UNARY_OP_SCALE, factor, 0);
+}
+
+xc_object_t *xc_buffer_clamp(xc_runtime_t *rt, xc_object_t *obj, double lo, double hi) {
+    return buffer_unary(rt, obj, xc_buffer_kind(rt, obj), BUFFER_UNARY_OP_CLAMP, lo, hi);
+}
+
+/* Running totals, always float64 so small integer kinds do not wrap */
+xc_object_t *xc_buffer_prefix_sum(xc_runtime_t *rt, xc_object_t *obj) {
+    return buffer_unary(rt, obj, XC_BUFFER_FLOAT64, BUFFER_UNARY_OP_PREFIX_SUM, 0, 0);
+}
+
+/* uint8 mask of a[i] <op> value (XC_SIMD_LT..XC_SIMD_NE) */
+xc_object_t *xc_buffer_compare(xc_runtime_t *rt, xc_object_t *obj, int op, double value) {
+    if (!xc_is_buffer(rt, obj) || op < XC_SIMD_LT || op > XC_SIMD_NE) {
+        return NULL;
+    }
+    xc_buffer_t *out = (xc_buffer_t *)xc_buffer_create(rt, XC_BUFFER_UINT8, ((xc_buffer_t *)obj)->length);
+    if (!out) {
+        return NULL;
+    }
+    double *copy;
+    const double *a = buffer_f64_view((xc_buffer_t *)obj, &copy);
+    if (a) {
+        xc_simd_compare_f64((uint8_t *)out->data, a, out->length, value, op);
+    }
+    free(copy);
+    return (xc_object_t *)out;
+}
+
+/*
+ * Radix sort. Each kind maps to unsigned keys whose integer order is the
+ * numeric order (sign bit flipped for integers, all bits flipped for
+ * negative floats), then an LSD radix sort runs one byte per pass. All
+ * byte histograms come from a single read, and a byte shared by every key
+ * skips its pass, so small integers stored as int64 cost one or two passes.
+ * NaN sorts after +Infinity; -0 sorts before 0 as in JavaScript typed arrays.
+ */
+#define BUFFER_RADIX_SMALL 48
+
+static inline uint64_t radix_key_f64(double value) {
+    if (value != value) {
+        return UINT64_MAX;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x8000000000000000ULL) ? ~bits : bits | 0x8000000000000000ULL;
+}
+
+static inline double radix_value_f64(uint64_t key) {
+    uint64_t bits = (key & 0x8000000000000000ULL) ? key ^ 0x8000000000000000ULL : ~key;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline uint64_t radix_key_f32(float value) {
+    if (value != value) {
+        return UINT32_MAX;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? (uint32_t)~bits : bits | 0x80000000u;
+}
+
+static inline float radix_value_f32(uint64_t key) {
+    uint32_t bits = (key & 0x80000000u) ? (uint32_t)key ^ 0x80000000u : (uint32_t)~key;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Sorts the low `bytes` bytes of each key; tmp holds n keys */
+static void radix_sort_keys(uint64_t *keys, uint64_t *tmp, size_t n, int bytes) {
+    if (n <= BUFFER_RADIX_SMALL) {
+        for (size_t i = 1; i < n; i++) {
+            uint64_t x = keys[i];
+            size_t j = i;
+            while (j > 0 && keys[j - 1] > x) {
+                keys[j] = keys[j - 1];
+                j--;
+            }
+            keys[j] = x;
+        }
+        return;
+    }
+
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts[0]) * bytes);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t key = keys[i];
+        for (int d = 0; d < bytes; d++) {
+            counts[d][(key >> (8 * d)) & 0xff]++;
+        }
+    }
+
+    uint64_t *src = keys, *dst = tmp;
+    for (int d = 0; d < bytes; d++) {
+        size_t *count = counts[d];
+        if (count[(src[0] >> (8 * d)) & 0xff] == n) {
+            continue;
+        }
+        size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t key = src[i];
+            dst[count[(key >> (8 * d)) & 0xff]++] = key;
+        }
+        uint64_t *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != keys) {
+        memcpy(keys, src, n * sizeof(uint64_t));
+    }
+}
+
+/* Keys for elements [begin, end) of a non-uint8 buffer */
+static void radix_encode(xc_buffer_t *buf, uint64_t *keys, size_t begin, size_t end) {
+    switch (buf->kind) {
+        case XC_BUFFER_FLOAT64: {
+            const double *data = buf->data;
+            for (size_t i = begin; i < end; i++) keys[i] = radix_key_f64(data[i]);
+            break;
+        }
+        case XC_BUFFER_FLOAT32: {
+            const float *data = buf->data;
+            for (size_t i = begin; i < end; i++) keys[i] = radix_key_f32(data[i]);
+            break;
+        }
+        case XC_BUFFER_INT64: {
+            const int64_t *data = buf->data;
+            for (size_t i = begin; i < end; i++) keys[i] = (uint64_t)data[i] ^ 0x8000000000000000ULL;
+            break;
+        }
+        default: {
+            const int32_t *data = buf->data;
+            for (size_t i = begin; i < end; i++) keys[i] = (uint32_t)data[i] ^ 0x80000000u;
+            break;
+        }
+    }
+}
+
+static void radix_decode(xc_buffer_t *buf, const uint64_t *keys, size_t begin, size_t end) {
+    switch (buf->kind) {
+        case XC_BUFFER_FLOAT64: {
+            double *data = buf->data;
+            for (size_t i = begin; i < end; i++) data[i] = radix_value_f64(keys[i]);
+            break;
+        }
+        case XC_BUFFER_FLOAT32: {
+            float *data = buf->data;
+            for (size_t i = begin; i < end; i++) data[i] = radix_value_f32(keys[i]);
+            break;
+        }
+        case XC_BUFFER_INT64: {
+            int64_t *data = buf->data;
+            for (size_t i = begin; i < end; i++) data[i] = (int64_t)(keys[i] ^ 0x8000000000000000ULL);
+            break;
+        }
+        default: {
+            int32_t *data = buf->data;
+            for (size_t i = begin; i < end; i++) data[i] = (int32_t)((uint32_t)keys[i] ^ 0x80000000u);
+            break;
+        }
+    }
+}
+
+static inline int radix_key_bytes(xc_buffer_t *buf) {
+    return buf->kind == XC_BUFFER_FLOAT64 || buf->kind == XC_BUFFER_INT64 ? 8 : 4;
+}
+
+static void radix_count_uint8(xc_buffer_t *buf) {
+    size_t count[256] = {0};
+    uint8_t *data = buf->data;
+    for (size_t i = 0; i < buf->length; i++) {
+        count[data[i]]++;
+    }
+    for (int b = 0; b < 256; b++) {
+        memset(data, b, count[b]);
+        data += count[b];
+    }
+}
+
+/* Sorts a typed array in place, ascending */
+void xc_buffer_sort(xc_runtime_t *rt, xc_object_t *obj) {
+    if (!xc_is_buffer(rt, obj)) {
+        return;
+    }
+    xc_buffer_t *buf = (xc_buffer_t *)obj;
+    size_t n = buf->length;
+    if (n < 2) {
+        return;
+    }
+
+    /* uint8 needs no keys: count and rewrite */
+    if (buf->kind == XC_BUFFER_UINT8) {
+        radix_count_uint8(buf);
+        return;
+    }
+
+    uint64_t *keys = malloc(2 * n * sizeof(uint64_t));
+    if (!keys) {
+        return;
+    }
+    radix_encode(buf, keys, 0, n);
+    radix_sort_keys(keys, keys + n, n, radix_key_bytes(buf));
+    radix_decode(buf, keys, 0, n);
+    free(keys);
+}
+
+/*
+ * Parallel sort: chunks are encoded and radix sorted on the xc_parallel
+ * pool, merged pairwise, and decoded in parallel from whichever half of
+ * the key block holds the result.
+ */
+typedef struct {
+    xc_buffer_t *buf;
+    uint64_t *keys;       /* n keys followed by n scratch keys */
+    const uint64_t *sorted;
+    size_t n;
+} radix_parallel_t;
+
+static void radix_sort_chunk(size_t chunk, size_t begin, size_t end, void *data) {
+    radix_parallel_t *job = data;
+    radix_encode(job->buf, job->keys, begin, end);
+    radix_sort_keys(job->keys + begin, job->keys + job->n + begin, end - begin, radix_key_bytes(job->buf));
+}
+
+static void radix_merge_runs(const void *a, size_t na, const void *b, size_t nb, void *out, void *data) {
+    const uint64_t *x = a, *y = b;
+    uint64_t *dst = out;
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+        *dst++ = y[j] < x[i] ? y[j++] : x[i++];
+    }
+    memcpy(dst, x + i, (na - i) * sizeof(uint64_t));
+    memcpy(dst + (na - i), y + j, (nb - j) * sizeof(uint64_t));
+}
+
+static void radix_decode_chunk(size_t chunk, size_t begin, size_t end, void *data) {
+    radix_parallel_t *job = data;
+    radix_decode(job->buf, job->sorted, begin, end);
+}
+
+void xc_buffer_sort_parallel(xc_runtime_t *rt, xc_object_t *obj) {
+    if (!xc_is_buffer(rt, obj)) {
+        return;
+    }
+    xc_buffer_t *buf = (xc_buffer_t *)obj;
+    size_t n = buf->length;
+    if (n < 2 || buf->kind == XC_BUFFER_UINT8 || xc_parallel_chunk_count(n, 0) == 1) {
+        xc_buffer_sort(rt, obj);
+        return;
+    }
+    uint64_t *keys = malloc(2 * n * sizeof(uint64_t));
+    if (!keys) {
+        return;
+    }
+    radix_parallel_t job = { buf, keys, NULL, n };
+    job.sorted = xc_parallel_sort_runs(keys, keys + n, n, sizeof(uint64_t), radix_sort_chunk, radix_merge_runs, &job);
+    xc_parallel_for(n, 0, radix_decode_chunk, &job);
+    free(keys);
+}
+
+/* 方法包装函数 */
+static xc_val buffer_length_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, (double)xc_buffer_length(rt, self));
+}
+
+static xc_val buffer_get_method(xc_val self, xc_val arg) {
+    if (!arg || !rt->is(arg, XC_TYPE_NUMBER)) {
+        return NULL;
+    }
+    double index = xc_number_value(rt, arg);
+    if (index < 0) {
+        return NULL;
+    }
+    return xc_buffer_get(rt, self, (size_t)index);
+}
+
+/* set: 参数是数组 [index, value] */
+static xc_val buffer_set_method(xc_val self, xc_val arg) {
+    if (!arg || !rt->is(arg, XC_TYPE_ARRAY) || xc_array_length(rt, arg) < 2) {
+        return NULL;
+    }
+    xc_object_t *index = xc_array_get(rt, arg, 0);
+    if (!index || !rt->is(index, XC_TYPE_NUMBER) || xc_number_value(rt, index) < 0) {
+        return NULL;
+    }
+    xc_buffer_set(rt, self, (size_t)xc_number_value(rt, index), xc_array_get(rt, arg, 1));
+    return self;
+}
+
+static xc_val buffer_push_method(xc_val self, xc_val arg) {
+    xc_buffer_push(rt, self, xc_to_number(rt, arg));
+    return self;
+}
+
+static xc_val buffer_to_array_method(xc_val self, xc_val arg) {
+    return xc_buffer_to_array(rt, self);
+}
+
+static xc_val buffer_to_string_method(xc_val self, xc_val arg) {
+    return buffer_convert_to(self, XC_TYPE_STRING);
+}
+
+/* 数值内核方法 */
+static xc_val buffer_sum_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, xc_buffer_sum(rt, self));
+}
+
+static xc_val buffer_mean_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, xc_buffer_mean(rt, self));
+}
+
+static xc_val buffer_min_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, xc_buffer_min(rt, self));
+}
+
+static xc_val buffer_max_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, xc_buffer_max(rt, self));
+}
+
+static xc_val buffer_argmin_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, (double)xc_buffer_argmin(rt, self));
+}
+
+static xc_val buffer_argmax_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, (double)xc_buffer_argmax(rt, self));
+}
+
+static xc_val buffer_dot_method(xc_val self, xc_val arg) {
+    if (!xc_is_buffer(rt, arg)) {
+        return NULL;
+    }
+    return xc_number_box(rt, xc_buffer_dot(rt, self, arg));
+}
+
+static xc_val buffer_add_method(xc_val self, xc_val arg) {
+    return xc_buffer_add(rt, self, arg);
+}
+
+static xc_val buffer_mul_method(xc_val self, xc_val arg) {
+    return xc_buffer_mul(rt, self, arg);
+}
+
+static xc_val buffer_scale_method(xc_val self, xc_val arg) {
+    if (!arg || !rt->is(arg, XC_TYPE_NUMBER)) {
+        return NULL;
+    }
+    return xc_buffer_scale(rt, self, xc_number_value(rt, arg));
+}
+
+/* clamp: 参数是数组 [lo, hi] */
+static xc_val buffer_clamp_method(xc_val self, xc_val arg) {
+    if (!arg || !rt->is(arg, XC_TYPE_ARRAY) || xc_array_length(rt, arg) < 2) {
+        return NULL;
+    }
+    return xc_buffer_clamp(rt, self, xc_to_number(rt, xc_array_get(rt, arg, 0)),
+                           xc_to_number(rt, xc_array_get(rt, arg, 1)));
+}
+
+static xc_val buffer_prefix_sum_method(xc_val self, xc_val arg) {
+    return xc_buffer_prefix_sum(rt, self);
+}
+
+static xc_val buffer_sort_method(xc_val self, xc_val arg) {
+    xc_buffer_sort(rt, self);
+    return self;
+}
+
+#define BUFFER_COMPARE_METHOD(name, op)                                 \
+    static xc_val buffer_##name##_method(xc_val self, xc_val arg) {     \
+        if (!arg || !rt->is(arg, XC_TYPE_NUMBER)) {                     \
+            return NULL;                                                \
+        }                                                               \
+        return xc_buffer_compare(rt, self, op, xc_number_value(rt, arg)); \
+    }
+
+BUFFER_COMPARE_METHOD(lt, XC_SIMD_LT)
+BUFFER_COMPARE_METHOD(le, XC_SIMD_LE)
+BUFFER_COMPARE_METHOD(gt, XC_SIMD_GT)
+BUFFER_COMPARE_METHOD(ge, XC_SIMD_GE)
+BUFFER_COMPARE_METHOD(eq, XC_SIMD_EQ)
+BUFFER_COMPARE_METHOD(ne, XC_SIMD_NE)
+
+/* Register typed array type */
+void xc_register_buffer_type(xc_runtime_t *caller_rt) {
+    rt = caller_rt;
+    rt->register_type("buffer", &buffer_type);
+
+    /* 注册类型化数组方法 */
+    rt->register_method(XC_TYPE_BUFFER, "length", buffer_length_method);
+    rt->register_method(XC_TYPE_BUFFER, "get", buffer_get_method);
+    rt->register_method(XC_TYPE_BUFFER, "set", buffer_set_method);
+    rt->register_method(XC_TYPE_BUFFER, "push", buffer_push_method);
+    rt->register_method(XC_TYPE_BUFFER, "toArray", buffer_to_array_method);
+    rt->register_method(XC_TYPE_BUFFER, "toString", buffer_to_string_method);
+    rt->register_method(XC_TYPE_BUFFER, "sum", buffer_sum_method);
+    rt->register_method(XC_TYPE_BUFFER, "mean", buffer_mean_method);
+    rt->register_method(XC_TYPE_BUFFER, "min", buffer_min_method);
+    rt->register_method(XC_TYPE_BUFFER, "max", buffer_max_method);
+    rt->register_method(XC_TYPE_BUFFER, "argmin", buffer_argmin_method);
+    rt->register_method(XC_TYPE_BUFFER, "argmax", buffer_argmax_method);
+    rt->register_method(XC_TYPE_BUFFER, "dot", buffer_dot_method);
+    rt->register_method(XC_TYPE_BUFFER, "add", buffer_add_method);
+    rt->register_method(XC_TYPE_BUFFER, "mul", buffer_mul_method);
+    rt->register_method(XC_TYPE_BUFFER, "scale", buffer_scale_method);
+    rt->register_method(XC_TYPE_BUFFER, "clamp", buffer_clamp_method);
+    rt->register_method(XC_TYPE_BUFFER, "prefixSum", buffer_prefix_sum_method);
+    rt->register_method(XC_TYPE_BUFFER, "sort", buffer_sort_method);
+    rt->register_method(XC_TYPE_BUFFER, "lt", buffer_lt_method);
+    rt->register_method(XC_TYPE_BUFFER, "le", buffer_le_method);
+    rt->register_method(XC_TYPE_BUFFER, "gt", buffer_gt_method);
+    rt->register_method(XC_TYPE_BUFFER, "ge", buffer_ge_method);
+    rt->register_method(XC_TYPE_BUFFER, "eq", buffer_eq_method);
+    rt->register_method(XC_TYPE_BUFFER, "ne", buffer_ne_method);
+}
+
+/* Create a zero-filled typed array of length elements */
+xc_object_t *xc_buffer_create(xc_runtime_t *rt, int kind, size_t length) {
+    if (!buffer_kind_valid(kind)) {
+        return NULL;
+    }
+
+    xc_buffer_t *buf = (xc_buffer_t *)xc_gc_alloc(rt, sizeof(xc_buffer_t), XC_TYPE_BUFFER);
+    if (!buf) {
+        return NULL;
+    }
+
+    ((xc_object_t *)buf)->type_id = XC_TYPE_BUFFER;
+    buf->kind = kind;
+    buf->length = 0;
+    buf->capacity = 0;
+    buf->data = NULL;
+
+    if (length > 0) {
+        buf->data = calloc(length, buffer_element_sizes[kind]);
+        if (!buf->data) {
+            return NULL;
+        }
+        buf->capacity = length;
+        buf->length = length;
+    }
+    return (xc_object_t *)buf;
+}
+
+/* Copy a generic array into a typed array; non-numbers convert with xc_to_number */
+xc_object_t *xc_buffer_from_array(xc_runtime_t *rt, int kind, xc_object_t *arr) {
+    if (!xc_is_array(rt, arr)) {
+        return NULL;
+    }
+    size_t length = xc_array_length(rt, arr);
+    xc_buffer_t *buf = (xc_buffer_t *)xc_buffer_create(rt, kind, length);
+    if (!buf) {
+        return NULL;
+    }
+    xc_object_t **items = xc_array_items(rt, arr);
+    for (size_t i = 0; i < length; i++) {
+        buffer_store(buf, i, xc_to_number(rt, items[i]));
+    }
+    return (xc_object_t *)buf;
+}
+
+/* Box every element into a new generic array */
+xc_object_t *xc_buffer_to_array(xc_runtime_t *rt, xc_object_t *obj) {
+    if (!xc_is_buffer(rt, obj)) {
+        return NULL;
+    }
+    xc_buffer_t *buf = (xc_buffer_t *)obj;
+    xc_object_t *arr = xc_array_create_with_capacity(rt, buf->length);
+    if (!arr) {
+        return NULL;
+    }
+    /* 装箱会分配、可能触发回收；arr 只在局部变量里，obj 也可能是临时值，装箱期间都登记为根 */
+    xc_gc_add_root(rt, &arr);
+    xc_gc_add_root(rt, &obj);
+    for (size_t i = 0; i < buf->length; i++) {
+        xc_array_push(rt, arr, xc_number_box(rt, buffer_load(buf, i)));
+    }
+    xc_gc_remove_root(rt, &obj);
+    xc_gc_remove_root(rt, &arr);
+    return arr;
+}
+
+/* Type checking */
+bool xc_is_buffer(xc_runtime_t *rt, xc_object_t *obj) {
+    return obj && obj->type_id == XC_TYPE_BUFFER;
+}
+
+/* Value access */
+size_t xc_buffer_length(xc_runtime_t *rt, xc_object_t *obj) {
+    return xc_is_buffer(rt, obj) ? ((xc_buffer_t *)obj)->length : 0;
+}
+
+int xc_buffer_kind(xc_runtime_t *rt, xc_object_t *obj) {
+    return xc_is_buffer(rt, obj) ? ((xc_buffer_t *)obj)->kind : -1;
+}
+
+/* Raw element storage; valid until the buffer grows */
+void *xc_buffer_data(xc_runtime_t *rt, xc_object_t *obj) {
+    return xc_is_buffer(rt, obj) ? ((xc_buffer_t *)obj)->data : NULL;
+}
+
+double xc_buffer_get_number(xc_runtime_t *rt, xc_object_t *obj, size_t index) {
+    xc_buffer_t *buf = (xc_buffer_t *)obj;
+    if (!xc_is_buffer(rt, obj) || index >= buf->length) {
+        return 0.0;
+    }
+    return buffer_load(buf, index);
+}
+
+/* Store a number; writing past the end grows the buffer with zeros */
+void xc_buffer_set_number(xc_runtime_t *rt, xc_object_t *obj, size_t index, double value) {
+    xc_buffer_t *buf = (xc_buffer_t *)obj;
+    if (!xc_is_buffer(rt, obj)) {
+        return;
+    }
+    if (index >= buf->length) {
+        if (!buffer_ensure_capacity(buf, index + 1)) {
+            return;
+        }
+        buf->length = index + 1;
+    }
+    buffer_store(buf, index, value);
+}
+
+/* Boxed element access; NULL when out of range */
+xc_object_t *xc_buffer_get(xc_runtime_t *rt, xc_object_t *obj, size_t index) {
+    if (!xc_is_buffer(rt, obj) || index >= ((xc_buffer_t *)obj)->length) {
+        return NULL;
+    }
+    return xc_number_box(rt, buffer_load((xc_buffer_t *)obj, index));
+}
+
+void xc_buffer_set(xc_runtime_t *rt, xc_object_t *obj, size_t index, xc_object_t *value) {
+    xc_buffer_set_number(rt, obj, index, xc_to_number(rt, value));
+}
+
+void xc_buffer_push(xc_runtime_t *rt, xc_object_t *obj, double value) {
+    xc_buffer_set_number(rt, obj, xc_buffer_length(rt, obj), value);
+}
@@ -4,7 +4,7 @@
 xc_exception_frame_t *xc_exception_frame = NULL;
 
 /* Forward declarations */
-static void xc_error_free(xc_runtime_t *rt, xc_object_t *obj);
+static int xc_error_free(xc_val obj);
 static void xc_error_mark(xc_object_t *obj, mark_func mark);
 static bool error_equal(xc_val a, xc_val b);
 static int error_compare(xc_val a, xc_val b);
@@ -15,121 +15,213 @@ static xc_type_lifecycle_t error_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = error_creator,
-    .destroyer = (xc_destroy_func)xc_error_free,
+    .destroyer = xc_error_free,
     .marker = xc_error_mark,
     //.allocator = NULL,
     .name = "error",
-    .equal = (bool (*)(xc_val, xc_val))error_equal,
-    .compare = (int (*)(xc_val, xc_val))error_compare,
+    .equal = error_equal,
+    .compare = error_compare,
     .flags = 0
 };
 
 static xc_type_lifecycle_t *error_type_ptr = NULL;
 
-/* Create a stack trace entry */
-static xc_stack_trace_entry_t xc_stack_trace_entry_create(const char *function, const char *file, int line) {
-    xc_stack_trace_entry_t entry;
-    entry.function = function ? strdup(function) : strdup("unknown");
-    entry.file = file ? strdup(file) : strdup("unknown");
-    entry.line = line;
-    return entry;
-}
+/* Exception types at or above this id always capture traces */
+#define XC_EXCEPTION_TRACE_TYPES 256
 
-/* Create a stack trace */
-static xc_stack_trace_t *xc_stack_trace_create(xc_runtime_t *rt) {
-    xc_stack_trace_t *stack_trace = (xc_stack_trace_t *)malloc(sizeof(xc_stack_trace_t));
-    if (!stack_trace) return NULL;
-    
-    stack_trace->entries = NULL;
-    stack_trace->count = 0;
-    stack_trace->capacity = 0;
-    
-    return stack_trace;
-}
+/* 按异常类型关闭栈跟踪（控制流用的异常不需要） */
+static bool trace_disabled[XC_EXCEPTION_TRACE_TYPES];
 
-/* Add an entry to a stack trace */
-static void xc_stack_trace_add_entry(xc_stack_trace_t *stack_trace, const char *function, const char *file, int line) {
-    if (!stack_trace) return;
-    
-    /* Check if we need to expand the entries array */
-    if (stack_trace->count >= stack_trace->capacity) {
-        size_t new_capacity = stack_trace->capacity == 0 ? 16 : stack_trace->capacity * 2;
-        xc_stack_trace_entry_t *new_entries = (xc_stack_trace_entry_t *)realloc(stack_trace->entries, new_capacity * sizeof(xc_stack_trace_entry_t));
-        if (!new_entries) return;
-        stack_trace->entries = new_entries;
-        stack_trace->capacity = new_capacity;
+void xc_exception_set_trace_enabled(xc_runtime_t *rt, int type, bool enabled) {
+    if (type >= 0 && type < XC_EXCEPTION_TRACE_TYPES) {
+        trace_disabled[type] = !enabled;
     }
-    
-    /* Add the entry */
-    stack_trace->entries[stack_trace->count++] = xc_stack_trace_entry_create(function, file, line);
 }
 
-/* Free a stack trace */
+bool xc_exception_trace_enabled(xc_runtime_t *rt, int type) {
+    return type < 0 || type >= XC_EXCEPTION_TRACE_TYPES || !trace_disabled[type];
+}
+
+/* Free a stack trace; entry strings point into static frame descriptors */
 static void xc_stack_trace_free(xc_stack_trace_t *stack_trace) {
     if (!stack_trace) return;
-    
-    /* Free all entries */
-    for (size_t i = 0; i < stack_trace->count; i++) {
-        free((void *)stack_trace->entries[i].function);
-        free((void *)stack_trace->entries[i].file);
-    }
-    
-    /* Free the entries array */
     free(stack_trace->entries);
-    
-    /* Free the stack trace structure */
     free(stack_trace);
 }
 
-/* Capture the current stack trace */
-xc_stack_trace_t *xc_stack_trace_capture(xc_runtime_t *rt) {
-    xc_exception_frame_t *frame = xc_exception_frame;
+/* Snapshot the innermost call frames: only descriptor pointers are copied,
+ * nothing is allocated or formatted until the trace is asked for */
+static void xc_stack_trace_snapshot(xc_exception_t *exception, int depth) {
+    int count = depth < XC_EXCEPTION_TRACE_FRAMES ? depth : XC_EXCEPTION_TRACE_FRAMES;
+    for (int i = 0; i < count; i++) {
+        exception->trace_frames[i] = _xc_thread_state.frames[depth - 1 - i];
+    }
+    exception->trace_depth = depth;
+}
+
+/* Build the entries array from the snapshot */
+static xc_stack_trace_t *xc_stack_trace_symbolize(xc_exception_t *exception) {
+    size_t count = exception->trace_depth < XC_EXCEPTION_TRACE_FRAMES ?
+                   (size_t)exception->trace_depth : XC_EXCEPTION_TRACE_FRAMES;
     
     xc_stack_trace_t *trace = (xc_stack_trace_t *)malloc(sizeof(xc_stack_trace_t));
     if (!trace) {
         return NULL;
     }
-    
-    trace->entries = NULL;
-    trace->count = 0;
-    trace->capacity = 0;
-    
-    while (frame) {
-        if (trace->count >= trace->capacity) {
-            size_t new_capacity = trace->capacity == 0 ? 8 : trace->capacity * 2;
-            xc_stack_trace_entry_t *new_entries = (xc_stack_trace_entry_t *)realloc(
-                trace->entries, new_capacity * sizeof(xc_stack_trace_entry_t));
-            if (!new_entries) {
-                return trace;
-            }
-            trace->entries = new_entries;
-            trace->capacity = new_capacity;
-        }
-        
-        trace->entries[trace->count].function = frame->file;
-        trace->entries[trace->count].file = frame->file;
-        trace->entries[trace->count].line = frame->line;
-        trace->count++;
-        
-        frame = frame->prev;
+    trace->entries = count ? (xc_stack_trace_entry_t *)malloc(count * sizeof(xc_stack_trace_entry_t)) : NULL;
+    trace->count = trace->entries ? count : 0;
+    trace->capacity = trace->count;
+    
+    for (size_t i = 0; i < trace->count; i++) {
+        const xc_stack_frame_t *frame = &exception->trace_frames[i];
+        const char *function = frame->name ? frame->name : frame->desc->func_name;
+        trace->entries[i].function = function ? function : "unknown";
+        trace->entries[i].file = frame->desc->file_name ? frame->desc->file_name : "unknown";
+        trace->entries[i].line = frame->desc->line_number;
     }
     
     return trace;
 }
 
+/* Call depth to snapshot for a new exception of this type */
+static int xc_exception_trace_depth(xc_runtime_t *rt, int type) {
+    if (!xc_exception_trace_enabled(rt, type)) {
+        return 0;
+    }
+    return _xc_thread_state.depth < XC_MAX_STACK_FRAMES ? _xc_thread_state.depth : XC_MAX_STACK_FRAMES;
+}
+
+/* Free what an exception owns outside its own allocation */
+static void xc_exception_release_owned(xc_exception_t *exception) {
+    if (exception->message && exception->message != exception->inline_message) {
+        free(exception->message);
+    }
+    exception->message = NULL;
+    if (exception->stack_trace) {
+        xc_stack_trace_free(exception->stack_trace);
+        exception->stack_trace = NULL;
+    }
+}
+
+/* Initialize the exception fields; short messages are copied inline */
+static void xc_exception_init_fields(xc_exception_t *exception, int type, int flags, const char *message,
+                                     xc_object_t *cause, int depth) {
+    exception->type = type;
+    exception->flags = flags;
+    exception->message = NULL;
+    if (message) {
+        size_t length = strlen(message) + 1;
+        if (length <= XC_EXCEPTION_MESSAGE_INLINE) {
+            memcpy(exception->inline_message, message, length);
+            exception->message = exception->inline_message;
+        } else {
+            exception->message = strdup(message);
+        }
+    }
+    exception->stack_trace = NULL;
+    exception->cause = (struct xc_exception *)cause;
+    xc_stack_trace_snapshot(exception, depth);
+}
+
 /* Create a new exception object */
 static xc_exception_t *xc_exception_create_internal(xc_runtime_t *rt, int type, const char *message, xc_object_t *cause) {
+    /* Only the frames that will be snapshotted are allocated */
+    int depth = xc_exception_trace_depth(rt, type);
+    size_t frames = depth < XC_EXCEPTION_TRACE_FRAMES ? (size_t)depth : XC_EXCEPTION_TRACE_FRAMES;
+    
     /* Allocate memory for the exception object */
-    xc_exception_t *exception = (xc_exception_t *)xc_gc_alloc(rt, sizeof(xc_exception_t), XC_TYPE_EXCEPTION);
-    if (!exception) return NULL;
+    xc_exception_t *exception = (xc_exception_t *)xc_gc_alloc(
+        rt, sizeof(xc_exception_t) + frames * sizeof(xc_stack_frame_t), XC_TYPE_EXCEPTION);
+    if (!exception) {
+        /* 内存不足时使用预分配的异常报告 */
+        return (xc_exception_t *)xc_exception_reserved(rt, XC_EXCEPTION_TYPE_MEMORY);
+    }
     
-    /* Initialize the exception fields */
-    exception->type = type;
-    exception->message = message ? strdup(message) : NULL;
-    exception->stack_trace = xc_stack_trace_capture(rt);
-    exception->cause = (struct xc_exception *)cause;
+    xc_exception_init_fields(exception, type, 0, message, cause, depth);
+    return exception;
+}
+
+/* 每线程预分配的异常：内存不足、栈溢出、内部错误 */
+static __thread xc_exception_t reserved_memory_error;
+static __thread xc_exception_t reserved_stack_overflow;
+static __thread xc_exception_t reserved_internal_error;
+
+/* 每线程异常对象池，通过 base.gc_next 链接 */
+static __thread xc_exception_t *exception_pool = NULL;
+static __thread size_t exception_pool_count = 0;
+
+/* Return the thread's preallocated exception for the type, reset for a new throw */
+xc_object_t *xc_exception_reserved(xc_runtime_t *rt, int type) {
+    xc_exception_t *exception;
+    const char *message;
+    switch (type) {
+        case XC_EXCEPTION_TYPE_MEMORY:
+            exception = &reserved_memory_error;
+            message = "Out of memory";
+            break;
+        case XC_EXCEPTION_TYPE_STACK_OVERFLOW:
+            exception = &reserved_stack_overflow;
+            message = "Stack overflow";
+            break;
+        case XC_EXCEPTION_TYPE_INTERNAL:
+            exception = &reserved_internal_error;
+            message = "Internal error";
+            break;
+        default:
+            return NULL;
+    }
     
-    return (xc_exception_t *)exception;
+    xc_exception_release_owned(exception);
+    exception->base.size = sizeof(xc_exception_t);
+    exception->base.type_id = XC_TYPE_EXCEPTION;
+    exception->base.gc_color = 3; /* XC_GC_PERMANENT */
+    exception->base.gc_next = NULL;
+    /* The object has no room for a frame snapshot */
+    xc_exception_init_fields(exception, type, XC_EXCEPTION_RESERVED, message, NULL, 0);
+    return (xc_object_t *)exception;
+}
+
+/* Create an exception from the thread's pool */
+xc_object_t *xc_exception_create_pooled(xc_runtime_t *rt, int type, const char *message) {
+    size_t size = sizeof(xc_exception_t) + XC_EXCEPTION_TRACE_FRAMES * sizeof(xc_stack_frame_t);
+    xc_exception_t *exception = exception_pool;
+    if (exception) {
+        exception_pool = (xc_exception_t *)exception->base.gc_next;
+        exception_pool_count--;
+    } else {
+        exception = (xc_exception_t *)malloc(size);
+        if (!exception) {
+            return xc_exception_reserved(rt, XC_EXCEPTION_TYPE_MEMORY);
+        }
+        exception->base.size = size;
+        exception->base.type_id = XC_TYPE_EXCEPTION;
+        exception->base.gc_color = 3; /* XC_GC_PERMANENT */
+    }
+    exception->base.gc_next = NULL;
+    
+    xc_exception_init_fields(exception, type, XC_EXCEPTION_POOLED, message, NULL, xc_exception_trace_depth(rt, type));
+    return (xc_object_t *)exception;
+}
+
+/* Return a pooled exception to the pool; other exceptions are left alone */
+void xc_exception_release(xc_runtime_t *rt, xc_object_t *exception) {
+    if (!exception || exception->type_id != XC_TYPE_EXCEPTION) {
+        return;
+    }
+    xc_exception_t *exc = (xc_exception_t *)exception;
+    if (!(exc->flags & XC_EXCEPTION_POOLED)) {
+        return;
+    }
+    
+    xc_exception_release_owned(exc);
+    exc->cause = NULL;
+    if (exception_pool_count < XC_EXCEPTION_POOL_SIZE) {
+        exc->base.gc_next = (xc_object_t *)exception_pool;
+        exception_pool = exc;
+        exception_pool_count++;
+    } else {
+        free(exc);
+    }
 }
 
 /* 设置异常的cause（异常链） */
@@ -204,14 +296,13 @@ static xc_val xc_exception_get_stack_trace_method(xc_val self, xc_val arg) {
         return NULL;
     }
     
-    xc_exception_t *exception = (xc_exception_t *)self;
-    
-    if (!exception->stack_trace) {
+    xc_stack_trace_t *stack_trace = xc_exception_get_stack_trace(NULL, self);
+    if (!stack_trace) {
         return NULL;
     }
     
     /* 创建一个字符串表示堆栈跟踪 */
-    char *trace_str = xc_stack_trace_to_string(NULL, exception->stack_trace);
+    char *trace_str = xc_stack_trace_to_string(NULL, stack_trace);
     if (!trace_str) {
         return NULL;
     }
@@ -304,17 +395,13 @@ void xc_exception_throw(xc_runtime_t *rt, xc_object_t *exception) {
                 fprintf(stderr, "%s\n", exc->message ? exc->message : "No message");
                 
                 /* 打印堆栈跟踪 */
-                if (exc->stack_trace) {
-                    xc_stack_trace_print(rt, exc->stack_trace);
-                }
+                xc_stack_trace_print(rt, xc_exception_get_stack_trace(rt, exception));
                 
                 /* 打印异常链 */
                 xc_exception_t *cause = exc->cause;
                 if (cause) {
                     fprintf(stderr, "Caused by: %s\n", cause->message ? cause->message : "No message");
-                    if (cause->stack_trace) {
-                        xc_stack_trace_print(rt, cause->stack_trace);
-                    }
+                    xc_stack_trace_print(rt, xc_exception_get_stack_trace(rt, (xc_object_t *)cause));
                 }
             } else {
                 fprintf(stderr, "Unknown exception\n");
@@ -352,10 +439,13 @@ xc_object_t *xc_exception_get_cause(xc_runtime_t *rt, xc_object_t *exception) {
     return (xc_object_t *)exc->cause;
 }
 
-/* Get exception stack trace */
+/* Get exception stack trace, symbolizing the frame snapshot on first use */
 xc_stack_trace_t *xc_exception_get_stack_trace(xc_runtime_t *rt, xc_object_t *exception) {
     if (!exception || ((xc_object_t *)exception)->type_id != XC_TYPE_EXCEPTION) return NULL;
     xc_exception_t *exc = (xc_exception_t *)exception;
+    if (!exc->stack_trace && exc->trace_depth > 0) {
+        exc->stack_trace = xc_stack_trace_symbolize(exc);
+    }
     return exc->stack_trace;
 }
 
@@ -418,6 +508,35 @@ void xc_exception_rethrow(xc_runtime_t *rt) {
     xc_exception_throw(rt, exception);
 }
 
+/* 错误结果哨兵：永久对象，不进入 GC 链表 */
+xc_object_t xc_error_sentinel = { sizeof(xc_object_t), XC_TYPE_NULL, 3 /* XC_GC_PERMANENT */, NULL };
+
+/* Park an exception for the caller and return the error sentinel */
+xc_val xc_raise(xc_runtime_t *rt, xc_object_t *exception) {
+    _xc_thread_state.pending_exception = exception;
+    return XC_ERROR;
+}
+
+xc_object_t *xc_pending_exception(xc_runtime_t *rt) {
+    return _xc_thread_state.pending_exception;
+}
+
+/* Return and clear the pending exception */
+xc_object_t *xc_take_pending_exception(xc_runtime_t *rt) {
+    xc_object_t *exception = _xc_thread_state.pending_exception;
+    _xc_thread_state.pending_exception = NULL;
+    return exception;
+}
+
+/* Convert a pending error result into a longjmp throw, for callers that
+ * cannot return XC_ERROR themselves */
+void xc_throw_pending(xc_runtime_t *rt) {
+    xc_object_t *exception = xc_take_pending_exception(rt);
+    if (exception) {
+        xc_exception_throw(rt, exception);
+    }
+}
+
 /* Clear the current exception */
 void xc_exception_clear(xc_runtime_t *rt) {
     if (xc_exception_frame) {
@@ -461,24 +580,16 @@ xc_object_t *xc_exception_create_internal_error(xc_runtime_t *rt, const char *me
 }
 
 /* Free an error object */
-static void xc_error_free(xc_runtime_t *rt, xc_object_t *obj) {
-    if (!obj || ((xc_object_t *)obj)->type_id != XC_TYPE_EXCEPTION) return;
+static int xc_error_free(xc_val obj) {
+    if (!obj || ((xc_object_t *)obj)->type_id != XC_TYPE_EXCEPTION) return 0;
     
     xc_exception_t *exception = (xc_exception_t *)obj;
     
-    /* Free the message */
-    if (exception->message) {
-        free(exception->message);
-        exception->message = NULL;
-    }
-    
-    /* Free the stack trace */
-    if (exception->stack_trace) {
-        xc_stack_trace_free(exception->stack_trace);
-        exception->stack_trace = NULL;
-    }
+    /* Free the message and stack trace */
+    xc_exception_release_owned(exception);
     
     /* Note: We don't free the cause, as it's managed by GC */
+    return 0;
 }
 
 /* Mark an error object for GC */
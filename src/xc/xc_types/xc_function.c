@@ -3,9 +3,9 @@
 
 /* Forward declarations */
 // static void function_mark(xc_runtime_t *rt, xc_object_t *obj);
-static void function_free(xc_runtime_t *rt, xc_object_t *obj);
-static bool function_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
-static int function_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+static int function_free(xc_val obj);
+static bool function_equal(xc_val a, xc_val b);
+static int function_compare(xc_val a, xc_val b);
 static xc_val function_creator(int type, va_list args);
 
 /* Function methods */
@@ -17,9 +17,14 @@ static void function_mark(xc_object_t *obj, mark_func mark) {
     if (func->closure) {
         mark(func->closure);
     }
+    for (size_t i = 0; i < func->capture_count; i++) {
+        if (func->captures[i]) {
+            mark(func->captures[i]);
+        }
+    }
 }
 
-static void function_free(xc_runtime_t *rt, xc_object_t *obj) {
+static int function_free(xc_val obj) {
     //auto gc...
     // xc_function_t *func = (xc_function_t *)obj;
     // if (func->this_obj) {
@@ -30,10 +35,11 @@ static void function_free(xc_runtime_t *rt, xc_object_t *obj) {
     //     /* 释放闭包环境 */
     //     xc_gc_free(rt, func->closure);
     // }
+    return 0;
 }
 
-static bool function_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
-    if (!xc_is_function(rt, b)) {
+static bool function_equal(xc_val a, xc_val b) {
+    if (!xc_is_function(NULL, b)) {
         return false;
     }
     
@@ -42,12 +48,15 @@ static bool function_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
     
     /* Functions are equal only if they have the same handler, closure and this_obj */
     return func_a->handler == func_b->handler && 
+           func_a->method == func_b->method &&
            func_a->closure == func_b->closure &&
-           func_a->this_obj == func_b->this_obj;
+           func_a->this_obj == func_b->this_obj &&
+           func_a->capture_count == func_b->capture_count &&
+           memcmp(func_a->captures, func_b->captures, func_a->capture_count * sizeof(xc_object_t *)) == 0;
 }
 
-static int function_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
-    if (!xc_is_function(rt, b)) {
+static int function_compare(xc_val a, xc_val b) {
+    if (!xc_is_function(NULL, b)) {
         return 1; /* Functions are greater than non-functions */
     }
     
@@ -80,12 +89,12 @@ static xc_type_lifecycle_t function_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = function_creator,
-    .destroyer = (xc_destroy_func)function_free,
+    .destroyer = function_free,
     .marker = function_mark,
     // .allocator = NULL,
     .name = "function",
-    .equal = (bool (*)(xc_val, xc_val))function_equal,
-    .compare = (int (*)(xc_val, xc_val))function_compare,
+    .equal = function_equal,
+    .compare = function_compare,
     .flags = 0
 };
 
@@ -113,12 +122,95 @@ xc_object_t *xc_function_create(xc_runtime_t *rt, xc_function_ptr_t fn, xc_objec
     obj->handler = fn;
     obj->closure = closure;
     obj->this_obj = NULL;
+    obj->method = NULL;
+    obj->capture_count = 0;
     
     printf("DEBUG: xc_function_create 成功，返回对象=%p，handler=%p\n", obj, fn);
     
     return (xc_object_t *)obj;
 }
 
+/* Create a function bound to a native method and its receiver */
+xc_object_t *xc_function_bind_method(xc_runtime_t *rt, xc_method_func method, xc_object_t *this_obj) {
+    xc_function_t *obj = (xc_function_t *)xc_gc_alloc(rt, sizeof(xc_function_t), XC_TYPE_FUNC);
+    if (!obj) {
+        return NULL;
+    }
+    
+    ((xc_object_t *)obj)->type_id = XC_TYPE_FUNC;
+    obj->handler = NULL;
+    obj->closure = NULL;
+    obj->this_obj = this_obj;
+    obj->method = method;
+    obj->capture_count = 0;
+    
+    return (xc_object_t *)obj;
+}
+
+/* Create a closure whose captured variables live in a flat slot array
+ * allocated with the function; captures may be NULL for all-empty slots */
+xc_object_t *xc_function_create_closure(xc_runtime_t *rt, xc_function_ptr_t fn, size_t capture_count,
+                                        xc_object_t **captures) {
+    size_t size = sizeof(xc_function_t) + capture_count * sizeof(xc_object_t *);
+    xc_function_t *obj = (xc_function_t *)xc_gc_alloc(rt, size, XC_TYPE_FUNC);
+    if (!obj) {
+        return NULL;
+    }
+    
+    ((xc_object_t *)obj)->type_id = XC_TYPE_FUNC;
+    obj->handler = fn;
+    obj->closure = NULL;
+    obj->this_obj = NULL;
+    obj->method = NULL;
+    obj->capture_count = capture_count;
+    if (captures) {
+        memcpy(obj->captures, captures, capture_count * sizeof(xc_object_t *));
+    } else {
+        memset(obj->captures, 0, capture_count * sizeof(xc_object_t *));
+    }
+    
+    return (xc_object_t *)obj;
+}
+
+size_t xc_function_capture_count(xc_runtime_t *rt, xc_object_t *func) {
+    assert(xc_is_function(rt, func));
+    return ((xc_function_t *)func)->capture_count;
+}
+
+xc_object_t *xc_function_get_capture(xc_runtime_t *rt, xc_object_t *func, size_t slot) {
+    assert(xc_is_function(rt, func));
+    xc_function_t *function = (xc_function_t *)func;
+    return slot < function->capture_count ? function->captures[slot] : NULL;
+}
+
+void xc_function_set_capture(xc_runtime_t *rt, xc_object_t *func, size_t slot, xc_object_t *value) {
+    assert(xc_is_function(rt, func));
+    xc_function_t *function = (xc_function_t *)func;
+    if (slot < function->capture_count) {
+        function->captures[slot] = value;
+    }
+}
+
+/* 当前线程正在执行的函数对象，handler 通过它读取自己的捕获槽 */
+static __thread xc_function_t *current_function = NULL;
+
+xc_object_t *xc_function_current(xc_runtime_t *rt) {
+    return (xc_object_t *)current_function;
+}
+
+/* try 帧 longjmp 回来时恢复进入时的函数，跳过的 handler 来不及自己恢复 */
+void xc_function_set_current(xc_runtime_t *rt, xc_object_t *func) {
+    current_function = (xc_function_t *)func;
+}
+
+xc_val xc_function_apply_handler(xc_runtime_t *rt, xc_function_t *function, xc_val this_obj, int argc, xc_val *argv) {
+    xc_function_t *caller = current_function;
+    current_function = function;
+    xc_val result = function->handler(rt, this_obj, argc, argv);
+    current_function = caller;
+    return result;
+}
+
 // /* Function operations */
 // xc_object_t *xc_function_bind(xc_runtime_t *rt, xc_object_t *func, xc_object_t *this_obj) {
 //     assert(xc_is_function(rt, func));
@@ -147,10 +239,18 @@ xc_object_t *xc_function_call(xc_runtime_t *rt, xc_object_t *func, xc_object_t *
         this_obj = function->this_obj;
     }
     
+    if (function->method) {
+        if (argc > 1) {
+            return xc_raise(rt, xc_exception_create(rt, XC_EXCEPTION_TYPE_TYPE,
+                                                    "call: bound methods take one argument"));
+        }
+        return function->method(this_obj, argc > 0 ? argv[0] : NULL);
+    }
+    
     if (function->handler) {
         /* 类型转换以匹配函数签名 */
         //return function->handler(rt, this_obj, argc, (xc_object_t **)argv);//same...
-        return function->handler(rt, this_obj, argc, (xc_val*)argv);
+        return xc_function_apply_handler(rt, function, this_obj, argc, (xc_val*)argv);
     }
     
     return NULL;
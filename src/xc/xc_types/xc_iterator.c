@@ -0,0 +1,446 @@
+/*
+ * xc_iterator.c - 惰性迭代器管道（map/filter/skip/take + reduce）
+ *
+ * xc_iter(source) starts a pipeline over an array or typed array; map,
+ * filter, skip and take append stages to it and return it, and a terminal
+ * (reduce, toArray, count, sum) runs every stage per element in one pass.
+ * No intermediate arrays are built, and take stops the pass early.
+ *
+ * Stages are xc functions or native C callbacks. The f64 callbacks work on
+ * unboxed doubles: a typed array feeding only f64 stages into sum never
+ * allocates. Values are boxed or unboxed lazily at the first stage that
+ * needs the other form.
+ */
+#include "../xc.h"
+#include "../xc_internal.h"
+
+static xc_runtime_t* rt = NULL;
+
+/* Forward declarations */
+static void iterator_mark(xc_object_t *obj, mark_func mark);
+static int iterator_free(xc_val obj);
+static xc_val iterator_creator(int type, va_list args);
+
+/*
+ * The iterator running on this thread, registered once as a GC root. Each
+ * run links the previous one through outer, and the marker follows the
+ * chain, so in-flight values stay alive while stage callbacks allocate.
+ */
+static __thread xc_object_t *iter_running = NULL;
+static __thread bool iter_root_registered = false;
+
+/* Lifecycle */
+static void iterator_mark(xc_object_t *obj, mark_func mark) {
+    xc_iterator_t *it = (xc_iterator_t *)obj;
+    if (it->source) mark(it->source);
+    if (it->value) mark(it->value);
+    if (it->acc) mark(it->acc);
+    if (it->outer) mark(it->outer);
+    for (size_t i = 0; i < it->stage_count; i++) {
+        if (it->stages[i].fn) {
+            mark(it->stages[i].fn);
+        }
+    }
+}
+
+static int iterator_free(xc_val obj) {
+    xc_iterator_t *it = (xc_iterator_t *)obj;
+    free(it->stages);
+    it->stages = NULL;
+    it->stage_count = 0;
+    it->stage_capacity = 0;
+    return 0;
+}
+
+/* Type descriptor for iterators */
+static xc_type_lifecycle_t iterator_type = {
+    .initializer = NULL,
+    .cleaner = NULL,
+    .creator = iterator_creator,
+    .destroyer = iterator_free,
+    .marker = (xc_marker_func)iterator_mark,
+    .name = "iterator",
+    .flags = XC_TYPE_INTERNAL
+};
+
+/* rt->new(XC_TYPE_ITERATOR, source) */
+static xc_val iterator_creator(int type, va_list args) {
+    xc_object_t *source = va_arg(args, xc_object_t *);
+    return (xc_val)xc_iter(rt, source);
+}
+
+xc_object_t *xc_iter(xc_runtime_t *rt, xc_object_t *source) {
+    if (!xc_is_array(rt, source) && !xc_is_buffer(rt, source)) {
+        return NULL;
+    }
+    xc_iterator_t *it = (xc_iterator_t *)xc_gc_alloc(rt, sizeof(xc_iterator_t), XC_TYPE_ITERATOR);
+    if (!it) {
+        return NULL;
+    }
+    ((xc_object_t *)it)->type_id = XC_TYPE_ITERATOR;
+    it->source = source;
+    it->stages = NULL;
+    it->stage_count = 0;
+    it->stage_capacity = 0;
+    it->value = NULL;
+    it->acc = NULL;
+    it->outer = NULL;
+    return (xc_object_t *)it;
+}
+
+bool xc_is_iterator(xc_runtime_t *rt, xc_object_t *obj) {
+    return obj && obj->type_id == XC_TYPE_ITERATOR;
+}
+
+/* Appends a stage; returns it (zeroed apart from kind) or NULL */
+static xc_iter_stage_t *iterator_add_stage(xc_runtime_t *rt, xc_object_t *obj, int kind) {
+    if (!xc_is_iterator(rt, obj)) {
+        return NULL;
+    }
+    xc_iterator_t *it = (xc_iterator_t *)obj;
+    if (it->stage_count == it->stage_capacity) {
+        size_t capacity = it->stage_capacity ? it->stage_capacity * 2 : 4;
+        xc_iter_stage_t *stages = realloc(it->stages, capacity * sizeof(xc_iter_stage_t));
+        if (!stages) {
+            return NULL;
+        }
+        it->stages = stages;
+        it->stage_capacity = capacity;
+    }
+    xc_iter_stage_t *stage = &it->stages[it->stage_count++];
+    memset(stage, 0, sizeof(*stage));
+    stage->kind = kind;
+    return stage;
+}
+
+/* Stage builders: each returns the iterator so calls chain */
+xc_object_t *xc_iter_map(xc_runtime_t *rt, xc_object_t *it, xc_object_t *fn) {
+    xc_iter_stage_t *stage = xc_is_function(rt, fn) ? iterator_add_stage(rt, it, XC_ITER_MAP) : NULL;
+    if (stage) {
+        stage->fn = fn;
+    }
+    return it;
+}
+
+xc_object_t *xc_iter_filter(xc_runtime_t *rt, xc_object_t *it, xc_object_t *fn) {
+    xc_iter_stage_t *stage = xc_is_function(rt, fn) ? iterator_add_stage(rt, it, XC_ITER_FILTER) : NULL;
+    if (stage) {
+        stage->fn = fn;
+    }
+    return it;
+}
+
+xc_object_t *xc_iter_map_native(xc_runtime_t *rt, xc_object_t *it, xc_iter_map_func fn, void *data) {
+    xc_iter_stage_t *stage = fn ? iterator_add_stage(rt, it, XC_ITER_MAP_NATIVE) : NULL;
+    if (stage) {
+        stage->map = fn;
+        stage->data = data;
+    }
+    return it;
+}
+
+xc_object_t *xc_iter_filter_native(xc_runtime_t *rt, xc_object_t *it, xc_iter_filter_func fn, void *data) {
+    xc_iter_stage_t *stage = fn ? iterator_add_stage(rt, it, XC_ITER_FILTER_NATIVE) : NULL;
+    if (stage) {
+        stage->filter = fn;
+        stage->data = data;
+    }
+    return it;
+}
+
+xc_object_t *xc_iter_map_f64(xc_runtime_t *rt, xc_object_t *it, xc_iter_map_f64_func fn, void *data) {
+    xc_iter_stage_t *stage = fn ? iterator_add_stage(rt, it, XC_ITER_MAP_F64) : NULL;
+    if (stage) {
+        stage->map_f64 = fn;
+        stage->data = data;
+    }
+    return it;
+}
+
+xc_object_t *xc_iter_filter_f64(xc_runtime_t *rt, xc_object_t *it, xc_iter_filter_f64_func fn, void *data) {
+    xc_iter_stage_t *stage = fn ? iterator_add_stage(rt, it, XC_ITER_FILTER_F64) : NULL;
+    if (stage) {
+        stage->filter_f64 = fn;
+        stage->data = data;
+    }
+    return it;
+}
+
+xc_object_t *xc_iter_skip(xc_runtime_t *rt, xc_object_t *it, size_t count) {
+    xc_iter_stage_t *stage = iterator_add_stage(rt, it, XC_ITER_SKIP);
+    if (stage) {
+        stage->count = count;
+    }
+    return it;
+}
+
+xc_object_t *xc_iter_take(xc_runtime_t *rt, xc_object_t *it, size_t count) {
+    xc_iter_stage_t *stage = iterator_add_stage(rt, it, XC_ITER_TAKE);
+    if (stage) {
+        stage->count = count;
+    }
+    return it;
+}
+
+/*
+ * The fused loop. Each element flows through every stage; `boxed` says
+ * whether the current value is it->value or num. The sink sees the value
+ * in whichever form the last stage left it and returns false to stop.
+ */
+typedef bool (*iter_sink_func)(xc_runtime_t *rt, xc_iterator_t *it, double num, bool boxed, void *data);
+
+static inline void iter_box(xc_runtime_t *rt, xc_iterator_t *it, double num, bool *boxed) {
+    if (!*boxed) {
+        it->value = xc_number_box(rt, num);
+        *boxed = true;
+    }
+}
+
+static inline double iter_unbox(xc_runtime_t *rt, xc_iterator_t *it, double num, bool *boxed) {
+    if (*boxed) {
+        *boxed = false;
+        return xc_to_number(rt, it->value);
+    }
+    return num;
+}
+
+static void iterator_run(xc_runtime_t *rt, xc_object_t *obj, iter_sink_func sink, void *data) {
+    xc_iterator_t *it = (xc_iterator_t *)obj;
+    if (!iter_root_registered) {
+        xc_gc_add_root(rt, &iter_running);
+        iter_root_registered = true;
+    }
+    it->outer = iter_running;
+    iter_running = obj;
+
+    for (size_t s = 0; s < it->stage_count; s++) {
+        it->stages[s].seen = 0;
+    }
+
+    xc_object_t *source = it->source;
+    bool from_array = xc_is_array(rt, source);
+    bool stop = false;
+    for (size_t i = 0; !stop; i++) {
+        /* Re-read the length each step: callbacks may grow or shrink the source */
+        double num = 0;
+        bool boxed = from_array;
+        if (from_array) {
+            if (i >= xc_array_length(rt, source)) break;
+            it->value = xc_array_get(rt, source, i);
+        } else {
+            xc_buffer_t *buf = (xc_buffer_t *)source;
+            if (i >= buf->length) break;
+            num = buf->kind == XC_BUFFER_FLOAT64 ? ((const double *)buf->data)[i] : xc_buffer_get_number(rt, source, i);
+        }
+
+        bool pass = true;
+        for (size_t s = 0; s < it->stage_count && pass; s++) {
+            xc_iter_stage_t *stage = &it->stages[s];
+            switch (stage->kind) {
+                case XC_ITER_MAP:
+                    iter_box(rt, it, num, &boxed);
+                    it->value = xc_function_call(rt, stage->fn, NULL, 1, &it->value);
+                    break;
+                case XC_ITER_FILTER:
+                    iter_box(rt, it, num, &boxed);
+                    pass = xc_to_boolean(rt, xc_function_call(rt, stage->fn, NULL, 1, &it->value));
+                    break;
+                case XC_ITER_MAP_NATIVE:
+                    iter_box(rt, it, num, &boxed);
+                    it->value = stage->map(rt, it->value, stage->data);
+                    break;
+                case XC_ITER_FILTER_NATIVE:
+                    iter_box(rt, it, num, &boxed);
+                    pass = stage->filter(rt, it->value, stage->data);
+                    break;
+                case XC_ITER_MAP_F64:
+                    num = stage->map_f64(iter_unbox(rt, it, num, &boxed), stage->data);
+                    break;
+                case XC_ITER_FILTER_F64:
+                    num = iter_unbox(rt, it, num, &boxed);
+                    pass = stage->filter_f64(num, stage->data);
+                    break;
+                case XC_ITER_SKIP:
+                    if (stage->seen < stage->count) {
+                        stage->seen++;
+                        pass = false;
+                    }
+                    break;
+                case XC_ITER_TAKE:
+                    if (stage->seen >= stage->count) {
+                        pass = false;
+                        stop = true;
+                    } else if (++stage->seen == stage->count) {
+                        /* Last element this stage lets through: finish after the sink */
+                        stop = true;
+                    }
+                    break;
+            }
+        }
+        if (pass && !sink(rt, it, num, boxed, data)) {
+            stop = true;
+        }
+    }
+
+    it->value = NULL;
+    iter_running = it->outer;
+    it->outer = NULL;
+}
+
+/* Terminals */
+static bool iter_sink_array(xc_runtime_t *rt, xc_iterator_t *it, double num, bool boxed, void *data) {
+    iter_box(rt, it, num, &boxed);
+    xc_array_push(rt, it->acc, it->value);
+    return true;
+}
+
+xc_object_t *xc_iter_to_array(xc_runtime_t *rt, xc_object_t *obj) {
+    if (!xc_is_iterator(rt, obj)) {
+        return NULL;
+    }
+    xc_iterator_t *it = (xc_iterator_t *)obj;
+    it->acc = xc_array_create(rt);
+    iterator_run(rt, obj, iter_sink_array, NULL);
+    xc_object_t *result = it->acc;
+    it->acc = NULL;
+    return result;
+}
+
+static bool iter_sink_count(xc_runtime_t *rt, xc_iterator_t *it, double num, bool boxed, void *data) {
+    (*(size_t *)data)++;
+    return true;
+}
+
+size_t xc_iter_count(xc_runtime_t *rt, xc_object_t *obj) {
+    size_t count = 0;
+    if (xc_is_iterator(rt, obj)) {
+        iterator_run(rt, obj, iter_sink_count, &count);
+    }
+    return count;
+}
+
+static bool iter_sink_sum(xc_runtime_t *rt, xc_iterator_t *it, double num, bool boxed, void *data) {
+    *(double *)data += iter_unbox(rt, it, num, &boxed);
+    return true;
+}
+
+double xc_iter_sum(xc_runtime_t *rt, xc_object_t *obj) {
+    double sum = 0;
+    if (xc_is_iterator(rt, obj)) {
+        iterator_run(rt, obj, iter_sink_sum, &sum);
+    }
+    return sum;
+}
+
+/* reduce: fn(acc, value) through an xc function or a native callback */
+typedef struct {
+    xc_object_t *fn;
+    xc_iter_reduce_func native;
+    void *data;
+} iter_reduce_t;
+
+static bool iter_sink_reduce(xc_runtime_t *rt, xc_iterator_t *it, double num, bool boxed, void *data) {
+    iter_reduce_t *reduce = data;
+    iter_box(rt, it, num, &boxed);
+    if (reduce->native) {
+        it->acc = reduce->native(rt, it->acc, it->value, reduce->data);
+    } else {
+        xc_object_t *argv[2] = { it->acc, it->value };
+        it->acc = xc_function_call(rt, reduce->fn, NULL, 2, argv);
+    }
+    return true;
+}
+
+static xc_object_t *iterator_reduce(xc_runtime_t *rt, xc_object_t *obj, iter_reduce_t *reduce, xc_object_t *initial) {
+    if (!xc_is_iterator(rt, obj)) {
+        return NULL;
+    }
+    xc_iterator_t *it = (xc_iterator_t *)obj;
+    it->acc = initial;
+    iterator_run(rt, obj, iter_sink_reduce, reduce);
+    xc_object_t *result = it->acc;
+    it->acc = NULL;
+    return result;
+}
+
+xc_object_t *xc_iter_reduce(xc_runtime_t *rt, xc_object_t *it, xc_object_t *fn, xc_object_t *initial) {
+    if (!xc_is_function(rt, fn)) {
+        return NULL;
+    }
+    iter_reduce_t reduce = { fn, NULL, NULL };
+    return iterator_reduce(rt, it, &reduce, initial);
+}
+
+xc_object_t *xc_iter_reduce_native(xc_runtime_t *rt, xc_object_t *it, xc_iter_reduce_func fn,
+                                   xc_object_t *initial, void *data) {
+    if (!fn) {
+        return NULL;
+    }
+    iter_reduce_t reduce = { NULL, fn, data };
+    return iterator_reduce(rt, it, &reduce, initial);
+}
+
+/* 方法包装函数 */
+static xc_val iterator_map_method(xc_val self, xc_val arg) {
+    return xc_iter_map(rt, self, arg);
+}
+
+static xc_val iterator_filter_method(xc_val self, xc_val arg) {
+    return xc_iter_filter(rt, self, arg);
+}
+
+static xc_val iterator_skip_method(xc_val self, xc_val arg) {
+    double count = xc_to_number(rt, arg);
+    return xc_iter_skip(rt, self, count > 0 ? (size_t)count : 0);
+}
+
+static xc_val iterator_take_method(xc_val self, xc_val arg) {
+    double count = xc_to_number(rt, arg);
+    return xc_iter_take(rt, self, count > 0 ? (size_t)count : 0);
+}
+
+/* reduce: 参数是函数，或数组 [函数, 初始值] */
+static xc_val iterator_reduce_method(xc_val self, xc_val arg) {
+    xc_object_t *initial = NULL;
+    if (arg && rt->is(arg, XC_TYPE_ARRAY)) {
+        initial = xc_array_get(rt, arg, 1);
+        arg = xc_array_get(rt, arg, 0);
+    }
+    return xc_iter_reduce(rt, self, arg, initial);
+}
+
+static xc_val iterator_to_array_method(xc_val self, xc_val arg) {
+    return xc_iter_to_array(rt, self);
+}
+
+static xc_val iterator_count_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, (double)xc_iter_count(rt, self));
+}
+
+static xc_val iterator_sum_method(xc_val self, xc_val arg) {
+    return xc_number_box(rt, xc_iter_sum(rt, self));
+}
+
+static xc_val source_iter_method(xc_val self, xc_val arg) {
+    return xc_iter(rt, self);
+}
+
+/* Register iterator type */
+void xc_register_iterator_type(xc_runtime_t *caller_rt) {
+    rt = caller_rt;
+    rt->register_type("iterator", &iterator_type);
+
+    /* 注册迭代器方法 */
+    rt->register_method(XC_TYPE_ITERATOR, "map", iterator_map_method);
+    rt->register_method(XC_TYPE_ITERATOR, "filter", iterator_filter_method);
+    rt->register_method(XC_TYPE_ITERATOR, "skip", iterator_skip_method);
+    rt->register_method(XC_TYPE_ITERATOR, "take", iterator_take_method);
+    rt->register_method(XC_TYPE_ITERATOR, "reduce", iterator_reduce_method);
+    rt->register_method(XC_TYPE_ITERATOR, "toArray", iterator_to_array_method);
+    rt->register_method(XC_TYPE_ITERATOR, "count", iterator_count_method);
+    rt->register_method(XC_TYPE_ITERATOR, "sum", iterator_sum_method);
+
+    /* 数组和类型化数组的入口 */
+    rt->register_method(XC_TYPE_ARRAY, "iter", source_iter_method);
+    rt->register_method(XC_TYPE_BUFFER, "iter", source_iter_method);
+}
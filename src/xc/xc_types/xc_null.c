@@ -3,10 +3,11 @@
 
 /* Forward declarations */
 // static void null_mark(xc_runtime_t *rt, xc_object_t *obj, void (*mark_func)(xc_val));
-static void null_free(xc_runtime_t *rt, xc_object_t *obj);
-static bool null_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
-static int null_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+static int null_free(xc_val obj);
+static bool null_equal(xc_val a, xc_val b);
+static int null_compare(xc_val a, xc_val b);
 static xc_val null_creator(int type, va_list args);
+static xc_val null_convert_to(xc_val obj, int target_type);
 
 /* Null object structure */
 typedef struct {
@@ -21,17 +22,18 @@ static void null_mark(xc_object_t *obj, mark_func mark) {
     /* Null doesn't have references to other objects */
 }
 
-static void null_free(xc_runtime_t *rt, xc_object_t *obj) {
+static int null_free(xc_val obj) {
     /* No resources to free */
+    return 0;
 }
 
-static bool null_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static bool null_equal(xc_val a, xc_val b) {
     /* All null objects are equal */
-    return xc_is_null(rt, b);
+    return xc_is_null(NULL, b);
 }
 
-static int null_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
-    if (xc_is_null(rt, b)) {
+static int null_compare(xc_val a, xc_val b) {
+    if (xc_is_null(NULL, b)) {
         return 0;  /* Null equals null */
     }
     return -1;    /* Null is less than any other type */
@@ -42,13 +44,14 @@ static xc_type_lifecycle_t null_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = null_creator,
-    .destroyer = (xc_destroy_func)null_free,
+    .destroyer = null_free,
     .marker = null_mark,
     // .allocator = NULL,
     .name = "null",
-    .equal = (bool (*)(xc_val, xc_val))null_equal,
-    .compare = (int (*)(xc_val, xc_val))null_compare,
-    .flags = XC_TYPE_PRIMITIVE
+    .equal = null_equal,
+    .compare = null_compare,
+    .flags = XC_TYPE_PRIMITIVE,
+    .convert_to = null_convert_to
 };
 
 /* Null creator function for use with create() */
@@ -57,6 +60,18 @@ static xc_val null_creator(int type, va_list args) {
     return (xc_val)null_singleton;
 }
 
+/* 转换到其他类型：null 为假 */
+static xc_val null_convert_to(xc_val obj, int target_type) {
+    switch (target_type) {
+        case XC_TYPE_NULL:
+            return obj;
+        case XC_TYPE_BOOL:
+            return xc_boolean_create(xc_singleton(), false);
+        default:
+            return NULL; // 不支持的转换
+    }
+}
+
 /* Register null type */
 void xc_register_null_type(xc_runtime_t *rt) {
     /* 定义类型生命周期管理接口 */
@@ -65,18 +80,7 @@ void xc_register_null_type(xc_runtime_t *rt) {
     xc_null_type = &null_type;
 
     /* Create singleton null instance if not already created */
-    if (!null_singleton) {
-        /* 使用 xc_gc_alloc 分配对象，并传递类型索引 */
-        xc_null_t *obj = (xc_null_t *)xc_gc_alloc(rt, sizeof(xc_null_t), XC_TYPE_NULL);
-        if (null_singleton) {
-            /* 设置正确的类型ID */
-            ((xc_object_t *)obj)->type_id = XC_TYPE_NULL;
-            /* 使用 xc_gc_mark_permanent 标记为永久对象 */
-            //xc_gc_mark_permanent(rt, (xc_object_t *)obj);
-            //TODO 不对，应该 root.dot(name, XC_FLAG_CONST, val)?
-            null_singleton = (xc_object_t *)obj;
-        }
-    }
+    xc_null_create(rt);
 }
 
 /* Create null object - returns singleton instance */
@@ -95,7 +99,8 @@ xc_object_t *xc_null_create(xc_runtime_t *rt) {
     /* 初始化对象 */
     ((xc_object_t *)obj)->type_id = XC_TYPE_NULL;
     
-    /* 保存单例 */
+    /* 保存单例：只存在静态变量里，标记为永久对象 */
+    xc_gc_mark_permanent(rt, (xc_object_t *)obj);
     null_singleton = (xc_object_t *)obj;
     
     return null_singleton;
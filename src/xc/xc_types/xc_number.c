@@ -1,12 +1,13 @@
 #include "../xc.h"
 #include "../xc_internal.h"
+#include "xc_number_tables.h"
 
 static xc_runtime_t* rt = NULL;
 
 /* Forward declarations */
-static void number_free(xc_runtime_t *rt, xc_object_t *obj);
-static bool number_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
-static int number_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+static int number_free(xc_val obj);
+static bool number_equal(xc_val a, xc_val b);
+static int number_compare(xc_val a, xc_val b);
 static xc_val number_creator(int type, va_list args);
 
 /* Number type structure */
@@ -20,11 +21,12 @@ static void number_mark(xc_object_t *obj, mark_func mark) {
     /* Numbers don't have references to other objects */
 }
 
-static void number_free(xc_runtime_t *rt, xc_object_t *obj) {
+static int number_free(xc_val obj) {
     /* Memory is managed by GC */
+    return 0;
 }
 
-static bool number_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static bool number_equal(xc_val a, xc_val b) {
     if (!xc_is_number(rt, b)) {
         return false;
     }
@@ -33,7 +35,7 @@ static bool number_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
     return num_a->value == num_b->value;
 }
 
-static int number_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static int number_compare(xc_val a, xc_val b) {
     if (!xc_is_number(rt, b)) {
         return 1; /* Numbers are greater than non-numbers */
     }
@@ -60,14 +62,14 @@ static xc_val number_convert_to(xc_val obj, int target_type) {
     
     switch (target_type) {
         case XC_TYPE_BOOL:
-            return rt->new(XC_TYPE_BOOL, value != 0.0);
+            return rt->new(XC_TYPE_BOOL, value != 0.0 && value == value);
             
         case XC_TYPE_NUMBER:
             return obj; // 已经是数字类型
             
         case XC_TYPE_STRING: {
-            char buffer[32];
-            snprintf(buffer, sizeof(buffer), "%g", value);
+            char buffer[XC_NUMBER_FORMAT_SIZE];
+            xc_number_format(value, buffer);
             return rt->new(XC_TYPE_STRING, buffer);
         }
             
@@ -76,17 +78,22 @@ static xc_val number_convert_to(xc_val obj, int target_type) {
     }
 }
 
+/* Number method: toString */
+static xc_val number_to_string_method(xc_val self, xc_val arg) {
+    return number_convert_to(self, XC_TYPE_STRING);
+}
+
 /* Type descriptor for number type */
 static xc_type_lifecycle_t number_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = number_creator,
-    .destroyer = (xc_destroy_func)number_free,
+    .destroyer = number_free,
     .marker = number_mark,
     // .allocator = NULL,
     .name = "number",
-    .equal = (bool (*)(xc_val, xc_val))number_equal,
-    .compare = (int (*)(xc_val, xc_val))number_compare,
+    .equal = number_equal,
+    .compare = number_compare,
     .flags = XC_TYPE_PRIMITIVE,
     .get_value = number_get_value,
     .convert_to = number_convert_to
@@ -108,6 +115,7 @@ void xc_register_number_type(xc_runtime_t *caller_rt) {
     /* 注册类型 */
     int type_id = rt->register_type("number", &number_type);
     // xc_number_type = &number_type;
+    rt->register_method(XC_TYPE_NUMBER, "toString", number_to_string_method);
 }
 
 /* Create a number object */
@@ -125,6 +133,34 @@ xc_object_t *xc_number_create(xc_runtime_t *rt, double value) {
     return (xc_object_t *)obj;
 }
 
+/* 线程本地的小整数装箱缓存，槽位注册为GC根 */
+#define NUMBER_BOX_MIN (-128)
+#define NUMBER_BOX_MAX 1023
+
+static __thread xc_object_t *number_box_cache[NUMBER_BOX_MAX - NUMBER_BOX_MIN + 1];
+static __thread bool number_box_cache_rooted = false;
+
+/* Box a number; small integers share one cached box per thread.
+ * Number boxes are never mutated, so sharing them is safe. */
+xc_object_t *xc_number_box(xc_runtime_t *rt, double value) {
+    if (value >= NUMBER_BOX_MIN && value <= NUMBER_BOX_MAX &&
+        value == (double)(int)value && !(value == 0 && signbit(value))) {
+        xc_object_t **slot = &number_box_cache[(int)value - NUMBER_BOX_MIN];
+        if (*slot) {
+            return *slot;
+        }
+        if (!number_box_cache_rooted) {
+            for (int i = 0; i <= NUMBER_BOX_MAX - NUMBER_BOX_MIN; i++) {
+                xc_gc_add_root(rt, &number_box_cache[i]);
+            }
+            number_box_cache_rooted = true;
+        }
+        *slot = xc_number_create(rt, value);
+        return *slot;
+    }
+    return xc_number_create(rt, value);
+}
+
 /* Type checking */
 bool xc_is_number(xc_runtime_t *rt, xc_object_t *obj) {
     return obj && obj->type_id == XC_TYPE_NUMBER;
@@ -137,6 +173,528 @@ double xc_number_value(xc_runtime_t *rt, xc_object_t *obj) {
     return num->value;
 }
 
+/*
+ * Number formatting: shortest round-trip digits (Grisu3, with an exact
+ * printf/strtod search for the ~0.5% of values it cannot decide) printed
+ * like JavaScript's Number.prototype.toString.
+ */
+
+/* 64-bit significand with a binary exponent: f * 2^e */
+typedef struct {
+    uint64_t f;
+    int e;
+} diy_fp_t;
+
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
+#define DP_EXPONENT_BIAS    1075   /* 0x3FF + 52 */
+
+static const uint64_t pow10_u64[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static inline uint64_t double_bits(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+static inline double bits_double(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+/* Upper 64 bits of a * b, rounded */
+static inline diy_fp_t diy_fp_mul(diy_fp_t a, diy_fp_t b) {
+    unsigned __int128 p = (unsigned __int128)a.f * b.f;
+    uint64_t h = (uint64_t)(p >> 64);
+    h += (uint64_t)p >> 63;
+    diy_fp_t r = {h, a.e + b.e + 64};
+    return r;
+}
+
+static inline diy_fp_t diy_fp_normalize(diy_fp_t x) {
+    int s = __builtin_clzll(x.f);
+    x.f <<= s;
+    x.e -= s;
+    return x;
+}
+
+/* Normalized boundaries m- and m+ of the rounding interval of v */
+static void diy_fp_boundaries(diy_fp_t v, diy_fp_t *minus, diy_fp_t *plus) {
+    diy_fp_t pl = {(v.f << 1) + 1, v.e - 1};
+    pl = diy_fp_normalize(pl);
+    diy_fp_t mi;
+    if (v.f == DP_HIDDEN_BIT) {
+        mi.f = (v.f << 2) - 1;
+        mi.e = v.e - 2;
+    } else {
+        mi.f = (v.f << 1) - 1;
+        mi.e = v.e - 1;
+    }
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+    *minus = mi;
+    *plus = pl;
+}
+
+/* Cached power c = 10^-k with binary exponent in the range Grisu needs */
+static diy_fp_t grisu_cached_power(int e, int *k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0) {
+        ik++;
+    }
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    diy_fp_t c = {grisu_powers_f[index], grisu_powers_e[index]};
+    return c;
+}
+
+static inline int count_digits32(uint32_t n) {
+    int digits = 1;
+    while (digits < 10 && n >= pow10_u64[digits]) {
+        digits++;
+    }
+    return digits;
+}
+
+/*
+ * Move the last digit towards W while staying inside the safe interval,
+ * then check that the result is the closest shortest candidate for every
+ * value the imprecise W could stand for. False means Grisu cannot decide.
+ */
+static bool grisu_round_weed(char *buffer, int len, uint64_t too_high_w, uint64_t unsafe,
+                             uint64_t rest, uint64_t ten_kappa, uint64_t unit) {
+    uint64_t small_distance = too_high_w - unit;
+    uint64_t big_distance = too_high_w + unit;
+    while (rest < small_distance && unsafe - rest >= ten_kappa &&
+           (rest + ten_kappa < small_distance ||
+            small_distance - rest >= rest + ten_kappa - small_distance)) {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+    if (rest < big_distance && unsafe - rest >= ten_kappa &&
+        (rest + ten_kappa < big_distance ||
+         big_distance - rest > rest + ten_kappa - big_distance)) {
+        return false;
+    }
+    return 2 * unit <= rest && rest <= unsafe - 4 * unit;
+}
+
+/* Generate the shortest digits inside (low, high) around W (Grisu3) */
+static bool grisu_digit_gen(diy_fp_t low, diy_fp_t w, diy_fp_t high, char *buffer, int *len, int *k) {
+    uint64_t unit = 1;
+    diy_fp_t too_low = {low.f - unit, low.e};
+    diy_fp_t too_high = {high.f + unit, high.e};
+    uint64_t unsafe = too_high.f - too_low.f;
+    diy_fp_t one = {1ULL << -w.e, w.e};
+    uint32_t p1 = (uint32_t)(too_high.f >> -one.e);
+    uint64_t p2 = too_high.f & (one.f - 1);
+    int kappa = count_digits32(p1);
+    *len = 0;
+    
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t)pow10_u64[kappa - 1];
+        buffer[(*len)++] = (char)('0' + p1 / divisor);
+        p1 %= divisor;
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest < unsafe) {
+            *k += kappa;
+            return grisu_round_weed(buffer, *len, too_high.f - w.f, unsafe, rest,
+                                    (uint64_t)divisor << -one.e, unit);
+        }
+    }
+    
+    for (;;) {
+        p2 *= 10;
+        unit *= 10;
+        unsafe *= 10;
+        buffer[(*len)++] = (char)('0' + (p2 >> -one.e));
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < unsafe) {
+            *k += kappa;
+            return grisu_round_weed(buffer, *len, (too_high.f - w.f) * unit, unsafe, p2, one.f, unit);
+        }
+    }
+}
+
+/* Digits of a positive finite value (value = digits * 10^k), or 0 if Grisu3 gives up */
+static int grisu3(double value, char *buffer, int *k) {
+    uint64_t bits = double_bits(value);
+    int biased_e = (int)((bits >> 52) & 0x7FF);
+    diy_fp_t v;
+    if (biased_e != 0) {
+        v.f = (bits & DP_SIGNIFICAND_MASK) + DP_HIDDEN_BIT;
+        v.e = biased_e - DP_EXPONENT_BIAS;
+    } else {
+        v.f = bits & DP_SIGNIFICAND_MASK;
+        v.e = 1 - DP_EXPONENT_BIAS;
+    }
+    
+    diy_fp_t w_m, w_p;
+    diy_fp_boundaries(v, &w_m, &w_p);
+    diy_fp_t c_mk = grisu_cached_power(w_p.e, k);
+    diy_fp_t w = diy_fp_mul(diy_fp_normalize(v), c_mk);
+    diy_fp_t wp = diy_fp_mul(w_p, c_mk);
+    diy_fp_t wm = diy_fp_mul(w_m, c_mk);
+    
+    int len;
+    return grisu_digit_gen(wm, w, wp, buffer, &len, k) ? len : 0;
+}
+
+/*
+ * Exact fallback for the values Grisu3 rejects. printf rounds correctly, so
+ * the nearest candidate with a given number of digits round-trips once any
+ * candidate of that length does. Just below a power of two the interval is
+ * wider above the value, so the candidate one unit up is tried as well.
+ * Returns the digit count, or 0 if no candidate of this precision
+ * round-trips.
+ */
+static int exact_digits(double value, int precision, char *buffer, int *k) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+    char *exp = strchr(text, 'e');
+    int len = 0;
+    for (char *c = text; c < exp; c++) {
+        if (*c != '.') {
+            buffer[len++] = *c;
+        }
+    }
+    *k = atoi(exp + 1) - (len - 1);
+    double parsed = strtod(text, NULL);
+    if (parsed < value) {
+        int i = len - 1;
+        while (i >= 0 && buffer[i] == '9') {
+            buffer[i--] = '0';
+        }
+        if (i >= 0) {
+            buffer[i]++;
+        } else {
+            buffer[0] = '1';
+            (*k)++;
+        }
+        char candidate[40];
+        snprintf(candidate, sizeof(candidate), "%.*se%d", len, buffer, *k);
+        parsed = strtod(candidate, NULL);
+    }
+    return parsed == value ? len : 0;
+}
+
+/* Shortest precision by bisection: 17 digits always round-trip */
+static int shortest_exact(double value, char *buffer, int *k) {
+    int lo = 1, hi = 17;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (exact_digits(value, mid, buffer, k)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    int len = exact_digits(value, lo, buffer, k);
+    while (len > 1 && buffer[len - 1] == '0') {
+        len--;
+        (*k)++;
+    }
+    return len;
+}
+
+/* Write an unsigned integer, returning its length */
+static int format_u64(uint64_t n, char *out) {
+    char tmp[20];
+    int len = 0;
+    do {
+        tmp[len++] = (char)('0' + n % 10);
+        n /= 10;
+    } while (n);
+    for (int i = 0; i < len; i++) {
+        out[i] = tmp[len - 1 - i];
+    }
+    return len;
+}
+
+/*
+ * Format a double as the shortest string that parses back to it.
+ * out needs XC_NUMBER_FORMAT_SIZE bytes; returns the length (NUL-terminated).
+ */
+size_t xc_number_format(double value, char *out) {
+    char *p = out;
+    
+    if (value != value) {
+        memcpy(out, "NaN", 4);
+        return 3;
+    }
+    if (value < 0) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value == __builtin_inf()) {
+        memcpy(p, "Infinity", 9);
+        return (size_t)(p - out) + 8;
+    }
+    if (value == 0) {
+        /* -0 prints as 0 */
+        out[0] = '0';
+        out[1] = '\0';
+        return 1;
+    }
+    
+    /* Integers below 2^53 print exactly */
+    if (value < 9007199254740992.0 && value == (double)(uint64_t)value) {
+        p += format_u64((uint64_t)value, p);
+        *p = '\0';
+        return (size_t)(p - out);
+    }
+    
+    char digits[20];
+    int k;
+    int len = grisu3(value, digits, &k);
+    if (len == 0) {
+        len = shortest_exact(value, digits, &k);
+    }
+    int point = len + k;  /* Position of the decimal point relative to the digits */
+    
+    if (point > 0 && point <= 21) {
+        if (k >= 0) {
+            /* 1234e7 -> 12340000000 */
+            memcpy(p, digits, len);
+            memset(p + len, '0', k);
+            p += point;
+        } else {
+            /* 1234e-2 -> 12.34 */
+            memcpy(p, digits, point);
+            p[point] = '.';
+            memcpy(p + point + 1, digits + point, len - point);
+            p += len + 1;
+        }
+    } else if (point <= 0 && point > -6) {
+        /* 1234e-6 -> 0.001234 */
+        p[0] = '0';
+        p[1] = '.';
+        memset(p + 2, '0', -point);
+        memcpy(p + 2 - point, digits, len);
+        p += 2 - point + len;
+    } else {
+        /* 1.234e+30, 1e-7 */
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, len - 1);
+            p += len - 1;
+        }
+        int exponent = point - 1;
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        p += format_u64((uint64_t)(exponent < 0 ? -exponent : exponent), p);
+    }
+    *p = '\0';
+    return (size_t)(p - out);
+}
+
+/*
+ * Number parsing: decimal significand and exponent, then the exact fast
+ * path (Clinger) or Eisel-Lemire; rare ambiguous cases fall back to strtod.
+ */
+
+static const double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* man * 10^exp10 correctly rounded, or false if it cannot decide */
+static bool eisel_lemire(uint64_t man, int exp10, bool negative, double *out) {
+    if (man == 0) {
+        *out = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (exp10 < -348 || exp10 > 347) {
+        return false;
+    }
+    
+    int clz = __builtin_clzll(man);
+    man <<= clz;
+    uint64_t ret_exp2 = (uint64_t)(((217706 * exp10) >> 16) + 64 + 1023) - (uint64_t)clz;
+    
+    const uint64_t *pow = lemire_powers[exp10 + 348];
+    unsigned __int128 x = (unsigned __int128)man * pow[1];
+    uint64_t x_hi = (uint64_t)(x >> 64), x_lo = (uint64_t)x;
+    
+    /* Widen with the low half of the power when the product is too close to call */
+    if ((x_hi & 0x1FF) == 0x1FF && x_lo + man < man) {
+        unsigned __int128 y = (unsigned __int128)man * pow[0];
+        uint64_t y_hi = (uint64_t)(y >> 64), y_lo = (uint64_t)y;
+        uint64_t merged_hi = x_hi, merged_lo = x_lo + y_hi;
+        if (merged_lo < x_lo) {
+            merged_hi++;
+        }
+        if ((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && y_lo + man < man) {
+            return false;
+        }
+        x_hi = merged_hi;
+        x_lo = merged_lo;
+    }
+    
+    uint64_t msb = x_hi >> 63;
+    uint64_t ret_mantissa = x_hi >> (msb + 9);
+    ret_exp2 -= 1 ^ msb;
+    
+    /* Exactly halfway between two doubles */
+    if (x_lo == 0 && (x_hi & 0x1FF) == 0 && (ret_mantissa & 3) == 1) {
+        return false;
+    }
+    
+    ret_mantissa += ret_mantissa & 1;
+    ret_mantissa >>= 1;
+    if (ret_mantissa >> 53) {
+        ret_mantissa >>= 1;
+        ret_exp2++;
+    }
+    /* Subnormal, infinite or out of range */
+    if (ret_exp2 - 1 >= 0x7FF - 1) {
+        return false;
+    }
+    
+    uint64_t bits = ret_exp2 << 52 | (ret_mantissa & DP_SIGNIFICAND_MASK);
+    if (negative) {
+        bits |= 0x8000000000000000ULL;
+    }
+    *out = bits_double(bits);
+    return true;
+}
+
+/* Slow path for inputs the fast paths cannot decide (and inf/nan/hex) */
+static size_t parse_fallback(const char *str, size_t len, double *value) {
+    char stack_buf[128];
+    char *buf = len < sizeof(stack_buf) ? stack_buf : (char *)malloc(len + 1);
+    if (!buf) {
+        return 0;
+    }
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+    char *end;
+    *value = strtod(buf, &end);
+    size_t used = (size_t)(end - buf);
+    if (buf != stack_buf) {
+        free(buf);
+    }
+    return used;
+}
+
+/*
+ * Parse a number from str[0..len) (no terminator needed).
+ * Returns the number of bytes consumed, 0 if there is no number.
+ */
+size_t xc_number_parse(const char *str, size_t len, double *value) {
+    size_t i = 0;
+    bool negative = false;
+    
+    if (i < len && (str[i] == '-' || str[i] == '+')) {
+        negative = str[i] == '-';
+        i++;
+    }
+    
+    uint64_t man = 0;
+    int digits = 0;          /* Significant digits kept in man */
+    int dropped = 0;         /* Integer digits that did not fit */
+    bool truncated = false;  /* A nonzero digit was dropped */
+    int exp10 = 0;
+    size_t start = i;
+    
+    while (i < len && str[i] == '0') {
+        i++;
+    }
+    if (i == start + 1 && i < len && (str[i] == 'x' || str[i] == 'X')) {
+        /* Hexadecimal */
+        return parse_fallback(str, len, value);
+    }
+    while (i < len && (unsigned)(str[i] - '0') < 10) {
+        if (digits < 19) {
+            man = man * 10 + (uint64_t)(str[i] - '0');
+            digits++;
+        } else {
+            dropped++;
+            truncated |= str[i] != '0';
+        }
+        i++;
+    }
+    exp10 = dropped;
+    bool any_digits = i > start;
+    
+    if (i < len && str[i] == '.') {
+        i++;
+        size_t frac_start = i;
+        if (digits == 0) {
+            /* Leading zeros of the fraction only move the exponent */
+            while (i < len && str[i] == '0') {
+                i++;
+                exp10--;
+            }
+        }
+        while (i < len && (unsigned)(str[i] - '0') < 10) {
+            if (digits < 19) {
+                man = man * 10 + (uint64_t)(str[i] - '0');
+                digits++;
+                exp10--;
+            } else {
+                truncated |= str[i] != '0';
+            }
+            i++;
+        }
+        any_digits |= i > frac_start;
+    }
+    
+    if (!any_digits) {
+        /* inf, nan, or not a number */
+        return parse_fallback(str, len, value);
+    }
+    
+    if (i < len && (str[i] == 'e' || str[i] == 'E')) {
+        size_t exp_start = i++;
+        bool exp_negative = false;
+        if (i < len && (str[i] == '-' || str[i] == '+')) {
+            exp_negative = str[i] == '-';
+            i++;
+        }
+        if (i < len && (unsigned)(str[i] - '0') < 10) {
+            int e = 0;
+            while (i < len && (unsigned)(str[i] - '0') < 10) {
+                if (e < 100000) {
+                    e = e * 10 + (str[i] - '0');
+                }
+                i++;
+            }
+            exp10 += exp_negative ? -e : e;
+        } else {
+            /* "1e" parses as 1 */
+            i = exp_start;
+        }
+    }
+    
+    if (truncated) {
+        return parse_fallback(str, i, value);
+    }
+    
+    /* Exact when both the significand and the power of ten are exact doubles */
+    if (man <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        double d = (double)man;
+        d = exp10 < 0 ? d / exact_pow10[-exp10] : d * exact_pow10[exp10];
+        *value = negative ? -d : d;
+        return i;
+    }
+    
+    if (eisel_lemire(man, exp10, negative, value)) {
+        return i;
+    }
+    return parse_fallback(str, i, value);
+}
+
 /* Type conversion */
 double xc_to_number(xc_runtime_t *rt, xc_object_t *obj) {
     if (!obj) {
@@ -152,9 +710,16 @@ double xc_to_number(xc_runtime_t *rt, xc_object_t *obj) {
     }
     
     if (xc_is_string(rt, obj)) {
-        const char *str = xc_string_value(rt, obj);
+        const char *str = xc_string_data(rt, obj);
         if (!str) return 0.0;
-        return atof(str);
+        size_t len = xc_string_length(rt, obj);
+        /* Leading whitespace is skipped, like atof */
+        while (len > 0 && isspace((unsigned char)*str)) {
+            str++;
+            len--;
+        }
+        double value;
+        return xc_number_parse(str, len, &value) ? value : 0.0;
     }
     
     return 0.0;
@@ -1,94 +1,533 @@
 #include "../xc.h"
 #include "../xc_internal.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /* Forward declarations */
-static void object_mark(xc_runtime_t *rt, xc_object_t *obj);
-static void object_free(xc_runtime_t *rt, xc_object_t *obj);
-static bool object_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
-static int object_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+static void object_mark(xc_object_t *obj, mark_func mark);
+static int object_free(xc_val obj);
+static bool object_equal(xc_val a, xc_val b);
+static int object_compare(xc_val a, xc_val b);
 static xc_val object_creator(int type, va_list args);
 
-/* Initial capacity for object properties */
+/* Initial capacity for object properties once they leave the inline slots */
 #define INITIAL_CAPACITY 8
 
-/* Internal helper: Find property by key */
-static xc_property_t *find_property(xc_object_data_t *obj, const char *key) {
-    for (size_t i = 0; i < obj->count; i++) {
-        const char *prop_key = xc_string_value(NULL, obj->properties[i].key);
-        if (strcmp(prop_key, key) == 0) {
-            return &obj->properties[i];
+/* Size of the per-thread (shape, key) -> slot lookup cache */
+#define SHAPE_LOOKUP_CACHE_SIZE 256
+
+/* Root of the shape transition tree: the empty object */
+static xc_shape_t root_shape = {0};
+
+/* Serializes creation of new transitions; lookups are lock-free */
+static pthread_mutex_t shape_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Shapes created so far (guarded by shape_lock) */
+static uint32_t shape_count = 0;
+
+/* Per-thread cache for uncached property lookups (xc_object_get/set) */
+typedef struct {
+    xc_shape_t *shape;
+    unsigned int hash;
+    uint32_t slot;
+} shape_lookup_entry_t;
+
+static __thread shape_lookup_entry_t shape_lookup_cache[SHAPE_LOOKUP_CACHE_SIZE];
+
+/* Internal helper: Hash a property key (FNV-1a) */
+static inline unsigned int key_hash(const char *key) {
+    unsigned int hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Internal helper: Find the slot of key in shape, -1 if absent */
+static int shape_find_slot(xc_shape_t *shape, const char *key, unsigned int hash) {
+    for (uint32_t i = 0; i < shape->slot_count; i++) {
+        if (shape->hashes[i] == hash && strcmp(shape->keys[i], key) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* Internal helper: Find an existing transition for key */
+static xc_shape_t *shape_find_transition(xc_shape_t *shape, const char *key, unsigned int hash) {
+    xc_shape_t *child = __atomic_load_n(&shape->children, __ATOMIC_ACQUIRE);
+    while (child) {
+        if (child->hash == hash && strcmp(child->key, key) == 0) {
+            return child;
         }
+        child = child->sibling;
     }
     return NULL;
 }
 
+/* Internal helper: Get (or create) the shape reached by adding key.
+ * NULL when the transition budget is used up (or on allocation failure):
+ * the caller keeps the object in dictionary mode instead. */
+static xc_shape_t *shape_add_key(xc_shape_t *shape, const char *key, unsigned int hash) {
+    xc_shape_t *child = shape_find_transition(shape, key, hash);
+    if (child) {
+        return child;
+    }
+
+    pthread_mutex_lock(&shape_lock);
+
+    /* Another thread may have added the transition meanwhile */
+    child = shape_find_transition(shape, key, hash);
+    if (child) {
+        pthread_mutex_unlock(&shape_lock);
+        return child;
+    }
+    if (shape->child_count >= XC_SHAPE_MAX_TRANSITIONS || shape_count >= XC_SHAPE_MAX_COUNT) {
+        pthread_mutex_unlock(&shape_lock);
+        return NULL;
+    }
+
+    uint32_t count = shape->slot_count + 1;
+    child = (xc_shape_t *)calloc(1, sizeof(xc_shape_t));
+    char *key_copy = strdup(key);
+    const char **keys = (const char **)malloc(count * sizeof(const char *));
+    unsigned int *hashes = (unsigned int *)malloc(count * sizeof(unsigned int));
+    if (!child || !key_copy || !keys || !hashes) {
+        free(child);
+        free(key_copy);
+        free(keys);
+        free(hashes);
+        pthread_mutex_unlock(&shape_lock);
+        return NULL;
+    }
+
+    if (shape->slot_count) {
+        memcpy(keys, shape->keys, shape->slot_count * sizeof(const char *));
+        memcpy(hashes, shape->hashes, shape->slot_count * sizeof(unsigned int));
+    }
+    keys[count - 1] = key_copy;
+    hashes[count - 1] = hash;
+
+    child->parent = shape;
+    child->key = key_copy;
+    child->hash = hash;
+    child->slot_count = count;
+    child->keys = keys;
+    child->hashes = hashes;
+    child->sibling = shape->children;
+    shape->child_count++;
+    shape_count++;
+
+    /* Publish only after the child is fully initialized */
+    __atomic_store_n(&shape->children, child, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&shape_lock);
+    return child;
+}
+
+/* Internal helper: Find the slot of key in an object, -1 if absent */
+static int find_slot(xc_object_data_t *obj, const char *key, unsigned int hash) {
+    xc_shape_t *shape = obj->shape;
+    if (shape->slot_count == 0) {
+        return -1;
+    }
+
+    uintptr_t index = (((uintptr_t)shape >> 4) ^ hash) & (SHAPE_LOOKUP_CACHE_SIZE - 1);
+    shape_lookup_entry_t *entry = &shape_lookup_cache[index];
+    if (entry->shape == shape && entry->hash == hash &&
+        strcmp(shape->keys[entry->slot], key) == 0) {
+        return (int)entry->slot;
+    }
+
+    int slot = shape_find_slot(shape, key, hash);
+    if (slot >= 0) {
+        entry->shape = shape;
+        entry->hash = hash;
+        entry->slot = (uint32_t)slot;
+    }
+    return slot;
+}
+
 /* Internal helper: Ensure capacity */
 static bool ensure_capacity(xc_runtime_t *rt, xc_object_data_t *obj, size_t needed) {
     if (needed <= obj->capacity) {
         return true;
     }
 
-    size_t new_capacity = obj->capacity == 0 ? INITIAL_CAPACITY : obj->capacity * 2;
+    size_t new_capacity = obj->capacity < INITIAL_CAPACITY ? INITIAL_CAPACITY : obj->capacity * 2;
     while (new_capacity < needed) {
         new_capacity *= 2;
     }
 
-    xc_property_t *new_props = realloc(obj->properties, new_capacity * sizeof(xc_property_t));
-    if (!new_props) {
+    xc_object_t **new_slots;
+    if (obj->slots == obj->inline_slots) {
+        new_slots = malloc(new_capacity * sizeof(xc_object_t *));
+        if (new_slots) {
+            memcpy(new_slots, obj->inline_slots, sizeof(obj->inline_slots));
+        }
+    } else {
+        new_slots = realloc(obj->slots, new_capacity * sizeof(xc_object_t *));
+    }
+    if (!new_slots) {
         return false;
     }
 
-    obj->properties = new_props;
+    obj->slots = new_slots;
     obj->capacity = new_capacity;
     return true;
 }
 
+/* Internal helper: Append a new property, moving the object to a new shape */
+static void add_property(xc_runtime_t *rt, xc_object_data_t *obj, xc_shape_t *next, xc_object_t *value) {
+    uint32_t slot = obj->shape->slot_count;
+    if (!next || !ensure_capacity(rt, obj, slot + 1)) {
+        return;
+    }
+    obj->slots[slot] = value;
+    obj->shape = next;
+}
+
+/* Internal helper: Initialize an empty object */
+static void object_init(xc_object_data_t *obj) {
+    ((xc_object_t *)obj)->type_id = XC_TYPE_OBJECT;
+    obj->shape = &root_shape;
+    obj->slots = obj->inline_slots;
+    obj->capacity = XC_OBJECT_INLINE_SLOTS;
+    obj->prototype = NULL;
+    obj->dict = NULL;
+}
+
+/* Shape of objects in dictionary mode; never matches an inline cache */
+static xc_shape_t dictionary_shape = {0};
+
+/* Control byte of an empty bucket; full buckets hold the top 7 hash bits */
+#define DICT_EMPTY 0x80
+/* Buckets probed at once (one SSE2 compare) */
+#define DICT_GROUP 16
+
+static inline uint8_t dict_h2(unsigned int hash) {
+    return (uint8_t)(hash >> 25);
+}
+
+/* Bitmask of the buckets in the group starting at ctrl whose byte equals byte */
+static inline uint32_t dict_group_match(const uint8_t *ctrl, uint8_t byte) {
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < DICT_GROUP; i++) {
+        if (ctrl[i] == byte) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/* Write a control byte, keeping the mirrored tail used by wrap-around loads */
+static inline void dict_set_ctrl(xc_dict_t *d, uint32_t bucket, uint8_t byte) {
+    d->ctrl[bucket] = byte;
+    if (bucket < DICT_GROUP) {
+        d->ctrl[d->bucket_mask + 1 + bucket] = byte;
+    }
+}
+
+/* Find the bucket holding key, -1 if absent */
+static int64_t dict_find(xc_dict_t *d, const char *key, unsigned int hash) {
+    uint32_t mask = d->bucket_mask;
+    uint32_t pos = hash & mask;
+    uint8_t h2 = dict_h2(hash);
+    
+    for (;;) {
+        const uint8_t *group = d->ctrl + pos;
+        uint32_t match = dict_group_match(group, h2);
+        uint32_t empty = dict_group_match(group, DICT_EMPTY);
+        
+        /* The probe run ends at the first empty bucket */
+        if (empty) {
+            match &= (empty & (0u - empty)) - 1;
+        }
+        while (match) {
+            uint32_t bucket = (pos + __builtin_ctz(match)) & mask;
+            xc_dict_entry_t *entry = &d->entries[d->index[bucket]];
+            if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+                return bucket;
+            }
+            match &= match - 1;
+        }
+        if (empty) {
+            return -1;
+        }
+        pos = (pos + DICT_GROUP) & mask;
+    }
+}
+
+/* Put entry position into the first empty bucket of its probe run */
+static void dict_index_insert(xc_dict_t *d, uint32_t position, unsigned int hash) {
+    uint32_t mask = d->bucket_mask;
+    uint32_t pos = hash & mask;
+    
+    for (;;) {
+        uint32_t empty = dict_group_match(d->ctrl + pos, DICT_EMPTY);
+        if (empty) {
+            uint32_t bucket = (pos + __builtin_ctz(empty)) & mask;
+            dict_set_ctrl(d, bucket, dict_h2(hash));
+            d->index[bucket] = position;
+            return;
+        }
+        pos = (pos + DICT_GROUP) & mask;
+    }
+}
+
+/* Drop deleted entries and rebuild the index with the given bucket count */
+static bool dict_rebuild(xc_dict_t *d, uint32_t buckets) {
+    uint8_t *ctrl = (uint8_t *)malloc(buckets + DICT_GROUP);
+    uint32_t *index = (uint32_t *)malloc(buckets * sizeof(uint32_t));
+    if (!ctrl || !index) {
+        free(ctrl);
+        free(index);
+        return false;
+    }
+    free(d->ctrl);
+    free(d->index);
+    d->ctrl = ctrl;
+    d->index = index;
+    d->bucket_mask = buckets - 1;
+    memset(d->ctrl, DICT_EMPTY, buckets + DICT_GROUP);
+    
+    /* Compact entries, preserving insertion order */
+    uint32_t live = 0;
+    for (uint32_t i = 0; i < d->entry_count; i++) {
+        if (d->entries[i].key) {
+            d->entries[live] = d->entries[i];
+            dict_index_insert(d, live, d->entries[live].hash);
+            live++;
+        }
+    }
+    d->entry_count = live;
+    d->live = live;
+    return true;
+}
+
+/* Append a key known to be absent */
+static bool dict_insert(xc_dict_t *d, const char *key, unsigned int hash, xc_object_t *value) {
+    uint32_t buckets = d->bucket_mask + 1;
+    
+    /* Keep the index at most 3/4 full */
+    if ((d->live + 1) * 4 > buckets * 3) {
+        if (!dict_rebuild(d, buckets * 2)) {
+            return false;
+        }
+    }
+    
+    if (d->entry_count == d->entry_capacity) {
+        /* Reuse the space of deleted entries before growing */
+        if (d->entry_count - d->live >= d->entry_count / 2) {
+            if (!dict_rebuild(d, d->bucket_mask + 1)) {
+                return false;
+            }
+        } else {
+            uint32_t capacity = d->entry_capacity * 2;
+            xc_dict_entry_t *entries = realloc(d->entries, capacity * sizeof(xc_dict_entry_t));
+            if (!entries) {
+                return false;
+            }
+            d->entries = entries;
+            d->entry_capacity = capacity;
+        }
+    }
+    
+    char *key_copy = strdup(key);
+    if (!key_copy) {
+        return false;
+    }
+    
+    uint32_t position = d->entry_count++;
+    d->entries[position].key = key_copy;
+    d->entries[position].hash = hash;
+    d->entries[position].value = value;
+    dict_index_insert(d, position, hash);
+    d->live++;
+    return true;
+}
+
+/* Remove the entry in bucket, shifting later buckets of the run back */
+static void dict_remove(xc_dict_t *d, uint32_t bucket) {
+    uint32_t mask = d->bucket_mask;
+    uint32_t position = d->index[bucket];
+    
+    free(d->entries[position].key);
+    d->entries[position].key = NULL;
+    d->entries[position].value = NULL;
+    d->live--;
+    
+    uint32_t hole = bucket;
+    uint32_t next = (hole + 1) & mask;
+    while (d->ctrl[next] != DICT_EMPTY) {
+        uint32_t home = d->entries[d->index[next]].hash & mask;
+        /* Move back unless the entry's home lies after the hole */
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            dict_set_ctrl(d, hole, d->ctrl[next]);
+            d->index[hole] = d->index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    dict_set_ctrl(d, hole, DICT_EMPTY);
+    
+    /* Trailing deleted entries can be reused immediately */
+    while (d->entry_count > 0 && !d->entries[d->entry_count - 1].key) {
+        d->entry_count--;
+    }
+}
+
+static void dict_free(xc_dict_t *d) {
+    for (uint32_t i = 0; i < d->entry_count; i++) {
+        free(d->entries[i].key);
+    }
+    free(d->entries);
+    free(d->ctrl);
+    free(d->index);
+    free(d);
+}
+
+/* Move an object's properties from its shape into a new dictionary */
+static bool object_to_dictionary(xc_object_data_t *obj) {
+    xc_shape_t *shape = obj->shape;
+    uint32_t count = shape->slot_count;
+    
+    uint32_t buckets = DICT_GROUP;
+    while (buckets * 3 < count * 2 * 4) {
+        buckets *= 2;
+    }
+    
+    xc_dict_t *d = (xc_dict_t *)calloc(1, sizeof(xc_dict_t));
+    if (!d) {
+        return false;
+    }
+    d->entry_capacity = count ? count * 2 : INITIAL_CAPACITY;
+    d->entries = (xc_dict_entry_t *)malloc(d->entry_capacity * sizeof(xc_dict_entry_t));
+    if (!d->entries) {
+        free(d);
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        /* A NULL key would read as a deleted entry and drop the property */
+        d->entries[i].key = strdup(shape->keys[i]);
+        if (!d->entries[i].key) {
+            d->entry_count = i;
+            dict_free(d);
+            return false;
+        }
+        d->entries[i].hash = shape->hashes[i];
+        d->entries[i].value = obj->slots[i];
+    }
+    d->entry_count = count;
+    if (!dict_rebuild(d, buckets)) {
+        dict_free(d);
+        return false;
+    }
+    
+    if (obj->slots != obj->inline_slots) {
+        free(obj->slots);
+    }
+    obj->slots = obj->inline_slots;
+    obj->capacity = XC_OBJECT_INLINE_SLOTS;
+    obj->shape = &dictionary_shape;
+    obj->dict = d;
+    return true;
+}
+
+/* Internal helper: Find the value cell of an own property in either mode */
+static xc_object_t **find_value(xc_object_data_t *obj, const char *key, unsigned int hash) {
+    if (obj->dict) {
+        int64_t bucket = dict_find(obj->dict, key, hash);
+        return bucket < 0 ? NULL : &obj->dict->entries[obj->dict->index[bucket]].value;
+    }
+    int slot = find_slot(obj, key, hash);
+    return slot < 0 ? NULL : &obj->slots[slot];
+}
+
+/* Internal helper: Add a property known to be absent */
+static void insert_property(xc_runtime_t *rt, xc_object_data_t *obj, const char *key, unsigned int hash, xc_object_t *value) {
+    if (!obj->dict) {
+        xc_shape_t *next = obj->shape->slot_count < XC_OBJECT_DICT_THRESHOLD ?
+                           shape_add_key(obj->shape, key, hash) : NULL;
+        if (next) {
+            add_property(rt, obj, next, value);
+            return;
+        }
+        /* Too many keys, or no room left in the transition tree */
+        if (!object_to_dictionary(obj)) {
+            return;
+        }
+    }
+    dict_insert(obj->dict, key, hash, value);
+}
+
 /* Object methods */
-static void object_mark(xc_runtime_t *rt, xc_object_t *obj) {
+static void object_mark(xc_object_t *obj, mark_func mark) {
     xc_object_data_t *object = (xc_object_data_t *)obj;
     
-    /* Mark all properties */
-    for (size_t i = 0; i < object->count; i++) {
-        if (object->properties[i].key) {
-            xc_gc_mark(rt, object->properties[i].key);
+    /* Mark all property values (keys are C strings owned by shapes or the dictionary) */
+    if (object->dict) {
+        for (uint32_t i = 0; i < object->dict->entry_count; i++) {
+            if (object->dict->entries[i].value) {
+                mark(object->dict->entries[i].value);
+            }
         }
-        if (object->properties[i].value) {
-            xc_gc_mark(rt, object->properties[i].value);
+    } else {
+        for (uint32_t i = 0; i < object->shape->slot_count; i++) {
+            if (object->slots[i]) {
+                mark(object->slots[i]);
+            }
         }
     }
     
     /* Mark prototype */
     if (object->prototype) {
-        xc_gc_mark(rt, object->prototype);
+        mark(object->prototype);
     }
 }
 
-static void object_free(xc_runtime_t *rt, xc_object_t *obj) {
+static int object_free(xc_val obj) {
     xc_object_data_t *object = (xc_object_data_t *)obj;
     
-    /* Free all properties */
-    for (size_t i = 0; i < object->count; i++) {
-        if (object->properties[i].key) {
-            //xc_gc_free(rt, object->properties[i].key);
-//TODO xc.delete(object->properties[i].key) ?
-        }
-        if (object->properties[i].value) {
-            //xc_gc_free(rt, object->properties[i].value);
-//TODO xc.delete(object->properties[i].value) ?
-        }
+    /* Free out-of-line slots; values and prototype are reclaimed by the GC */
+    if (object->slots != object->inline_slots) {
+        free(object->slots);
     }
+    object->slots = object->inline_slots;
     
-    /* Free properties array */
-    free(object->properties);
-    
-    /* Free prototype reference */
-    if (object->prototype) {
-        //xc_gc_free(rt, object->prototype);
-//TODO xc.delete(object->prototype);
+    if (object->dict) {
+        dict_free(object->dict);
+        object->dict = NULL;
+    }
+    return 0;
+}
+
+/* foreach callback for object_equal */
+typedef struct {
+    xc_object_data_t *other;
+    bool equal;
+} object_equal_ctx_t;
+
+static void object_equal_visit(xc_runtime_t *rt, const char *key, xc_object_t *value, void *user_data) {
+    object_equal_ctx_t *ctx = (object_equal_ctx_t *)user_data;
+    if (!ctx->equal) {
+        return;
+    }
+    xc_object_t **other = find_value(ctx->other, key, key_hash(key));
+    if (!other || !xc_equal(rt, value, *other)) {
+        ctx->equal = false;
     }
 }
 
-static bool object_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static bool object_equal(xc_val a, xc_val b) {
+    xc_runtime_t *rt = xc_singleton();
     if (!xc_is_object(rt, b)) {
         return false;
     }
@@ -96,35 +535,38 @@ static bool object_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
     xc_object_data_t *obj_a = (xc_object_data_t *)a;
     xc_object_data_t *obj_b = (xc_object_data_t *)b;
     
-    if (obj_a->count != obj_b->count) {
+    if (xc_object_count(rt, a) != xc_object_count(rt, b)) {
         return false;
     }
     
-    /* Compare all properties */
-    for (size_t i = 0; i < obj_a->count; i++) {
-        xc_property_t *prop_a = &obj_a->properties[i];
-        const char *key = xc_string_value(rt, prop_a->key);
-        xc_property_t *prop_b = find_property(obj_b, key);
-        
-        if (!prop_b || !xc_equal(rt, prop_a->value, prop_b->value)) {
-            return false;
+    /* Same shape: compare slot by slot */
+    if (!obj_a->dict && obj_a->shape == obj_b->shape) {
+        for (uint32_t i = 0; i < obj_a->shape->slot_count; i++) {
+            if (!xc_equal(rt, obj_a->slots[i], obj_b->slots[i])) {
+                return false;
+            }
         }
+        return true;
     }
     
-    return true;
+    /* Compare all properties by key */
+    object_equal_ctx_t ctx = {obj_b, true};
+    xc_object_foreach(rt, a, object_equal_visit, &ctx);
+    return ctx.equal;
 }
 
-static int object_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static int object_compare(xc_val a, xc_val b) {
+    xc_runtime_t *rt = xc_singleton();
     if (!xc_is_object(rt, b)) {
         return 1;  /* Objects are greater than non-objects */
     }
     
     /* Compare by number of properties */
-    xc_object_data_t *obj_a = (xc_object_data_t *)a;
-    xc_object_data_t *obj_b = (xc_object_data_t *)b;
+    size_t count_a = xc_object_count(rt, a);
+    size_t count_b = xc_object_count(rt, b);
     
-    if (obj_a->count < obj_b->count) return -1;
-    if (obj_a->count > obj_b->count) return 1;
+    if (count_a < count_b) return -1;
+    if (count_a > count_b) return 1;
     
     return 0;  /* Equal number of properties */
 }
@@ -136,10 +578,7 @@ static xc_val object_creator(int type, va_list args) {
     if (!obj) return NULL;
     
     // 初始化对象属性
-    obj->properties = NULL;
-    obj->count = 0;
-    obj->capacity = 0;
-    obj->prototype = NULL;
+    object_init(obj);
     
     return (xc_val)obj;
 }
@@ -149,12 +588,12 @@ static xc_type_lifecycle_t object_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = object_creator,
-    .destroyer = (xc_destroy_func)object_free,
-    .marker = (xc_marker_func)object_mark,
+    .destroyer = object_free,
+    .marker = object_mark,
     // .allocator = NULL,
     .name = "object",
-    .equal = (bool (*)(xc_val, xc_val))object_equal,
-    .compare = (int (*)(xc_val, xc_val))object_compare,
+    .equal = object_equal,
+    .compare = object_compare,
     .flags = 0
 };
 
@@ -176,116 +615,163 @@ xc_object_t *xc_object_create(xc_runtime_t *rt) {
     }
     
     /* 初始化对象 */
-    ((xc_object_t *)obj)->type_id = XC_TYPE_OBJECT;
-    obj->properties = NULL;
-    obj->count = 0;
-    obj->capacity = 0;
-    obj->prototype = NULL;
+    object_init(obj);
     
     return (xc_object_t *)obj;
 }
 
 /* Object operations */
 xc_object_t *xc_object_get(xc_runtime_t *rt, xc_object_t *obj, const char *key) {
+    assert(xc_is_object(rt, obj));
+    unsigned int hash = key_hash(key);
+    
+    /* Look for property in this object, then in the prototype chain */
+    while (obj) {
+        xc_object_data_t *object = (xc_object_data_t *)obj;
+        xc_object_t **value = find_value(object, key, hash);
+        if (value) {
+            return *value;
+        }
+        obj = object->prototype;
+    }
+    
+    return NULL;
+}
+
+void xc_object_set(xc_runtime_t *rt, xc_object_t *obj, const char *key, xc_object_t *value) {
     assert(xc_is_object(rt, obj));
     xc_object_data_t *object = (xc_object_data_t *)obj;
+    unsigned int hash = key_hash(key);
     
-    /* Look for property in this object */
-    xc_property_t *prop = find_property(object, key);
-    if (prop) {
-        return prop->value;
+    /* Update existing property */
+    xc_object_t **cell = find_value(object, key, hash);
+    if (cell) {
+        *cell = value;
+        return;
     }
     
-    /* Look in prototype chain */
-    if (object->prototype) {
-        return xc_object_get(rt, object->prototype, key);
+    /* Create new property: follow (or create) the shape transition */
+    insert_property(rt, object, key, hash, value);
+}
+
+/* Get with an inline cache: a shape check plus an indexed load on a hit */
+xc_object_t *xc_object_get_cached(xc_runtime_t *rt, xc_object_t *obj, const char *key, xc_inline_cache_t *ic) {
+    assert(xc_is_object(rt, obj));
+    xc_object_data_t *object = (xc_object_data_t *)obj;
+    
+    if (object->shape == ic->shape && !ic->transition) {
+        return object->slots[ic->slot];
     }
     
-    return NULL;
+    /* Dictionary-mode objects are not cached */
+    if (object->dict) {
+        return xc_object_get(rt, obj, key);
+    }
+    
+    int slot = find_slot(object, key, key_hash(key));
+    if (slot < 0) {
+        /* Prototype lookups are not cached */
+        return object->prototype ? xc_object_get(rt, object->prototype, key) : NULL;
+    }
+    
+    ic->shape = object->shape;
+    ic->transition = NULL;
+    ic->slot = (uint32_t)slot;
+    return object->slots[slot];
 }
 
-void xc_object_set(xc_runtime_t *rt, xc_object_t *obj, const char *key, xc_object_t *value) {
+/* Set with an inline cache; also caches the transition for adding the key */
+void xc_object_set_cached(xc_runtime_t *rt, xc_object_t *obj, const char *key, xc_object_t *value, xc_inline_cache_t *ic) {
     assert(xc_is_object(rt, obj));
     xc_object_data_t *object = (xc_object_data_t *)obj;
     
-    /* Look for existing property */
-    xc_property_t *prop = find_property(object, key);
-    if (prop) {
-        /* Update existing property */
-        if (prop->value) {
-            //xc_gc_free(rt, prop->value);
-//TODO xc.delete
+    if (object->shape == ic->shape) {
+        if (!ic->transition) {
+            object->slots[ic->slot] = value;
+        } else {
+            add_property(rt, object, ic->transition, value);
         }
-        prop->value = value;
-        // if (value) {
-        //     xc_gc_add_ref(rt, value);
-        // }
         return;
     }
     
-    /* Create new property */
-    if (!ensure_capacity(rt, object, object->count + 1)) {
+    /* Dictionary-mode objects, and adds that would switch to it, are not cached */
+    if (object->dict || object->shape->slot_count >= XC_OBJECT_DICT_THRESHOLD) {
+        xc_object_set(rt, obj, key, value);
         return;
     }
     
-    /* Create key string */
-    xc_object_t *key_str = xc_string_create(rt, key);
-    if (!key_str) {
+    unsigned int hash = key_hash(key);
+    int slot = find_slot(object, key, hash);
+    if (slot >= 0) {
+        ic->shape = object->shape;
+        ic->transition = NULL;
+        ic->slot = (uint32_t)slot;
+        object->slots[slot] = value;
         return;
     }
     
-    /* Add new property */
-    prop = &object->properties[object->count++];
-    prop->key = key_str;
-    prop->value = value;
-    // if (value) {
-    //     xc_gc_add_ref(rt, value);
-    // }
+    xc_shape_t *next = shape_add_key(object->shape, key, hash);
+    if (!next) {
+        insert_property(rt, object, key, hash, value);
+        return;
+    }
+    ic->shape = object->shape;
+    ic->transition = next;
+    ic->slot = object->shape->slot_count;
+    add_property(rt, object, next, value);
 }
 
 bool xc_object_has(xc_runtime_t *rt, xc_object_t *obj, const char *key) {
     assert(xc_is_object(rt, obj));
-    return find_property((xc_object_data_t *)obj, key) != NULL;
+    return find_value((xc_object_data_t *)obj, key, key_hash(key)) != NULL;
+}
+
+/* Number of own properties */
+size_t xc_object_count(xc_runtime_t *rt, xc_object_t *obj) {
+    assert(xc_is_object(rt, obj));
+    xc_object_data_t *object = (xc_object_data_t *)obj;
+    return object->dict ? object->dict->live : object->shape->slot_count;
 }
 
 // Delete a property from an object. Returns true if the key existed.
 bool xc_object_delete(xc_runtime_t *rt, xc_object_t *obj, const char *key) {
     assert(xc_is_object(rt, obj));
     xc_object_data_t *object = (xc_object_data_t *)obj;
+    unsigned int hash = key_hash(key);
+    
+    /* Shapes only grow: an object that deletes a key leaves the tree for good
+     * instead of creating a new shape path without the key */
+    if (!object->dict && (find_slot(object, key, hash) < 0 || !object_to_dictionary(object))) {
+        return false;
+    }
+    
+    int64_t bucket = dict_find(object->dict, key, hash);
+    if (bucket < 0) {
+        return false;
+    }
+    dict_remove(object->dict, (uint32_t)bucket);
+    return true;
+}
+
+/* Iterate own properties in insertion order */
+void xc_object_foreach(xc_runtime_t *rt, xc_object_t *obj, void (*callback)(xc_runtime_t *rt, const char *key, xc_object_t *value, void *user_data), void *user_data) {
+    assert(xc_is_object(rt, obj));
+    xc_object_data_t *object = (xc_object_data_t *)obj;
     
-    for (size_t i = 0; i < object->count; i++) {
-        const char *prop_key = xc_string_value(rt, object->properties[i].key);
-        if (strcmp(prop_key, key) == 0) {
-            // /* Release property references */
-            // if (object->properties[i].key) {
-            //     xc_gc_release(rt, object->properties[i].key);
-            // }
-            // if (object->properties[i].value) {
-            //     xc_gc_release(rt, object->properties[i].value);
-            // }
-            // 在纯 GC 系统中，我们不需要显式释放引用
-            // 只需要移除引用关系，让 GC 处理不可达对象
-// 重要的不是 memmove 本身，而是引用关系的断开：
-// 在 memmove 之前，对象持有对 "age" 值的引用
-// memmove 后，对象不再持有这个引用
-// 如果没有其他地方引用这个值，它就变成了"不可达"对象
-// 下次 GC 运行时，会识别并回收这个不可达对象
-            /* Move remaining properties */
-            memmove(&object->properties[i], &object->properties[i + 1],
-                   (object->count - i - 1) * sizeof(xc_property_t));
-            object->count--;
-
-            /* Clear the last slot */
-            if (object->count < object->capacity) {
-                object->properties[object->count].key = NULL;
-                object->properties[object->count].value = NULL;
+    if (object->dict) {
+        xc_dict_t *d = object->dict;
+        for (uint32_t i = 0; i < d->entry_count; i++) {
+            if (d->entries[i].key) {
+                callback(rt, d->entries[i].key, d->entries[i].value, user_data);
             }
-            // // 可选：标记对象为灰色，触发重新标记
-            // xc_gc_mark(rt, obj);
-            return true;
         }
+        return;
+    }
+    
+    xc_shape_t *shape = object->shape;
+    for (uint32_t i = 0; i < shape->slot_count; i++) {
+        callback(rt, shape->keys[i], object->slots[i], user_data);
     }
-    return false;
 }
 
 /* Type checking */
@@ -0,0 +1,349 @@
+/*
+ * xc_sort.h - Sorting template, instantiated once per element type
+ *
+ * Define before including:
+ *   SORT_NAME        prefix for the generated functions
+ *   SORT_TYPE        element type (copied by value)
+ *   SORT_LESS(a, b)  strict weak ordering; may use the `ctx` argument
+ *
+ * Generates, all static:
+ *   SORT_NAME_sort(a, n, ctx)          pattern-defeating introsort (unstable)
+ *   SORT_NAME_stable(a, tmp, n, ctx)   merge sort, tmp holds n elements
+ *   SORT_NAME_select(a, n, k, ctx)     moves the k smallest to a[0..k), unordered
+ *   SORT_NAME_merge(a, na, b, nb, out, ctx)  merges two sorted runs into out
+ *
+ * Included only by xc_array.c; there is no include guard. Instantiations
+ * need not use every entry point, hence SORT_API.
+ */
+
+#define SORT_CAT_(a, b) a##_##b
+#define SORT_CAT(a, b) SORT_CAT_(a, b)
+#define SORT_FN(name) SORT_CAT(SORT_NAME, name)
+#define SORT_API static __attribute__((unused))
+
+/* Below this size insertion sort beats partitioning */
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 24
+#endif
+/* Above this size the pivot is a ninther (median of three medians) */
+#ifndef SORT_NINTHER_THRESHOLD
+#define SORT_NINTHER_THRESHOLD 128
+#endif
+/* Element moves allowed before a partial insertion sort gives up */
+#ifndef SORT_PARTIAL_LIMIT
+#define SORT_PARTIAL_LIMIT 8
+#endif
+
+static inline void SORT_FN(swap)(SORT_TYPE *a, SORT_TYPE *b) {
+    SORT_TYPE t = *a;
+    *a = *b;
+    *b = t;
+}
+
+static void SORT_FN(insertion)(SORT_TYPE *a, size_t n, void *ctx) {
+    (void)ctx;
+    for (size_t i = 1; i < n; i++) {
+        SORT_TYPE x = a[i];
+        size_t j = i;
+        while (j > 0 && SORT_LESS(x, a[j - 1])) {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = x;
+    }
+}
+
+/* Insertion sort that bails out after SORT_PARTIAL_LIMIT moves; true if a is now sorted */
+static bool SORT_FN(partial_insertion)(SORT_TYPE *a, size_t n, void *ctx) {
+    (void)ctx;
+    size_t moves = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (!SORT_LESS(a[i], a[i - 1])) {
+            continue;
+        }
+        SORT_TYPE x = a[i];
+        size_t j = i;
+        do {
+            a[j] = a[j - 1];
+            j--;
+        } while (j > 0 && SORT_LESS(x, a[j - 1]));
+        a[j] = x;
+        moves += i - j;
+        if (moves > SORT_PARTIAL_LIMIT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void SORT_FN(sift_down)(SORT_TYPE *a, size_t root, size_t n, void *ctx) {
+    (void)ctx;
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= n) {
+            return;
+        }
+        if (child + 1 < n && SORT_LESS(a[child], a[child + 1])) {
+            child++;
+        }
+        if (!SORT_LESS(a[root], a[child])) {
+            return;
+        }
+        SORT_FN(swap)(&a[root], &a[child]);
+        root = child;
+    }
+}
+
+/* O(n log n) fallback once partitioning keeps going badly */
+static void SORT_FN(heap)(SORT_TYPE *a, size_t n, void *ctx) {
+    for (size_t i = n / 2; i-- > 0;) {
+        SORT_FN(sift_down)(a, i, n, ctx);
+    }
+    for (size_t i = n; i-- > 1;) {
+        SORT_FN(swap)(&a[0], &a[i]);
+        SORT_FN(sift_down)(a, 0, i, ctx);
+    }
+}
+
+/* Orders a[i] <= a[j] <= a[k] */
+static inline void SORT_FN(sort3)(SORT_TYPE *a, size_t i, size_t j, size_t k, void *ctx) {
+    (void)ctx;
+    if (SORT_LESS(a[j], a[i])) SORT_FN(swap)(&a[i], &a[j]);
+    if (SORT_LESS(a[k], a[j])) SORT_FN(swap)(&a[j], &a[k]);
+    if (SORT_LESS(a[j], a[i])) SORT_FN(swap)(&a[i], &a[j]);
+}
+
+/* Moves the chosen pivot to a[0] */
+static void SORT_FN(choose_pivot)(SORT_TYPE *a, size_t n, void *ctx) {
+    size_t mid = n / 2;
+    if (n > SORT_NINTHER_THRESHOLD) {
+        SORT_FN(sort3)(a, 0, mid, n - 1, ctx);
+        SORT_FN(sort3)(a, 1, mid - 1, n - 2, ctx);
+        SORT_FN(sort3)(a, 2, mid + 1, n - 3, ctx);
+        SORT_FN(sort3)(a, mid - 1, mid, mid + 1, ctx);
+    } else {
+        SORT_FN(sort3)(a, mid, 0, n - 1, ctx);
+        return;
+    }
+    SORT_FN(swap)(&a[0], &a[mid]);
+}
+
+/*
+ * Partitions a[1..n) around the pivot in a[0] and places the pivot at the
+ * returned index. Elements equal to the pivot go right. *already is set
+ * when no element had to move, the signature of presorted input.
+ * choose_pivot leaves an element >= pivot on the right, which guards the
+ * first left-to-right scan.
+ */
+static size_t SORT_FN(partition_right)(SORT_TYPE *a, size_t n, bool *already, void *ctx) {
+    (void)ctx;
+    SORT_TYPE pivot = a[0];
+    size_t first = 0;
+    size_t last = n;
+    while (SORT_LESS(a[++first], pivot)) {}
+    if (first == 1) {
+        while (first < last && !SORT_LESS(a[--last], pivot)) {}
+    } else {
+        /* a[first - 1] < pivot guards the right-to-left scan */
+        while (!SORT_LESS(a[--last], pivot)) {}
+    }
+    *already = first >= last;
+    while (first < last) {
+        SORT_FN(swap)(&a[first], &a[last]);
+        while (SORT_LESS(a[++first], pivot)) {}
+        while (!SORT_LESS(a[--last], pivot)) {}
+    }
+    size_t pos = first - 1;
+    a[0] = a[pos];
+    a[pos] = pivot;
+    return pos;
+}
+
+/*
+ * Elements equal to the pivot in a[0] go left; used when the element before
+ * a equals the pivot, so the whole left part is final. Returns its size.
+ */
+static size_t SORT_FN(partition_left)(SORT_TYPE *a, size_t n, void *ctx) {
+    (void)ctx;
+    SORT_TYPE pivot = a[0];
+    size_t first = 0;
+    size_t last = n;
+    while (SORT_LESS(pivot, a[--last])) {}
+    if (last + 1 == n) {
+        while (first < last && !SORT_LESS(pivot, a[++first])) {}
+    } else {
+        while (!SORT_LESS(pivot, a[++first])) {}
+    }
+    while (first < last) {
+        SORT_FN(swap)(&a[first], &a[last]);
+        while (SORT_LESS(pivot, a[--last])) {}
+        while (!SORT_LESS(pivot, a[++first])) {}
+    }
+    a[0] = a[last];
+    a[last] = pivot;
+    return last + 1;
+}
+
+/* Swaps a few fixed elements to break adversarial patterns after an unbalanced split */
+static void SORT_FN(break_patterns)(SORT_TYPE *a, size_t n) {
+    size_t q = n / 4;
+    SORT_FN(swap)(&a[0], &a[q]);
+    SORT_FN(swap)(&a[n - 1], &a[n - q]);
+    if (n > SORT_NINTHER_THRESHOLD) {
+        SORT_FN(swap)(&a[1], &a[q + 1]);
+        SORT_FN(swap)(&a[2], &a[q + 2]);
+        SORT_FN(swap)(&a[n - 2], &a[n - q - 1]);
+        SORT_FN(swap)(&a[n - 3], &a[n - q - 2]);
+    }
+}
+
+/*
+ * pdqsort loop: `bad` counts unbalanced partitions left before heapsort,
+ * `leftmost` says whether a[-1] is a valid sentinel no greater than a[0..n).
+ */
+static void SORT_FN(pdq)(SORT_TYPE *a, size_t n, int bad, bool leftmost, void *ctx) {
+    for (;;) {
+        if (n <= SORT_INSERTION_THRESHOLD) {
+            SORT_FN(insertion)(a, n, ctx);
+            return;
+        }
+
+        SORT_FN(choose_pivot)(a, n, ctx);
+
+        /* Runs of equal keys: a[-1] equal to the pivot means everything <= it is done */
+        if (!leftmost && !SORT_LESS(a[-1], a[0])) {
+            size_t left = SORT_FN(partition_left)(a, n, ctx);
+            a += left;
+            n -= left;
+            continue;
+        }
+
+        bool already = false;
+        size_t pos = SORT_FN(partition_right)(a, n, &already, ctx);
+        size_t left_n = pos;
+        size_t right_n = n - pos - 1;
+
+        if (left_n < n / 8 || right_n < n / 8) {
+            if (--bad <= 0) {
+                SORT_FN(heap)(a, n, ctx);
+                return;
+            }
+            if (left_n >= SORT_INSERTION_THRESHOLD) {
+                SORT_FN(break_patterns)(a, left_n);
+            }
+            if (right_n >= SORT_INSERTION_THRESHOLD) {
+                SORT_FN(break_patterns)(a + pos + 1, right_n);
+            }
+        } else if (already &&
+                   SORT_FN(partial_insertion)(a, left_n, ctx) &&
+                   SORT_FN(partial_insertion)(a + pos + 1, right_n, ctx)) {
+            return;
+        }
+
+        /* Recurse into the smaller side, loop on the larger */
+        if (left_n < right_n) {
+            SORT_FN(pdq)(a, left_n, bad, leftmost, ctx);
+            a += pos + 1;
+            n = right_n;
+            leftmost = false;
+        } else {
+            SORT_FN(pdq)(a + pos + 1, right_n, bad, false, ctx);
+            n = left_n;
+        }
+    }
+}
+
+SORT_API void SORT_FN(sort)(SORT_TYPE *a, size_t n, void *ctx) {
+    if (n < 2) {
+        return;
+    }
+    int bad = 0;
+    for (size_t m = n; m > 1; m >>= 1) {
+        bad++;
+    }
+    SORT_FN(pdq)(a, n, bad, true, ctx);
+}
+
+/* Top-down merge sort; tmp must hold n elements */
+SORT_API void SORT_FN(stable)(SORT_TYPE *a, SORT_TYPE *tmp, size_t n, void *ctx) {
+    if (n <= SORT_INSERTION_THRESHOLD) {
+        SORT_FN(insertion)(a, n, ctx);
+        return;
+    }
+    size_t mid = n / 2;
+    SORT_FN(stable)(a, tmp, mid, ctx);
+    SORT_FN(stable)(a + mid, tmp, n - mid, ctx);
+
+    /* Already in order: nothing to merge */
+    if (!SORT_LESS(a[mid], a[mid - 1])) {
+        return;
+    }
+
+    memcpy(tmp, a, mid * sizeof(SORT_TYPE));
+    size_t i = 0, j = mid, k = 0;
+    while (i < mid && j < n) {
+        /* Ties take the left run, which keeps the sort stable */
+        if (SORT_LESS(a[j], tmp[i])) {
+            a[k++] = a[j++];
+        } else {
+            a[k++] = tmp[i++];
+        }
+    }
+    while (i < mid) {
+        a[k++] = tmp[i++];
+    }
+}
+
+/* Stable merge of sorted a[0..na) and b[0..nb) into out, which overlaps neither */
+SORT_API void SORT_FN(merge)(SORT_TYPE *a, size_t na, SORT_TYPE *b, size_t nb, SORT_TYPE *out, void *ctx) {
+    (void)ctx;
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+        if (SORT_LESS(b[j], a[i])) {
+            *out++ = b[j++];
+        } else {
+            *out++ = a[i++];
+        }
+    }
+    memcpy(out, a + i, (na - i) * sizeof(SORT_TYPE));
+    memcpy(out + (na - i), b + j, (nb - j) * sizeof(SORT_TYPE));
+}
+
+/* Quickselect with a heapsort-style depth limit */
+SORT_API void SORT_FN(select)(SORT_TYPE *a, size_t n, size_t k, void *ctx) {
+    int bad = 0;
+    for (size_t m = n; m > 1; m >>= 1) {
+        bad++;
+    }
+    bad *= 2;
+    while (n > SORT_INSERTION_THRESHOLD && k > 0 && k < n) {
+        if (--bad <= 0) {
+            SORT_FN(heap)(a, n, ctx);
+            return;
+        }
+        SORT_FN(choose_pivot)(a, n, ctx);
+        bool already;
+        size_t pos = SORT_FN(partition_right)(a, n, &already, ctx);
+        if (pos == k || pos + 1 == k) {
+            return;
+        }
+        if (k < pos) {
+            n = pos;
+        } else {
+            a += pos + 1;
+            n -= pos + 1;
+            k -= pos + 1;
+        }
+    }
+    if (k > 0 && k < n) {
+        SORT_FN(insertion)(a, n, ctx);
+    }
+}
+
+#undef SORT_API
+#undef SORT_FN
+#undef SORT_CAT
+#undef SORT_CAT_
+#undef SORT_NAME
+#undef SORT_TYPE
+#undef SORT_LESS
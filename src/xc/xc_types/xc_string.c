@@ -4,54 +4,243 @@
 static xc_runtime_t* rt = NULL;
 
 /* Forward declarations */
-static void string_free(xc_runtime_t *rt, xc_object_t *obj);
-static bool string_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
-static int string_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b);
+static int string_free(xc_val obj);
+static bool string_equal(xc_val a, xc_val b);
+static int string_compare(xc_val a, xc_val b);
 static xc_val string_creator(int type, va_list args);
 
 /* String method implementations */
 static xc_val string_concat_method(xc_val obj, xc_val arg);
 static xc_val string_length_method(xc_val obj, xc_val arg);
+static xc_val string_index_of_method(xc_val obj, xc_val arg);
+static xc_val string_includes_method(xc_val obj, xc_val arg);
+static xc_val string_split_method(xc_val obj, xc_val arg);
+static xc_val string_to_lower_method(xc_val obj, xc_val arg);
+static xc_val string_to_upper_method(xc_val obj, xc_val arg);
+static xc_val string_is_valid_utf8_method(xc_val obj, xc_val arg);
+static xc_val string_code_point_length_method(xc_val obj, xc_val arg);
 
 /* 值访问和类型转换函数 */
 static void* string_get_value(xc_val obj);
 static xc_val string_convert_to(xc_val obj, int target_type);
 
-/* String object structure */
+/* String flags */
+#define STRING_INTERNED   0x1  /* The canonical copy in the intern table */
+#define STRING_HASHED     0x2  /* hash is valid */
+#define STRING_OWNS_CHARS 0x4  /* chars is a malloc'd buffer freed with the string */
+#define STRING_UNTERMINATED 0x8  /* Slice ending before its parent: chars[length] is not NUL */
+
+/* Concatenations shorter than this are copied instead of building a rope */
+#define ROPE_MIN_LENGTH 256
+
+/* Slices shorter than this are copied: a view would not save memory */
+#define SLICE_MIN_LENGTH 32
+/* Slices of parents at least this large that use under 1/SLICE_COMPACT_RATIO
+ * of them are copied, so a small token cannot pin a huge input */
+#define SLICE_COMPACT_PARENT 65536
+#define SLICE_COMPACT_RATIO 16
+
+/*
+ * String object structure.
+ * A flat string points chars at its own data[] (or at an adopted buffer).
+ * A rope (from concat) has chars == NULL and the two halves in left/right
+ * until the first read flattens it into one buffer.
+ * A slice points chars into its parent's characters and keeps the parent
+ * alive through parent.
+ */
 typedef struct {
     xc_object_t base;  /* Must be first */
     size_t length;     /* String length */
+    uint64_t hash;     /* Cached hash, computed on first use */
+    uint32_t flags;    /* STRING_* flags */
+    const char *chars; /* Characters, NULL for an unflattened rope */
+    xc_object_t *left;  /* Rope halves, cleared once flattened */
+    xc_object_t *right;
+    xc_object_t *parent; /* Slice parent, cleared if the slice is copied out */
     char data[];       /* Flexible array member for string data */
 } xc_string_t;
 
+static const char *string_flatten(xc_string_t *str);
+static const char *string_terminate(xc_string_t *str);
+
+/* Characters of any string (length bytes, maybe not NUL-terminated);
+ * NULL with a MemoryError pending if a rope could not be flattened */
+static inline const char *string_chars(xc_string_t *str) {
+    const char *chars = __atomic_load_n(&str->chars, __ATOMIC_ACQUIRE);
+    return chars ? chars : string_flatten(str);
+}
+
+/* NUL-terminated characters of any string; NULL like string_chars */
+static inline const char *string_cstr(xc_string_t *str) {
+    if (__atomic_load_n(&str->flags, __ATOMIC_ACQUIRE) & STRING_UNTERMINATED) {
+        return string_terminate(str);
+    }
+    return string_chars(str);
+}
+
+/*
+ * Intern table: linear probing over string pointers.
+ * One table per thread, like the GC heap that owns the strings, so a
+ * thread never gets back a string from another thread's heap and no lock
+ * is needed. Weak: entries are not GC roots, and string_free (run by the
+ * owning thread's sweep) removes a collected string from the table.
+ */
+#define INTERN_INITIAL_CAPACITY 256
+
+static __thread xc_string_t **intern_table = NULL;
+static __thread size_t intern_capacity = 0;
+static __thread size_t intern_count = 0;
+
+/* Hash string bytes (64-bit FNV-1a) */
+static uint64_t string_hash_bytes(const char *data, size_t len) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* Hash of a string object, cached after the first call
+ * (a rope that cannot be flattened hashes to 0 and is not cached) */
+static inline uint64_t string_hash(xc_string_t *str) {
+    if (!(str->flags & STRING_HASHED)) {
+        const char *chars = string_chars(str);
+        if (!chars) {
+            return 0;
+        }
+        str->hash = string_hash_bytes(chars, str->length);
+        str->flags |= STRING_HASHED;
+    }
+    return str->hash;
+}
+
+/* Find the intern table slot for (data, len): its entry or the empty slot to fill */
+static size_t intern_find_slot(const char *data, size_t len, uint64_t hash) {
+    size_t mask = intern_capacity - 1;
+    size_t i = (size_t)hash & mask;
+    while (intern_table[i]) {
+        xc_string_t *entry = intern_table[i];
+        if (entry->hash == hash && entry->length == len &&
+            memcmp(entry->chars, data, len) == 0) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* Grow the intern table to keep it at most half full */
+static bool intern_grow(void) {
+    size_t old_capacity = intern_capacity;
+    xc_string_t **old_table = intern_table;
+    size_t capacity = old_capacity ? old_capacity * 2 : INTERN_INITIAL_CAPACITY;
+    
+    xc_string_t **table = (xc_string_t **)calloc(capacity, sizeof(xc_string_t *));
+    if (!table) {
+        return false;
+    }
+    intern_table = table;
+    intern_capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++) {
+        xc_string_t *entry = old_table[i];
+        if (entry) {
+            intern_table[intern_find_slot(entry->chars, entry->length, entry->hash)] = entry;
+        }
+    }
+    free(old_table);
+    return true;
+}
+
+/* Remove a collected string, shifting later entries of its probe run back */
+static void intern_remove(xc_string_t *str) {
+    if (intern_capacity == 0) {
+        return;
+    }
+    size_t mask = intern_capacity - 1;
+    size_t hole = intern_find_slot(str->chars, str->length, str->hash);
+    if (intern_table[hole] == str) {
+        size_t next = (hole + 1) & mask;
+        while (intern_table[next]) {
+            size_t home = (size_t)intern_table[next]->hash & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                intern_table[hole] = intern_table[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        intern_table[hole] = NULL;
+        intern_count--;
+    }
+}
+
 /* String methods */
 static void string_mark(xc_object_t *obj, mark_func mark) {
-    /* Strings don't have references to other objects */
+    /* Unflattened ropes reference their halves, slices their parent */
+    xc_string_t *str = (xc_string_t *)obj;
+    if (str->left) {
+        mark(str->left);
+    }
+    if (str->right) {
+        mark(str->right);
+    }
+    if (str->parent) {
+        mark(str->parent);
+    }
 }
 
-static void string_free(xc_runtime_t *rt, xc_object_t *obj) {
-    /* 不需要额外的清理，因为字符串数据是直接跟在对象后面的 */
+static int string_free(xc_val obj) {
+    /* 字符串数据一般直接跟在对象后面；驻留的字符串移出驻留表，释放拼接/构建得到的缓冲区 */
+    xc_string_t *str = (xc_string_t *)obj;
+    if (str->flags & STRING_INTERNED) {
+        intern_remove(str);
+    }
+    if (str->flags & STRING_OWNS_CHARS) {
+        free((char *)str->chars);
+    }
+    return 0;
 }
 
-static bool string_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static bool string_equal(xc_val a, xc_val b) {
+    if (a == b) {
+        return true;
+    }
     if (!xc_is_string(rt, b)) {
         return false;
     }
     xc_string_t *str_a = (xc_string_t *)a;
     xc_string_t *str_b = (xc_string_t *)b;
     
-    return str_a->length == str_b->length &&
-           memcmp(str_a->data, str_b->data, str_a->length) == 0;
+    if (str_a->length != str_b->length) {
+        return false;
+    }
+    if ((str_a->flags & str_b->flags & STRING_HASHED) && str_a->hash != str_b->hash) {
+        return false;
+    }
+    const char *chars_a = string_chars(str_a);
+    const char *chars_b = string_chars(str_b);
+    if (!chars_a || !chars_b) {
+        return false;
+    }
+    return xc_simd_mismatch(chars_a, chars_b, str_a->length) == str_a->length;
 }
 
-static int string_compare(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+static int string_compare(xc_val a, xc_val b) {
     if (!xc_is_string(rt, b)) {
         return 1; /* Strings are greater than non-strings */
     }
     xc_string_t *str_a = (xc_string_t *)a;
     xc_string_t *str_b = (xc_string_t *)b;
     
-    return strcmp(str_a->data, str_b->data);
+    /* Byte order, then length (the shorter prefix sorts first) */
+    const unsigned char *chars_a = (const unsigned char *)string_chars(str_a);
+    const unsigned char *chars_b = (const unsigned char *)string_chars(str_b);
+    size_t len = str_a->length < str_b->length ? str_a->length : str_b->length;
+    size_t i = chars_a && chars_b ? xc_simd_mismatch((const char *)chars_a, (const char *)chars_b, len) : len;
+    if (i < len) {
+        return chars_a[i] < chars_b[i] ? -1 : 1;
+    }
+    return (str_a->length > str_b->length) - (str_a->length < str_b->length);
 }
 
 /* String creator function for use with create() */
@@ -65,13 +254,15 @@ static xc_type_lifecycle_t string_type = {
     .initializer = NULL,
     .cleaner = NULL,
     .creator = string_creator,
-    .destroyer = (xc_destroy_func)string_free,
+    .destroyer = string_free,
     .marker = string_mark,
     // .allocator = NULL,
     .name = "string",
-    .equal = (bool (*)(xc_val, xc_val))string_equal,
-    .compare = (int (*)(xc_val, xc_val))string_compare,
-    .flags = XC_TYPE_PRIMITIVE
+    .equal = string_equal,
+    .compare = string_compare,
+    .flags = XC_TYPE_PRIMITIVE,
+    .get_value = string_get_value,
+    .convert_to = string_convert_to
 };
 
 /* Register string type */
@@ -85,16 +276,23 @@ void xc_register_string_type(xc_runtime_t *caller_rt) {
     /* 注册字符串方法 */
     rt->register_method(XC_TYPE_STRING, "concat", string_concat_method);
     rt->register_method(XC_TYPE_STRING, "length", string_length_method);
+    rt->register_method(XC_TYPE_STRING, "indexOf", string_index_of_method);
+    rt->register_method(XC_TYPE_STRING, "includes", string_includes_method);
+    rt->register_method(XC_TYPE_STRING, "split", string_split_method);
+    rt->register_method(XC_TYPE_STRING, "toLowerCase", string_to_lower_method);
+    rt->register_method(XC_TYPE_STRING, "toUpperCase", string_to_upper_method);
+    rt->register_method(XC_TYPE_STRING, "isValidUTF8", string_is_valid_utf8_method);
+    rt->register_method(XC_TYPE_STRING, "codePointLength", string_code_point_length_method);
     
     /* 设置生命周期函数 */
     string_type.initializer = NULL;
     string_type.cleaner = NULL;
     string_type.creator = string_creator;
-    string_type.destroyer = (xc_destroy_func)string_free;
+    string_type.destroyer = string_free;
     string_type.marker = (xc_marker_func)string_mark;
     string_type.name = "string";
-    string_type.equal = (void*)string_equal;
-    string_type.compare = (void*)string_compare;
+    string_type.equal = string_equal;
+    string_type.compare = string_compare;
     
     /* 新增：值访问和类型转换 */
     string_type.get_value = string_get_value;
@@ -112,6 +310,12 @@ static xc_object_t *string_alloc(xc_runtime_t *rt, size_t len) {
     /* 初始化对象 */
     ((xc_object_t *)obj)->type_id = XC_TYPE_STRING;
     obj->length = len;
+    obj->hash = 0;
+    obj->flags = 0;
+    obj->chars = obj->data;
+    obj->left = NULL;
+    obj->right = NULL;
+    obj->parent = NULL;
     
     return (xc_object_t *)obj;
 }
@@ -139,16 +343,75 @@ xc_object_t *xc_string_create(xc_runtime_t *rt, const char *value) {
     return xc_string_create_len(rt, value, value ? strlen(value) : 0);
 }
 
+/* Get the interned string for value[0..len), creating it on first use */
+xc_object_t *xc_string_intern_len(xc_runtime_t *rt, const char *value, size_t len) {
+    uint64_t hash = string_hash_bytes(value, len);
+    
+    if (intern_capacity > 0) {
+        xc_string_t *found = intern_table[intern_find_slot(value, len, hash)];
+        if (found) {
+            return (xc_object_t *)found;
+        }
+    }
+    
+    /* Allocate before picking a slot: the allocation may collect, and the
+     * sweep removes entries from this table */
+    xc_string_t *str = (xc_string_t *)xc_string_create_len(rt, value, len);
+    if (!str) {
+        return NULL;
+    }
+    if ((intern_count + 1) * 2 > intern_capacity && !intern_grow()) {
+        return NULL;
+    }
+    str->hash = hash;
+    str->flags = STRING_INTERNED | STRING_HASHED;
+    intern_table[intern_find_slot(value, len, hash)] = str;
+    intern_count++;
+    
+    return (xc_object_t *)str;
+}
+
+/* Get the interned string for a C string */
+xc_object_t *xc_string_intern(xc_runtime_t *rt, const char *value) {
+    return xc_string_intern_len(rt, value, strlen(value));
+}
+
+bool xc_string_is_interned(xc_runtime_t *rt, xc_object_t *obj) {
+    assert(xc_is_string(rt, obj));
+    return (((xc_string_t *)obj)->flags & STRING_INTERNED) != 0;
+}
+
+/* Content equality; cached hashes reject most mismatches without reading bytes */
+bool xc_string_equal(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
+    assert(xc_is_string(rt, a));
+    return string_equal(a, b);
+}
+
+/* 64-bit content hash, cached in the string */
+uint64_t xc_string_hash(xc_runtime_t *rt, xc_object_t *obj) {
+    assert(xc_is_string(rt, obj));
+    return string_hash((xc_string_t *)obj);
+}
+
 /* Type checking */
 bool xc_is_string(xc_runtime_t *rt, xc_object_t *obj) {
     return obj && obj->type_id == XC_TYPE_STRING;
 }
 
-/* Value access */
+/* Value access: NULL, with a MemoryError pending, if the characters of a
+ * rope or slice could not be copied into a terminated buffer */
 const char *xc_string_value(xc_runtime_t *rt, xc_object_t *obj) {
     assert(xc_is_string(rt, obj));
     xc_string_t *str = (xc_string_t *)obj;
-    return str->data;
+    return string_cstr(str);
+}
+
+/* Raw characters: xc_string_length bytes, not necessarily NUL-terminated.
+ * Unlike xc_string_value this never copies a slice out of its parent, but
+ * it can still return NULL (MemoryError pending) for a rope. */
+const char *xc_string_data(xc_runtime_t *rt, xc_object_t *obj) {
+    assert(xc_is_string(rt, obj));
+    return string_chars((xc_string_t *)obj);
 }
 
 /* Length access */
@@ -158,26 +421,164 @@ size_t xc_string_length(xc_runtime_t *rt, xc_object_t *obj) {
     return str->length;
 }
 
+/* Copy a rope's characters into buf (length + 1 bytes) without recursion;
+ * false if the traversal stack could not grow */
+static bool rope_copy(xc_string_t *root, char *buf) {
+    xc_string_t *stack_buf[64];
+    xc_string_t **stack = stack_buf;
+    size_t capacity = 64, depth = 0;
+    size_t end = root->length;
+    xc_string_t *node = root;
+    
+    /* Walk right-to-left so left-leaning ropes (repeated concat) need no stack */
+    for (;;) {
+        const char *chars = __atomic_load_n(&node->chars, __ATOMIC_ACQUIRE);
+        if (chars) {
+            end -= node->length;
+            memcpy(buf + end, chars, node->length);
+            if (depth == 0) {
+                break;
+            }
+            node = stack[--depth];
+            continue;
+        }
+        if (depth == capacity) {
+            xc_string_t **grown = (xc_string_t **)malloc(capacity * 2 * sizeof(xc_string_t *));
+            if (!grown) {
+                if (stack != stack_buf) {
+                    free(stack);
+                }
+                return false;
+            }
+            memcpy(grown, stack, depth * sizeof(xc_string_t *));
+            if (stack != stack_buf) {
+                free(stack);
+            }
+            stack = grown;
+            capacity *= 2;
+        }
+        stack[depth++] = (xc_string_t *)node->left;
+        node = (xc_string_t *)node->right;
+    }
+    
+    if (stack != stack_buf) {
+        free(stack);
+    }
+    buf[root->length] = '\0';
+    return true;
+}
+
+/* Out of memory while copying characters: the string keeps its length, so
+ * hand out no buffer at all rather than one shorter than that */
+static const char *string_out_of_memory(void) {
+    xc_raise(rt, xc_exception_reserved(rt, XC_EXCEPTION_TYPE_MEMORY));
+    return NULL;
+}
+
+/* Flatten a rope into one buffer; safe if several threads race to do it */
+static const char *string_flatten(xc_string_t *str) {
+    char *buf = (char *)malloc(str->length + 1);
+    if (!buf) {
+        return string_out_of_memory();
+    }
+    if (!rope_copy(str, buf)) {
+        free(buf);
+        return string_out_of_memory();
+    }
+    
+    const char *expected = NULL;
+    if (!__atomic_compare_exchange_n(&str->chars, &expected, buf, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(buf);
+        return expected;
+    }
+    __atomic_fetch_or(&str->flags, STRING_OWNS_CHARS, __ATOMIC_RELAXED);
+    /* The halves are no longer needed; let the GC reclaim them */
+    str->left = NULL;
+    str->right = NULL;
+    return buf;
+}
+
+/* Copy an unterminated slice into its own buffer so it can be read as a C string */
+static const char *string_terminate(xc_string_t *str) {
+    const char *chars = __atomic_load_n(&str->chars, __ATOMIC_ACQUIRE);
+    char *buf = (char *)malloc(str->length + 1);
+    if (!buf) {
+        return string_out_of_memory();
+    }
+    memcpy(buf, chars, str->length);
+    buf[str->length] = '\0';
+    
+    if (!__atomic_compare_exchange_n(&str->chars, &chars, buf, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        /* Another thread already copied it */
+        free(buf);
+        return chars;
+    }
+    __atomic_fetch_or(&str->flags, STRING_OWNS_CHARS, __ATOMIC_RELAXED);
+    __atomic_fetch_and(&str->flags, ~STRING_UNTERMINATED, __ATOMIC_RELEASE);
+    str->parent = NULL;
+    return buf;
+}
+
+/* Substring view of len bytes at start, sharing the parent's characters */
+xc_object_t *xc_string_slice(xc_runtime_t *rt, xc_object_t *obj, size_t start, size_t len) {
+    assert(xc_is_string(rt, obj));
+    xc_string_t *parent = (xc_string_t *)obj;
+    
+    if (start > parent->length) {
+        start = parent->length;
+    }
+    if (len > parent->length - start) {
+        len = parent->length - start;
+    }
+    if (start == 0 && len == parent->length) {
+        return obj;
+    }
+    
+    /* Slice the storage owner directly instead of chaining slices */
+    const char *chars = string_chars(parent);
+    if (!chars) {
+        return NULL;
+    }
+    if (parent->parent) {
+        parent = (xc_string_t *)parent->parent;
+    }
+    
+    /* Small slices, and small slices of huge parents, are compacted into a copy */
+    if (len < SLICE_MIN_LENGTH ||
+        (parent->length >= SLICE_COMPACT_PARENT && len < parent->length / SLICE_COMPACT_RATIO)) {
+        return xc_string_create_len(rt, chars + start, len);
+    }
+    
+    xc_string_t *slice = (xc_string_t *)string_alloc(rt, 0);
+    if (!slice) {
+        return NULL;
+    }
+    slice->length = len;
+    slice->chars = chars + start;
+    slice->parent = (xc_object_t *)parent;
+    if (chars + start + len != string_chars(parent) + parent->length) {
+        slice->flags |= STRING_UNTERMINATED;
+    }
+    return (xc_object_t *)slice;
+}
+
 /* String operations */
 xc_object_t *xc_string_concat(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b) {
     assert(xc_is_string(rt, a));
     
-    const char *str_a = xc_string_value(rt, a);
-    size_t len_a = xc_string_length(rt, a);
-    
     /* Convert b to string if needed */
-    char temp[64];
-    const char *str_b;
+    char temp[XC_NUMBER_FORMAT_SIZE];
+    const char *str_b = NULL;
     size_t len_b;
     
     if (xc_is_string(rt, b)) {
-        str_b = xc_string_value(rt, b);
         len_b = xc_string_length(rt, b);
     } else if (xc_is_number(rt, b)) {
         double num = xc_number_value(rt, b);
-        snprintf(temp, sizeof(temp), "%g", num);
+        len_b = xc_number_format(num, temp);
         str_b = temp;
-        len_b = strlen(temp);
     } else if (xc_is_boolean(rt, b)) {
         bool val = xc_boolean_value(rt, b);
         str_b = val ? "true" : "false";
@@ -190,6 +591,35 @@ xc_object_t *xc_string_concat(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b)
         len_b = 8;
     }
     
+    size_t len_a = xc_string_length(rt, a);
+    
+    /* Long results become a rope: O(1) now, one copy when first read */
+    if (len_a + len_b >= ROPE_MIN_LENGTH) {
+        if (str_b) {
+            b = xc_string_create_len(rt, str_b, len_b);
+            if (!b) {
+                return NULL;
+            }
+        }
+        xc_string_t *rope = (xc_string_t *)string_alloc(rt, 0);
+        if (!rope) {
+            return NULL;
+        }
+        rope->length = len_a + len_b;
+        rope->chars = NULL;
+        rope->left = a;
+        rope->right = b;
+        return (xc_object_t *)rope;
+    }
+    
+    if (!str_b) {
+        str_b = xc_string_data(rt, b);
+    }
+    const char *str_a = xc_string_data(rt, a);
+    if (!str_a || !str_b) {
+        return NULL;
+    }
+    
     /* Allocate new string with combined length */
     xc_string_t *result = (xc_string_t *)string_alloc(rt, len_a + len_b);
     if (!result) {
@@ -204,6 +634,212 @@ xc_object_t *xc_string_concat(xc_runtime_t *rt, xc_object_t *a, xc_object_t *b)
     return (xc_object_t *)result;
 }
 
+/* String builder: a growable buffer adopted by the final string */
+void xc_string_builder_init(xc_string_builder_t *sb, size_t capacity) {
+    sb->data = NULL;
+    sb->length = 0;
+    sb->capacity = 0;
+    if (capacity > 0) {
+        sb->data = (char *)malloc(capacity + 1);
+        sb->capacity = sb->data ? capacity : 0;
+    }
+}
+
+/* Make room for extra more bytes, growing geometrically */
+static bool string_builder_reserve(xc_string_builder_t *sb, size_t extra) {
+    size_t needed = sb->length + extra;
+    if (needed <= sb->capacity) {
+        return true;
+    }
+    size_t capacity = sb->capacity ? sb->capacity * 2 : 64;
+    if (capacity < needed) {
+        capacity = needed;
+    }
+    char *data = (char *)realloc(sb->data, capacity + 1);
+    if (!data) {
+        return false;
+    }
+    sb->data = data;
+    sb->capacity = capacity;
+    return true;
+}
+
+bool xc_string_builder_append_len(xc_string_builder_t *sb, const char *value, size_t len) {
+    if (!string_builder_reserve(sb, len)) {
+        return false;
+    }
+    memcpy(sb->data + sb->length, value, len);
+    sb->length += len;
+    return true;
+}
+
+bool xc_string_builder_append(xc_string_builder_t *sb, const char *value) {
+    return xc_string_builder_append_len(sb, value, strlen(value));
+}
+
+bool xc_string_builder_append_char(xc_string_builder_t *sb, char c) {
+    if (!string_builder_reserve(sb, 1)) {
+        return false;
+    }
+    sb->data[sb->length++] = c;
+    return true;
+}
+
+/* Append the characters of a string object */
+bool xc_string_builder_append_string(xc_runtime_t *rt, xc_string_builder_t *sb, xc_object_t *str) {
+    assert(xc_is_string(rt, str));
+    const char *chars = xc_string_data(rt, str);
+    if (!chars) {
+        return false;
+    }
+    return xc_string_builder_append_len(sb, chars, xc_string_length(rt, str));
+}
+
+/* Turn the builder into a string that takes over its buffer (no copy) */
+xc_object_t *xc_string_builder_finish(xc_runtime_t *rt, xc_string_builder_t *sb) {
+    if (!sb->data) {
+        return xc_string_create_len(rt, "", 0);
+    }
+    
+    /* Give back slack from geometric growth */
+    if (sb->capacity > sb->length + sb->length / 4 + 64) {
+        char *data = (char *)realloc(sb->data, sb->length + 1);
+        if (data) {
+            sb->data = data;
+        }
+    }
+    sb->data[sb->length] = '\0';
+    
+    xc_string_t *str = (xc_string_t *)string_alloc(rt, 0);
+    if (!str) {
+        xc_string_builder_free(sb);
+        return NULL;
+    }
+    str->length = sb->length;
+    str->chars = sb->data;
+    str->flags |= STRING_OWNS_CHARS;
+    
+    sb->data = NULL;
+    sb->length = 0;
+    sb->capacity = 0;
+    return (xc_object_t *)str;
+}
+
+void xc_string_builder_free(xc_string_builder_t *sb) {
+    free(sb->data);
+    sb->data = NULL;
+    sb->length = 0;
+    sb->capacity = 0;
+}
+
+/* Search, split and case mapping (SIMD kernels in xc_simd.c) */
+int64_t xc_string_index_of(xc_runtime_t *rt, xc_object_t *str, xc_object_t *needle) {
+    assert(xc_is_string(rt, str) && xc_is_string(rt, needle));
+    const char *chars = xc_string_data(rt, str);
+    const char *needle_chars = xc_string_data(rt, needle);
+    if (!chars || !needle_chars) {
+        return -1;
+    }
+    return xc_simd_find(chars, xc_string_length(rt, str),
+                        needle_chars, xc_string_length(rt, needle));
+}
+
+bool xc_string_includes(xc_runtime_t *rt, xc_object_t *str, xc_object_t *needle) {
+    return xc_string_index_of(rt, str, needle) >= 0;
+}
+
+/* Split on every occurrence of separator; the parts are slices of str */
+xc_object_t *xc_string_split(xc_runtime_t *rt, xc_object_t *str, xc_object_t *separator) {
+    assert(xc_is_string(rt, str));
+    xc_object_t *parts = xc_array_create(rt);
+    if (!parts) {
+        return NULL;
+    }
+    /* 每个切片都是一次分配，可能触发回收。parts 只在这个局部变量里，
+     * 参数也可能是 rt->call 的临时值，切分期间都登记为根 */
+    xc_gc_add_root(rt, &parts);
+    xc_gc_add_root(rt, &str);
+    xc_gc_add_root(rt, &separator);
+    
+    const char *chars = xc_string_data(rt, str);
+    size_t len = xc_string_length(rt, str);
+    
+    if (!chars) {
+        /* A rope that could not be flattened (MemoryError pending) */
+        parts = NULL;
+    } else if (!separator || !xc_is_string(rt, separator)) {
+        /* No separator: the whole string */
+        xc_array_push(rt, parts, str);
+    } else if (xc_string_length(rt, separator) == 0) {
+        /* Empty separator: one part per byte */
+        for (size_t i = 0; i < len; i++) {
+            xc_array_push(rt, parts, xc_string_slice(rt, str, i, 1));
+        }
+    } else {
+        const char *sep = xc_string_data(rt, separator);
+        size_t sep_len = xc_string_length(rt, separator);
+        size_t start = 0;
+        for (;;) {
+            if (!sep) {
+                parts = NULL;
+                break;
+            }
+            int64_t found = xc_simd_find(chars + start, len - start, sep, sep_len);
+            if (found < 0) {
+                break;
+            }
+            xc_array_push(rt, parts, xc_string_slice(rt, str, start, (size_t)found));
+            start += (size_t)found + sep_len;
+        }
+        if (parts) {
+            xc_array_push(rt, parts, xc_string_slice(rt, str, start, len - start));
+        }
+    }
+    
+    xc_gc_remove_root(rt, &separator);
+    xc_gc_remove_root(rt, &str);
+    xc_gc_remove_root(rt, &parts);
+    return parts;
+}
+
+/* ASCII case mapping into a new string */
+static xc_object_t *string_case_map(xc_runtime_t *rt, xc_object_t *str, bool upper) {
+    assert(xc_is_string(rt, str));
+    size_t len = xc_string_length(rt, str);
+    const char *chars = xc_string_data(rt, str);
+    if (!chars) {
+        return NULL;
+    }
+    xc_string_t *result = (xc_string_t *)string_alloc(rt, len);
+    if (!result) {
+        return NULL;
+    }
+    xc_simd_case_map(result->data, chars, len, upper);
+    result->data[len] = '\0';
+    return (xc_object_t *)result;
+}
+
+xc_object_t *xc_string_to_lower(xc_runtime_t *rt, xc_object_t *str) {
+    return string_case_map(rt, str, false);
+}
+
+xc_object_t *xc_string_to_upper(xc_runtime_t *rt, xc_object_t *str) {
+    return string_case_map(rt, str, true);
+}
+
+bool xc_string_is_valid_utf8(xc_runtime_t *rt, xc_object_t *str) {
+    assert(xc_is_string(rt, str));
+    const char *chars = xc_string_data(rt, str);
+    return chars && xc_simd_utf8_validate(chars, xc_string_length(rt, str));
+}
+
+/* Number of code points, assuming valid UTF-8 (0 if a rope cannot be flattened) */
+size_t xc_string_code_point_length(xc_runtime_t *rt, xc_object_t *str) {
+    assert(xc_is_string(rt, str));
+    const char *chars = xc_string_data(rt, str);
+    return chars ? xc_simd_utf8_length(chars, xc_string_length(rt, str)) : 0;
+}
+
 /* String method implementations */
 static xc_val string_concat_method(xc_val obj, xc_val arg) {
     return (xc_val)xc_string_concat(NULL, (xc_object_t *)obj, (xc_object_t *)arg);
@@ -214,6 +850,39 @@ static xc_val string_length_method(xc_val obj, xc_val arg) {
     return (xc_val)xc_number_create(NULL, (double)len);
 }
 
+static xc_val string_index_of_method(xc_val obj, xc_val arg) {
+    if (!xc_is_string(NULL, (xc_object_t *)arg)) {
+        return (xc_val)xc_number_create(NULL, -1);
+    }
+    return (xc_val)xc_number_create(NULL, (double)xc_string_index_of(NULL, (xc_object_t *)obj, (xc_object_t *)arg));
+}
+
+static xc_val string_includes_method(xc_val obj, xc_val arg) {
+    bool found = xc_is_string(NULL, (xc_object_t *)arg) &&
+                 xc_string_includes(NULL, (xc_object_t *)obj, (xc_object_t *)arg);
+    return (xc_val)xc_boolean_create(NULL, found);
+}
+
+static xc_val string_split_method(xc_val obj, xc_val arg) {
+    return (xc_val)xc_string_split(NULL, (xc_object_t *)obj, (xc_object_t *)arg);
+}
+
+static xc_val string_to_lower_method(xc_val obj, xc_val arg) {
+    return (xc_val)xc_string_to_lower(NULL, (xc_object_t *)obj);
+}
+
+static xc_val string_to_upper_method(xc_val obj, xc_val arg) {
+    return (xc_val)xc_string_to_upper(NULL, (xc_object_t *)obj);
+}
+
+static xc_val string_is_valid_utf8_method(xc_val obj, xc_val arg) {
+    return (xc_val)xc_boolean_create(NULL, xc_string_is_valid_utf8(NULL, (xc_object_t *)obj));
+}
+
+static xc_val string_code_point_length_method(xc_val obj, xc_val arg) {
+    return (xc_val)xc_number_create(NULL, (double)xc_string_code_point_length(NULL, (xc_object_t *)obj));
+}
+
 /* Type conversion */
 const char *xc_to_string(xc_runtime_t *rt, xc_object_t *obj) {
     if (!obj) {
@@ -221,7 +890,8 @@ const char *xc_to_string(xc_runtime_t *rt, xc_object_t *obj) {
     }
 
     if (xc_is_string(rt, obj)) {
-        return xc_string_value(rt, obj);
+        const char *value = xc_string_value(rt, obj);
+        return value ? value : "error";
     }
 
     if (xc_is_boolean(rt, obj)) {
@@ -230,9 +900,9 @@ const char *xc_to_string(xc_runtime_t *rt, xc_object_t *obj) {
 
     if (xc_is_number(rt, obj)) {
         /* Convert number to string */
-        char buffer[32];
-        snprintf(buffer, sizeof(buffer), "%.14g", xc_number_value(rt, obj));
-        xc_object_t *str = xc_string_create(rt, buffer);
+        char buffer[XC_NUMBER_FORMAT_SIZE];
+        size_t len = xc_number_format(xc_number_value(rt, obj), buffer);
+        xc_object_t *str = xc_string_create_len(rt, buffer, len);
         if (!str) {
             return "error";
         }
@@ -245,26 +915,33 @@ const char *xc_to_string(xc_runtime_t *rt, xc_object_t *obj) {
 /* 获取字符串值 */
 static void* string_get_value(xc_val obj) {
     xc_string_t* string = (xc_string_t*)obj;
-    // 返回指向字符串数据的指针
-    return string->data;
+    // 返回指向字符串数据的指针（内存不足时为 NULL）
+    return (void*)string_cstr(string);
 }
 
 /* 转换到其他类型 */
 static xc_val string_convert_to(xc_val obj, int target_type) {
     xc_string_t* string = (xc_string_t*)obj;
-    const char* str = string->data;
     
     switch (target_type) {
         case XC_TYPE_BOOL:
             // 非空字符串为true
-            return rt->new(XC_TYPE_BOOL, str && str[0] != '\0');
+            return rt->new(XC_TYPE_BOOL, string->length > 0);
             
         case XC_TYPE_NUMBER: {
-            // 尝试将字符串转换为数字
-            char* end;
-            double value = strtod(str, &end);
-            // 如果转换成功（end不等于str且end指向字符串结束符或空白字符）
-            if (end != str && (*end == '\0' || isspace(*end))) {
+            // 尝试将字符串转换为数字（跳过前导空白，后面只允许空白）
+            const char *data = xc_string_data(rt, (xc_object_t *)obj);
+            size_t len = xc_string_length(rt, (xc_object_t *)obj);
+            if (!data) {
+                return NULL; // 内存不足，MemoryError 已挂起
+            }
+            while (len > 0 && isspace((unsigned char)*data)) {
+                data++;
+                len--;
+            }
+            double value;
+            size_t used = xc_number_parse(data, len, &value);
+            if (used > 0 && (used == len || isspace((unsigned char)data[used]))) {
                 return rt->new(XC_TYPE_NUMBER, value);
             }
             // 转换失败，返回0
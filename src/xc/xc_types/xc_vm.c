@@ -1,7 +1,7 @@
 #include "../xc.h"
 #include "../xc_internal.h"
 
-xc_runtime_t* rt = NULL;
+static xc_runtime_t* rt = NULL;
 
 /**
  * ============================================================================
@@ -91,178 +91,1961 @@ xc_runtime_t* rt = NULL;
  * 为了支持JIT编译，指令结构需要与CPU指令易于映射，同时保持与动态语言特性的兼容。
  */
 
-/* 字节码指令类型 */
+/*
+ * 解释器
+ *
+ * 栈效果（左边先压栈）：
+ *   PUSH_VAL val           -> val
+ *   ADD..MOD, BIT_*, SHx   a b -> a op b         NEG, BIT_NOT, NOT   a -> op a
+ *   EQ..GE, AND, OR        a b -> bool
+ *   LOAD var.index         -> locals[i]          STORE var.index     v ->
+ *   LOAD_GLOBAL str        -> global[str]        STORE_GLOBAL str    v ->
+ *   GET_PROP str           obj -> obj[str]       SET_PROP str        obj v ->
+ *   HAS_PROP/DEL_PROP str  obj -> bool
+ *   NEW_ARRAY i32          v1..vn -> array       NEW_OBJECT          -> object
+ *   GET_ELEM               c k -> c[k]           SET_ELEM            c k v ->
+ *   ARRAY_LEN              arr -> length         ARRAY_PUSH          arr v -> arr
+ *   ARRAY_POP              arr -> value          KEYS                obj -> array
+ *   CALL i32               fn a1..an -> result
+ *   JMP i32; JMP_IF_TRUE/JMP_IF_FALSE i32        cond ->
+ *   TRY_BEGIN addr1        catch 入口栈恢复到 TRY_BEGIN 时的深度再压入异常
+ *   THROW                  v ->                  RET v -> 结束；RET_VOID -> 结束
+ * 执行到代码末尾时，栈顶（如有）作为结果。
+ *
+ * 执行前先做一次栈深度校验：每个位置的栈深度在所有路径上一致、不会下溢，
+ * 跳转目标合法。于是循环内部不需要逐条检查栈边界，只在开始时比较一次
+ * 最大深度和栈大小。
+ *
+ * 紧凑编码：
+ * xc_instruction_t 只是构建用的形式（每条 16 字节）。校验通过后编码成
+ * 字节流，解释器直接在字节流上执行：
+ *   - 操作码 1 字节
+ *   - 常量下标、名字下标、缓存下标、局部变量下标、参数个数用 LEB128
+ *   - 跳转目标和 catch 地址用 4 字节小端的字节偏移，编码前就能算出每条
+ *     指令的位置
+ *   - 提示和调试指令不占字节，跳到它们的目标落在下一条指令上
+ * PUSH_VAL 的值在 xc_vm_emit 时放进常量池，名字放进名字池，指令里只保留
+ * 下标。GC 只标记常量池，不再扫描代码。
+ */
+
+#define XC_VM_DEFAULT_STACK 256
+
+/* 本线程正在运行的 VM，注册为一次 GC 根，经 outer 串起嵌套运行 */
+static __thread xc_object_t *vm_running = NULL;
+static __thread bool vm_root_registered = false;
+
+/* 使用名字操作数的指令，名字保存在名字池 */
+static bool vm_op_has_str(xc_opcode_t op) {
+    switch (op) {
+        case OP_LOAD_GLOBAL: case OP_STORE_GLOBAL:
+        case OP_GET_PROP: case OP_SET_PROP: case OP_HAS_PROP: case OP_DEL_PROP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* 指令出栈/入栈数量，-1 表示解释器不支持该指令 */
+static int vm_stack_effect(const xc_instruction_t *ins, int *pops, int *pushes) {
+    *pops = 0;
+    *pushes = 0;
+    switch (ins->op) {
+        case OP_NOP: case OP_ENTER_SCOPE: case OP_LEAVE_SCOPE: case OP_BREAKPOINT:
+        case OP_LINE_NUM: case OP_SOURCE_POS: case OP_GC_HINT:
+        case OP_JIT_HINT_LOOP: case OP_JIT_HINT_END: case OP_JMP:
+        case OP_TRY_BEGIN: case OP_TRY_END: case OP_RETHROW: case OP_RET_VOID:
+        case OP_COUNT:
+            return 0;
+        case OP_PUSH_VAL: case OP_LOAD: case OP_LOAD_GLOBAL: case OP_NEW_OBJECT:
+            *pushes = 1; return 0;
+        case OP_POP: case OP_STORE: case OP_STORE_GLOBAL: case OP_RET: case OP_THROW:
+        case OP_JMP_IF_TRUE: case OP_JMP_IF_FALSE:
+            *pops = 1; return 0;
+        case OP_DUP:
+            *pops = 1; *pushes = 2; return 0;
+        case OP_SWAP:
+            *pops = 2; *pushes = 2; return 0;
+        case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD:
+        case OP_BIT_AND: case OP_BIT_OR: case OP_BIT_XOR: case OP_SHL: case OP_SHR:
+        case OP_EQ: case OP_NE: case OP_LT: case OP_LE: case OP_GT: case OP_GE:
+        case OP_AND: case OP_OR: case OP_GET_ELEM: case OP_ARRAY_PUSH:
+            *pops = 2; *pushes = 1; return 0;
+        case OP_NEG: case OP_BIT_NOT: case OP_NOT: case OP_GET_PROP: case OP_HAS_PROP:
+        case OP_DEL_PROP: case OP_ARRAY_LEN: case OP_ARRAY_POP: case OP_KEYS:
+            *pops = 1; *pushes = 1; return 0;
+        case OP_SET_PROP:
+            *pops = 2; return 0;
+        case OP_SET_ELEM:
+            *pops = 3; return 0;
+        case OP_NEW_ARRAY:
+            if (ins->operand.i32 < 0) return -1;
+            *pops = ins->operand.i32; *pushes = 1; return 0;
+        case OP_CALL: case OP_TAIL_CALL:
+            if (ins->operand.i32 < 0) return -1;
+            *pops = ins->operand.i32 + 1; *pushes = 1; return 0;
+        default:
+            return -1;
+    }
+}
+
+/* 记录某位置的栈深度，不一致时校验失败 */
+static bool vm_verify_edge(int *heights, int *work, int *work_count, int n, int target, int height) {
+    if (target < 0 || target > n) {
+        return false;
+    }
+    if (heights[target] < 0) {
+        heights[target] = height;
+        work[(*work_count)++] = target;
+        return true;
+    }
+    return heights[target] == height;
+}
+
+/* 校验字节码并计算最大栈深度和局部变量数量，失败返回错误消息；
+ * 成功且 heights_out 非空时交出每条指令的栈深度（-1 为不可达），由调用者释放 */
+static const char *vm_verify(xc_vm_t *vm, int *max_stack, int *max_local, int **heights_out) {
+    int n = vm->code_size;
+    int *heights = (int *)malloc((size_t)(n + 1) * sizeof(int) * 2);
+    if (!heights) {
+        return "Out of memory";
+    }
+    int *work = heights + n + 1;
+    int work_count = 0;
+    const char *error = NULL;
+    
+    for (int i = 0; i <= n; i++) {
+        heights[i] = -1;
+    }
+    *max_stack = 0;
+    *max_local = 0;
+    vm_verify_edge(heights, work, &work_count, n, 0, 0);
+    
+    while (work_count > 0 && !error) {
+        int pc = work[--work_count];
+        if (pc == n) {
+            continue;
+        }
+        const xc_instruction_t *ins = &vm->code[pc];
+        int height = heights[pc];
+        int pops, pushes;
+        if (vm_stack_effect(ins, &pops, &pushes) < 0) {
+            error = "Unsupported opcode";
+            break;
+        }
+        if (height < pops) {
+            error = "Stack underflow";
+            break;
+        }
+        if (vm_op_has_str(ins->op) && (ins->operand.i32 < 0 || ins->operand.i32 >= vm->name_count)) {
+            error = "Invalid name operand";
+            break;
+        }
+        if (ins->op == OP_PUSH_VAL && (ins->operand.i32 < 0 || ins->operand.i32 >= vm->constant_count)) {
+            error = "Invalid constant operand";
+            break;
+        }
+        int next = height - pops + pushes;
+        if (next > *max_stack) {
+            *max_stack = next;
+        }
+        if ((ins->op == OP_LOAD || ins->op == OP_STORE) && ins->operand.var.index + 1 > *max_local) {
+            *max_local = ins->operand.var.index + 1;
+        }
+        
+        bool ok = true;
+        switch (ins->op) {
+            case OP_JMP:
+                ok = vm_verify_edge(heights, work, &work_count, n, ins->operand.i32, next);
+                break;
+            case OP_JMP_IF_TRUE:
+            case OP_JMP_IF_FALSE:
+                ok = vm_verify_edge(heights, work, &work_count, n, ins->operand.i32, next) &&
+                     vm_verify_edge(heights, work, &work_count, n, pc + 1, next);
+                break;
+            case OP_TRY_BEGIN:
+                /* catch 入口：栈恢复到当前深度后压入异常 */
+                if (height + 1 > *max_stack) {
+                    *max_stack = height + 1;
+                }
+                ok = vm_verify_edge(heights, work, &work_count, n, ins->operand.addr_pair.addr1, height + 1) &&
+                     vm_verify_edge(heights, work, &work_count, n, pc + 1, next);
+                break;
+            case OP_RET:
+            case OP_RET_VOID:
+            case OP_THROW:
+            case OP_RETHROW:
+                break;
+            default:
+                ok = vm_verify_edge(heights, work, &work_count, n, pc + 1, next);
+                break;
+        }
+        if (!ok) {
+            error = "Invalid jump target or inconsistent stack depth";
+        }
+    }
+    
+    if (!error && heights_out) {
+        *heights_out = heights;
+    } else {
+        free(heights);
+    }
+    return error;
+}
+
+/* 真值判断 */
+static inline bool vm_truthy(xc_val v) {
+    if (!v) return false;
+    switch (v->type_id) {
+        case XC_TYPE_NULL: return false;
+        case XC_TYPE_BOOL: return xc_boolean_value(rt, v);
+        case XC_TYPE_NUMBER: {
+            double d = xc_number_value(rt, v);
+            return d != 0 && d == d;
+        }
+        case XC_TYPE_STRING: return xc_string_length(rt, v) > 0;
+        default: return true;
+    }
+}
+
+static inline bool vm_is_number(xc_val v) {
+    return v && v->type_id == XC_TYPE_NUMBER;
+}
+
+/* 相等比较：数字按值，其余走类型的 equal */
+static bool vm_equal(xc_val a, xc_val b) {
+    if (a == b) return true;
+    bool a_null = !a || a->type_id == XC_TYPE_NULL;
+    bool b_null = !b || b->type_id == XC_TYPE_NULL;
+    if (a_null || b_null) return a_null && b_null;
+    if (vm_is_number(a) && vm_is_number(b)) {
+        return xc_number_value(rt, a) == xc_number_value(rt, b);
+    }
+    return xc_equal(rt, a, b);
+}
+
+/* 大小比较：数字或字符串，返回 -2 表示类型不可比较 */
+static int vm_compare(xc_val a, xc_val b) {
+    if (vm_is_number(a) && vm_is_number(b)) {
+        double x = xc_number_value(rt, a), y = xc_number_value(rt, b);
+        return x < y ? -1 : x > y ? 1 : x == y ? 0 : 2;
+    }
+    if (a && b && a->type_id == XC_TYPE_STRING && b->type_id == XC_TYPE_STRING) {
+        const char *x = xc_string_value(rt, a), *y = xc_string_value(rt, b);
+        if (!x || !y) {
+            return 2; // 无法展平（MemoryError 已挂起），与 NaN 一样无序
+        }
+        int c = strcmp(x, y);
+        return c < 0 ? -1 : c > 0;
+    }
+    return -2;
+}
+
+static void vm_collect_key(xc_runtime_t *rt, const char *key, xc_object_t *value, void *user_data) {
+    xc_array_push(rt, (xc_object_t *)user_data, xc_string_create(rt, key));
+}
+
+/* 不占字节的提示和调试指令 */
+static bool vm_op_is_hint(xc_opcode_t op) {
+    switch (op) {
+        case OP_NOP: case OP_ENTER_SCOPE: case OP_LEAVE_SCOPE: case OP_BREAKPOINT:
+        case OP_LINE_NUM: case OP_SOURCE_POS: case OP_GC_HINT:
+        case OP_JIT_HINT_LOOP: case OP_JIT_HINT_END:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static int vm_uleb_size(uint32_t value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static uint8_t *vm_put_uleb(uint8_t *p, uint32_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static uint8_t *vm_put_i32(uint8_t *p, int32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+static inline uint32_t vm_read_uleb(const uint8_t **ip) {
+    const uint8_t *p = *ip;
+    uint32_t value = *p++;
+    if (value >= 0x80) {
+        uint32_t byte;
+        int shift = 7;
+        value &= 0x7f;
+        do {
+            byte = *p++;
+            value |= (byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+    }
+    *ip = p;
+    return value;
+}
+
+static inline int32_t vm_read_i32(const uint8_t *p) {
+    return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+/* 编码后的字节数，*caches 累计属性缓存数量 */
+static int vm_encoded_size(const xc_instruction_t *ins, int *caches) {
+    if (vm_op_is_hint(ins->op)) {
+        return 0;
+    }
+    switch (ins->op) {
+        case OP_PUSH_VAL: case OP_NEW_ARRAY: case OP_CALL: case OP_TAIL_CALL:
+        case OP_HAS_PROP: case OP_DEL_PROP:
+            return 1 + vm_uleb_size((uint32_t)ins->operand.i32);
+        case OP_LOAD: case OP_STORE:
+            return 1 + vm_uleb_size(ins->operand.var.index);
+        case OP_LOAD_GLOBAL: case OP_STORE_GLOBAL: case OP_GET_PROP: case OP_SET_PROP:
+            return 1 + vm_uleb_size((uint32_t)ins->operand.i32) + vm_uleb_size((uint32_t)(*caches)++);
+        case OP_JMP: case OP_JMP_IF_TRUE: case OP_JMP_IF_FALSE: case OP_TRY_BEGIN:
+            return 1 + 4;
+        default:
+            return 1;
+    }
+}
+
+/*
+ * 寄存器模式
+ *
+ * 寄存器文件 vm->locals 的布局是 [局部变量 L | 临时寄存器 S | 常量 K]：栈槽 h
+ * 对应临时寄存器 L+h，常量 k 对应 L+S+k，三地址指令的操作数都是寄存器下标。
+ *
+ * 翻译时维护符号栈，记录每个栈槽的值当前在哪个寄存器：PUSH_VAL、LOAD、DUP、
+ * POP 只改符号栈不产生指令；STORE 直接改写上一条指令的目标寄存器。跳转、try
+ * 和跳转目标处把符号栈落实到各自的临时寄存器，CALL/NEW_ARRAY 只落实参数区。
+ * 于是 `LOAD i; PUSH_VAL 1; ADD; STORE i` 翻译成一条 `ADD ri, ri, k1`。
+ *
+ * 快速化（quickening）：ADD、LT/LE/GT/GE、GET_ELEM 的通用形式看到数字（或
+ * 数组加数字下标）时把自己的操作码字节原地改写成特化形式，例如
+ * R_ADD -> R_ADD_NUM_NUM。特化形式只检查一次类型守卫，守卫失败就改回通用
+ * 形式并重新执行这条指令。两种形式的操作数编码相同，只改一个字节。
+ */
 typedef enum {
-    /* 基础栈操作 */
-    OP_NOP,            // 空操作
-    OP_PUSH_VAL,       // 压入值（胖指针类型）
-    OP_POP,            // 弹出栈顶
-    OP_DUP,            // 复制栈顶值
-    OP_SWAP,           // 交换栈顶两个值
-    
-    /* 算术运算 */
-    OP_ADD,            // 加法
-    OP_SUB,            // 减法
-    OP_MUL,            // 乘法
-    OP_DIV,            // 除法
-    OP_MOD,            // 取模
-    OP_NEG,            // 取负
-    
-    /* 位运算 */
-    OP_BIT_AND,        // 按位与
-    OP_BIT_OR,         // 按位或
-    OP_BIT_XOR,        // 按位异或
-    OP_BIT_NOT,        // 按位取反
-    OP_SHL,            // 左移
-    OP_SHR,            // 右移
-    
-    /* 比较运算 */
-    OP_EQ,             // 相等
-    OP_NE,             // 不等
-    OP_LT,             // 小于
-    OP_LE,             // 小于等于
-    OP_GT,             // 大于
-    OP_GE,             // 大于等于
-    
-    /* 逻辑运算 */
-    OP_AND,            // 逻辑与
-    OP_OR,             // 逻辑或
-    OP_NOT,            // 逻辑非
-    
-    /* 变量操作 */
-    OP_STORE,          // 存储变量
-    OP_LOAD,           // 加载变量
-    OP_LOAD_GLOBAL,    // 加载全局变量
-    OP_STORE_GLOBAL,   // 存储全局变量
-    
-    /* 属性操作 - 用于JSON和对象 */
-    OP_GET_PROP,       // 获取属性
-    OP_SET_PROP,       // 设置属性
-    OP_HAS_PROP,       // 检查属性是否存在
-    OP_DEL_PROP,       // 删除属性
-    
-    /* 数组操作 */
-    OP_NEW_ARRAY,      // 创建新数组
-    OP_GET_ELEM,       // 获取数组元素
-    OP_SET_ELEM,       // 设置数组元素
-    OP_ARRAY_LEN,      // 获取数组长度
-    OP_ARRAY_PUSH,     // 数组末尾添加元素
-    OP_ARRAY_POP,      // 弹出数组末尾元素
-    
-    /* 对象操作 */
-    OP_NEW_OBJECT,     // 创建新对象
-    OP_KEYS,           // 获取对象键列表
-    
-    /* 函数操作 */
-    OP_CALL,           // 调用函数，参数: [arg_count]
-    OP_TAIL_CALL,      // 尾调用优化
-    OP_RET,            // 返回，将栈顶值作为返回值
-    OP_RET_VOID,       // 返回void
-    OP_MAKE_CLOSURE,   // 创建闭包函数
-    
-    /* 控制流 */
-    OP_JMP,            // 无条件跳转
-    OP_JMP_IF_TRUE,    // 条件为真时跳转
-    OP_JMP_IF_FALSE,   // 条件为假时跳转
-    
-    /* 异常处理 */
-    OP_TRY_BEGIN,      // 开始try块，参数: [catch_addr, finally_addr]
-    OP_TRY_END,        // 结束try块
-    OP_THROW,          // 抛出异常
-    OP_RETHROW,        // 重新抛出当前异常
-    
-    /* 作用域操作 */
-    OP_ENTER_SCOPE,    // 进入新作用域
-    OP_LEAVE_SCOPE,    // 离开当前作用域
-    
-    /* 类LISP语言特性支持 */
-    OP_CONS,           // 创建cons单元 (a . b)
-    OP_CAR,            // 获取cons单元的第一个元素
-    OP_CDR,            // 获取cons单元的第二个元素
-    OP_IS_SYMBOL,      // 检查是否为符号
-    OP_IS_LIST,        // 检查是否为列表
-    
-    /* 异步支持 */
-    OP_AWAIT,          // 等待Promise完成
-    OP_YIELD,          // 生成器yield
-    OP_RESUME,         // 恢复生成器执行
-    
-    /* 调试支持 */
-    OP_BREAKPOINT,     // 断点
-    OP_LINE_NUM,       // 源代码行号，用于调试和错误报告
-    OP_SOURCE_POS,     // 源代码位置信息
-    
-    /* 内存和GC相关操作 */
-    OP_GC_HINT,        // 提示GC可能是个好时机（优化用）
-    
-    /* JIT优化支持 */
-    OP_JIT_HINT_LOOP,  // 提示JIT编译器这是循环开始（用于热点检测）
-    OP_JIT_HINT_END    // 提示JIT编译器循环结束
-} xc_opcode_t;
-
-/* 字节码指令结构 */
+    R_MOVE, R_SWAP,
+    R_ADD, R_SUB, R_MUL, R_DIV, R_MOD,
+    R_BIT_AND, R_BIT_OR, R_BIT_XOR, R_SHL, R_SHR,
+    R_EQ, R_NE, R_LT, R_LE, R_GT, R_GE, R_AND, R_OR,
+    R_NEG, R_BIT_NOT, R_NOT,
+    R_GET_GLOBAL, R_SET_GLOBAL, R_GET_PROP, R_SET_PROP, R_HAS_PROP, R_DEL_PROP,
+    R_NEW_ARRAY, R_GET_ELEM, R_SET_ELEM, R_ARRAY_LEN, R_ARRAY_PUSH, R_ARRAY_POP,
+    R_NEW_OBJECT, R_KEYS, R_CALL,
+    R_RET, R_RET_VOID, R_JMP, R_JMP_IF_TRUE, R_JMP_IF_FALSE,
+    R_TRY_BEGIN, R_TRY_END, R_THROW, R_RETHROW,
+    /* 运行时改写出的特化形式，翻译器不直接产生 */
+    R_ADD_NUM_NUM, R_LT_NUM, R_LE_NUM, R_GT_NUM, R_GE_NUM, R_GET_ELEM_ARRAY_INT,
+    R_COUNT
+} vm_reg_op_t;
+
+/* 操作数个数（LEB128），是否带 4 字节跳转偏移，第一个操作数是否为目标寄存器 */
+static const struct {
+    uint8_t operands;
+    uint8_t jump;
+    uint8_t dest;
+} vm_reg_info[R_COUNT] = {
+    [R_MOVE] = {2, 0, 1}, [R_SWAP] = {2, 0, 0},
+    [R_ADD] = {3, 0, 1}, [R_SUB] = {3, 0, 1}, [R_MUL] = {3, 0, 1}, [R_DIV] = {3, 0, 1}, [R_MOD] = {3, 0, 1},
+    [R_BIT_AND] = {3, 0, 1}, [R_BIT_OR] = {3, 0, 1}, [R_BIT_XOR] = {3, 0, 1}, [R_SHL] = {3, 0, 1}, [R_SHR] = {3, 0, 1},
+    [R_EQ] = {3, 0, 1}, [R_NE] = {3, 0, 1}, [R_LT] = {3, 0, 1}, [R_LE] = {3, 0, 1}, [R_GT] = {3, 0, 1},
+    [R_GE] = {3, 0, 1}, [R_AND] = {3, 0, 1}, [R_OR] = {3, 0, 1},
+    [R_NEG] = {2, 0, 1}, [R_BIT_NOT] = {2, 0, 1}, [R_NOT] = {2, 0, 1},
+    [R_GET_GLOBAL] = {3, 0, 1}, [R_SET_GLOBAL] = {3, 0, 0}, [R_GET_PROP] = {4, 0, 1}, [R_SET_PROP] = {4, 0, 0},
+    [R_HAS_PROP] = {3, 0, 1}, [R_DEL_PROP] = {3, 0, 1},
+    [R_NEW_ARRAY] = {3, 0, 1}, [R_GET_ELEM] = {3, 0, 1}, [R_SET_ELEM] = {3, 0, 0}, [R_ARRAY_LEN] = {2, 0, 1},
+    [R_ARRAY_PUSH] = {2, 0, 0}, [R_ARRAY_POP] = {2, 0, 1},
+    [R_NEW_OBJECT] = {1, 0, 1}, [R_KEYS] = {2, 0, 1}, [R_CALL] = {3, 0, 1},
+    [R_RET] = {1, 0, 0}, [R_RET_VOID] = {0, 0, 0}, [R_JMP] = {0, 1, 0},
+    [R_JMP_IF_TRUE] = {1, 1, 0}, [R_JMP_IF_FALSE] = {1, 1, 0},
+    [R_TRY_BEGIN] = {1, 1, 0}, [R_TRY_END] = {0, 0, 0}, [R_THROW] = {1, 0, 0}, [R_RETHROW] = {0, 0, 0},
+    [R_ADD_NUM_NUM] = {3, 0, 1}, [R_LT_NUM] = {3, 0, 1}, [R_LE_NUM] = {3, 0, 1}, [R_GT_NUM] = {3, 0, 1},
+    [R_GE_NUM] = {3, 0, 1}, [R_GET_ELEM_ARRAY_INT] = {3, 0, 1},
+};
+
 typedef struct {
-    xc_opcode_t op;     // 操作码
-    union {
-        xc_val val;     // 值（胖指针）
-        double num;     // 数字常量
-        char* str;      // 字符串常量
-        int32_t i32;    // 32位整数
-        int64_t i64;    // 64位整数
-        struct {
-            int32_t addr1;  // 第一个地址参数（用于try/catch等）
-            int32_t addr2;  // 第二个地址参数
-        } addr_pair;
-        struct {
-            uint16_t index;  // 变量或属性索引
-            uint16_t scope;  // 作用域深度
-        } var;
-    } operand;
-} xc_instruction_t;
-
-/* VM 类型数据结构 */
+    uint8_t op;
+    uint32_t x[4];      // 操作数
+    int target;         // 跳转目标（栈指令下标）
+} vm_reg_instr_t;
+
 typedef struct {
-    xc_val* stack;          // 操作数栈
-    int stack_size;         // 栈大小
-    int stack_top;          // 栈顶指针
-    
-    xc_instruction_t* code; // 字节码
-    int code_size;          // 字节码大小
-    int code_capacity;      // 字节码容量
-    int pc;                 // 程序计数器
-    
-    xc_val* call_stack;     // 调用栈
-    int call_stack_size;    // 调用栈大小
-    int call_stack_top;     // 调用栈顶
-    
-    xc_val* scopes;         // 作用域栈
-    int scope_count;        // 作用域数量
-    int scope_capacity;     // 作用域容量
-    
-    xc_val global;          // 全局作用域
-    xc_val exception;       // 当前异常，如果有
-    
-    xc_val result;          // 最后执行结果
-    
-    /* JIT 编译相关 */
-    void* jit_code;         // JIT编译的代码
-    int jit_enabled;        // 是否启用JIT
-    int* hot_spots;         // 热点代码计数器
-} xc_vm_t;
-
-/* Forward declarations */
-static void vm_marker(xc_object_t *obj, mark_func mark);
-static int vm_destroy(xc_val self);
-static void vm_initialize(void);
-static xc_val vm_creator(int type, va_list args);
-static xc_val vm_to_string(xc_val self, xc_val arg);
-static xc_val vm_execute(xc_val self, xc_val arg);
-static xc_val vm_add_instruction(xc_val self, xc_val arg);
-static xc_val vm_reset(xc_val self, xc_val arg);
-static xc_val vm_get_result(xc_val self, xc_val arg);
-static xc_val vm_set_global(xc_val self, xc_val arg);
-static xc_val vm_enable_jit(xc_val self, xc_val arg);
-static xc_val vm_get_exception(xc_val self, xc_val arg);
+    vm_reg_instr_t *code;
+    int count;
+    int capacity;
+    int block_start;    // 当前基本块的第一条寄存器指令
+    uint32_t *sym;      // 符号栈：栈槽 -> 寄存器
+    int height;
+    uint32_t temps;     // 第一个临时寄存器 L
+    bool failed;
+} vm_reg_builder_t;
+
+static vm_reg_instr_t *vm_reg_emit(vm_reg_builder_t *b, vm_reg_op_t op, uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3) {
+    if (b->count >= b->capacity) {
+        int capacity = b->capacity ? b->capacity * 2 : 32;
+        vm_reg_instr_t *code = (vm_reg_instr_t *)realloc(b->code, (size_t)capacity * sizeof(vm_reg_instr_t));
+        if (!code) {
+            b->failed = true;
+            return NULL;
+        }
+        b->code = code;
+        b->capacity = capacity;
+    }
+    vm_reg_instr_t *ins = &b->code[b->count++];
+    ins->op = (uint8_t)op;
+    ins->x[0] = x0;
+    ins->x[1] = x1;
+    ins->x[2] = x2;
+    ins->x[3] = x3;
+    ins->target = 0;
+    return ins;
+}
+
+/* 把栈槽 [from, to) 落实到各自的临时寄存器；从高往低，DUP 只会引用更低的栈槽 */
+static void vm_reg_settle(vm_reg_builder_t *b, int from, int to) {
+    for (int h = to - 1; h >= from; h--) {
+        if (b->sym[h] != b->temps + (uint32_t)h) {
+            vm_reg_emit(b, R_MOVE, b->temps + (uint32_t)h, b->sym[h], 0, 0);
+            b->sym[h] = b->temps + (uint32_t)h;
+        }
+    }
+}
+
+/* 局部变量被改写前，仍引用它旧值的栈槽先拷出来 */
+static bool vm_reg_release_local(vm_reg_builder_t *b, uint32_t local) {
+    bool released = false;
+    for (int h = 0; h < b->height; h++) {
+        if (b->sym[h] == local) {
+            vm_reg_emit(b, R_MOVE, b->temps + (uint32_t)h, local, 0, 0);
+            b->sym[h] = b->temps + (uint32_t)h;
+            released = true;
+        }
+    }
+    return released;
+}
+
+static vm_reg_op_t vm_reg_binary_op(xc_opcode_t op) {
+    switch (op) {
+        case OP_ADD: return R_ADD;
+        case OP_SUB: return R_SUB;
+        case OP_MUL: return R_MUL;
+        case OP_DIV: return R_DIV;
+        case OP_MOD: return R_MOD;
+        case OP_BIT_AND: return R_BIT_AND;
+        case OP_BIT_OR: return R_BIT_OR;
+        case OP_BIT_XOR: return R_BIT_XOR;
+        case OP_SHL: return R_SHL;
+        case OP_SHR: return R_SHR;
+        case OP_EQ: return R_EQ;
+        case OP_NE: return R_NE;
+        case OP_LT: return R_LT;
+        case OP_LE: return R_LE;
+        case OP_GT: return R_GT;
+        case OP_GE: return R_GE;
+        case OP_AND: return R_AND;
+        case OP_OR: return R_OR;
+        case OP_GET_ELEM: return R_GET_ELEM;
+        default: return R_COUNT;
+    }
+}
+
+static vm_reg_op_t vm_reg_unary_op(xc_opcode_t op) {
+    switch (op) {
+        case OP_NEG: return R_NEG;
+        case OP_BIT_NOT: return R_BIT_NOT;
+        case OP_NOT: return R_NOT;
+        case OP_ARRAY_LEN: return R_ARRAY_LEN;
+        case OP_ARRAY_POP: return R_ARRAY_POP;
+        case OP_KEYS: return R_KEYS;
+        default: return R_COUNT;
+    }
+}
+
+/* 由已校验的栈指令翻译出寄存器代码并编码到 vm->regcode */
+static const char *vm_translate_registers(xc_vm_t *vm, const int *heights) {
+    int n = vm->code_size;
+    uint32_t L = (uint32_t)vm->local_count;
+    uint32_t consts = L + (uint32_t)vm->max_stack;
+    vm_reg_builder_t b;
+    memset(&b, 0, sizeof(b));
+    b.temps = L;
+    
+    /* 跳转目标和 catch 入口是基本块起点；reg_start[i] 是栈指令 i 的第一条寄存器指令 */
+    bool *leader = (bool *)calloc((size_t)n + 1, sizeof(bool));
+    int *reg_start = (int *)malloc(((size_t)n + 1) * sizeof(int));
+    b.sym = (uint32_t *)malloc(((size_t)vm->max_stack + 1) * sizeof(uint32_t));
+    if (!leader || !reg_start || !b.sym) {
+        free(leader);
+        free(reg_start);
+        free(b.sym);
+        return "Out of memory";
+    }
+    for (int i = 0; i < n; i++) {
+        const xc_instruction_t *ins = &vm->code[i];
+        if (ins->op == OP_JMP || ins->op == OP_JMP_IF_TRUE || ins->op == OP_JMP_IF_FALSE) {
+            leader[ins->operand.i32] = true;
+        } else if (ins->op == OP_TRY_BEGIN) {
+            leader[ins->operand.addr_pair.addr1] = true;
+        }
+    }
+    
+    bool falls = true;
+    int cache = 0;
+    for (int i = 0; i <= n && !b.failed; i++) {
+        if (falls && leader[i]) {
+            vm_reg_settle(&b, 0, b.height);
+        }
+        reg_start[i] = b.count;
+        if (heights[i] < 0) {
+            /* 不可达；属性访问点仍占一个缓存下标，和字节流编码一致 */
+            if (i < n && (vm->code[i].op == OP_LOAD_GLOBAL || vm->code[i].op == OP_STORE_GLOBAL ||
+                          vm->code[i].op == OP_GET_PROP || vm->code[i].op == OP_SET_PROP)) {
+                cache++;
+            }
+            falls = false;
+            continue;
+        }
+        if (leader[i] || !falls) {
+            b.block_start = b.count;
+            b.height = heights[i];
+            for (int h = 0; h < b.height; h++) {
+                b.sym[h] = L + (uint32_t)h;
+            }
+        }
+        if (i == n) {
+            /* 执行到末尾：栈顶作为结果 */
+            if (b.height > 0) {
+                vm_reg_emit(&b, R_RET, b.sym[b.height - 1], 0, 0, 0);
+            } else {
+                vm_reg_emit(&b, R_RET_VOID, 0, 0, 0, 0);
+            }
+            break;
+        }
+        
+        const xc_instruction_t *ins = &vm->code[i];
+        int t = b.height - 1;
+        uint32_t top = t >= 0 ? L + (uint32_t)t : 0;
+        vm_reg_instr_t *out;
+        vm_reg_op_t op;
+        falls = true;
+        
+        switch (ins->op) {
+            case OP_PUSH_VAL:
+                b.sym[b.height++] = consts + (uint32_t)ins->operand.i32;
+                break;
+            case OP_LOAD:
+                b.sym[b.height++] = ins->operand.var.index;
+                break;
+            case OP_POP:
+                b.height--;
+                break;
+            case OP_DUP:
+                b.sym[b.height] = b.sym[t];
+                b.height++;
+                break;
+            case OP_SWAP:
+                vm_reg_settle(&b, 0, b.height);
+                vm_reg_emit(&b, R_SWAP, top - 1, top, 0, 0);
+                break;
+            case OP_STORE: {
+                uint32_t local = ins->operand.var.index;
+                uint32_t src = b.sym[t];
+                b.height--;
+                vm_reg_instr_t *last = b.count > b.block_start ? &b.code[b.count - 1] : NULL;
+                if (src == local) {
+                    break;
+                }
+                if (vm_reg_release_local(&b, local)) {
+                    last = NULL;
+                }
+                if (last && src == top && vm_reg_info[last->op].dest && last->x[0] == src) {
+                    last->x[0] = local;
+                } else {
+                    vm_reg_emit(&b, R_MOVE, local, src, 0, 0);
+                }
+                break;
+            }
+            case OP_LOAD_GLOBAL:
+                vm_reg_emit(&b, R_GET_GLOBAL, L + (uint32_t)b.height, (uint32_t)ins->operand.i32, (uint32_t)cache++, 0);
+                b.sym[b.height] = L + (uint32_t)b.height;
+                b.height++;
+                break;
+            case OP_STORE_GLOBAL:
+                vm_reg_emit(&b, R_SET_GLOBAL, b.sym[t], (uint32_t)ins->operand.i32, (uint32_t)cache++, 0);
+                b.height--;
+                break;
+            case OP_GET_PROP:
+                vm_reg_emit(&b, R_GET_PROP, top, b.sym[t], (uint32_t)ins->operand.i32, (uint32_t)cache++);
+                b.sym[t] = top;
+                break;
+            case OP_SET_PROP:
+                vm_reg_emit(&b, R_SET_PROP, b.sym[t - 1], b.sym[t], (uint32_t)ins->operand.i32, (uint32_t)cache++);
+                b.height -= 2;
+                break;
+            case OP_HAS_PROP:
+            case OP_DEL_PROP:
+                vm_reg_emit(&b, ins->op == OP_HAS_PROP ? R_HAS_PROP : R_DEL_PROP, top, b.sym[t], (uint32_t)ins->operand.i32, 0);
+                b.sym[t] = top;
+                break;
+            case OP_NEW_ARRAY:
+            case OP_CALL:
+            case OP_TAIL_CALL: {
+                /* 函数和参数需要在连续的寄存器里 */
+                int base = b.height - ins->operand.i32 - (ins->op == OP_NEW_ARRAY ? 0 : 1);
+                vm_reg_settle(&b, base, b.height);
+                vm_reg_emit(&b, ins->op == OP_NEW_ARRAY ? R_NEW_ARRAY : R_CALL, L + (uint32_t)base, L + (uint32_t)base,
+                            (uint32_t)ins->operand.i32, 0);
+                b.sym[base] = L + (uint32_t)base;
+                b.height = base + 1;
+                break;
+            }
+            case OP_SET_ELEM:
+                vm_reg_emit(&b, R_SET_ELEM, b.sym[t - 2], b.sym[t - 1], b.sym[t], 0);
+                b.height -= 3;
+                break;
+            case OP_ARRAY_PUSH:
+                vm_reg_emit(&b, R_ARRAY_PUSH, b.sym[t - 1], b.sym[t], 0, 0);
+                b.height--;
+                break;
+            case OP_NEW_OBJECT:
+                vm_reg_emit(&b, R_NEW_OBJECT, L + (uint32_t)b.height, 0, 0, 0);
+                b.sym[b.height] = L + (uint32_t)b.height;
+                b.height++;
+                break;
+            case OP_RET:
+                vm_reg_emit(&b, R_RET, b.sym[t], 0, 0, 0);
+                falls = false;
+                break;
+            case OP_RET_VOID:
+                vm_reg_emit(&b, R_RET_VOID, 0, 0, 0, 0);
+                falls = false;
+                break;
+            case OP_JMP:
+                vm_reg_settle(&b, 0, b.height);
+                if ((out = vm_reg_emit(&b, R_JMP, 0, 0, 0, 0))) out->target = ins->operand.i32;
+                falls = false;
+                break;
+            case OP_JMP_IF_TRUE:
+            case OP_JMP_IF_FALSE: {
+                uint32_t cond = b.sym[t];
+                b.height--;
+                vm_reg_settle(&b, 0, b.height);
+                out = vm_reg_emit(&b, ins->op == OP_JMP_IF_TRUE ? R_JMP_IF_TRUE : R_JMP_IF_FALSE, cond, 0, 0, 0);
+                if (out) out->target = ins->operand.i32;
+                break;
+            }
+            case OP_TRY_BEGIN:
+                /* catch 入口：异常放在当前栈顶之上的临时寄存器 */
+                vm_reg_settle(&b, 0, b.height);
+                out = vm_reg_emit(&b, R_TRY_BEGIN, L + (uint32_t)b.height, 0, 0, 0);
+                if (out) out->target = ins->operand.addr_pair.addr1;
+                break;
+            case OP_TRY_END:
+                vm_reg_emit(&b, R_TRY_END, 0, 0, 0, 0);
+                break;
+            case OP_THROW:
+                vm_reg_emit(&b, R_THROW, b.sym[t], 0, 0, 0);
+                falls = false;
+                break;
+            case OP_RETHROW:
+                vm_reg_emit(&b, R_RETHROW, 0, 0, 0, 0);
+                falls = false;
+                break;
+            default:
+                if ((op = vm_reg_binary_op(ins->op)) != R_COUNT) {
+                    vm_reg_emit(&b, op, top - 1, b.sym[t - 1], b.sym[t], 0);
+                    b.sym[t - 1] = top - 1;
+                    b.height--;
+                } else if ((op = vm_reg_unary_op(ins->op)) != R_COUNT) {
+                    vm_reg_emit(&b, op, top, b.sym[t], 0, 0);
+                    b.sym[t] = top;
+                }
+                /* 其余是提示和调试指令 */
+                break;
+        }
+    }
+    free(b.sym);
+    free(leader);
+    
+    /* 编码：和栈字节流相同的格式，先算每条指令的偏移再写出 */
+    int *offsets = b.failed ? NULL : (int *)malloc(((size_t)b.count + 1) * sizeof(int));
+    int size = 0;
+    if (offsets) {
+        for (int k = 0; k < b.count; k++) {
+            const vm_reg_instr_t *ins = &b.code[k];
+            offsets[k] = size;
+            size += 1 + (vm_reg_info[ins->op].jump ? 4 : 0);
+            for (int j = 0; j < vm_reg_info[ins->op].operands; j++) {
+                size += vm_uleb_size(ins->x[j]);
+            }
+        }
+        offsets[b.count] = size;
+    }
+    uint8_t *regcode = offsets ? (uint8_t *)realloc(vm->regcode, (size_t)size + 1) : NULL;
+    if (!regcode) {
+        free(offsets);
+        free(reg_start);
+        free(b.code);
+        return "Out of memory";
+    }
+    uint8_t *p = regcode;
+    for (int k = 0; k < b.count; k++) {
+        const vm_reg_instr_t *ins = &b.code[k];
+        *p++ = ins->op;
+        for (int j = 0; j < vm_reg_info[ins->op].operands; j++) {
+            p = vm_put_uleb(p, ins->x[j]);
+        }
+        if (vm_reg_info[ins->op].jump) {
+            p = vm_put_i32(p, offsets[reg_start[ins->target]]);
+        }
+    }
+    *p = (uint8_t)R_COUNT;
+    vm->regcode = regcode;
+    vm->regcode_size = size;
+    vm->reg_instr_count = b.count;
+    free(offsets);
+    free(reg_start);
+    free(b.code);
+    return NULL;
+}
+
+/* 准备执行：校验、编码栈字节流和寄存器代码，建立寄存器文件和属性缓存 */
+static const char *vm_prepare(xc_vm_t *vm) {
+    int max_stack, max_local;
+    int *heights = NULL;
+    const char *error = vm_verify(vm, &max_stack, &max_local, &heights);
+    if (error) {
+        return error;
+    }
+    
+    /* 第一遍：每条指令的字节偏移，offsets[code_size] 为结束哨兵 */
+    int *offsets = (int *)malloc((size_t)(vm->code_size + 1) * sizeof(int));
+    if (!offsets) {
+        free(heights);
+        return "Out of memory";
+    }
+    int size = 0, cache_count = 0;
+    for (int i = 0; i < vm->code_size; i++) {
+        offsets[i] = size;
+        size += vm_encoded_size(&vm->code[i], &cache_count);
+    }
+    offsets[vm->code_size] = size;
+    
+    uint8_t *bytecode = (uint8_t *)realloc(vm->bytecode, (size_t)size + 1);
+    if (bytecode) vm->bytecode = bytecode;
+    if (cache_count > vm->cache_count || !vm->caches) {
+        xc_inline_cache_t *caches = (xc_inline_cache_t *)realloc(vm->caches, (size_t)(cache_count + 1) * sizeof(xc_inline_cache_t));
+        if (caches) vm->caches = caches;
+        else bytecode = NULL;
+    }
+    if (!bytecode) {
+        free(offsets);
+        free(heights);
+        return "Out of memory";
+    }
+    memset(vm->caches, 0, (size_t)(cache_count + 1) * sizeof(xc_inline_cache_t));
+    vm->cache_count = cache_count;
+    
+    /* 第二遍：写出字节流 */
+    uint8_t *p = bytecode;
+    int cache = 0;
+    for (int i = 0; i < vm->code_size; i++) {
+        const xc_instruction_t *ins = &vm->code[i];
+        if (vm_op_is_hint(ins->op)) {
+            continue;
+        }
+        *p++ = (uint8_t)ins->op;
+        switch (ins->op) {
+            case OP_PUSH_VAL: case OP_NEW_ARRAY: case OP_CALL: case OP_TAIL_CALL:
+            case OP_HAS_PROP: case OP_DEL_PROP:
+                p = vm_put_uleb(p, (uint32_t)ins->operand.i32);
+                break;
+            case OP_LOAD: case OP_STORE:
+                p = vm_put_uleb(p, ins->operand.var.index);
+                break;
+            case OP_LOAD_GLOBAL: case OP_STORE_GLOBAL: case OP_GET_PROP: case OP_SET_PROP:
+                p = vm_put_uleb(p, (uint32_t)ins->operand.i32);
+                p = vm_put_uleb(p, (uint32_t)cache++);
+                break;
+            case OP_JMP: case OP_JMP_IF_TRUE: case OP_JMP_IF_FALSE:
+                p = vm_put_i32(p, offsets[ins->operand.i32]);
+                break;
+            case OP_TRY_BEGIN:
+                p = vm_put_i32(p, offsets[ins->operand.addr_pair.addr1]);
+                break;
+            default:
+                break;
+        }
+    }
+    /* 结束哨兵 */
+    *p = (uint8_t)OP_COUNT;
+    vm->bytecode_size = size;
+    free(offsets);
+    
+    /* 寄存器文件 [局部变量 | 临时寄存器 | 常量]，保留已有局部变量的值 */
+    int local_count = max_local > vm->local_count ? max_local : vm->local_count;
+    int reg_count = local_count + max_stack + vm->constant_count;
+    xc_val *regs = (xc_val *)calloc((size_t)reg_count + 1, sizeof(xc_val));
+    if (!regs) {
+        free(heights);
+        return "Out of memory";
+    }
+    if (vm->locals) {
+        memcpy(regs, vm->locals, (size_t)vm->local_count * sizeof(xc_val));
+        free(vm->locals);
+    }
+    memcpy(regs + local_count + max_stack, vm->constants, (size_t)vm->constant_count * sizeof(xc_val));
+    vm->locals = regs;
+    vm->local_count = local_count;
+    vm->reg_count = reg_count;
+    vm->max_stack = max_stack;
+    
+    error = vm_translate_registers(vm, heights);
+    free(heights);
+    if (error) {
+        return error;
+    }
+    vm->prepared_size = vm->code_size;
+    return NULL;
+}
+
+/* 栈模式解释器，执行 vm->bytecode */
+static xc_val vm_run_stack(xc_vm_t *vm) {
+#if XC_VM_THREADED
+    static const void *const labels[OP_COUNT + 1] = {
+        [0 ... OP_COUNT] = &&op_unsupported,
+        [OP_NOP] = &&op_OP_NOP, [OP_PUSH_VAL] = &&op_OP_PUSH_VAL, [OP_POP] = &&op_OP_POP,
+        [OP_DUP] = &&op_OP_DUP, [OP_SWAP] = &&op_OP_SWAP,
+        [OP_ADD] = &&op_OP_ADD, [OP_SUB] = &&op_OP_SUB, [OP_MUL] = &&op_OP_MUL,
+        [OP_DIV] = &&op_OP_DIV, [OP_MOD] = &&op_OP_MOD, [OP_NEG] = &&op_OP_NEG,
+        [OP_BIT_AND] = &&op_OP_BIT_AND, [OP_BIT_OR] = &&op_OP_BIT_OR, [OP_BIT_XOR] = &&op_OP_BIT_XOR,
+        [OP_BIT_NOT] = &&op_OP_BIT_NOT, [OP_SHL] = &&op_OP_SHL, [OP_SHR] = &&op_OP_SHR,
+        [OP_EQ] = &&op_OP_EQ, [OP_NE] = &&op_OP_NE, [OP_LT] = &&op_OP_LT,
+        [OP_LE] = &&op_OP_LE, [OP_GT] = &&op_OP_GT, [OP_GE] = &&op_OP_GE,
+        [OP_AND] = &&op_OP_AND, [OP_OR] = &&op_OP_OR, [OP_NOT] = &&op_OP_NOT,
+        [OP_STORE] = &&op_OP_STORE, [OP_LOAD] = &&op_OP_LOAD,
+        [OP_LOAD_GLOBAL] = &&op_OP_LOAD_GLOBAL, [OP_STORE_GLOBAL] = &&op_OP_STORE_GLOBAL,
+        [OP_GET_PROP] = &&op_OP_GET_PROP, [OP_SET_PROP] = &&op_OP_SET_PROP,
+        [OP_HAS_PROP] = &&op_OP_HAS_PROP, [OP_DEL_PROP] = &&op_OP_DEL_PROP,
+        [OP_NEW_ARRAY] = &&op_OP_NEW_ARRAY, [OP_GET_ELEM] = &&op_OP_GET_ELEM,
+        [OP_SET_ELEM] = &&op_OP_SET_ELEM, [OP_ARRAY_LEN] = &&op_OP_ARRAY_LEN,
+        [OP_ARRAY_PUSH] = &&op_OP_ARRAY_PUSH, [OP_ARRAY_POP] = &&op_OP_ARRAY_POP,
+        [OP_NEW_OBJECT] = &&op_OP_NEW_OBJECT, [OP_KEYS] = &&op_OP_KEYS,
+        [OP_CALL] = &&op_OP_CALL, [OP_TAIL_CALL] = &&op_OP_CALL,
+        [OP_RET] = &&op_OP_RET, [OP_RET_VOID] = &&op_OP_RET_VOID,
+        [OP_JMP] = &&op_OP_JMP, [OP_JMP_IF_TRUE] = &&op_OP_JMP_IF_TRUE,
+        [OP_JMP_IF_FALSE] = &&op_OP_JMP_IF_FALSE,
+        [OP_TRY_BEGIN] = &&op_OP_TRY_BEGIN, [OP_TRY_END] = &&op_OP_TRY_END,
+        [OP_THROW] = &&op_OP_THROW, [OP_RETHROW] = &&op_OP_RETHROW,
+        [OP_ENTER_SCOPE] = &&op_OP_NOP, [OP_LEAVE_SCOPE] = &&op_OP_NOP,
+        [OP_BREAKPOINT] = &&op_OP_NOP, [OP_LINE_NUM] = &&op_OP_NOP,
+        [OP_SOURCE_POS] = &&op_OP_NOP, [OP_GC_HINT] = &&op_OP_NOP,
+        [OP_JIT_HINT_LOOP] = &&op_OP_NOP, [OP_JIT_HINT_END] = &&op_OP_NOP,
+        [OP_COUNT] = &&vm_end,
+    };
+#endif
+    
+    /* 常用状态缓存在局部变量里，便于编译器放进寄存器 */
+    const uint8_t *const bytecode = vm->bytecode;
+    const uint8_t *ip = bytecode;
+    xc_val *const constants = vm->constants;
+    char *const *const names = vm->names;
+    xc_inline_cache_t *const caches = vm->caches;
+    xc_val *const stack = vm->stack;
+    xc_val *const locals = vm->locals;
+    xc_val *sp = stack;
+    xc_val exc = NULL;
+    xc_val a, b, r;
+    const char *name;
+    xc_inline_cache_t *cache;
+    vm->handler_count = 0;
+    
+/* 分配前写回栈顶，让 GC 标记到仍在栈上的值 */
+#define VM_SYNC() (vm->stack_top = (int)(sp - stack))
+#define VM_THROW(type, message) do { VM_SYNC(); exc = xc_exception_create(rt, (type), (message)); goto vm_throw; } while (0)
+#define VM_THROW_PENDING() do { VM_SYNC(); exc = xc_take_pending_exception(rt); goto vm_throw; } while (0)
+#if XC_VM_THREADED
+#define VM_CASE(name) op_##name:
+#define VM_DISPATCH() goto *labels[*ip++]
+#else
+#define VM_CASE(name) case name:
+#define VM_DISPATCH() goto dispatch
+#endif
+/* 操作数在各指令里读取，ip 已经指向下一条指令 */
+#define VM_NEXT() VM_DISPATCH()
+#define VM_JUMP(target) do { ip = bytecode + (target); VM_DISPATCH(); } while (0)
+#define VM_OPERAND() vm_read_uleb(&ip)
+#define VM_NUMBER(value) xc_number_box(rt, (value))
+    
+#if XC_VM_THREADED
+    VM_DISPATCH();
+#else
+dispatch:
+    switch (*ip++) {
+#endif
+    
+    VM_CASE(OP_NOP)
+        VM_NEXT();
+    
+    VM_CASE(OP_PUSH_VAL)
+        *sp++ = constants[VM_OPERAND()];
+        VM_NEXT();
+    
+    VM_CASE(OP_POP)
+        sp--;
+        VM_NEXT();
+    
+    VM_CASE(OP_DUP)
+        sp[0] = sp[-1];
+        sp++;
+        VM_NEXT();
+    
+    VM_CASE(OP_SWAP)
+        a = sp[-1];
+        sp[-1] = sp[-2];
+        sp[-2] = a;
+        VM_NEXT();
+    
+    VM_CASE(OP_ADD)
+        a = sp[-2];
+        b = sp[-1];
+        VM_SYNC();
+        if (vm_is_number(a) && vm_is_number(b)) {
+            r = VM_NUMBER(xc_number_value(rt, a) + xc_number_value(rt, b));
+        } else if (a && b && a->type_id == XC_TYPE_STRING && b->type_id == XC_TYPE_STRING) {
+            r = xc_string_concat(rt, a, b);
+        } else {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ADD expects two numbers or two strings");
+        }
+        sp--;
+        sp[-1] = r;
+        VM_NEXT();
+    
+#define VM_ARITH(name, expr) \
+    VM_CASE(name) \
+        a = sp[-2]; \
+        b = sp[-1]; \
+        if (!vm_is_number(a) || !vm_is_number(b)) { \
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, #name " expects numbers"); \
+        } \
+        { \
+            double x = xc_number_value(rt, a), y = xc_number_value(rt, b); \
+            VM_SYNC(); \
+            r = VM_NUMBER(expr); \
+        } \
+        sp--; \
+        sp[-1] = r; \
+        VM_NEXT();
+    
+    VM_ARITH(OP_SUB, x - y)
+    VM_ARITH(OP_MUL, x * y)
+    VM_ARITH(OP_DIV, x / y)
+    VM_ARITH(OP_MOD, fmod(x, y))
+    VM_ARITH(OP_BIT_AND, (double)((int32_t)(int64_t)x & (int32_t)(int64_t)y))
+    VM_ARITH(OP_BIT_OR, (double)((int32_t)(int64_t)x | (int32_t)(int64_t)y))
+    VM_ARITH(OP_BIT_XOR, (double)((int32_t)(int64_t)x ^ (int32_t)(int64_t)y))
+    VM_ARITH(OP_SHL, (double)(int32_t)((uint32_t)(int32_t)(int64_t)x << ((uint32_t)(int64_t)y & 31)))
+    VM_ARITH(OP_SHR, (double)((int32_t)(int64_t)x >> ((uint32_t)(int64_t)y & 31)))
+    
+    VM_CASE(OP_NEG)
+        a = sp[-1];
+        if (!vm_is_number(a)) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "NEG expects a number");
+        }
+        VM_SYNC();
+        sp[-1] = VM_NUMBER(-xc_number_value(rt, a));
+        VM_NEXT();
+    
+    VM_CASE(OP_BIT_NOT)
+        a = sp[-1];
+        if (!vm_is_number(a)) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "BIT_NOT expects a number");
+        }
+        VM_SYNC();
+        sp[-1] = VM_NUMBER((double)~(int32_t)(int64_t)xc_number_value(rt, a));
+        VM_NEXT();
+    
+    VM_CASE(OP_EQ)
+        sp--;
+        sp[-1] = xc_boolean_create(rt, vm_equal(sp[-1], sp[0]));
+        VM_NEXT();
+    
+    VM_CASE(OP_NE)
+        sp--;
+        sp[-1] = xc_boolean_create(rt, !vm_equal(sp[-1], sp[0]));
+        VM_NEXT();
+    
+#define VM_COMPARE(name, test) \
+    VM_CASE(name) \
+        { \
+            int c = vm_compare(sp[-2], sp[-1]); \
+            if (c == -2) { \
+                VM_THROW(XC_EXCEPTION_TYPE_TYPE, #name " expects two numbers or two strings"); \
+            } \
+            sp--; \
+            sp[-1] = xc_boolean_create(rt, c != 2 && (test)); \
+        } \
+        VM_NEXT();
+    
+    VM_COMPARE(OP_LT, c < 0)
+    VM_COMPARE(OP_LE, c <= 0)
+    VM_COMPARE(OP_GT, c > 0)
+    VM_COMPARE(OP_GE, c >= 0)
+    
+    VM_CASE(OP_AND)
+        sp--;
+        sp[-1] = xc_boolean_create(rt, vm_truthy(sp[-1]) && vm_truthy(sp[0]));
+        VM_NEXT();
+    
+    VM_CASE(OP_OR)
+        sp--;
+        sp[-1] = xc_boolean_create(rt, vm_truthy(sp[-1]) || vm_truthy(sp[0]));
+        VM_NEXT();
+    
+    VM_CASE(OP_NOT)
+        sp[-1] = xc_boolean_create(rt, !vm_truthy(sp[-1]));
+        VM_NEXT();
+    
+    VM_CASE(OP_LOAD)
+        *sp++ = locals[VM_OPERAND()];
+        VM_NEXT();
+    
+    VM_CASE(OP_STORE)
+        locals[VM_OPERAND()] = *--sp;
+        VM_NEXT();
+    
+    VM_CASE(OP_LOAD_GLOBAL)
+        {
+            const char *name = names[VM_OPERAND()];
+            xc_inline_cache_t *cache = &caches[VM_OPERAND()];
+            VM_SYNC();
+            *sp++ = xc_object_get_cached(rt, vm->global, name, cache);
+        }
+        VM_NEXT();
+    
+    VM_CASE(OP_STORE_GLOBAL)
+        {
+            const char *name = names[VM_OPERAND()];
+            xc_inline_cache_t *cache = &caches[VM_OPERAND()];
+            VM_SYNC();
+            xc_object_set_cached(rt, vm->global, name, sp[-1], cache);
+            sp--;
+        }
+        VM_NEXT();
+    
+    VM_CASE(OP_GET_PROP)
+        name = names[VM_OPERAND()];
+        cache = &caches[VM_OPERAND()];
+        a = sp[-1];
+        if (!a || a->type_id != XC_TYPE_OBJECT) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "GET_PROP expects an object");
+        }
+        VM_SYNC();
+        sp[-1] = xc_object_get_cached(rt, a, name, cache);
+        VM_NEXT();
+    
+    VM_CASE(OP_SET_PROP)
+        name = names[VM_OPERAND()];
+        cache = &caches[VM_OPERAND()];
+        a = sp[-2];
+        if (!a || a->type_id != XC_TYPE_OBJECT) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "SET_PROP expects an object");
+        }
+        VM_SYNC();
+        xc_object_set_cached(rt, a, name, sp[-1], cache);
+        sp -= 2;
+        VM_NEXT();
+    
+    VM_CASE(OP_HAS_PROP)
+        name = names[VM_OPERAND()];
+        a = sp[-1];
+        sp[-1] = xc_boolean_create(rt, a && a->type_id == XC_TYPE_OBJECT &&
+                                       xc_object_has(rt, a, name));
+        VM_NEXT();
+    
+    VM_CASE(OP_DEL_PROP)
+        name = names[VM_OPERAND()];
+        a = sp[-1];
+        sp[-1] = xc_boolean_create(rt, a && a->type_id == XC_TYPE_OBJECT &&
+                                       xc_object_delete(rt, a, name));
+        VM_NEXT();
+    
+    VM_CASE(OP_NEW_ARRAY)
+        {
+            int count = (int)VM_OPERAND();
+            VM_SYNC();
+            r = xc_array_create_with_values(rt, sp - count, (size_t)count);
+            sp -= count;
+            *sp++ = r;
+        }
+        VM_NEXT();
+    
+    VM_CASE(OP_GET_ELEM)
+        a = sp[-2];
+        b = sp[-1];
+        if (a && a->type_id == XC_TYPE_ARRAY && vm_is_number(b)) {
+            double index = xc_number_value(rt, b);
+            r = index >= 0 && index < (double)xc_array_length(rt, a) ? xc_array_get(rt, a, (size_t)index) : NULL;
+        } else if (a && a->type_id == XC_TYPE_OBJECT && b && b->type_id == XC_TYPE_STRING) {
+            name = xc_string_value(rt, b);
+            if (!name) {
+                VM_THROW_PENDING();
+            }
+            r = xc_object_get(rt, a, name);
+        } else {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "GET_ELEM expects array[number] or object[string]");
+        }
+        sp--;
+        sp[-1] = r;
+        VM_NEXT();
+    
+    VM_CASE(OP_SET_ELEM)
+        a = sp[-3];
+        b = sp[-2];
+        VM_SYNC();
+        if (a && a->type_id == XC_TYPE_ARRAY && vm_is_number(b) && xc_number_value(rt, b) >= 0) {
+            xc_array_set(rt, a, (size_t)xc_number_value(rt, b), sp[-1]);
+        } else if (a && a->type_id == XC_TYPE_OBJECT && b && b->type_id == XC_TYPE_STRING) {
+            name = xc_string_value(rt, b);
+            if (!name) {
+                VM_THROW_PENDING();
+            }
+            xc_object_set(rt, a, name, sp[-1]);
+        } else {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "SET_ELEM expects array[number] or object[string]");
+        }
+        sp -= 3;
+        VM_NEXT();
+    
+    VM_CASE(OP_ARRAY_LEN)
+        a = sp[-1];
+        if (!a || a->type_id != XC_TYPE_ARRAY) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ARRAY_LEN expects an array");
+        }
+        VM_SYNC();
+        sp[-1] = VM_NUMBER((double)xc_array_length(rt, a));
+        VM_NEXT();
+    
+    VM_CASE(OP_ARRAY_PUSH)
+        a = sp[-2];
+        if (!a || a->type_id != XC_TYPE_ARRAY) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ARRAY_PUSH expects an array");
+        }
+        VM_SYNC();
+        xc_array_push(rt, a, sp[-1]);
+        sp--;
+        VM_NEXT();
+    
+    VM_CASE(OP_ARRAY_POP)
+        a = sp[-1];
+        if (!a || a->type_id != XC_TYPE_ARRAY) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ARRAY_POP expects an array");
+        }
+        sp[-1] = xc_array_pop(rt, a);
+        VM_NEXT();
+    
+    VM_CASE(OP_NEW_OBJECT)
+        VM_SYNC();
+        *sp++ = xc_object_create(rt);
+        VM_NEXT();
+    
+    VM_CASE(OP_KEYS)
+        a = sp[-1];
+        if (!a || a->type_id != XC_TYPE_OBJECT) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "KEYS expects an object");
+        }
+        VM_SYNC();
+        r = xc_array_create(rt);
+        sp[-1] = r;
+        xc_object_foreach(rt, a, vm_collect_key, r);
+        VM_NEXT();
+    
+    VM_CASE(OP_CALL)
+        {
+            int argc = (int)VM_OPERAND();
+            xc_val *args = sp - argc;
+            a = args[-1];
+            if (!a || a->type_id != XC_TYPE_FUNC) {
+                VM_THROW(XC_EXCEPTION_TYPE_TYPE, "CALL expects a function");
+            }
+            VM_SYNC();
+            r = xc_function_call(rt, a, NULL, (size_t)argc, args);
+            if (XC_IS_ERROR(r)) {
+                exc = xc_take_pending_exception(rt);
+                goto vm_throw;
+            }
+            sp = args;
+            sp[-1] = r;
+        }
+        VM_NEXT();
+    
+    VM_CASE(OP_RET)
+        vm->result = *--sp;
+        goto vm_done;
+    
+    VM_CASE(OP_RET_VOID)
+        vm->result = NULL;
+        goto vm_done;
+    
+    VM_CASE(OP_JMP)
+        VM_JUMP(vm_read_i32(ip));
+    
+    VM_CASE(OP_JMP_IF_TRUE)
+        if (vm_truthy(*--sp)) {
+            VM_JUMP(vm_read_i32(ip));
+        }
+        ip += 4;
+        VM_NEXT();
+    
+    VM_CASE(OP_JMP_IF_FALSE)
+        if (!vm_truthy(*--sp)) {
+            VM_JUMP(vm_read_i32(ip));
+        }
+        ip += 4;
+        VM_NEXT();
+    
+    VM_CASE(OP_TRY_BEGIN)
+        if (vm->handler_count >= XC_VM_MAX_HANDLERS) {
+            VM_SYNC();
+            exc = xc_exception_reserved(rt, XC_EXCEPTION_TYPE_STACK_OVERFLOW);
+            goto vm_throw;
+        }
+        vm->handlers[vm->handler_count].catch_pc = vm_read_i32(ip);
+        ip += 4;
+        vm->handlers[vm->handler_count].stack_top = (int)(sp - stack);
+        vm->handler_count++;
+        VM_NEXT();
+    
+    VM_CASE(OP_TRY_END)
+        if (vm->handler_count > 0) {
+            vm->handler_count--;
+        }
+        VM_NEXT();
+    
+    VM_CASE(OP_THROW)
+        exc = *--sp;
+        VM_SYNC();
+        goto vm_throw;
+    
+    VM_CASE(OP_RETHROW)
+        exc = vm->exception;
+        VM_SYNC();
+        goto vm_throw;
+    
+#if !XC_VM_THREADED
+    case OP_COUNT:
+        goto vm_end;
+    default:
+        goto op_unsupported;
+    }
+#endif
+    
+op_unsupported:
+    /* 校验已拒绝不支持的指令，这里只是防御 */
+    VM_THROW(XC_EXCEPTION_TYPE_INTERNAL, "Unsupported opcode");
+    
+vm_throw:
+    vm->exception = exc;
+    if (vm->handler_count > 0) {
+        vm->handler_count--;
+        sp = stack + vm->handlers[vm->handler_count].stack_top;
+        *sp++ = exc;
+        VM_JUMP(vm->handlers[vm->handler_count].catch_pc);
+    }
+    vm->stack_top = 0;
+    vm->pc = (int)(ip - bytecode);
+    return xc_raise(rt, (xc_object_t *)exc);
+    
+vm_end:
+    vm->result = sp > stack ? sp[-1] : NULL;
+    
+vm_done:
+    vm->exception = NULL;
+    vm->stack_top = 0;
+    vm->pc = (int)(ip - bytecode);
+    return vm->result;
+    
+#undef VM_SYNC
+#undef VM_THROW
+#undef VM_THROW_PENDING
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef VM_NEXT
+#undef VM_JUMP
+#undef VM_NUMBER
+#undef VM_OPERAND
+#undef VM_ARITH
+#undef VM_COMPARE
+}
+
+/* 寄存器模式解释器，执行 vm->regcode；寄存器文件整体由 GC 标记，分配前不需要同步 */
+static xc_val vm_run_registers(xc_vm_t *vm) {
+#if XC_VM_THREADED
+    static const void *const labels[R_COUNT + 1] = {
+        [R_MOVE] = &&op_R_MOVE, [R_SWAP] = &&op_R_SWAP,
+        [R_ADD] = &&op_R_ADD, [R_SUB] = &&op_R_SUB, [R_MUL] = &&op_R_MUL,
+        [R_DIV] = &&op_R_DIV, [R_MOD] = &&op_R_MOD,
+        [R_BIT_AND] = &&op_R_BIT_AND, [R_BIT_OR] = &&op_R_BIT_OR, [R_BIT_XOR] = &&op_R_BIT_XOR,
+        [R_SHL] = &&op_R_SHL, [R_SHR] = &&op_R_SHR,
+        [R_EQ] = &&op_R_EQ, [R_NE] = &&op_R_NE, [R_LT] = &&op_R_LT, [R_LE] = &&op_R_LE,
+        [R_GT] = &&op_R_GT, [R_GE] = &&op_R_GE, [R_AND] = &&op_R_AND, [R_OR] = &&op_R_OR,
+        [R_NEG] = &&op_R_NEG, [R_BIT_NOT] = &&op_R_BIT_NOT, [R_NOT] = &&op_R_NOT,
+        [R_GET_GLOBAL] = &&op_R_GET_GLOBAL, [R_SET_GLOBAL] = &&op_R_SET_GLOBAL,
+        [R_GET_PROP] = &&op_R_GET_PROP, [R_SET_PROP] = &&op_R_SET_PROP,
+        [R_HAS_PROP] = &&op_R_HAS_PROP, [R_DEL_PROP] = &&op_R_DEL_PROP,
+        [R_NEW_ARRAY] = &&op_R_NEW_ARRAY, [R_GET_ELEM] = &&op_R_GET_ELEM,
+        [R_SET_ELEM] = &&op_R_SET_ELEM, [R_ARRAY_LEN] = &&op_R_ARRAY_LEN,
+        [R_ARRAY_PUSH] = &&op_R_ARRAY_PUSH, [R_ARRAY_POP] = &&op_R_ARRAY_POP,
+        [R_NEW_OBJECT] = &&op_R_NEW_OBJECT, [R_KEYS] = &&op_R_KEYS, [R_CALL] = &&op_R_CALL,
+        [R_RET] = &&op_R_RET, [R_RET_VOID] = &&op_R_RET_VOID,
+        [R_JMP] = &&op_R_JMP, [R_JMP_IF_TRUE] = &&op_R_JMP_IF_TRUE, [R_JMP_IF_FALSE] = &&op_R_JMP_IF_FALSE,
+        [R_TRY_BEGIN] = &&op_R_TRY_BEGIN, [R_TRY_END] = &&op_R_TRY_END,
+        [R_THROW] = &&op_R_THROW, [R_RETHROW] = &&op_R_RETHROW,
+        [R_ADD_NUM_NUM] = &&op_R_ADD_NUM_NUM, [R_LT_NUM] = &&op_R_LT_NUM, [R_LE_NUM] = &&op_R_LE_NUM,
+        [R_GT_NUM] = &&op_R_GT_NUM, [R_GE_NUM] = &&op_R_GE_NUM,
+        [R_GET_ELEM_ARRAY_INT] = &&op_R_GET_ELEM_ARRAY_INT,
+        [R_COUNT] = &&op_R_RET_VOID,
+    };
+#endif
+    
+    uint8_t *const regcode = vm->regcode;
+    const uint8_t *ip = regcode;
+    xc_val *const regs = vm->locals;
+    char *const *const names = vm->names;
+    xc_inline_cache_t *const caches = vm->caches;
+    xc_val exc = NULL;
+    xc_val a, b, c, r;
+    uint32_t d;
+    const uint8_t *at;      // 当前指令的操作码字节，快速化时改写
+    const char *key;
+    vm->handler_count = 0;
+    
+#define VM_THROW(type, message) do { exc = xc_exception_create(rt, (type), (message)); goto vm_throw; } while (0)
+#define VM_THROW_PENDING() do { exc = xc_take_pending_exception(rt); goto vm_throw; } while (0)
+#if XC_VM_THREADED
+#define VM_CASE(name) op_##name:
+#define VM_DISPATCH() goto *labels[*ip++]
+#else
+#define VM_CASE(name) case name:
+#define VM_DISPATCH() goto dispatch
+#endif
+#define VM_NEXT() VM_DISPATCH()
+#define VM_JUMP(target) do { ip = regcode + (target); VM_DISPATCH(); } while (0)
+#define VM_OPERAND() vm_read_uleb(&ip)
+#define VM_REG() regs[vm_read_uleb(&ip)]
+#define VM_NUMBER(value) xc_number_box(rt, (value))
+#define VM_QUICKEN(op) (*(uint8_t *)at = (uint8_t)(op))
+/* 守卫失败：改回通用形式，从这条指令重新开始 */
+#define VM_DEOPT(op) do { VM_QUICKEN(op); ip = at; VM_DISPATCH(); } while (0)
+    
+#if XC_VM_THREADED
+    VM_DISPATCH();
+#else
+dispatch:
+    switch (*ip++) {
+#endif
+    
+    VM_CASE(R_MOVE)
+        d = VM_OPERAND();
+        regs[d] = VM_REG();
+        VM_NEXT();
+    
+    VM_CASE(R_SWAP)
+        {
+            uint32_t x = VM_OPERAND(), y = VM_OPERAND();
+            a = regs[x];
+            regs[x] = regs[y];
+            regs[y] = a;
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_ADD)
+        at = ip - 1;
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        if (vm_is_number(a) && vm_is_number(b)) {
+            VM_QUICKEN(R_ADD_NUM_NUM);
+            r = VM_NUMBER(xc_number_value(rt, a) + xc_number_value(rt, b));
+        } else if (a && b && a->type_id == XC_TYPE_STRING && b->type_id == XC_TYPE_STRING) {
+            r = xc_string_concat(rt, a, b);
+        } else {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ADD expects two numbers or two strings");
+        }
+        regs[d] = r;
+        VM_NEXT();
+    
+    VM_CASE(R_ADD_NUM_NUM)
+        at = ip - 1;
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        if (!vm_is_number(a) || !vm_is_number(b)) {
+            VM_DEOPT(R_ADD);
+        }
+        regs[d] = VM_NUMBER(xc_number_value(rt, a) + xc_number_value(rt, b));
+        VM_NEXT();
+    
+#define VM_ARITH(name, expr) \
+    VM_CASE(R_##name) \
+        d = VM_OPERAND(); \
+        a = VM_REG(); \
+        b = VM_REG(); \
+        if (!vm_is_number(a) || !vm_is_number(b)) { \
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "OP_" #name " expects numbers"); \
+        } \
+        { \
+            double x = xc_number_value(rt, a), y = xc_number_value(rt, b); \
+            regs[d] = VM_NUMBER(expr); \
+        } \
+        VM_NEXT();
+    
+    VM_ARITH(SUB, x - y)
+    VM_ARITH(MUL, x * y)
+    VM_ARITH(DIV, x / y)
+    VM_ARITH(MOD, fmod(x, y))
+    VM_ARITH(BIT_AND, (double)((int32_t)(int64_t)x & (int32_t)(int64_t)y))
+    VM_ARITH(BIT_OR, (double)((int32_t)(int64_t)x | (int32_t)(int64_t)y))
+    VM_ARITH(BIT_XOR, (double)((int32_t)(int64_t)x ^ (int32_t)(int64_t)y))
+    VM_ARITH(SHL, (double)(int32_t)((uint32_t)(int32_t)(int64_t)x << ((uint32_t)(int64_t)y & 31)))
+    VM_ARITH(SHR, (double)((int32_t)(int64_t)x >> ((uint32_t)(int64_t)y & 31)))
+    
+    VM_CASE(R_NEG)
+        d = VM_OPERAND();
+        a = VM_REG();
+        if (!vm_is_number(a)) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "NEG expects a number");
+        }
+        regs[d] = VM_NUMBER(-xc_number_value(rt, a));
+        VM_NEXT();
+    
+    VM_CASE(R_BIT_NOT)
+        d = VM_OPERAND();
+        a = VM_REG();
+        if (!vm_is_number(a)) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "BIT_NOT expects a number");
+        }
+        regs[d] = VM_NUMBER((double)~(int32_t)(int64_t)xc_number_value(rt, a));
+        VM_NEXT();
+    
+    VM_CASE(R_EQ)
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        regs[d] = xc_boolean_create(rt, vm_equal(a, b));
+        VM_NEXT();
+    
+    VM_CASE(R_NE)
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        regs[d] = xc_boolean_create(rt, !vm_equal(a, b));
+        VM_NEXT();
+    
+/* 通用比较看到两个数字时改写成 _NUM 形式；NaN 的比较结果两边一致 */
+#define VM_COMPARE(name, test, op) \
+    VM_CASE(R_##name) \
+        at = ip - 1; \
+        d = VM_OPERAND(); \
+        a = VM_REG(); \
+        b = VM_REG(); \
+        { \
+            int cmp = vm_compare(a, b); \
+            if (cmp == -2) { \
+                VM_THROW(XC_EXCEPTION_TYPE_TYPE, "OP_" #name " expects two numbers or two strings"); \
+            } \
+            if (vm_is_number(a)) { \
+                VM_QUICKEN(R_##name##_NUM); \
+            } \
+            regs[d] = xc_boolean_create(rt, cmp != 2 && (test)); \
+        } \
+        VM_NEXT(); \
+    \
+    VM_CASE(R_##name##_NUM) \
+        at = ip - 1; \
+        d = VM_OPERAND(); \
+        a = VM_REG(); \
+        b = VM_REG(); \
+        if (!vm_is_number(a) || !vm_is_number(b)) { \
+            VM_DEOPT(R_##name); \
+        } \
+        regs[d] = xc_boolean_create(rt, xc_number_value(rt, a) op xc_number_value(rt, b)); \
+        VM_NEXT();
+    
+    VM_COMPARE(LT, cmp < 0, <)
+    VM_COMPARE(LE, cmp <= 0, <=)
+    VM_COMPARE(GT, cmp > 0, >)
+    VM_COMPARE(GE, cmp >= 0, >=)
+    
+    VM_CASE(R_AND)
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        regs[d] = xc_boolean_create(rt, vm_truthy(a) && vm_truthy(b));
+        VM_NEXT();
+    
+    VM_CASE(R_OR)
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        regs[d] = xc_boolean_create(rt, vm_truthy(a) || vm_truthy(b));
+        VM_NEXT();
+    
+    VM_CASE(R_NOT)
+        d = VM_OPERAND();
+        a = VM_REG();
+        regs[d] = xc_boolean_create(rt, !vm_truthy(a));
+        VM_NEXT();
+    
+    VM_CASE(R_GET_GLOBAL)
+        {
+            d = VM_OPERAND();
+            const char *name = names[VM_OPERAND()];
+            xc_inline_cache_t *cache = &caches[VM_OPERAND()];
+            regs[d] = xc_object_get_cached(rt, vm->global, name, cache);
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_SET_GLOBAL)
+        {
+            a = VM_REG();
+            const char *name = names[VM_OPERAND()];
+            xc_inline_cache_t *cache = &caches[VM_OPERAND()];
+            xc_object_set_cached(rt, vm->global, name, a, cache);
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_GET_PROP)
+        {
+            d = VM_OPERAND();
+            a = VM_REG();
+            const char *name = names[VM_OPERAND()];
+            xc_inline_cache_t *cache = &caches[VM_OPERAND()];
+            if (!a || a->type_id != XC_TYPE_OBJECT) {
+                VM_THROW(XC_EXCEPTION_TYPE_TYPE, "GET_PROP expects an object");
+            }
+            regs[d] = xc_object_get_cached(rt, a, name, cache);
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_SET_PROP)
+        {
+            a = VM_REG();
+            b = VM_REG();
+            const char *name = names[VM_OPERAND()];
+            xc_inline_cache_t *cache = &caches[VM_OPERAND()];
+            if (!a || a->type_id != XC_TYPE_OBJECT) {
+                VM_THROW(XC_EXCEPTION_TYPE_TYPE, "SET_PROP expects an object");
+            }
+            xc_object_set_cached(rt, a, name, b, cache);
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_HAS_PROP)
+        {
+            d = VM_OPERAND();
+            a = VM_REG();
+            const char *name = names[VM_OPERAND()];
+            regs[d] = xc_boolean_create(rt, a && a->type_id == XC_TYPE_OBJECT && xc_object_has(rt, a, name));
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_DEL_PROP)
+        {
+            d = VM_OPERAND();
+            a = VM_REG();
+            const char *name = names[VM_OPERAND()];
+            regs[d] = xc_boolean_create(rt, a && a->type_id == XC_TYPE_OBJECT && xc_object_delete(rt, a, name));
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_NEW_ARRAY)
+        {
+            d = VM_OPERAND();
+            uint32_t first = VM_OPERAND();
+            uint32_t count = VM_OPERAND();
+            regs[d] = xc_array_create_with_values(rt, regs + first, count);
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_GET_ELEM)
+        at = ip - 1;
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        if (a && a->type_id == XC_TYPE_ARRAY && vm_is_number(b)) {
+            VM_QUICKEN(R_GET_ELEM_ARRAY_INT);
+            double index = xc_number_value(rt, b);
+            r = index >= 0 && index < (double)xc_array_length(rt, a) ? xc_array_get(rt, a, (size_t)index) : NULL;
+        } else if (a && a->type_id == XC_TYPE_OBJECT && b && b->type_id == XC_TYPE_STRING) {
+            key = xc_string_value(rt, b);
+            if (!key) {
+                VM_THROW_PENDING();
+            }
+            r = xc_object_get(rt, a, key);
+        } else {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "GET_ELEM expects array[number] or object[string]");
+        }
+        regs[d] = r;
+        VM_NEXT();
+    
+    VM_CASE(R_GET_ELEM_ARRAY_INT)
+        at = ip - 1;
+        d = VM_OPERAND();
+        a = VM_REG();
+        b = VM_REG();
+        if (!a || a->type_id != XC_TYPE_ARRAY || !vm_is_number(b)) {
+            VM_DEOPT(R_GET_ELEM);
+        }
+        {
+            double index = xc_number_value(rt, b);
+            regs[d] = index >= 0 && index < (double)xc_array_length(rt, a) ? xc_array_get(rt, a, (size_t)index) : NULL;
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_SET_ELEM)
+        a = VM_REG();
+        b = VM_REG();
+        c = VM_REG();
+        if (a && a->type_id == XC_TYPE_ARRAY && vm_is_number(b) && xc_number_value(rt, b) >= 0) {
+            xc_array_set(rt, a, (size_t)xc_number_value(rt, b), c);
+        } else if (a && a->type_id == XC_TYPE_OBJECT && b && b->type_id == XC_TYPE_STRING) {
+            key = xc_string_value(rt, b);
+            if (!key) {
+                VM_THROW_PENDING();
+            }
+            xc_object_set(rt, a, key, c);
+        } else {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "SET_ELEM expects array[number] or object[string]");
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_ARRAY_LEN)
+        d = VM_OPERAND();
+        a = VM_REG();
+        if (!a || a->type_id != XC_TYPE_ARRAY) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ARRAY_LEN expects an array");
+        }
+        regs[d] = VM_NUMBER((double)xc_array_length(rt, a));
+        VM_NEXT();
+    
+    VM_CASE(R_ARRAY_PUSH)
+        a = VM_REG();
+        b = VM_REG();
+        if (!a || a->type_id != XC_TYPE_ARRAY) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ARRAY_PUSH expects an array");
+        }
+        xc_array_push(rt, a, b);
+        VM_NEXT();
+    
+    VM_CASE(R_ARRAY_POP)
+        d = VM_OPERAND();
+        a = VM_REG();
+        if (!a || a->type_id != XC_TYPE_ARRAY) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "ARRAY_POP expects an array");
+        }
+        regs[d] = xc_array_pop(rt, a);
+        VM_NEXT();
+    
+    VM_CASE(R_NEW_OBJECT)
+        d = VM_OPERAND();
+        regs[d] = xc_object_create(rt);
+        VM_NEXT();
+    
+    VM_CASE(R_KEYS)
+        d = VM_OPERAND();
+        a = VM_REG();
+        if (!a || a->type_id != XC_TYPE_OBJECT) {
+            VM_THROW(XC_EXCEPTION_TYPE_TYPE, "KEYS expects an object");
+        }
+        r = xc_array_create(rt);
+        regs[d] = r;
+        xc_object_foreach(rt, a, vm_collect_key, r);
+        VM_NEXT();
+    
+    VM_CASE(R_CALL)
+        {
+            d = VM_OPERAND();
+            uint32_t first = VM_OPERAND();
+            uint32_t argc = VM_OPERAND();
+            a = regs[first];
+            if (!a || a->type_id != XC_TYPE_FUNC) {
+                VM_THROW(XC_EXCEPTION_TYPE_TYPE, "CALL expects a function");
+            }
+            r = xc_function_call(rt, a, NULL, argc, regs + first + 1);
+            if (XC_IS_ERROR(r)) {
+                exc = xc_take_pending_exception(rt);
+                goto vm_throw;
+            }
+            regs[d] = r;
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_RET)
+        vm->result = VM_REG();
+        goto vm_done;
+    
+    VM_CASE(R_RET_VOID)
+        vm->result = NULL;
+        goto vm_done;
+    
+    VM_CASE(R_JMP)
+        VM_JUMP(vm_read_i32(ip));
+    
+    VM_CASE(R_JMP_IF_TRUE)
+        if (vm_truthy(VM_REG())) {
+            VM_JUMP(vm_read_i32(ip));
+        }
+        ip += 4;
+        VM_NEXT();
+    
+    VM_CASE(R_JMP_IF_FALSE)
+        if (!vm_truthy(VM_REG())) {
+            VM_JUMP(vm_read_i32(ip));
+        }
+        ip += 4;
+        VM_NEXT();
+    
+    VM_CASE(R_TRY_BEGIN)
+        d = VM_OPERAND();
+        if (vm->handler_count >= XC_VM_MAX_HANDLERS) {
+            exc = xc_exception_reserved(rt, XC_EXCEPTION_TYPE_STACK_OVERFLOW);
+            goto vm_throw;
+        }
+        /* stack_top 在寄存器模式下是接收异常的寄存器 */
+        vm->handlers[vm->handler_count].catch_pc = vm_read_i32(ip);
+        vm->handlers[vm->handler_count].stack_top = (int)d;
+        vm->handler_count++;
+        ip += 4;
+        VM_NEXT();
+    
+    VM_CASE(R_TRY_END)
+        if (vm->handler_count > 0) {
+            vm->handler_count--;
+        }
+        VM_NEXT();
+    
+    VM_CASE(R_THROW)
+        exc = VM_REG();
+        goto vm_throw;
+    
+    VM_CASE(R_RETHROW)
+        exc = vm->exception;
+        goto vm_throw;
+    
+#if !XC_VM_THREADED
+    default:
+        vm->result = NULL;
+        goto vm_done;
+    }
+#endif
+    
+vm_throw:
+    vm->exception = exc;
+    if (vm->handler_count > 0) {
+        vm->handler_count--;
+        regs[vm->handlers[vm->handler_count].stack_top] = exc;
+        VM_JUMP(vm->handlers[vm->handler_count].catch_pc);
+    }
+    vm->pc = (int)(ip - regcode);
+    memset(regs + vm->local_count, 0, (size_t)vm->max_stack * sizeof(xc_val));
+    return xc_raise(rt, (xc_object_t *)exc);
+    
+vm_done:
+    vm->exception = NULL;
+    vm->pc = (int)(ip - regcode);
+    /* 临时寄存器不再持有引用 */
+    memset(regs + vm->local_count, 0, (size_t)vm->max_stack * sizeof(xc_val));
+    return vm->result;
+    
+#undef VM_THROW
+#undef VM_THROW_PENDING
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef VM_NEXT
+#undef VM_JUMP
+#undef VM_OPERAND
+#undef VM_REG
+#undef VM_QUICKEN
+#undef VM_DEOPT
+#undef VM_NUMBER
+#undef VM_ARITH
+#undef VM_COMPARE
+}
+
+/* 执行 VM 中的字节码，未捕获的异常以 XC_ERROR 返回并保存在 vm->exception */
+xc_val xc_vm_run(xc_runtime_t *caller_rt, xc_object_t *obj) {
+    xc_vm_t *vm = (xc_vm_t *)obj;
+    
+    vm->exception = NULL;
+    vm->result = NULL;
+    if (vm->prepared_size != vm->code_size) {
+        const char *error = vm_prepare(vm);
+        if (error) {
+            vm->exception = xc_exception_create(rt, XC_EXCEPTION_TYPE_INTERNAL, error);
+            return xc_raise(rt, vm->exception);
+        }
+    }
+    if (vm->max_stack > vm->stack_size) {
+        vm->exception = xc_exception_reserved(rt, XC_EXCEPTION_TYPE_STACK_OVERFLOW);
+        return xc_raise(rt, vm->exception);
+    }
+    
+    /* 运行期间保持可达 */
+    if (!vm_root_registered) {
+        xc_gc_add_root(rt, &vm_running);
+        vm_root_registered = true;
+    }
+    vm->outer = vm_running;
+    vm_running = obj;
+    
+    xc_val result = vm->mode == XC_VM_MODE_STACK ? vm_run_stack(vm) : vm_run_registers(vm);
+    
+    vm_running = vm->outer;
+    vm->outer = NULL;
+    return result;
+}
+
+/* 常量池下标，相同的值共用一项 */
+static int vm_add_constant(xc_vm_t *vm, xc_val value) {
+    for (int i = 0; i < vm->constant_count; i++) {
+        if (vm->constants[i] == value) {
+            return i;
+        }
+    }
+    if (vm->constant_count >= vm->constant_capacity) {
+        int capacity = vm->constant_capacity ? vm->constant_capacity * 2 : 8;
+        xc_val *constants = (xc_val *)realloc(vm->constants, (size_t)capacity * sizeof(xc_val));
+        if (!constants) {
+            return -1;
+        }
+        vm->constants = constants;
+        vm->constant_capacity = capacity;
+    }
+    vm->constants[vm->constant_count] = value;
+    return vm->constant_count++;
+}
+
+/* 名字池下标，名字被复制 */
+static int vm_add_name(xc_vm_t *vm, const char *name) {
+    for (int i = 0; i < vm->name_count; i++) {
+        if (strcmp(vm->names[i], name) == 0) {
+            return i;
+        }
+    }
+    char **names = (char **)realloc(vm->names, (size_t)(vm->name_count + 1) * sizeof(char *));
+    if (!names) {
+        return -1;
+    }
+    vm->names = names;
+    if (!(names[vm->name_count] = strdup(name))) {
+        return -1;
+    }
+    return vm->name_count++;
+}
+
+/* 追加一条指令，返回其位置；PUSH_VAL 的值和名字操作数换成池下标 */
+int xc_vm_emit(xc_runtime_t *caller_rt, xc_object_t *obj, xc_instruction_t instr) {
+    xc_vm_t *vm = (xc_vm_t *)obj;
+    
+    if (instr.op == OP_PUSH_VAL) {
+        int index = vm_add_constant(vm, instr.operand.val);
+        if (index < 0) {
+            return -1;
+        }
+        instr.operand.i64 = 0;
+        instr.operand.i32 = index;
+    } else if (vm_op_has_str(instr.op)) {
+        int index = instr.operand.str ? vm_add_name(vm, instr.operand.str) : -1;
+        if (index < 0) {
+            return -1;
+        }
+        instr.operand.i64 = 0;
+        instr.operand.i32 = index;
+    }
+    
+    if (vm->code_size >= vm->code_capacity) {
+        int capacity = vm->code_capacity ? vm->code_capacity * 2 : 16;
+        xc_instruction_t *code = (xc_instruction_t *)realloc(vm->code, (size_t)capacity * sizeof(xc_instruction_t));
+        if (!code) {
+            return -1;
+        }
+        vm->code = code;
+        vm->code_capacity = capacity;
+    }
+    
+    vm->code[vm->code_size] = instr;
+    vm->prepared_size = -1;
+    return vm->code_size++;
+}
+
+/* 回填跳转目标（JMP/JMP_IF_* 的 i32，TRY_BEGIN 的 catch 地址） */
+void xc_vm_set_jump(xc_runtime_t *caller_rt, xc_object_t *obj, int at, int target) {
+    xc_vm_t *vm = (xc_vm_t *)obj;
+    if (at < 0 || at >= vm->code_size) {
+        return;
+    }
+    if (vm->code[at].op == OP_TRY_BEGIN) {
+        vm->code[at].operand.addr_pair.addr1 = target;
+    } else {
+        vm->code[at].operand.i32 = target;
+    }
+    vm->prepared_size = -1;
+}
+
+/* 选择执行模式，默认寄存器模式；两种模式共用局部变量和全局变量 */
+void xc_vm_set_mode(xc_runtime_t *caller_rt, xc_object_t *obj, int mode) {
+    ((xc_vm_t *)obj)->mode = mode == XC_VM_MODE_STACK ? XC_VM_MODE_STACK : XC_VM_MODE_REGISTER;
+}
+
+/* 编码后的字节流，必要时先校验和编码；代码无效时返回 NULL */
+const uint8_t *xc_vm_bytecode(xc_runtime_t *caller_rt, xc_object_t *obj, size_t *size) {
+    xc_vm_t *vm = (xc_vm_t *)obj;
+    if (vm->prepared_size != vm->code_size && vm_prepare(vm)) {
+        return NULL;
+    }
+    if (size) {
+        *size = (size_t)vm->bytecode_size;
+    }
+    return vm->bytecode;
+}
+
+xc_val xc_vm_result(xc_runtime_t *caller_rt, xc_object_t *obj) {
+    return ((xc_vm_t *)obj)->result;
+}
+
+void xc_vm_set_global(xc_runtime_t *caller_rt, xc_object_t *obj, const char *name, xc_val value) {
+    xc_object_set(rt, ((xc_vm_t *)obj)->global, name, value);
+}
+
+/* 重置执行状态，保留字节码和全局变量 */
+void xc_vm_reset(xc_runtime_t *caller_rt, xc_object_t *obj) {
+    xc_vm_t *vm = (xc_vm_t *)obj;
+    vm->stack_top = 0;
+    vm->pc = 0;
+    vm->handler_count = 0;
+    vm->result = NULL;
+    vm->exception = NULL;
+    if (vm->locals) {
+        memset(vm->locals, 0, (size_t)vm->local_count * sizeof(xc_val));
+    }
+}
 
 /* VM 类型方法 */
 static xc_val vm_to_string(xc_val self, xc_val arg) {
@@ -271,103 +2054,192 @@ static xc_val vm_to_string(xc_val self, xc_val arg) {
 
 /* 执行 VM 中的字节码 */
 static xc_val vm_execute(xc_val self, xc_val arg) {
-    // TODO: 实现字节码执行逻辑
-    return rt->new(XC_TYPE_NULL);
+    return xc_vm_run(rt, self);
 }
 
-/* 添加指令到 VM */
+/* 添加指令到 VM：参数为数组 [操作码, 操作数]，TRY_BEGIN 可带第三项 finally 地址 */
 static xc_val vm_add_instruction(xc_val self, xc_val arg) {
-    // TODO: 实现添加指令逻辑
-    return rt->new(XC_TYPE_BOOL, 1);
+    if (!arg || !rt->is(arg, XC_TYPE_ARRAY) || xc_array_length(rt, arg) < 1 ||
+        !vm_is_number(xc_array_get(rt, arg, 0))) {
+        return xc_boolean_create(rt, false);
+    }
+    
+    xc_instruction_t instr;
+    memset(&instr, 0, sizeof(instr));
+    instr.op = (xc_opcode_t)(int)xc_number_value(rt, xc_array_get(rt, arg, 0));
+    if ((int)instr.op < 0 || instr.op >= OP_COUNT) {
+        return xc_boolean_create(rt, false);
+    }
+    xc_val operand = xc_array_length(rt, arg) > 1 ? xc_array_get(rt, arg, 1) : NULL;
+    double number = vm_is_number(operand) ? xc_number_value(rt, operand) : 0;
+    
+    switch (instr.op) {
+        case OP_PUSH_VAL:
+            instr.operand.val = operand;
+            break;
+        case OP_LOAD:
+        case OP_STORE:
+            instr.operand.var.index = (uint16_t)number;
+            break;
+        case OP_TRY_BEGIN:
+            instr.operand.addr_pair.addr1 = (int32_t)number;
+            if (xc_array_length(rt, arg) > 2 && vm_is_number(xc_array_get(rt, arg, 2))) {
+                instr.operand.addr_pair.addr2 = (int32_t)xc_number_value(rt, xc_array_get(rt, arg, 2));
+            }
+            break;
+        default:
+            if (vm_op_has_str(instr.op)) {
+                if (!operand || !rt->is(operand, XC_TYPE_STRING)) {
+                    return xc_boolean_create(rt, false);
+                }
+                instr.operand.str = (char *)xc_string_value(rt, operand);
+                if (!instr.operand.str) {
+                    return xc_boolean_create(rt, false);
+                }
+            } else {
+                instr.operand.i32 = (int32_t)number;
+            }
+            break;
+    }
+    
+    return xc_boolean_create(rt, xc_vm_emit(rt, self, instr) >= 0);
 }
 
 /* 重置 VM 状态 */
 static xc_val vm_reset(xc_val self, xc_val arg) {
-    // TODO: 实现重置逻辑
-    return rt->new(XC_TYPE_BOOL, 1);
+    xc_vm_reset(rt, self);
+    return xc_boolean_create(rt, true);
 }
 
 /* 获取执行结果 */
 static xc_val vm_get_result(xc_val self, xc_val arg) {
-    // TODO: 实现获取结果逻辑
-    return rt->new(XC_TYPE_NULL);
+    return xc_vm_result(rt, self);
 }
 
-/* 设置全局变量 */
+/* 设置全局变量：参数为数组 [名称, 值] */
 static xc_val vm_set_global(xc_val self, xc_val arg) {
-    // TODO: 实现设置全局变量逻辑
-    return rt->new(XC_TYPE_BOOL, 1);
+    if (!arg || !rt->is(arg, XC_TYPE_ARRAY) || xc_array_length(rt, arg) < 2 ||
+        !rt->is(xc_array_get(rt, arg, 0), XC_TYPE_STRING)) {
+        return xc_boolean_create(rt, false);
+    }
+    const char *name = xc_string_value(rt, xc_array_get(rt, arg, 0));
+    if (!name) {
+        return xc_boolean_create(rt, false);
+    }
+    xc_vm_set_global(rt, self, name, xc_array_get(rt, arg, 1));
+    return xc_boolean_create(rt, true);
 }
 
 /* 启用或禁用JIT编译 */
 static xc_val vm_enable_jit(xc_val self, xc_val arg) {
-    // TODO: 实现JIT启用/禁用逻辑
-    return rt->new(XC_TYPE_BOOL, 1);
+    /* 没有 JIT 后端 */
+    return xc_boolean_create(rt, false);
 }
 
 /* 获取当前异常 */
 static xc_val vm_get_exception(xc_val self, xc_val arg) {
-    // TODO: 实现获取异常逻辑
-    return rt->new(XC_TYPE_NULL);
+    return ((xc_vm_t *)self)->exception;
 }
 
 /* VM 类型的 GC 标记方法 */
-static void vm_marker(xc_val self, void (*mark_func)(xc_val)) {
-    // TODO: 实现标记逻辑
+static void vm_marker(xc_object_t *obj, mark_func mark) {
+    xc_vm_t *vm = (xc_vm_t *)obj;
+    for (int i = 0; i < vm->stack_top; i++) {
+        if (vm->stack[i]) mark(vm->stack[i]);
+    }
+    for (int i = 0; i < vm->reg_count; i++) {
+        if (vm->locals[i]) mark(vm->locals[i]);
+    }
+    for (int i = 0; i < vm->constant_count; i++) {
+        if (vm->constants[i]) mark(vm->constants[i]);
+    }
+    if (vm->global) mark(vm->global);
+    if (vm->exception) mark(vm->exception);
+    if (vm->result) mark(vm->result);
+    if (vm->outer) mark(vm->outer);
 }
 
 /* VM 类型的销毁方法 */
 static int vm_destroy(xc_val self) {
-    // TODO: 实现销毁逻辑
+    xc_vm_t *vm = (xc_vm_t *)self;
+    for (int i = 0; i < vm->name_count; i++) {
+        free(vm->names[i]);
+    }
+    free(vm->names);
+    free(vm->constants);
+    free(vm->code);
+    free(vm->bytecode);
+    free(vm->regcode);
+    free(vm->stack);
+    free(vm->locals);
+    free(vm->caches);
+    vm->names = NULL;
+    vm->constants = NULL;
+    vm->code = NULL;
+    vm->bytecode = NULL;
+    vm->regcode = NULL;
+    vm->stack = NULL;
+    vm->locals = NULL;
+    vm->caches = NULL;
+    vm->name_count = 0;
+    vm->constant_count = 0;
+    vm->code_size = 0;
+    vm->local_count = 0;
+    vm->reg_count = 0;
     return 0;
 }
 
-/* VM 类型初始化 */
-static void vm_initialize(void) {
-    // 注册方法
-    rt->register_method(XC_TYPE_VM, "toString", vm_to_string);
-    rt->register_method(XC_TYPE_VM, "execute", vm_execute);
-    rt->register_method(XC_TYPE_VM, "addInstruction", vm_add_instruction);
-    rt->register_method(XC_TYPE_VM, "reset", vm_reset);
-    rt->register_method(XC_TYPE_VM, "getResult", vm_get_result);
-    rt->register_method(XC_TYPE_VM, "setGlobal", vm_set_global);
-    rt->register_method(XC_TYPE_VM, "enableJIT", vm_enable_jit);
-    rt->register_method(XC_TYPE_VM, "getException", vm_get_exception);
-}
-
-/* VM 类型创建函数 */
+/* VM 类型创建函数：rt->new(XC_TYPE_VM, stack_size) */
 static xc_val vm_creator(int type, va_list args) {
-    // TODO: 实现创建逻辑
-    return NULL;
+    return xc_vm_create(va_arg(args, int));
 }
 
-/* 注册 VM 类型 */
-int _xc_type_vm = XC_TYPE_VM;
-
 /* Type descriptor for vm type */
 static xc_type_lifecycle_t vm_type = {
-    .initializer = vm_initialize,
+    .initializer = NULL,
     .cleaner = NULL,
     .creator = vm_creator,
     .destroyer = vm_destroy,
-    .marker = vm_marker,
-    // .allocator = NULL,
+    .marker = (xc_marker_func)vm_marker,
     .name = "vm",
     .equal = NULL,
     .compare = NULL,
     .flags = 0
 };
 
-__attribute__((constructor)) static void register_vm_type(void) {
-    rt = xc_singleton();
-    /* 注册类型 */
-    _xc_type_vm = rt->register_type("vm", &vm_type);
-    // vm_initialize();
+/* Register vm type */
+void xc_register_vm_type(xc_runtime_t *caller_rt) {
+    rt = caller_rt;
+    rt->register_type("vm", &vm_type);
+    
+    rt->register_method(XC_TYPE_VM, "toString", vm_to_string);
+    rt->register_method(XC_TYPE_VM, "execute", vm_execute);
+    rt->register_method(XC_TYPE_VM, "addInstruction", vm_add_instruction);
+    rt->register_method(XC_TYPE_VM, "reset", vm_reset);
+    rt->register_method(XC_TYPE_VM, "getResult", vm_get_result);
+    rt->register_method(XC_TYPE_VM, "setGlobal", vm_set_global);
+    rt->register_method(XC_TYPE_VM, "enableJIT", vm_enable_jit);
+    rt->register_method(XC_TYPE_VM, "getException", vm_get_exception);
 }
 
 /* 创建 VM 对象 */
-xc_val xc_vm_create(int stack_size) {
-    return rt->new(XC_TYPE_VM, stack_size);
+xc_object_t *xc_vm_create(int stack_size) {
+    if (stack_size <= 0) {
+        stack_size = XC_VM_DEFAULT_STACK;
+    }
+    
+    xc_vm_t *vm = (xc_vm_t *)xc_gc_alloc(rt, sizeof(xc_vm_t), XC_TYPE_VM);
+    if (!vm) {
+        return NULL;
+    }
+    ((xc_object_t *)vm)->type_id = XC_TYPE_VM;
+    memset((char *)vm + sizeof(xc_object_t), 0, sizeof(xc_vm_t) - sizeof(xc_object_t));
+    vm->prepared_size = -1;
+    vm->mode = XC_VM_MODE_REGISTER;
+    vm->stack = (xc_val *)calloc((size_t)stack_size, sizeof(xc_val));
+    vm->stack_size = vm->stack ? stack_size : 0;
+    vm->global = xc_object_create(rt);
+    return (xc_object_t *)vm;
 }
 
 /* 使用示例:
@@ -394,4 +2266,11 @@ rt->call(vm, "execute", NULL);
 // 获取结果
 xc_val result = rt->call(vm, "getResult", NULL);
 rt->print(result); // 输出 30
-*/ 
\ No newline at end of file
+
+// C 接口
+xc_vm_emit(rt, vm, (xc_instruction_t){OP_PUSH_VAL, {.val = xc_number_create(rt, 10)}});
+xc_vm_emit(rt, vm, (xc_instruction_t){OP_PUSH_VAL, {.val = xc_number_create(rt, 20)}});
+xc_vm_emit(rt, vm, (xc_instruction_t){OP_ADD});
+xc_vm_emit(rt, vm, (xc_instruction_t){OP_RET});
+xc_val result = xc_vm_run(rt, vm); // 30
+*/
@@ -0,0 +1,20 @@
+/*
+ * bench.h - 基准公共部分
+ *
+ * Included by every test/bench/bench_*.c: the internal headers and a
+ * monotonic wall clock in seconds.
+ */
+
+#ifndef XC_BENCH_H
+#define XC_BENCH_H
+
+#include "../../src/xc/xc.h"
+#include "../../src/xc/xc_internal.h"
+
+static inline double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#endif /* XC_BENCH_H */
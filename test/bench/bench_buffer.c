@@ -0,0 +1,61 @@
+/*
+ * bench_buffer.c - 类型化数组基准
+ *
+ * Fills and sums one million doubles stored in a generic array (boxed
+ * numbers) and in a float64 typed array, and converts between the two.
+ */
+#include "bench.h"
+
+#define BENCH_COUNT 1000000
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_buffer: %d doubles\n", BENCH_COUNT);
+
+    double start = bench_now();
+    xc_object_t *array = xc_array_create(rt);
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        xc_array_push(rt, array, xc_number_create(rt, i * 0.5));
+    }
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "fill generic array", elapsed * 1e3,
+           (size_t)BENCH_COUNT * (sizeof(xc_object_t *) + sizeof(xc_object_t) + sizeof(double)));
+
+    start = bench_now();
+    xc_object_t *buffer = xc_buffer_create(rt, XC_BUFFER_FLOAT64, 0);
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        xc_buffer_push(rt, buffer, i * 0.5);
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "fill float64 buffer", elapsed * 1e3,
+           (size_t)BENCH_COUNT * sizeof(double));
+
+    double sum = 0;
+    start = bench_now();
+    for (size_t i = 0; i < xc_array_length(rt, array); i++) {
+        sum += xc_number_value(rt, xc_array_get(rt, array, i));
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (sum %g)\n", "sum generic array", elapsed * 1e3, sum);
+
+    sum = 0;
+    start = bench_now();
+    const double *data = xc_buffer_data(rt, buffer);
+    for (size_t i = 0; i < xc_buffer_length(rt, buffer); i++) {
+        sum += data[i];
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (sum %g)\n", "sum float64 buffer", elapsed * 1e3, sum);
+
+    start = bench_now();
+    xc_object_t *converted = xc_buffer_from_array(rt, XC_BUFFER_FLOAT64, array);
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu elements)\n", "array -> buffer", elapsed * 1e3, xc_buffer_length(rt, converted));
+
+    start = bench_now();
+    converted = xc_buffer_to_array(rt, buffer);
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu elements)\n", "buffer -> array", elapsed * 1e3, xc_array_length(rt, converted));
+    return 0;
+}
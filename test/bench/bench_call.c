@@ -0,0 +1,58 @@
+/*
+ * bench_call.c - 调用约定开销基准
+ *
+ * Compares a plain indirect C call with xc_call (varargs), xc_call_argv,
+ * and xc_call_argv with stack-frame tracking switched off at runtime.
+ */
+#include "bench.h"
+
+#define BENCH_CALLS 20000000
+
+static xc_val direct_length(xc_val self, xc_val arg) {
+    return (xc_val)xc_array_length(NULL, self);
+}
+
+static void bench_report(const char *name, double elapsed, size_t checksum) {
+    printf("%-28s %8.3f s %8.2f ns/call  (checksum %zu)\n", name, elapsed,
+           elapsed * 1e9 / BENCH_CALLS, checksum);
+}
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    xc_val array = rt->new(XC_TYPE_ARRAY, 0);
+    rt->call(array, "push", rt->new(XC_TYPE_NUMBER, 1.0));
+
+    xc_method_func volatile fn = direct_length;
+    size_t checksum = 0;
+    double start = bench_now();
+    for (long i = 0; i < BENCH_CALLS; i++) {
+        checksum += (size_t)fn(array, NULL);
+    }
+    bench_report("indirect C call", bench_now() - start, checksum);
+
+    checksum = 0;
+    start = bench_now();
+    for (long i = 0; i < BENCH_CALLS; i++) {
+        checksum += (size_t)rt->call(array, "length");
+    }
+    bench_report("xc_call (varargs)", bench_now() - start, checksum);
+
+    checksum = 0;
+    start = bench_now();
+    for (long i = 0; i < BENCH_CALLS; i++) {
+        checksum += (size_t)rt->call_argv(array, "length", 0, NULL);
+    }
+    bench_report("xc_call_argv", bench_now() - start, checksum);
+
+    xc_stack_frames_disable(rt);
+    checksum = 0;
+    start = bench_now();
+    for (long i = 0; i < BENCH_CALLS; i++) {
+        checksum += (size_t)rt->call_argv(array, "length", 0, NULL);
+    }
+    bench_report("xc_call_argv (no frames)", bench_now() - start, checksum);
+    xc_stack_frames_enable(rt);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * bench_closure.c - 闭包捕获变量读取基准
+ *
+ * Calls a closure that reads four captured variables, once through an
+ * object environment (string-keyed property lookup) and once through the
+ * flat capture slots of xc_function_create_closure.
+ */
+#include "bench.h"
+
+#define BENCH_CALLS 5000000
+
+static const char *capture_names[4] = { "a", "b", "c", "d" };
+
+static xc_val env_sum(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    xc_object_t *env = xc_function_get_closure(rt, xc_function_current(rt));
+    double sum = 0;
+    for (int i = 0; i < 4; i++) {
+        sum += xc_number_value(rt, xc_object_get(rt, env, capture_names[i]));
+    }
+    return (xc_val)(intptr_t)sum;
+}
+
+static xc_val slot_sum(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    xc_object_t *self = xc_function_current(rt);
+    double sum = 0;
+    for (int i = 0; i < 4; i++) {
+        sum += xc_number_value(rt, XC_CAPTURE(self, i));
+    }
+    return (xc_val)(intptr_t)sum;
+}
+
+static void bench_report(const char *name, double elapsed, size_t checksum) {
+    printf("%-24s %8.2f ms %8.2f ns/call  (checksum %zu)\n", name, elapsed * 1e3,
+           elapsed * 1e9 / BENCH_CALLS, checksum);
+}
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_closure: %d calls, 4 captured variables\n", BENCH_CALLS);
+
+    xc_object_t *values[4];
+    xc_object_t *env = xc_object_create(rt);
+    for (int i = 0; i < 4; i++) {
+        values[i] = xc_number_create(rt, i + 1);
+        xc_object_set(rt, env, capture_names[i], values[i]);
+    }
+    xc_object_t *env_fn = xc_function_create(rt, env_sum, env);
+    xc_object_t *slot_fn = xc_function_create_closure(rt, slot_sum, 4, values);
+
+    size_t checksum = 0;
+    double start = bench_now();
+    for (long i = 0; i < BENCH_CALLS; i++) {
+        checksum += (size_t)xc_function_call(rt, env_fn, NULL, 0, NULL);
+    }
+    bench_report("object environment", bench_now() - start, checksum);
+
+    checksum = 0;
+    start = bench_now();
+    for (long i = 0; i < BENCH_CALLS; i++) {
+        checksum += (size_t)xc_function_call(rt, slot_fn, NULL, 0, NULL);
+    }
+    bench_report("capture slots", bench_now() - start, checksum);
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * bench_dict.c - 字典模式对象基准
+ *
+ * Loads 100k keys into one object (dictionary mode past
+ * XC_OBJECT_DICT_THRESHOLD), then times lookups, misses and deletes.
+ */
+#include "bench.h"
+
+#define BENCH_KEYS 100000
+
+static char keys[BENCH_KEYS][16];
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    for (int i = 0; i < BENCH_KEYS; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%d", i);
+    }
+    xc_object_t *value = xc_number_create(rt, 1);
+    xc_object_t *obj = xc_object_create(rt);
+    printf("bench_dict: %d keys in one object\n", BENCH_KEYS);
+
+    double start = bench_now();
+    for (int i = 0; i < BENCH_KEYS; i++) {
+        xc_object_set(rt, obj, keys[i], value);
+    }
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ns/key\n", "load", elapsed * 1e9 / BENCH_KEYS);
+
+    double sum = 0;
+    start = bench_now();
+    for (int r = 0; r < 10; r++) {
+        for (int i = 0; i < BENCH_KEYS; i++) {
+            sum += xc_number_value(rt, xc_object_get(rt, obj, keys[i]));
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ns/get  (sum %.0f)\n", "get (hit)", elapsed * 1e9 / (10.0 * BENCH_KEYS), sum);
+
+    int found = 0;
+    start = bench_now();
+    for (int i = 0; i < BENCH_KEYS; i++) {
+        found += xc_object_has(rt, obj, "missing-key") ? 1 : 0;
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ns/has  (found %d)\n", "has (miss)", elapsed * 1e9 / BENCH_KEYS, found);
+
+    start = bench_now();
+    for (int i = 0; i < BENCH_KEYS; i++) {
+        xc_object_delete(rt, obj, keys[i]);
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ns/key  (left %zu)\n", "delete", elapsed * 1e9 / BENCH_KEYS,
+           xc_object_count(rt, obj));
+    return 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * bench_dot.c - 属性访问基准
+ *
+ * Measures xc_dot property reads on an object and method reads on an
+ * array, and reports how many GC objects each read allocates.
+ */
+#include "bench.h"
+
+#define BENCH_READS 5000000
+
+static void bench_report(xc_runtime_t *rt, const char *name, double start,
+                         size_t allocated_before, int ok) {
+    double elapsed = bench_now() - start;
+    size_t allocated = xc_gc_get_stats(rt).total_allocated - allocated_before;
+    printf("%-24s %8.2f ns/read  %6.3f allocs/read  %s\n", name,
+           elapsed * 1e9 / BENCH_READS, (double)allocated / BENCH_READS,
+           ok ? "" : "(WRONG RESULT)");
+}
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    xc_val obj = rt->new(XC_TYPE_OBJECT);
+    const char *keys[] = {"a", "b", "c", "d", "e", "f", "g", "h"};
+    for (int i = 0; i < 8; i++) {
+        rt->dot(obj, keys[i], rt->new(XC_TYPE_NUMBER, (double)i));
+    }
+    xc_val expected = rt->dot(obj, "h", NULL);
+
+    size_t before = xc_gc_get_stats(rt).total_allocated;
+    double start = bench_now();
+    int ok = 1;
+    for (long i = 0; i < BENCH_READS; i++) {
+        ok &= rt->dot(obj, "h", NULL) == expected;
+    }
+    bench_report(rt, "object property read", start, before, ok);
+
+    xc_val array = rt->new(XC_TYPE_ARRAY, 0);
+    xc_val method = rt->dot(array, "push", NULL);
+    before = xc_gc_get_stats(rt).total_allocated;
+    start = bench_now();
+    ok = 1;
+    for (long i = 0; i < BENCH_READS; i++) {
+        ok &= rt->dot(array, "push", NULL) == method;
+    }
+    bench_report(rt, "array method read", start, before, ok);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * bench_iter.c - 惰性迭代器基准
+ *
+ * map(x * 2) -> filter(x % 3 == 0) -> sum over 1M numbers, four ways:
+ * eagerly with an intermediate array per stage, as a fused pipeline of xc
+ * functions, with native callbacks, and with f64 callbacks over a float64
+ * typed array (no boxing at all).
+ */
+#include "bench.h"
+
+#define BENCH_COUNT 1000000
+
+static xc_val double_fn(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_number_create(rt, xc_number_value(rt, argv[0]) * 2);
+}
+
+static xc_val multiple_of_three_fn(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_boolean_create(rt, fmod(xc_number_value(rt, argv[0]), 3) == 0);
+}
+
+static xc_object_t *double_native(xc_runtime_t *rt, xc_object_t *value, void *data) {
+    return xc_number_create(rt, xc_number_value(rt, value) * 2);
+}
+
+static bool multiple_of_three_native(xc_runtime_t *rt, xc_object_t *value, void *data) {
+    return fmod(xc_number_value(rt, value), 3) == 0;
+}
+
+static double double_f64(double value, void *data) {
+    return value * 2;
+}
+
+static bool multiple_of_three_f64(double value, void *data) {
+    return fmod(value, 3) == 0;
+}
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_iter: %d elements, map -> filter -> sum\n", BENCH_COUNT);
+
+    xc_object_t *arr = xc_array_create_with_capacity(rt, BENCH_COUNT);
+    xc_object_t *buf = xc_buffer_create(rt, XC_BUFFER_FLOAT64, BENCH_COUNT);
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        xc_array_push(rt, arr, xc_number_create(rt, i));
+        xc_buffer_set_number(rt, buf, i, i);
+    }
+    xc_object_t *map_fn = xc_function_create(rt, double_fn, NULL);
+    xc_object_t *filter_fn = xc_function_create(rt, multiple_of_three_fn, NULL);
+
+    /* 逐阶段生成中间数组 */
+    double start = bench_now();
+    xc_object_t *mapped = xc_array_create(rt);
+    for (size_t i = 0; i < xc_array_length(rt, arr); i++) {
+        xc_object_t *item = xc_array_get(rt, arr, i);
+        xc_array_push(rt, mapped, xc_function_call(rt, map_fn, NULL, 1, &item));
+    }
+    xc_object_t *filtered = xc_array_create(rt);
+    for (size_t i = 0; i < xc_array_length(rt, mapped); i++) {
+        xc_object_t *item = xc_array_get(rt, mapped, i);
+        if (xc_to_boolean(rt, xc_function_call(rt, filter_fn, NULL, 1, &item))) {
+            xc_array_push(rt, filtered, item);
+        }
+    }
+    double sum = 0;
+    for (size_t i = 0; i < xc_array_length(rt, filtered); i++) {
+        sum += xc_number_value(rt, xc_array_get(rt, filtered, i));
+    }
+    printf("%-24s %8.2f ms  (sum %.0f)\n", "eager arrays", (bench_now() - start) * 1e3, sum);
+
+    start = bench_now();
+    xc_object_t *it = xc_iter(rt, arr);
+    xc_iter_filter(rt, xc_iter_map(rt, it, map_fn), filter_fn);
+    sum = xc_iter_sum(rt, it);
+    printf("%-24s %8.2f ms  (sum %.0f)\n", "fused xc functions", (bench_now() - start) * 1e3, sum);
+
+    start = bench_now();
+    it = xc_iter(rt, arr);
+    xc_iter_filter_native(rt, xc_iter_map_native(rt, it, double_native, NULL), multiple_of_three_native, NULL);
+    sum = xc_iter_sum(rt, it);
+    printf("%-24s %8.2f ms  (sum %.0f)\n", "fused native", (bench_now() - start) * 1e3, sum);
+
+    start = bench_now();
+    it = xc_iter(rt, buf);
+    xc_iter_filter_f64(rt, xc_iter_map_f64(rt, it, double_f64, NULL), multiple_of_three_f64, NULL);
+    sum = xc_iter_sum(rt, it);
+    printf("%-24s %8.2f ms  (sum %.0f)\n", "fused f64 typed array", (bench_now() - start) * 1e3, sum);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * bench_kernels.c - 数值内核基准
+ *
+ * Runs the float64 kernels over one million elements at each SIMD level
+ * (scalar, SSE2, AVX2 where the CPU supports it).
+ */
+#include "bench.h"
+
+#define BENCH_COUNT 1000000
+#define BENCH_ROUNDS 20
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    double *a = malloc(BENCH_COUNT * sizeof(double));
+    double *b = malloc(BENCH_COUNT * sizeof(double));
+    double *out = malloc(BENCH_COUNT * sizeof(double));
+    uint8_t *mask = malloc(BENCH_COUNT);
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        a[i] = (i * 7919LL % 10007) * 0.01;
+        b[i] = (i % 13) * 0.5;
+    }
+    printf("bench_kernels: %d doubles x %d rounds\n", BENCH_COUNT, BENCH_ROUNDS);
+
+    static const char *level_names[] = {"scalar", "sse2", "avx2"};
+    for (int level = XC_SIMD_SCALAR; level <= XC_SIMD_AVX2; level++) {
+        if (xc_simd_set_level(level) != level) {
+            continue;
+        }
+        double sink = 0;
+        double start = bench_now();
+        for (int r = 0; r < BENCH_ROUNDS; r++) sink += xc_simd_sum_f64(a, BENCH_COUNT);
+        double sum_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        for (int r = 0; r < BENCH_ROUNDS; r++) sink += xc_simd_min_f64(a, BENCH_COUNT);
+        double min_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        for (int r = 0; r < BENCH_ROUNDS; r++) sink += xc_simd_argmin_f64(a, BENCH_COUNT);
+        double argmin_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        for (int r = 0; r < BENCH_ROUNDS; r++) sink += xc_simd_dot_f64(a, b, BENCH_COUNT);
+        double dot_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        for (int r = 0; r < BENCH_ROUNDS; r++) xc_simd_add_f64(out, a, b, BENCH_COUNT);
+        double add_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        for (int r = 0; r < BENCH_ROUNDS; r++) xc_simd_prefix_sum_f64(out, a, BENCH_COUNT);
+        double prefix_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        for (int r = 0; r < BENCH_ROUNDS; r++) sink += xc_simd_compare_f64(mask, a, BENCH_COUNT, 50.0, XC_SIMD_GT);
+        double compare_ms = (bench_now() - start) * 1e3;
+
+        printf("%-7s sum %6.2f  min %6.2f  argmin %6.2f  dot %6.2f  add %6.2f  prefix %6.2f  gt %6.2f ms  (%g)\n",
+               level_names[level], sum_ms, min_ms, argmin_ms, dot_ms, add_ms, prefix_ms, compare_ms, sink);
+    }
+
+    free(a);
+    free(b);
+    free(out);
+    free(mask);
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * bench_method_cache.c - 方法缓存多线程扩展性基准
+ *
+ * Every thread calls xc_call(array, "length") in a tight loop. The method
+ * cache is per thread, so throughput should scale with the thread count
+ * instead of collapsing on a shared cache line.
+ */
+#include "bench.h"
+
+#define BENCH_CALLS_PER_THREAD 2000000
+#define BENCH_MAX_THREADS 16
+
+typedef struct {
+    xc_runtime_t *rt;
+    xc_val array;
+    long calls;
+    size_t checksum;
+} bench_worker_t;
+
+static void *bench_worker(void *arg) {
+    bench_worker_t *w = (bench_worker_t *)arg;
+    xc_runtime_t *rt = w->rt;
+    size_t checksum = 0;
+
+    for (long i = 0; i < w->calls; i++) {
+        checksum += (size_t)rt->call(w->array, "length");
+    }
+    w->checksum = checksum;
+    return NULL;
+}
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    xc_val array = rt->new(XC_TYPE_ARRAY, 0);
+    rt->call(array, "push", rt->new(XC_TYPE_NUMBER, 1.0));
+    rt->call(array, "push", rt->new(XC_TYPE_NUMBER, 2.0));
+
+    printf("bench_method_cache: xc_call(array, \"length\"), %d calls/thread\n",
+           BENCH_CALLS_PER_THREAD);
+    printf("%8s %12s %14s %10s\n", "threads", "seconds", "Mcalls/s", "ns/call");
+
+    double base_rate = 0;
+    for (int threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+        pthread_t tids[BENCH_MAX_THREADS];
+        bench_worker_t workers[BENCH_MAX_THREADS];
+
+        double start = bench_now();
+        for (int t = 0; t < threads; t++) {
+            workers[t].rt = rt;
+            workers[t].array = array;
+            workers[t].calls = BENCH_CALLS_PER_THREAD;
+            workers[t].checksum = 0;
+            pthread_create(&tids[t], NULL, bench_worker, &workers[t]);
+        }
+        for (int t = 0; t < threads; t++) {
+            pthread_join(tids[t], NULL);
+        }
+        double elapsed = bench_now() - start;
+
+        for (int t = 0; t < threads; t++) {
+            if (workers[t].checksum != (size_t)2 * BENCH_CALLS_PER_THREAD) {
+                printf("bench_method_cache: wrong result on thread %d\n", t);
+                return 1;
+            }
+        }
+
+        double total = (double)threads * BENCH_CALLS_PER_THREAD;
+        double rate = total / elapsed / 1e6;
+        if (threads == 1) base_rate = rate;
+        printf("%8d %12.3f %14.2f %10.2f  (x%.2f)\n", threads, elapsed, rate,
+               elapsed * 1e9 / BENCH_CALLS_PER_THREAD, rate / base_rate);
+    }
+    return 0;
+}
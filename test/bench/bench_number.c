@@ -0,0 +1,83 @@
+/*
+ * bench_number.c - 数值文本转换基准
+ *
+ * Formats and parses 1M random doubles with xc_number_format/xc_number_parse
+ * and with snprintf("%.17g")/strtod, then joins a 100k-element numeric array.
+ */
+#include "bench.h"
+
+#define BENCH_VALUES 1000000
+#define BENCH_JOIN_ITEMS 100000
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    /* Mix of fractions and arbitrary bit patterns */
+    double *values = malloc(BENCH_VALUES * sizeof(double));
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double value;
+        memcpy(&value, &state, sizeof(value));
+        if (i % 2 || value != value || value - value != 0) {
+            value = (double)(state % 100000000) / 1000.0;
+        }
+        values[i] = value;
+    }
+    printf("bench_number: %d doubles\n", BENCH_VALUES);
+
+    char (*texts)[XC_NUMBER_FORMAT_SIZE] = malloc(BENCH_VALUES * sizeof(*texts));
+    size_t *lengths = malloc(BENCH_VALUES * sizeof(size_t));
+    size_t total = 0;
+    double start = bench_now();
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        lengths[i] = xc_number_format(values[i], texts[i]);
+        total += lengths[i];
+    }
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "xc_number_format", elapsed * 1e3, total);
+
+    char buffer[40];
+    total = 0;
+    start = bench_now();
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        total += snprintf(buffer, sizeof(buffer), "%.17g", values[i]);
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "snprintf %.17g", elapsed * 1e3, total);
+
+    double sum = 0;
+    start = bench_now();
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        double value;
+        xc_number_parse(texts[i], lengths[i], &value);
+        sum += value;
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (sum %g)\n", "xc_number_parse", elapsed * 1e3, sum);
+
+    sum = 0;
+    start = bench_now();
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        sum += strtod(texts[i], NULL);
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (sum %g)\n", "strtod", elapsed * 1e3, sum);
+
+    xc_object_t *array = xc_array_create(rt);
+    for (int i = 0; i < BENCH_JOIN_ITEMS; i++) {
+        xc_array_push(rt, array, xc_number_create(rt, values[i]));
+    }
+    start = bench_now();
+    xc_object_t *str = xc_array_join(rt, array, xc_string_create(rt, ","));
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "array join", elapsed * 1e3, xc_string_length(rt, str));
+
+    free(values);
+    free(texts);
+    free(lengths);
+    return 0;
+}
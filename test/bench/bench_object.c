@@ -0,0 +1,50 @@
+/*
+ * bench_object.c - 对象属性访问基准
+ *
+ * Builds many objects with the same key sequence (one shared shape) and
+ * reads a property through xc_object_get and through an inline cache.
+ */
+#include "bench.h"
+
+#define BENCH_OBJECTS 1000
+#define BENCH_ROUNDS 5000
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    static const char *keys[] = {"id", "name", "x", "y", "width", "height", "color", "visible"};
+    xc_object_t *objects[BENCH_OBJECTS];
+    for (int i = 0; i < BENCH_OBJECTS; i++) {
+        objects[i] = xc_object_create(rt);
+        for (int k = 0; k < 8; k++) {
+            xc_object_set(rt, objects[i], keys[k], xc_number_create(rt, i * 8 + k));
+        }
+    }
+    printf("bench_object: %d objects x %d rounds, reading \"visible\" (8th key)\n",
+           BENCH_OBJECTS, BENCH_ROUNDS);
+
+    double sum = 0;
+    double start = bench_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_OBJECTS; i++) {
+            sum += xc_number_value(rt, xc_object_get(rt, objects[i], "visible"));
+        }
+    }
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ns/get  (sum %.0f)\n", "xc_object_get",
+           elapsed * 1e9 / ((double)BENCH_OBJECTS * BENCH_ROUNDS), sum);
+
+    xc_inline_cache_t ic = {0};
+    sum = 0;
+    start = bench_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_OBJECTS; i++) {
+            sum += xc_number_value(rt, xc_object_get_cached(rt, objects[i], "visible", &ic));
+        }
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ns/get  (sum %.0f)\n", "xc_object_get_cached",
+           elapsed * 1e9 / ((double)BENCH_OBJECTS * BENCH_ROUNDS), sum);
+    return 0;
+}
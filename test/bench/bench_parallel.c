@@ -0,0 +1,96 @@
+/*
+ * bench_parallel.c - 并行数组操作的扩展性基准
+ *
+ * Runs sum, reduce, map, filter, index_of and sort over a float64 typed
+ * array with 1, 2, 4 ... up to the core count threads. The default is 100M
+ * elements (about 2.4 GB with the sort scratch space); pass a smaller
+ * count as the first argument on small machines.
+ */
+#include "bench.h"
+
+#define BENCH_COUNT 100000000
+
+static double bench_add(double acc, double value, void *data) {
+    return acc + value;
+}
+
+static double bench_scale(double value, void *data) {
+    return value * 1.5 + 1;
+}
+
+static bool bench_positive(double value, void *data) {
+    return value > 0;
+}
+
+int main(int argc, char **argv) {
+    xc_runtime_t *rt = xc_singleton();
+
+    size_t n = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : BENCH_COUNT;
+    xc_object_t *buf = xc_buffer_create(rt, XC_BUFFER_FLOAT64, n);
+    xc_object_t *work = xc_buffer_create(rt, XC_BUFFER_FLOAT64, n);
+    if (!buf || !work || n == 0) {
+        fprintf(stderr, "bench_parallel: cannot allocate %zu doubles\n", n);
+        return 1;
+    }
+    /* Results of each round are collected before the next one */
+    xc_gc_add_root(rt, &buf);
+    xc_gc_add_root(rt, &work);
+    double *data = xc_buffer_data(rt, buf);
+    uint64_t seed = 1;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        data[i] = (double)(int64_t)(seed >> 20) * 1e-9;
+    }
+
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    printf("bench_parallel: %zu doubles, %d cores\n", n, cores);
+    printf("%-8s %9s %9s %9s %9s %9s %9s\n", "threads", "sum", "reduce", "map", "filter", "index_of", "sort");
+
+    double sink = 0;
+    double base_sort = 0;
+    for (int threads = 1; threads <= (cores > 1 ? cores : 1); threads *= 2) {
+        xc_parallel_set_threads(threads);
+
+        double start = bench_now();
+        sink += xc_parallel_sum(rt, buf);
+        double sum_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        sink += xc_parallel_reduce(rt, buf, bench_add, 0, NULL);
+        double reduce_ms = (bench_now() - start) * 1e3;
+
+        start = bench_now();
+        xc_object_t *mapped = xc_parallel_map(rt, buf, bench_scale, NULL);
+        double map_ms = (bench_now() - start) * 1e3;
+        sink += xc_buffer_get_number(rt, mapped, n - 1);
+
+        start = bench_now();
+        xc_object_t *kept = xc_parallel_filter(rt, buf, bench_positive, NULL);
+        double filter_ms = (bench_now() - start) * 1e3;
+        sink += xc_buffer_length(rt, kept);
+        xc_gc_run(rt);
+
+        /* Missing value: every chunk is scanned */
+        start = bench_now();
+        sink += xc_parallel_index_of(rt, buf, -1e300);
+        double index_ms = (bench_now() - start) * 1e3;
+
+        memcpy(xc_buffer_data(rt, work), data, n * sizeof(double));
+        start = bench_now();
+        xc_parallel_sort(rt, work);
+        double sort_ms = (bench_now() - start) * 1e3;
+        if (threads == 1) {
+            base_sort = sort_ms;
+        }
+
+        printf("%-8d %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f ms  (sort x%.2f)\n", threads, sum_ms, reduce_ms,
+               map_ms, filter_ms, index_ms, sort_ms, base_sort / sort_ms);
+        if (threads < cores && threads * 2 > cores) {
+            threads = cores / 2;
+        }
+    }
+    printf("(%g)\n", sink);
+    xc_gc_remove_root(rt, &buf);
+    xc_gc_remove_root(rt, &work);
+    return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * bench_queue.c - 数组队列基准
+ *
+ * Uses an array as a FIFO queue: 1M push + shift cycles with 10k elements
+ * in flight, then 1M unshift + pop cycles (the mirrored deque direction).
+ */
+#include "bench.h"
+
+#define BENCH_CYCLES 1000000
+#define BENCH_DEPTH 10000
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_queue: %d cycles, %d elements in flight\n", BENCH_CYCLES, BENCH_DEPTH);
+
+    xc_object_t *item = xc_number_create(rt, 1);
+    xc_object_t *queue = xc_array_create(rt);
+    for (int i = 0; i < BENCH_DEPTH; i++) {
+        xc_array_push(rt, queue, item);
+    }
+    double start = bench_now();
+    size_t taken = 0;
+    for (int i = 0; i < BENCH_CYCLES; i++) {
+        xc_array_push(rt, queue, item);
+        taken += xc_array_shift(rt, queue) != NULL;
+    }
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu taken, %zu left)\n", "push + shift", elapsed * 1e3, taken, xc_array_length(rt, queue));
+
+    start = bench_now();
+    taken = 0;
+    for (int i = 0; i < BENCH_CYCLES; i++) {
+        xc_array_unshift(rt, queue, item);
+        taken += xc_array_pop(rt, queue) != NULL;
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu taken, %zu left)\n", "unshift + pop", elapsed * 1e3, taken, xc_array_length(rt, queue));
+    return 0;
+}
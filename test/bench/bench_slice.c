@@ -0,0 +1,51 @@
+/*
+ * bench_slice.c - 数组切片与拼接基准
+ *
+ * Read-mostly pipeline over a 1M element array: take half-array slices and
+ * concat pairs of them, summing a few elements of each result, then the
+ * same loop with one write per result (the copy-on-write path).
+ */
+#include "bench.h"
+
+#define BENCH_COUNT 1000000
+#define BENCH_ROUNDS 200
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_slice: %d elements, %d rounds\n", BENCH_COUNT, BENCH_ROUNDS);
+
+    xc_object_t *arr = xc_array_create_with_capacity(rt, BENCH_COUNT);
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        xc_array_push(rt, arr, xc_number_create(rt, i));
+    }
+
+    double sink = 0;
+    double start = bench_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        xc_object_t *slice = xc_array_slice(rt, arr, r, BENCH_COUNT / 2 + r);
+        sink += xc_number_value(rt, xc_array_get(rt, slice, BENCH_COUNT / 4));
+    }
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms\n", "slice (read)", elapsed * 1e3);
+
+    start = bench_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        xc_object_t *left = xc_array_slice(rt, arr, 0, BENCH_COUNT / 2);
+        xc_object_t *right = xc_array_slice(rt, arr, BENCH_COUNT / 2, BENCH_COUNT);
+        xc_object_t *joined = xc_array_concat(rt, right, left);
+        sink += xc_number_value(rt, xc_array_get(rt, joined, r));
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms\n", "slice + concat (read)", elapsed * 1e3);
+
+    start = bench_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        xc_object_t *slice = xc_array_slice(rt, arr, r, BENCH_COUNT / 2 + r);
+        xc_array_set(rt, slice, 0, NULL);
+        sink += xc_array_length(rt, slice);
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%g)\n", "slice + write", elapsed * 1e3, sink);
+    return 0;
+}
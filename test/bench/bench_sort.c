@@ -0,0 +1,90 @@
+/*
+ * bench_sort.c - 排序基准
+ *
+ * Sorts 1M random numbers with the number fast path, the stable merge sort
+ * and a custom comparator function (one call per comparison, the cost of
+ * sorting through a comparator before there was a native sort), then 200k
+ * strings, top-100 of 1M, and a 1M float64 typed array by radix sort
+ * against libc qsort on the same doubles.
+ */
+#include "bench.h"
+
+#define BENCH_COUNT 1000000
+#define BENCH_STRINGS 200000
+#define BENCH_TOP_K 100
+
+static xc_val compare_numbers(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    double a = xc_number_value(rt, argv[0]), b = xc_number_value(rt, argv[1]);
+    return xc_number_box(rt, (a > b) - (a < b));
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *name, double start, xc_object_t *arr) {
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (first %g)\n", name, elapsed * 1e3, xc_number_value(xc_singleton(), xc_array_get(xc_singleton(), arr, 0)));
+}
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_sort: %d numbers, %d strings\n", BENCH_COUNT, BENCH_STRINGS);
+
+    uint32_t seed = 42;
+    xc_object_t *numbers = xc_array_create_with_capacity(rt, BENCH_COUNT);
+    xc_object_t *floats = xc_buffer_create(rt, XC_BUFFER_FLOAT64, BENCH_COUNT);
+    double *plain = malloc(BENCH_COUNT * sizeof(double));
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        seed = seed * 1103515245 + 12345;
+        double x = (double)(int32_t)seed / 1024;
+        xc_array_push(rt, numbers, xc_number_create(rt, x));
+        xc_buffer_set_number(rt, floats, i, x);
+        plain[i] = x;
+    }
+
+    xc_object_t *copy = xc_array_slice(rt, numbers, 0, BENCH_COUNT);
+    double start = bench_now();
+    xc_array_sort(rt, copy, NULL);
+    report("sort numbers", start, copy);
+
+    copy = xc_array_slice(rt, numbers, 0, BENCH_COUNT);
+    start = bench_now();
+    xc_array_sort_stable(rt, copy, NULL);
+    report("sortStable numbers", start, copy);
+
+    copy = xc_array_slice(rt, numbers, 0, BENCH_COUNT);
+    xc_object_t *comparator = xc_function_create(rt, compare_numbers, NULL);
+    start = bench_now();
+    xc_array_sort(rt, copy, comparator);
+    report("sort with comparator", start, copy);
+
+    start = bench_now();
+    xc_object_t *top = xc_array_top_k(rt, numbers, BENCH_TOP_K, NULL);
+    report("topK 100", start, top);
+
+    xc_object_t *strings = xc_array_create_with_capacity(rt, BENCH_STRINGS);
+    for (int i = 0; i < BENCH_STRINGS; i++) {
+        char text[32];
+        seed = seed * 1103515245 + 12345;
+        snprintf(text, sizeof(text), "key-%08x", seed);
+        xc_array_push(rt, strings, xc_string_create(rt, text));
+    }
+    start = bench_now();
+    xc_array_sort(rt, strings, NULL);
+    printf("%-24s %8.2f ms  (first %s)\n", "sort strings", (bench_now() - start) * 1e3,
+           xc_string_value(rt, xc_array_get(rt, strings, 0)));
+
+    start = bench_now();
+    xc_buffer_sort(rt, floats);
+    printf("%-24s %8.2f ms  (first %g)\n", "buffer radix sort", (bench_now() - start) * 1e3,
+           xc_buffer_get_number(rt, floats, 0));
+
+    start = bench_now();
+    qsort(plain, BENCH_COUNT, sizeof(double), compare_doubles);
+    printf("%-24s %8.2f ms  (first %g)\n", "qsort doubles", (bench_now() - start) * 1e3, plain[0]);
+    free(plain);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * bench_string.c - 字符串拼接基准
+ *
+ * Builds a 10 MB string from 16-byte pieces with repeated concat (ropes)
+ * and with xc_string_builder, joins a 100k-element array, and splits the
+ * 10 MB string into 64-byte tokens with slices and with copies.
+ */
+#include "bench.h"
+
+#define BENCH_PIECES (10 * 1024 * 1024 / 16)
+#define BENCH_JOIN_ITEMS 100000
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+
+    xc_object_t *piece = xc_string_create(rt, "0123456789abcdef");
+    printf("bench_string: %d pieces of 16 bytes\n", BENCH_PIECES);
+
+    double start = bench_now();
+    xc_object_t *str = xc_string_create(rt, "");
+    for (int i = 0; i < BENCH_PIECES; i++) {
+        str = xc_string_concat(rt, str, piece);
+    }
+    size_t len = strlen(xc_string_value(rt, str));
+    double elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "concat + flatten", elapsed * 1e3, len);
+
+    start = bench_now();
+    xc_string_builder_t sb;
+    xc_string_builder_init(&sb, 0);
+    for (int i = 0; i < BENCH_PIECES; i++) {
+        xc_string_builder_append_string(rt, &sb, piece);
+    }
+    str = xc_string_builder_finish(rt, &sb);
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "string builder", elapsed * 1e3, xc_string_length(rt, str));
+
+    xc_object_t *array = xc_array_create(rt);
+    for (int i = 0; i < BENCH_JOIN_ITEMS; i++) {
+        xc_array_push(rt, array, i % 2 ? piece : xc_number_create(rt, i));
+    }
+    start = bench_now();
+    str = xc_array_join(rt, array, xc_string_create(rt, ","));
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu bytes)\n", "array join", elapsed * 1e3, xc_string_length(rt, str));
+
+    xc_string_builder_init(&sb, 0);
+    for (int i = 0; i < BENCH_PIECES; i++) {
+        xc_string_builder_append_string(rt, &sb, piece);
+    }
+    xc_object_t *text = xc_string_builder_finish(rt, &sb);
+    size_t text_len = xc_string_length(rt, text);
+
+    size_t tokens = 0;
+    start = bench_now();
+    for (size_t pos = 0; pos + 64 <= text_len; pos += 64) {
+        tokens += xc_string_slice(rt, text, pos, 64) != NULL;
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu tokens)\n", "tokenize (slice)", elapsed * 1e3, tokens);
+
+    tokens = 0;
+    const char *chars = xc_string_data(rt, text);
+    start = bench_now();
+    for (size_t pos = 0; pos + 64 <= text_len; pos += 64) {
+        tokens += xc_string_create_len(rt, chars + pos, 64) != NULL;
+    }
+    elapsed = bench_now() - start;
+    printf("%-24s %8.2f ms  (%zu tokens)\n", "tokenize (copy)", elapsed * 1e3, tokens);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * bench_string_kernels.c - 字符串 SIMD 内核基准
+ *
+ * Runs search, UTF-8 validation, code point counting and case mapping
+ * on 1 KB to 100 MB inputs at every SIMD level the CPU supports.
+ * Throughput is in GB/s; the needle only occurs at the very end.
+ */
+#include "bench.h"
+
+/* Bytes processed per measurement, so small inputs are repeated */
+#define BENCH_BYTES (256u * 1024 * 1024)
+
+static const char *level_names[] = {"scalar", "sse2", "avx2"};
+static volatile size_t sink;
+
+int main(void) {
+    static const size_t sizes[] = {1024, 64 * 1024, 1024 * 1024, 100 * 1024 * 1024};
+    size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    const char *needle = "xc-needle";
+    size_t needle_len = strlen(needle);
+
+    char *text = (char *)malloc(max_size);
+    char *out = (char *)malloc(max_size);
+    for (size_t i = 0; i < max_size; i++) {
+        text[i] = "The quick brown fox jumps over the lazy dog. "[i % 45];
+    }
+
+    int best = xc_simd_get_level();
+    printf("bench_string_kernels: best SIMD level %s\n", level_names[best]);
+    printf("%-10s %-8s %10s %10s %10s %10s\n", "size", "level", "indexOf", "utf8 ok", "cp length", "lower");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t size = sizes[s];
+        memcpy(text + size - needle_len, needle, needle_len);
+        size_t reps = BENCH_BYTES / size;
+        if (reps == 0) {
+            reps = 1;
+        }
+
+        for (int level = XC_SIMD_SCALAR; level <= best; level++) {
+            xc_simd_set_level(level);
+            double gbs[4];
+
+            double start = bench_now();
+            for (size_t r = 0; r < reps; r++) {
+                sink += (size_t)xc_simd_find(text, size, needle, needle_len);
+            }
+            gbs[0] = (double)size * reps / (bench_now() - start) / 1e9;
+
+            start = bench_now();
+            for (size_t r = 0; r < reps; r++) {
+                sink += xc_simd_utf8_validate(text, size);
+            }
+            gbs[1] = (double)size * reps / (bench_now() - start) / 1e9;
+
+            start = bench_now();
+            for (size_t r = 0; r < reps; r++) {
+                sink += xc_simd_utf8_length(text, size);
+            }
+            gbs[2] = (double)size * reps / (bench_now() - start) / 1e9;
+
+            start = bench_now();
+            for (size_t r = 0; r < reps; r++) {
+                xc_simd_case_map(out, text, size, false);
+                sink += (unsigned char)out[r % size];
+            }
+            gbs[3] = (double)size * reps / (bench_now() - start) / 1e9;
+
+            printf("%-10zu %-8s %7.2f GB/s %5.2f GB/s %5.2f GB/s %5.2f GB/s\n",
+                   size, level_names[level], gbs[0], gbs[1], gbs[2], gbs[3]);
+        }
+        memcpy(text + size - needle_len, "The quick", needle_len);
+    }
+
+    free(text);
+    free(out);
+    return 0;
+}
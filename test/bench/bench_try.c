@@ -0,0 +1,124 @@
+/*
+ * bench_try.c - try/catch 开销基准
+ *
+ * Runs a try block that returns normally and one that fails, first through
+ * try_catch_finally (setjmp frame per try, failure thrown with longjmp) and
+ * then through xc_try_result (failure returned as XC_ERROR, no setjmp).
+ */
+#include "bench.h"
+
+#define BENCH_TRIES 1000000
+
+static xc_object_t *bench_error;
+static xc_object_t *bench_value;
+
+static xc_val ok_block(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return bench_value;
+}
+
+static xc_val throw_block(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    rt->throw(bench_error);
+    return NULL;
+}
+
+static xc_val raise_block(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_raise(rt, bench_error);
+}
+
+static xc_val raise_new_block(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_raise(rt, xc_exception_create(rt, XC_EXCEPTION_TYPE_RANGE, "not found"));
+}
+
+static xc_val raise_pooled_block(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_raise(rt, xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_RANGE, "not found"));
+}
+
+static xc_val catch_block(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return bench_value;
+}
+
+/* 池化异常由处理器显式归还 */
+static xc_val release_catch_block(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    xc_exception_release(rt, argv[0]);
+    return bench_value;
+}
+
+static void bench_report(const char *name, double elapsed) {
+    printf("%-28s %8.2f ms %8.2f ns/try\n", name, elapsed * 1e3, elapsed * 1e9 / BENCH_TRIES);
+}
+
+int main(void) {
+    xc_runtime_t *rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_try: %d tries\n", BENCH_TRIES);
+
+    bench_error = xc_exception_create(rt, XC_EXCEPTION_TYPE_ERROR, "bench");
+    bench_value = xc_number_create(rt, 1);
+    xc_object_t *ok_fn = xc_function_create_closure(rt, ok_block, 0, NULL);
+    xc_object_t *throw_fn = xc_function_create_closure(rt, throw_block, 0, NULL);
+    xc_object_t *raise_fn = xc_function_create_closure(rt, raise_block, 0, NULL);
+    xc_object_t *raise_new_fn = xc_function_create_closure(rt, raise_new_block, 0, NULL);
+    xc_object_t *raise_pooled_fn = xc_function_create_closure(rt, raise_pooled_block, 0, NULL);
+    xc_object_t *catch_fn = xc_function_create_closure(rt, catch_block, 0, NULL);
+    xc_object_t *release_catch_fn = xc_function_create_closure(rt, release_catch_block, 0, NULL);
+
+    size_t hits = 0;
+    double start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += rt->try_catch_finally(ok_fn, catch_fn, NULL) == bench_value;
+    }
+    bench_report("try_catch_finally (ok)", bench_now() - start);
+
+    start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += rt->try_catch_finally(throw_fn, catch_fn, NULL) == bench_value;
+    }
+    bench_report("try_catch_finally (throw)", bench_now() - start);
+
+    start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += xc_try_result(rt, ok_fn, catch_fn, NULL) == bench_value;
+    }
+    bench_report("xc_try_result (ok)", bench_now() - start);
+
+    start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += xc_try_result(rt, raise_fn, catch_fn, NULL) == bench_value;
+    }
+    bench_report("xc_try_result (raise)", bench_now() - start);
+
+    /* Control-flow exceptions: creation cost 8 frames deep, with and without a trace snapshot */
+    static const xc_frame_desc_t bench_frame = {"bench_frame", __FILE__, __LINE__};
+    int depth = push_stack_frame(&bench_frame, NULL);
+    for (int i = 1; i < 8; i++) {
+        push_stack_frame(&bench_frame, NULL);
+    }
+    start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += xc_exception_create(rt, XC_EXCEPTION_TYPE_RANGE, "not found") != NULL;
+    }
+    bench_report("exception create", bench_now() - start);
+
+    xc_exception_set_trace_enabled(rt, XC_EXCEPTION_TYPE_RANGE, false);
+    start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += xc_exception_create(rt, XC_EXCEPTION_TYPE_RANGE, "not found") != NULL;
+    }
+    bench_report("exception create (no trace)", bench_now() - start);
+    pop_stack_frame(depth);
+
+    /* A fresh exception per throw: GC-allocated vs recycled from the pool */
+    start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += xc_try_result(rt, raise_new_fn, catch_fn, NULL) == bench_value;
+    }
+    bench_report("raise new exception", bench_now() - start);
+
+    start = bench_now();
+    for (long i = 0; i < BENCH_TRIES; i++) {
+        hits += xc_try_result(rt, raise_pooled_fn, release_catch_fn, NULL) == bench_value;
+    }
+    bench_report("raise pooled exception", bench_now() - start);
+    printf("(%zu)\n", hits);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * bench_vm.c - 字节码解释器基准
+ *
+ * Four loops run by xc_vm_run: arithmetic on locals, a property read/write
+ * on an object held in a local, a native call per iteration and an array
+ * element sum. Every value stays inside the small-integer box cache, so the
+ * loops measure dispatch and type checks rather than allocation. Each loop
+ * runs as stack bytecode and as translated register code (where ADD, LT and
+ * GET_ELEM are quickened to their numeric forms); the instruction counts
+ * are the dispatches per program. Build libxc and this file with
+ * -DXC_VM_THREADED=0 to time the switch fallback.
+ */
+#include "bench.h"
+
+#define BENCH_LOOP 256
+#define BENCH_RUNS 20000
+
+#define EMIT(vm, ...) xc_vm_emit(rt, vm, (xc_instruction_t){__VA_ARGS__})
+
+static xc_runtime_t *rt;
+
+static xc_val bench_inc(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_number_box(rt, xc_number_value(rt, argv[0]) + 1);
+}
+
+/* i = 0; while (i < BENCH_LOOP) { body; i = i + 1 }  locals[0] 为 i */
+static int emit_loop_head(xc_object_t *vm, int *exit_jump) {
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 0)});
+    EMIT(vm, OP_STORE, {.var = {0, 0}});
+    int loop = EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, BENCH_LOOP)});
+    EMIT(vm, OP_LT);
+    *exit_jump = EMIT(vm, OP_JMP_IF_FALSE);
+    return loop;
+}
+
+static void emit_loop_tail(xc_object_t *vm, int loop, int exit_jump) {
+    EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 1)});
+    EMIT(vm, OP_ADD);
+    EMIT(vm, OP_STORE, {.var = {0, 0}});
+    EMIT(vm, OP_JMP, {.i32 = loop});
+    xc_vm_set_jump(rt, vm, exit_jump, EMIT(vm, OP_LOAD, {.var = {1, 0}}));
+    EMIT(vm, OP_RET);
+}
+
+static double bench_mode(xc_object_t *vm, int mode, xc_val *result) {
+    xc_vm_set_mode(rt, vm, mode);
+    *result = xc_vm_run(rt, vm);
+    double start = bench_now();
+    for (int r = 0; r < BENCH_RUNS; r++) {
+        *result = xc_vm_run(rt, vm);
+    }
+    return bench_now() - start;
+}
+
+/* 同一段代码分别用栈模式和寄存器模式执行，交替两轮取较快的一次 */
+static void bench_run(const char *name, xc_object_t *vm) {
+    xc_vm_t *v = (xc_vm_t *)vm;
+    double best[2] = {1e9, 1e9};
+    xc_val result = NULL;
+    for (int round = 0; round < 2; round++) {
+        for (int mode = 0; mode < 2; mode++) {
+            double elapsed = bench_mode(vm, mode, &result);
+            if (elapsed < best[mode]) {
+                best[mode] = elapsed;
+            }
+        }
+    }
+    for (int mode = XC_VM_MODE_STACK; mode >= XC_VM_MODE_REGISTER; mode--) {
+        int instrs = mode == XC_VM_MODE_STACK ? v->code_size : v->reg_instr_count;
+        int bytes = mode == XC_VM_MODE_STACK ? v->bytecode_size : v->regcode_size;
+        printf("%-20s %-8s %8.2f ms  %6.2f ns/iter  (%d instrs, %d bytes, %g)\n", name,
+               mode == XC_VM_MODE_STACK ? "stack" : "register", best[mode] * 1e3,
+               best[mode] * 1e9 / ((double)BENCH_LOOP * BENCH_RUNS), instrs, bytes,
+               XC_IS_ERROR(result) ? -1 : xc_number_value(rt, result));
+    }
+}
+
+int main(void) {
+    rt = xc_singleton();
+    xc_gc_disable(rt);
+    printf("bench_vm: %d x %d iterations, %s dispatch\n", BENCH_RUNS, BENCH_LOOP,
+           XC_VM_THREADED ? "threaded" : "switch");
+    int exit_jump, loop;
+
+    /* acc = (acc * 3 + i) & 255 */
+    xc_object_t *vm = xc_vm_create(0);
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 0)});
+    EMIT(vm, OP_STORE, {.var = {1, 0}});
+    loop = emit_loop_head(vm, &exit_jump);
+    EMIT(vm, OP_LOAD, {.var = {1, 0}});
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 3)});
+    EMIT(vm, OP_MUL);
+    EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    EMIT(vm, OP_ADD);
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 255)});
+    EMIT(vm, OP_BIT_AND);
+    EMIT(vm, OP_STORE, {.var = {1, 0}});
+    emit_loop_tail(vm, loop, exit_jump);
+    bench_run("arithmetic loop", vm);
+
+    /* obj.count = obj.count + 1，结果为 obj.count */
+    vm = xc_vm_create(0);
+    EMIT(vm, OP_NEW_OBJECT);
+    EMIT(vm, OP_DUP);
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 0)});
+    EMIT(vm, OP_SET_PROP, {.str = "count"});
+    EMIT(vm, OP_STORE, {.var = {2, 0}});
+    loop = emit_loop_head(vm, &exit_jump);
+    EMIT(vm, OP_LOAD, {.var = {2, 0}});
+    EMIT(vm, OP_LOAD, {.var = {2, 0}});
+    EMIT(vm, OP_GET_PROP, {.str = "count"});
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 1)});
+    EMIT(vm, OP_ADD);
+    EMIT(vm, OP_DUP);
+    EMIT(vm, OP_STORE, {.var = {1, 0}});
+    EMIT(vm, OP_SET_PROP, {.str = "count"});
+    emit_loop_tail(vm, loop, exit_jump);
+    bench_run("property access", vm);
+
+    /* acc = inc(acc) */
+    vm = xc_vm_create(0);
+    xc_vm_set_global(rt, vm, "inc", xc_function_create(rt, bench_inc, NULL));
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 0)});
+    EMIT(vm, OP_STORE, {.var = {1, 0}});
+    loop = emit_loop_head(vm, &exit_jump);
+    EMIT(vm, OP_LOAD_GLOBAL, {.str = "inc"});
+    EMIT(vm, OP_LOAD, {.var = {1, 0}});
+    EMIT(vm, OP_CALL, {.i32 = 1});
+    EMIT(vm, OP_STORE, {.var = {1, 0}});
+    emit_loop_tail(vm, loop, exit_jump);
+    bench_run("native call", vm);
+
+    /* acc = (acc + arr[i]) & 511 */
+    xc_object_t *arr = xc_array_create_with_capacity(rt, BENCH_LOOP);
+    for (int i = 0; i < BENCH_LOOP; i++) {
+        xc_array_push(rt, arr, xc_number_box(rt, i & 7));
+    }
+    vm = xc_vm_create(0);
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 0)});
+    EMIT(vm, OP_STORE, {.var = {1, 0}});
+    loop = emit_loop_head(vm, &exit_jump);
+    EMIT(vm, OP_LOAD, {.var = {1, 0}});
+    EMIT(vm, OP_PUSH_VAL, {.val = arr});
+    EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    EMIT(vm, OP_GET_ELEM);
+    EMIT(vm, OP_ADD);
+    EMIT(vm, OP_PUSH_VAL, {.val = xc_number_box(rt, 511)});
+    EMIT(vm, OP_BIT_AND);
+    EMIT(vm, OP_STORE, {.var = {1, 0}});
+    emit_loop_tail(vm, loop, exit_jump);
+    bench_run("array element sum", vm);
+    return 0;
+}
@@ -39,10 +39,131 @@ static void test_runtime_interface(void) {
     test_end("Runtime Interface");
 }
 
+/* Worker for the threaded method lookup test */
+static void* method_lookup_worker(void* arg) {
+    xc_val array = (xc_val)arg;
+    long ok = 0;
+    for (int i = 0; i < 10000; i++) {
+        if ((size_t)rt->call(array, "length") == 1) ok++;
+    }
+    return (void*)ok;
+}
+
+/* Test method lookup through the per-thread cache */
+static void test_method_lookup(void) {
+    test_start("Method Lookup");
+    
+    /* "concat" is the first registered method and used to be unreachable */
+    xc_val a = rt->new(XC_TYPE_STRING, "foo");
+    xc_val b = rt->new(XC_TYPE_STRING, "bar");
+    xc_val ab = rt->call(a, "concat", b);
+    TEST_ASSERT(ab && rt->is(ab, XC_TYPE_STRING), "first registered method is found");
+    TEST_ASSERT(ab && strcmp(xc_string_value(rt, ab), "foobar") == 0, "concat result");
+    
+    /* Names sharing a cache slot must not return each other's methods */
+    TEST_ASSERT(rt->call(a, "no_such_method") == NULL, "unknown method returns null");
+    
+    xc_val array = rt->new(XC_TYPE_ARRAY, 0);
+    rt->call(array, "push", a);
+    pthread_t tids[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&tids[i], NULL, method_lookup_worker, array);
+    }
+    long total = 0;
+    for (int i = 0; i < 4; i++) {
+        void* ok = NULL;
+        pthread_join(tids[i], &ok);
+        total += (long)ok;
+    }
+    TEST_ASSERT_EQUAL(40000L, total, "concurrent lookups return the right method");
+    
+    test_end("Method Lookup");
+}
+
+/* Handler that echoes its first argument */
+static xc_val frame_depth_handler(xc_runtime_t* rt, xc_val this_obj, int argc, xc_val* argv) {
+    return argc > 0 ? argv[0] : NULL;
+}
+
+/* Test the argc/argv calling convention and frame tracking */
+static void test_call_argv(void) {
+    test_start("Call Argv");
+    
+    xc_val a = rt->new(XC_TYPE_STRING, "ab");
+    xc_val b = rt->new(XC_TYPE_STRING, "cd");
+    xc_val argv[1] = {b};
+    xc_val ab = rt->call_argv(a, "concat", 1, argv);
+    TEST_ASSERT(ab && strcmp(xc_string_value(rt, ab), "abcd") == 0, "call_argv passes argv[0]");
+    
+    xc_val fn = rt->new(XC_TYPE_FUNC, frame_depth_handler, NULL);
+    TEST_ASSERT(rt->invoke_argv(fn, 1, argv) == b, "invoke_argv passes argv");
+    TEST_ASSERT(rt->invoke(fn, 1, b) == b, "invoke still packs varargs");
+    
+    /* 多余的参数报错，而不是悄悄丢掉 */
+    xc_val two[2] = {b, b};
+    TEST_ASSERT(XC_IS_ERROR(rt->call_argv(a, "concat", 2, two)), "call_argv rejects a second argument");
+    xc_object_t *error = xc_take_pending_exception(rt);
+    TEST_ASSERT(error && xc_exception_get_type(rt, error) == XC_EXCEPTION_TYPE_TYPE, "TypeError is pending");
+    TEST_ASSERT(XC_IS_ERROR(rt->invoke(fn, XC_INVOKE_MAX_ARGS + 1, b, b, b, b, b, b, b, b, b, b, b, b, b, b, b, b, b)),
+                "invoke rejects more than XC_INVOKE_MAX_ARGS arguments");
+    error = xc_take_pending_exception(rt);
+    TEST_ASSERT(error && xc_exception_get_type(rt, error) == XC_EXCEPTION_TYPE_RANGE, "RangeError is pending");
+    xc_val bound = rt->dot(a, "concat", NULL);
+    TEST_ASSERT(XC_IS_ERROR(rt->invoke_argv(bound, 2, two)), "Bound method rejects a second argument");
+    xc_take_pending_exception(rt);
+    
+    int depth = _xc_thread_state.depth;
+    xc_stack_frames_disable(rt);
+    rt->call_argv(a, "length", 0, NULL);
+    xc_stack_frames_enable(rt);
+    TEST_ASSERT_EQUAL(depth, _xc_thread_state.depth, "frame depth restored after calls");
+    
+    test_end("Call Argv");
+}
+
+/* Test that a collection keeps reachable objects and frees the rest */
+static void test_gc_reachability(void) {
+    test_start("GC Reachability");
+    
+    xc_object_t *holder = xc_object_create(rt);
+    xc_gc_add_root(rt, &holder);
+    xc_object_t *items = xc_array_create(rt);
+    xc_object_set(rt, holder, "items", items);
+    for (int i = 0; i < 100; i++) {
+        xc_array_push(rt, items, xc_number_create(rt, i));
+    }
+    xc_object_set(rt, holder, "name", xc_string_create(rt, "kept"));
+    for (int i = 0; i < 100; i++) {
+        xc_string_create(rt, "garbage");
+    }
+    
+    size_t freed = xc_gc_get_stats(rt).total_freed;
+    xc_gc_run(rt);
+    TEST_ASSERT(xc_gc_get_stats(rt).total_freed >= freed + 100, "unreachable objects are freed");
+    
+    /* 对象、数组和数组元素都靠 marker 存活 */
+    items = xc_object_get(rt, holder, "items");
+    TEST_ASSERT_EQUAL(100, (int)xc_array_length(rt, items), "rooted array survives");
+    TEST_ASSERT_EQUAL(99.0, xc_number_value(rt, xc_array_get(rt, items, 99)), "array items survive");
+    TEST_ASSERT(strcmp(xc_string_value(rt, xc_object_get(rt, holder, "name")), "kept") == 0,
+                "object properties survive");
+    TEST_ASSERT(xc_is_null(rt, xc_null_create(rt)) && xc_to_boolean(rt, xc_boolean_create(rt, true)),
+                "null and boolean singletons survive");
+    
+    xc_gc_remove_root(rt, &holder);
+    test_end("GC Reachability");
+}
+
 /* Register all test suites */
 static void register_test_suites(void) {
     test_register("runtime.interface", test_runtime_interface, "core", 
                  "Test runtime interface availability");
+    test_register("runtime.method_lookup", test_method_lookup, "core",
+                 "Test method lookup cache");
+    test_register("runtime.call_argv", test_call_argv, "core",
+                 "Test argc/argv calling convention");
+    test_register("runtime.gc_reachability", test_gc_reachability, "core",
+                 "Test GC marking and sweeping");
 }
 
 int main(int argc, char* argv[]) {
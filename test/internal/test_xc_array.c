@@ -5,6 +5,7 @@
  * It tests array creation, element access, modification, and various array operations.
  */
 #include "test_utils.h"
+#include "../../src/xc/xc_std/xc_std_math.h"
 
 static xc_runtime_t* rt = NULL;
 // 将TEST_ARRAY_STANDALONE定义注释掉，这样main函数就不会被编译
@@ -23,6 +24,698 @@ static void test_array_simple() {
     test_end("Array Simple Test");
 }
 
+// 队列用法：两端的 shift/unshift 和 push/pop
+static void test_array_queue() {
+    test_start("Array Queue Test");
+    
+    xc_object_t *values[64];
+    for (int i = 0; i < 64; i++) {
+        values[i] = xc_number_create(rt, i);
+    }
+    
+    /* FIFO：交替 push 和 shift，队列中始终保持 10 个元素 */
+    xc_object_t *queue = xc_array_create(rt);
+    for (int i = 0; i < 10; i++) {
+        xc_array_push(rt, queue, values[i]);
+    }
+    bool fifo = true;
+    for (int i = 10; i < 10000; i++) {
+        xc_array_push(rt, queue, values[i % 64]);
+        fifo = fifo && xc_array_shift(rt, queue) == values[(i - 10) % 64];
+    }
+    TEST_ASSERT(fifo, "push + shift keeps FIFO order");
+    TEST_ASSERT_EQUAL((size_t)10, xc_array_length(rt, queue), "Queue length is stable");
+    TEST_ASSERT(((xc_array_t *)queue)->head + ((xc_array_t *)queue)->capacity <= 64,
+                "The front gap is reclaimed instead of growing");
+    
+    /* 反方向：unshift + pop */
+    xc_object_t *deque = xc_array_create(rt);
+    for (int i = 0; i < 100; i++) {
+        xc_array_unshift(rt, deque, values[i % 64]);
+    }
+    TEST_ASSERT(xc_array_get(rt, deque, 0) == values[99 % 64] && xc_array_get(rt, deque, 99) == values[0],
+                "unshift prepends");
+    bool lifo = true;
+    for (int i = 0; i < 100; i++) {
+        lifo = lifo && xc_array_pop(rt, deque) == values[i % 64];
+    }
+    TEST_ASSERT(lifo && xc_array_length(rt, deque) == 0, "pop returns unshifted elements in order");
+    TEST_ASSERT(xc_array_shift(rt, deque) == NULL, "shift on an empty array returns NULL");
+    
+    /* slice/concat/index_of 在前端有空隙时仍然正确 */
+    xc_object_t *arr = xc_array_create(rt);
+    for (int i = 0; i < 8; i++) {
+        xc_array_push(rt, arr, values[i]);
+    }
+    xc_array_shift(rt, arr);
+    xc_array_shift(rt, arr);
+    xc_array_unshift(rt, arr, values[42]);
+    xc_object_t *slice = xc_array_slice(rt, arr, 1, 3);
+    TEST_ASSERT(xc_array_length(rt, slice) == 2 && xc_array_get(rt, slice, 0) == values[2] &&
+                xc_array_get(rt, slice, 1) == values[3], "slice after shift/unshift");
+    TEST_ASSERT(xc_array_length(rt, xc_array_slice(rt, arr, 0, -100)) == 0 &&
+                xc_array_length(rt, xc_array_slice(rt, arr, -100, 2)) == 2 &&
+                xc_array_length(rt, xc_array_slice(rt, arr, -2, 100)) == 2, "Out-of-range negative indices clamp");
+    xc_object_t *joined = xc_array_concat(rt, arr, slice);
+    TEST_ASSERT(xc_array_length(rt, joined) == 9 && xc_array_get(rt, joined, 0) == values[42] &&
+                xc_array_get(rt, joined, 8) == values[3], "concat after shift/unshift");
+    TEST_ASSERT(xc_array_index_of(rt, arr, values[7]) == 6, "index_of after shift/unshift");
+    
+    test_end("Array Queue Test");
+}
+
+// 类型化数组测试
+static void test_array_typed() {
+    test_start("Typed Array Test");
+    
+    /* 一百万个 float64：一块连续内存，没有装箱对象 */
+    const size_t count = 1000000;
+    xc_object_t *f64 = xc_buffer_create(rt, XC_BUFFER_FLOAT64, count);
+    TEST_ASSERT_NOT_NULL(f64, "Create float64 typed array");
+    TEST_ASSERT(rt->is(f64, XC_TYPE_BUFFER), "Typed arrays use XC_TYPE_BUFFER");
+    TEST_ASSERT_EQUAL(count, xc_buffer_length(rt, f64), "Length of new typed array");
+    double *data = (double *)xc_buffer_data(rt, f64);
+    for (size_t i = 0; i < count; i++) {
+        data[i] = i * 0.5;
+    }
+    TEST_ASSERT(xc_buffer_get_number(rt, f64, 999999) == 499999.5, "Raw stores are visible");
+    TEST_ASSERT(xc_number_value(rt, xc_buffer_get(rt, f64, 3)) == 1.5, "Boxed get");
+    TEST_ASSERT(xc_buffer_get(rt, f64, count) == NULL, "Out-of-range get returns NULL");
+    
+    /* 小整数复用缓存的装箱对象 */
+    TEST_ASSERT(xc_buffer_get(rt, f64, 2) == xc_buffer_get(rt, f64, 2), "Small integers reuse cached boxes");
+    
+    /* 整数类型的截断和回绕 */
+    xc_object_t *u8 = xc_buffer_create(rt, XC_BUFFER_UINT8, 0);
+    xc_buffer_push(rt, u8, 255);
+    xc_buffer_push(rt, u8, 256);
+    xc_buffer_push(rt, u8, -1);
+    xc_buffer_push(rt, u8, 3.9);
+    TEST_ASSERT_EQUAL((size_t)4, xc_buffer_length(rt, u8), "Push grows the typed array");
+    TEST_ASSERT(xc_buffer_get_number(rt, u8, 0) == 255 && xc_buffer_get_number(rt, u8, 1) == 0 &&
+                xc_buffer_get_number(rt, u8, 2) == 255 && xc_buffer_get_number(rt, u8, 3) == 3,
+                "uint8 stores truncate and wrap");
+    xc_object_t *i32 = xc_buffer_create(rt, XC_BUFFER_INT32, 1);
+    xc_buffer_set_number(rt, i32, 0, 2147483648.0);
+    TEST_ASSERT(xc_buffer_get_number(rt, i32, 0) == -2147483648.0, "int32 stores wrap");
+    xc_object_t *f32 = xc_buffer_create(rt, XC_BUFFER_FLOAT32, 1);
+    xc_buffer_set_number(rt, f32, 0, 0.1);
+    TEST_ASSERT(xc_buffer_get_number(rt, f32, 0) == (double)0.1f, "float32 stores round");
+    
+    /* 与普通数组互转 */
+    xc_object_t *arr = xc_array_create(rt);
+    xc_array_push(rt, arr, xc_number_create(rt, 1.5));
+    xc_array_push(rt, arr, xc_number_create(rt, -2));
+    xc_array_push(rt, arr, xc_string_create(rt, "7"));
+    xc_object_t *i64 = xc_buffer_from_array(rt, XC_BUFFER_INT64, arr);
+    TEST_ASSERT(xc_buffer_get_number(rt, i64, 0) == 1 && xc_buffer_get_number(rt, i64, 1) == -2 &&
+                xc_buffer_get_number(rt, i64, 2) == 7, "Convert from a generic array");
+    xc_object_t *back = xc_buffer_to_array(rt, i64);
+    TEST_ASSERT(xc_is_array(rt, back) && xc_array_length(rt, back) == 3, "Convert to a generic array");
+    TEST_ASSERT(xc_number_value(rt, xc_array_get(rt, back, 1)) == -2, "Converted elements are boxed numbers");
+    
+    /* 方法 */
+    xc_object_t *str = rt->call(i64, "toString");
+    TEST_ASSERT(str && strcmp(xc_string_value(rt, str), "1,-2,7") == 0, "toString joins elements");
+    xc_object_t *args = xc_array_create(rt);
+    xc_array_push(rt, args, xc_number_create(rt, 1));
+    xc_array_push(rt, args, xc_number_create(rt, 42));
+    rt->call(i64, "set", args);
+    TEST_ASSERT(xc_number_value(rt, rt->call(i64, "get", xc_number_create(rt, 1))) == 42, "set/get methods");
+    TEST_ASSERT(xc_number_value(rt, rt->call(i64, "length")) == 3, "length method");
+    
+    /* 回收时 buffer_free 释放元素块；存活的 buffer 数据不变 */
+    xc_gc_add_root(rt, &i64);
+    xc_gc_run(rt);
+    TEST_ASSERT(xc_buffer_get_number(rt, i64, 1) == 42 && xc_buffer_length(rt, i64) == 3,
+                "Rooted typed array survives a collection");
+    xc_gc_remove_root(rt, &i64);
+    
+    /* 转成普通数组时装箱会触发回收，只有源 buffer 是根 */
+    xc_object_t *big = xc_buffer_create(rt, XC_BUFFER_FLOAT64, 30000);
+    xc_gc_add_root(rt, &big);
+    for (size_t i = 0; i < 30000; i++) {
+        xc_buffer_set_number(rt, big, i, i + 0.5);
+    }
+    size_t cycles = xc_gc_get_stats(rt).gc_cycles;
+    xc_object_t *boxed = rt->call(big, "toArray", NULL);
+    TEST_ASSERT(xc_gc_get_stats(rt).gc_cycles > cycles, "toArray collects while boxing");
+    TEST_ASSERT(xc_array_length(rt, boxed) == 30000 && xc_number_value(rt, xc_array_get(rt, boxed, 29999)) == 29999.5,
+                "toArray result survives collections");
+    xc_object_t *converted = rt->convert_type(big, XC_TYPE_ARRAY);
+    TEST_ASSERT(xc_array_length(rt, converted) == 30000 && xc_number_value(rt, xc_array_get(rt, converted, 7)) == 7.5,
+                "Conversion to an array survives collections");
+    xc_gc_remove_root(rt, &big);
+    
+    test_end("Typed Array Test");
+}
+
+// 类型化数组数值内核测试：每个 SIMD 级别的结果都和标量一致
+static void test_array_kernels() {
+    test_start("Typed Array Kernels");
+    
+    /* 长度不是向量宽度的倍数，检查尾部处理；整数值保证求和结果精确 */
+    const size_t n = 1003;
+    xc_object_t *a = xc_buffer_create(rt, XC_BUFFER_FLOAT64, n);
+    xc_object_t *b = xc_buffer_create(rt, XC_BUFFER_FLOAT64, n);
+    for (size_t i = 0; i < n; i++) {
+        xc_buffer_set_number(rt, a, i, (double)((i * 37) % 101) - 50);
+        xc_buffer_set_number(rt, b, i, (double)(i % 7));
+    }
+    xc_buffer_set_number(rt, a, 1001, -77);  /* Minimum in the scalar tail */
+    
+    double expected_sum = 0, expected_dot = 0;
+    for (size_t i = 0; i < n; i++) {
+        expected_sum += xc_buffer_get_number(rt, a, i);
+        expected_dot += xc_buffer_get_number(rt, a, i) * xc_buffer_get_number(rt, b, i);
+    }
+    
+    int saved = xc_simd_get_level();
+    bool consistent = true;
+    for (int level = XC_SIMD_SCALAR; level <= XC_SIMD_AVX2; level++) {
+        xc_simd_set_level(level);
+        consistent = consistent && xc_buffer_sum(rt, a) == expected_sum;
+        consistent = consistent && xc_buffer_dot(rt, a, b) == expected_dot;
+        consistent = consistent && xc_buffer_min(rt, a) == -77 && xc_buffer_argmin(rt, a) == 1001;
+        consistent = consistent && xc_buffer_max(rt, a) == 50;
+        consistent = consistent && xc_buffer_get_number(rt, a, xc_buffer_argmax(rt, a)) == 50;
+        
+        xc_object_t *sum = xc_buffer_add(rt, a, b);
+        xc_object_t *product = xc_buffer_mul(rt, a, b);
+        xc_object_t *scaled = xc_buffer_scale(rt, a, 2);
+        xc_object_t *clamped = xc_buffer_clamp(rt, a, -10, 10);
+        xc_object_t *prefix = xc_buffer_prefix_sum(rt, a);
+        xc_object_t *mask = xc_buffer_compare(rt, a, XC_SIMD_GT, 0);
+        double running = 0;
+        size_t positives = 0;
+        for (size_t i = 0; i < n; i++) {
+            double x = xc_buffer_get_number(rt, a, i), y = xc_buffer_get_number(rt, b, i);
+            running += x;
+            positives += x > 0;
+            consistent = consistent && xc_buffer_get_number(rt, sum, i) == x + y &&
+                         xc_buffer_get_number(rt, product, i) == x * y &&
+                         xc_buffer_get_number(rt, scaled, i) == x * 2 &&
+                         xc_buffer_get_number(rt, clamped, i) == (x < -10 ? -10 : x > 10 ? 10 : x) &&
+                         xc_buffer_get_number(rt, prefix, i) == running &&
+                         xc_buffer_get_number(rt, mask, i) == (x > 0);
+        }
+        consistent = consistent && xc_buffer_kind(rt, mask) == XC_BUFFER_UINT8 &&
+                     xc_buffer_sum(rt, mask) == (double)positives;
+    }
+    xc_simd_set_level(saved);
+    TEST_ASSERT(consistent, "Kernels agree at every SIMD level");
+    
+    /* 空数组和 NaN */
+    xc_object_t *empty = xc_buffer_create(rt, XC_BUFFER_FLOAT64, 0);
+    TEST_ASSERT(xc_buffer_sum(rt, empty) == 0 && xc_buffer_argmin(rt, empty) == -1, "Empty sum and argmin");
+    TEST_ASSERT(xc_buffer_max(rt, empty) == -__builtin_inf(), "Empty max is -Infinity");
+    xc_buffer_set_number(rt, b, 500, __builtin_nan(""));
+    double m = xc_buffer_min(rt, b);
+    TEST_ASSERT(m != m && xc_buffer_argmin(rt, b) == 500, "NaN makes min NaN");
+    
+    /* 其他元素类型先转换为 float64 */
+    xc_object_t *i32 = xc_buffer_create(rt, XC_BUFFER_INT32, 0);
+    for (int i = 1; i <= 100; i++) {
+        xc_buffer_push(rt, i32, i);
+    }
+    TEST_ASSERT(xc_buffer_sum(rt, i32) == 5050 && xc_buffer_mean(rt, i32) == 50.5, "int32 sum and mean");
+    xc_object_t *doubled = rt->call(i32, "scale", xc_number_create(rt, 2));
+    TEST_ASSERT(xc_buffer_kind(rt, doubled) == XC_BUFFER_INT32 && xc_buffer_get_number(rt, doubled, 99) == 200,
+                "Elementwise results keep the element kind");
+    TEST_ASSERT(xc_number_value(rt, rt->call(i32, "max")) == 100, "max method");
+    
+    /* Math 库 */
+    xc_val math = xc_std_get_math();
+    xc_val max = rt->dot(math, "max", NULL);
+    xc_val min = rt->dot(math, "min", NULL);
+    xc_val sum = rt->dot(math, "sum", NULL);
+    xc_object_t *arr = xc_array_create(rt);
+    xc_array_push(rt, arr, xc_number_create(rt, 4));
+    xc_array_push(rt, arr, xc_number_create(rt, -3));
+    TEST_ASSERT(xc_number_value(rt, rt->invoke(max, 3, xc_number_create(rt, 1), xc_number_create(rt, 9), arr)) == 9,
+                "Math.max takes any number of arguments");
+    TEST_ASSERT(xc_number_value(rt, rt->invoke(min, 2, arr, i32)) == -3, "Math.min over arrays and typed arrays");
+    TEST_ASSERT(xc_number_value(rt, rt->invoke(min, 0)) == __builtin_inf(), "Math.min() is Infinity");
+    TEST_ASSERT(xc_number_value(rt, rt->invoke(sum, 1, i32)) == 5050, "Math.sum over a typed array");
+    
+    test_end("Typed Array Kernels");
+}
+
+/* 比较函数：按字符串长度，长度相同视为相等 */
+static xc_val compare_by_length(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    double a = (double)xc_string_length(rt, argv[0]);
+    double b = (double)xc_string_length(rt, argv[1]);
+    return xc_number_create(rt, a - b);
+}
+
+/* 比较函数：数字降序 */
+static xc_val compare_descending(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_number_create(rt, xc_number_value(rt, argv[1]) - xc_number_value(rt, argv[0]));
+}
+
+/* 比较函数：数字降序，每 1000 次比较强制回收一次 */
+static xc_val compare_descending_collecting(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    static int calls = 0;
+    if (calls++ % 1000 == 0) {
+        xc_gc_run(rt);
+    }
+    return compare_descending(rt, this_obj, argc, argv);
+}
+
+static bool array_numbers_sorted(xc_object_t *arr) {
+    for (size_t i = 1; i < xc_array_length(rt, arr); i++) {
+        if (xc_number_value(rt, xc_array_get(rt, arr, i - 1)) > xc_number_value(rt, xc_array_get(rt, arr, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_array_sort() {
+    test_start("Array Sort");
+    
+    /* 局部数组没有注册为根，测试期间暂停 GC */
+    xc_gc_disable(rt);
+    
+    /* 随机、有序、逆序和大量重复的输入都走 pdqsort 的不同分支 */
+    const size_t n = 5000;
+    xc_object_t *shuffled = xc_array_create(rt);
+    xc_object_t *ascending = xc_array_create(rt);
+    xc_object_t *descending = xc_array_create(rt);
+    xc_object_t *repeated = xc_array_create(rt);
+    uint32_t seed = 12345;
+    double expected_sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        double x = (double)(seed >> 8) - 8000000;
+        expected_sum += x;
+        xc_array_push(rt, shuffled, xc_number_create(rt, x));
+        xc_array_push(rt, ascending, xc_number_create(rt, (double)i));
+        xc_array_push(rt, descending, xc_number_create(rt, (double)(n - i)));
+        xc_array_push(rt, repeated, xc_number_create(rt, (double)(i % 3)));
+    }
+    rt->call(shuffled, "sort", NULL);
+    xc_array_sort(rt, ascending, NULL);
+    xc_array_sort(rt, descending, NULL);
+    xc_array_sort_stable(rt, repeated, NULL);
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += xc_number_value(rt, xc_array_get(rt, shuffled, i));
+    }
+    TEST_ASSERT(array_numbers_sorted(shuffled) && sum == expected_sum, "Random numbers sorted, none lost");
+    TEST_ASSERT(array_numbers_sorted(ascending) && array_numbers_sorted(descending), "Sorted and reversed input");
+    TEST_ASSERT(array_numbers_sorted(repeated) && xc_number_value(rt, xc_array_get(rt, repeated, n / 2)) == 1,
+                "Many duplicates");
+    
+    /* NaN 排在最后，-0 与 0 相等 */
+    xc_object_t *special = xc_array_create(rt);
+    xc_array_push(rt, special, xc_number_create(rt, __builtin_nan("")));
+    xc_array_push(rt, special, xc_number_create(rt, 3));
+    xc_array_push(rt, special, xc_number_create(rt, -__builtin_inf()));
+    xc_array_push(rt, special, xc_number_create(rt, -1));
+    xc_array_sort(rt, special, NULL);
+    double last = xc_number_value(rt, xc_array_get(rt, special, 3));
+    TEST_ASSERT(xc_number_value(rt, xc_array_get(rt, special, 0)) == -__builtin_inf() && last != last,
+                "-Infinity first, NaN last");
+    
+    /* 字符串按字节序 */
+    const char *words[] = { "pear", "apple", "fig", "banana", "apples", "kiwi" };
+    xc_object_t *fruits = xc_array_create(rt);
+    for (size_t i = 0; i < 6; i++) {
+        xc_array_push(rt, fruits, xc_string_create(rt, words[i]));
+    }
+    xc_object_t *sorted = rt->call(xc_array_slice(rt, fruits, 0, 6), "sort", NULL);
+    xc_object_t *text = xc_array_join(rt, sorted, xc_string_create(rt, ","));
+    TEST_ASSERT(strcmp(xc_string_value(rt, text), "apple,apples,banana,fig,kiwi,pear") == 0, "Strings in byte order");
+    
+    /* 稳定排序 + 自定义比较函数：同长度保持原顺序 */
+    xc_object_t *by_length = xc_function_create(rt, compare_by_length, NULL);
+    rt->call(fruits, "sortStable", by_length);
+    text = xc_array_join(rt, fruits, xc_string_create(rt, ","));
+    TEST_ASSERT(strcmp(xc_string_value(rt, text), "fig,pear,kiwi,apple,banana,apples") == 0,
+                "Stable sort keeps ties in order");
+    
+    /* 混合类型：先按类型，再按值 */
+    xc_object_t *mixed = xc_array_create(rt);
+    xc_array_push(rt, mixed, xc_string_create(rt, "b"));
+    xc_array_push(rt, mixed, xc_number_create(rt, 2));
+    xc_array_push(rt, mixed, xc_string_create(rt, "a"));
+    xc_array_push(rt, mixed, xc_number_create(rt, 1));
+    xc_array_sort(rt, mixed, NULL);
+    text = xc_array_join(rt, mixed, xc_string_create(rt, ","));
+    TEST_ASSERT(strcmp(xc_string_value(rt, text), "1,2,a,b") == 0, "Mixed array sorts by type, then value");
+    
+    /* topK 不修改原数组 */
+    xc_object_t *smallest = xc_array_top_k(rt, shuffled, 10, NULL);
+    bool prefix = xc_array_length(rt, smallest) == 10;
+    for (size_t i = 0; prefix && i < 10; i++) {
+        prefix = xc_array_get(rt, smallest, i) == xc_array_get(rt, shuffled, i);
+    }
+    TEST_ASSERT(prefix, "topK returns the sorted prefix");
+    xc_object_t *args = xc_array_create(rt);
+    xc_array_push(rt, args, xc_number_create(rt, 3));
+    xc_array_push(rt, args, xc_function_create(rt, compare_descending, NULL));
+    xc_object_t *largest = rt->call(shuffled, "topK", args);
+    TEST_ASSERT(xc_array_length(rt, largest) == 3 &&
+                xc_array_get(rt, largest, 0) == xc_array_get(rt, shuffled, n - 1) &&
+                xc_array_get(rt, largest, 2) == xc_array_get(rt, shuffled, n - 3), "topK with a comparator");
+    
+    /* 类型化数组：基数排序 */
+    int kinds[] = { XC_BUFFER_FLOAT64, XC_BUFFER_FLOAT32, XC_BUFFER_INT64, XC_BUFFER_INT32, XC_BUFFER_UINT8 };
+    bool buffers_sorted = true;
+    for (size_t k = 0; k < 5; k++) {
+        xc_object_t *buf = xc_buffer_create(rt, kinds[k], 0);
+        for (size_t i = 0; i < 300; i++) {
+            seed = seed * 1103515245 + 12345;
+            xc_buffer_push(rt, buf, kinds[k] == XC_BUFFER_UINT8 ? (double)(seed >> 24) : (double)(int32_t)seed / 16);
+        }
+        rt->call(buf, "sort");
+        for (size_t i = 1; i < 300; i++) {
+            buffers_sorted = buffers_sorted && xc_buffer_get_number(rt, buf, i - 1) <= xc_buffer_get_number(rt, buf, i);
+        }
+    }
+    TEST_ASSERT(buffers_sorted, "Radix sort for every element kind");
+    xc_object_t *floats = xc_buffer_create(rt, XC_BUFFER_FLOAT64, 0);
+    xc_buffer_push(rt, floats, __builtin_nan(""));
+    xc_buffer_push(rt, floats, 0.5);
+    xc_buffer_push(rt, floats, -2.5);
+    xc_buffer_push(rt, floats, __builtin_inf());
+    xc_buffer_sort(rt, floats);
+    double tail = xc_buffer_get_number(rt, floats, 3);
+    TEST_ASSERT(xc_buffer_get_number(rt, floats, 0) == -2.5 && xc_buffer_get_number(rt, floats, 2) == __builtin_inf() &&
+                tail != tail, "Typed float sort puts NaN last");
+    
+    /* GC 开启：比较函数中途回收，只有源数组和比较函数是根 */
+    xc_gc_enable(rt);
+    xc_gc_add_root(rt, &shuffled);
+    xc_object_t *collecting = xc_function_create(rt, compare_descending_collecting, NULL);
+    xc_gc_add_root(rt, &collecting);
+    largest = xc_array_top_k(rt, shuffled, 3, collecting);
+    TEST_ASSERT(xc_array_length(rt, largest) == 3 &&
+                xc_array_get(rt, largest, 0) == xc_array_get(rt, shuffled, n - 1) &&
+                xc_array_get(rt, largest, 2) == xc_array_get(rt, shuffled, n - 3), "topK survives collections in the comparator");
+    xc_gc_remove_root(rt, &collecting);
+    xc_gc_remove_root(rt, &shuffled);
+    
+    test_end("Array Sort");
+}
+
+/* 迭代器阶段：xc 函数和原生回调 */
+static xc_val square_value(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    double x = xc_number_value(rt, argv[0]);
+    return xc_number_create(rt, x * x);
+}
+
+static xc_val is_odd_value(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_boolean_create(rt, ((long)xc_number_value(rt, argv[0])) % 2 != 0);
+}
+
+static xc_val add_values(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_number_create(rt, xc_to_number(rt, argv[0]) + xc_number_value(rt, argv[1]));
+}
+
+static double triple_f64(double value, void *data) {
+    return value * 3;
+}
+
+static bool below_f64(double value, void *data) {
+    return value < *(double *)data;
+}
+
+static size_t iter_calls = 0;
+
+static xc_object_t *counting_identity(xc_runtime_t *rt, xc_object_t *value, void *data) {
+    iter_calls++;
+    return value;
+}
+
+/* 在管道中途强制回收 */
+static xc_object_t *collecting_identity(xc_runtime_t *rt, xc_object_t *value, void *data) {
+    xc_gc_run(rt);
+    return value;
+}
+
+static void test_array_iterator() {
+    test_start("Array Iterator");
+    
+    /* 局部变量不是根，测试期间暂停 GC */
+    xc_gc_disable(rt);
+    
+    xc_object_t *arr = xc_array_create(rt);
+    for (int i = 1; i <= 10; i++) {
+        xc_array_push(rt, arr, xc_number_create(rt, i));
+    }
+    
+    /* map/filter/take/reduce 通过方法链调用 */
+    xc_object_t *it = rt->call(arr, "iter");
+    TEST_ASSERT(xc_is_iterator(rt, it), "iter returns an iterator");
+    rt->call(it, "filter", xc_function_create(rt, is_odd_value, NULL));
+    rt->call(it, "map", xc_function_create(rt, square_value, NULL));
+    rt->call(it, "take", xc_number_create(rt, 3));
+    xc_object_t *total = rt->call(it, "reduce", xc_function_create(rt, add_values, NULL));
+    TEST_ASSERT(xc_number_value(rt, total) == 1 + 9 + 25, "filter odd, square, take 3, sum");
+    
+    /* 同一个管道可以再次运行 */
+    xc_object_t *squares = xc_iter_to_array(rt, it);
+    xc_object_t *text = xc_array_join(rt, squares, xc_string_create(rt, ","));
+    TEST_ASSERT(strcmp(xc_string_value(rt, text), "1,9,25") == 0, "toArray reruns the pipeline");
+    
+    /* take 提前结束：后面的元素不会被访问 */
+    iter_calls = 0;
+    it = xc_iter(rt, arr);
+    xc_iter_map_native(rt, it, counting_identity, NULL);
+    xc_iter_take(rt, it, 4);
+    TEST_ASSERT_EQUAL((size_t)4, xc_iter_count(rt, it), "count after take");
+    TEST_ASSERT_EQUAL((size_t)4, iter_calls, "take stops the pass early");
+    
+    it = xc_iter(rt, arr);
+    xc_iter_skip(rt, it, 8);
+    TEST_ASSERT(xc_iter_sum(rt, it) == 9 + 10, "skip");
+    TEST_ASSERT_EQUAL((size_t)0, xc_iter_count(rt, xc_iter_take(rt, xc_iter(rt, arr), 0)), "take 0 is empty");
+    
+    /* 类型化数组 + f64 阶段：全程不装箱 */
+    xc_object_t *buf = xc_buffer_create(rt, XC_BUFFER_INT32, 0);
+    for (int i = 0; i < 100; i++) {
+        xc_buffer_push(rt, buf, i);
+    }
+    double limit = 30;
+    it = rt->call(buf, "iter");
+    xc_iter_map_f64(rt, it, triple_f64, NULL);
+    xc_iter_filter_f64(rt, it, below_f64, &limit);
+    TEST_ASSERT(xc_iter_sum(rt, it) == 3 * (0 + 1 + 2 + 3 + 4 + 5 + 6 + 7 + 8 + 9), "Unboxed typed array pipeline");
+    
+    /* f64 阶段之后接 xc 函数，值在需要时装箱 */
+    xc_iter_map(rt, it, xc_function_create(rt, square_value, NULL));
+    xc_object_t *boxed = xc_iter_to_array(rt, it);
+    TEST_ASSERT(xc_array_length(rt, boxed) == 10 && xc_number_value(rt, xc_array_get(rt, boxed, 9)) == 729,
+                "Mixed native and xc stages");
+    
+    TEST_ASSERT(xc_iter(rt, xc_string_create(rt, "abc")) == NULL, "Strings are not iterable sources");
+    
+    /* GC 开启：只有源数组和迭代器是根，阶段函数和在途的值靠迭代器的标记存活 */
+    xc_gc_enable(rt);
+    xc_gc_add_root(rt, &arr);
+    it = xc_iter(rt, arr);
+    xc_gc_add_root(rt, &it);
+    xc_iter_map(rt, it, xc_function_create(rt, square_value, NULL));
+    xc_iter_map_native(rt, it, collecting_identity, NULL);
+    TEST_ASSERT(xc_iter_sum(rt, it) == 385, "Pipeline survives collections mid-pass");
+    xc_gc_remove_root(rt, &it);
+    xc_gc_remove_root(rt, &arr);
+    
+    test_end("Array Iterator");
+}
+
+static double parallel_add(double acc, double value, void *data) {
+    return acc + value;
+}
+
+static double parallel_max(double acc, double value, void *data) {
+    return value > acc ? value : acc;
+}
+
+static void test_array_parallel() {
+    test_start("Array Parallel");
+    xc_gc_disable(rt);
+    
+    /* 强制 4 个线程，即使只有一个核心也要走线程池 */
+    int saved_threads = xc_parallel_get_threads();
+    xc_parallel_set_threads(4);
+    
+    size_t n = 200000;
+    xc_object_t *buf = xc_buffer_create(rt, XC_BUFFER_FLOAT64, n);
+    double *data = xc_buffer_data(rt, buf);
+    uint64_t seed = 42;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        data[i] = (double)(seed >> 44) - 500000;
+    }
+    TEST_ASSERT(xc_parallel_chunk_count(n, 0) > 1, "Large input is split into chunks");
+    
+    double sum = 0, max = data[0];
+    for (size_t i = 0; i < n; i++) {
+        sum += data[i];
+        max = data[i] > max ? data[i] : max;
+    }
+    TEST_ASSERT(xc_parallel_sum(rt, buf) == sum, "Parallel sum matches sequential");
+    TEST_ASSERT(xc_parallel_reduce(rt, buf, parallel_add, 0, NULL) == sum, "Parallel reduce with +");
+    TEST_ASSERT(xc_parallel_reduce(rt, buf, parallel_max, -INFINITY, NULL) == max, "Parallel reduce with max");
+    
+    xc_object_t *tripled = xc_parallel_map(rt, buf, triple_f64, NULL);
+    TEST_ASSERT(xc_buffer_length(rt, tripled) == n && xc_buffer_get_number(rt, tripled, n - 1) == 3 * data[n - 1],
+                "Parallel map over a typed array");
+    
+    double limit = 0;
+    xc_object_t *negative = xc_parallel_filter(rt, buf, below_f64, &limit);
+    size_t expected = 0;
+    bool ordered = true;
+    for (size_t i = 0; i < n; i++) {
+        if (data[i] < 0) {
+            ordered = ordered && xc_buffer_get_number(rt, negative, expected) == data[i];
+            expected++;
+        }
+    }
+    TEST_ASSERT(xc_buffer_length(rt, negative) == expected && ordered, "Parallel filter keeps order");
+    
+    /* 第一个匹配：后面的块里也有相同的值 */
+    data[n - 10] = data[n / 2 + 3] = data[n / 4] = 1e9;
+    TEST_ASSERT(xc_parallel_index_of(rt, buf, 1e9) == (int64_t)(n / 4), "Parallel index_of finds the first match");
+    TEST_ASSERT(xc_parallel_index_of(rt, buf, 0.5) == -1, "Parallel index_of miss");
+    
+    xc_object_t *copy = xc_buffer_create(rt, XC_BUFFER_FLOAT64, n);
+    memcpy(xc_buffer_data(rt, copy), data, n * sizeof(double));
+    xc_buffer_sort(rt, copy);
+    xc_parallel_sort(rt, buf);
+    TEST_ASSERT(memcmp(xc_buffer_data(rt, copy), data, n * sizeof(double)) == 0, "Parallel typed array sort");
+    
+    /* 普通数组：数字按值排序，过滤返回原来的元素对象 */
+    xc_object_t *arr = xc_array_create(rt);
+    for (size_t i = 0; i < 50000; i++) {
+        xc_array_push(rt, arr, xc_number_create(rt, (double)((i * 7919) % 50000)));
+    }
+    xc_object_t *first = xc_array_get(rt, arr, 1);
+    limit = 10;
+    xc_object_t *small = xc_parallel_filter(rt, arr, below_f64, &limit);
+    TEST_ASSERT(xc_array_length(rt, small) == 10 && xc_array_get(rt, small, 1) == xc_array_get(rt, arr, 3037),
+                "Parallel filter over an array");
+    xc_object_t *mapped = xc_parallel_map(rt, arr, triple_f64, NULL);
+    TEST_ASSERT(xc_number_value(rt, xc_array_get(rt, mapped, 1)) == 3 * 7919, "Parallel map boxes on the caller");
+    xc_parallel_sort(rt, arr);
+    TEST_ASSERT(array_numbers_sorted(arr) && xc_array_get(rt, arr, 7919) == first, "Parallel array sort");
+    TEST_ASSERT(xc_parallel_index_of(rt, arr, 123) == 123, "Parallel index_of over an array");
+    
+    /* GC 开启：装箱结果时会回收，只有源数组是根 */
+    xc_gc_enable(rt);
+    xc_gc_add_root(rt, &arr);
+    size_t cycles = xc_gc_get_stats(rt).gc_cycles;
+    mapped = xc_parallel_map(rt, arr, triple_f64, NULL);
+    TEST_ASSERT(xc_gc_get_stats(rt).gc_cycles > cycles, "Parallel map collects while boxing");
+    TEST_ASSERT(xc_array_length(rt, mapped) == 50000 &&
+                xc_number_value(rt, xc_array_get(rt, mapped, 49999)) == 3 * 49999.0,
+                "Parallel map result survives collections");
+    xc_gc_remove_root(rt, &arr);
+    
+    xc_parallel_set_threads(saved_threads);
+    test_end("Array Parallel");
+}
+
+// 写时复制：长切片和 concat 共享存储，第一次写入时才复制
+static void test_array_views() {
+    test_start("Array Copy-on-Write Views");
+    xc_gc_disable(rt);
+    
+    xc_object_t *values[200];
+    xc_object_t *arr = xc_array_create(rt);
+    for (int i = 0; i < 200; i++) {
+        values[i] = xc_number_create(rt, i);
+        xc_array_push(rt, arr, values[i]);
+    }
+    
+    /* 长切片是视图，短切片直接复制 */
+    xc_object_t *view = xc_array_slice(rt, arr, 50, 150);
+    TEST_ASSERT(xc_array_is_shared(rt, view) && xc_array_is_shared(rt, arr), "Long slice shares storage");
+    TEST_ASSERT(xc_array_get(rt, view, 0) == values[50] && xc_array_get(rt, view, 99) == values[149],
+                "Slice view reads the parent's elements");
+    TEST_ASSERT(!xc_array_is_shared(rt, xc_array_slice(rt, arr, 0, 4)), "Short slice is copied");
+    
+    /* 写视图：父数组不受影响 */
+    xc_array_set(rt, view, 0, values[0]);
+    TEST_ASSERT(!xc_array_is_shared(rt, view), "Writing a view copies it");
+    TEST_ASSERT(xc_array_get(rt, view, 0) == values[0] && xc_array_get(rt, arr, 50) == values[50],
+                "Parent keeps its element after the view is written");
+    
+    /* 写父数组：已有视图不受影响 */
+    xc_object_t *view2 = xc_array_slice(rt, arr, 100, 200);
+    xc_array_set(rt, arr, 150, values[1]);
+    xc_array_push(rt, arr, values[2]);
+    TEST_ASSERT(xc_array_get(rt, view2, 50) == values[150] && xc_array_length(rt, view2) == 100,
+                "View keeps its elements after the parent is written");
+    
+    /* pop/shift 只移动视图的窗口 */
+    xc_object_t *view3 = xc_array_slice(rt, arr, 0, 100);
+    TEST_ASSERT(xc_array_pop(rt, view3) == values[99] && xc_array_shift(rt, view3) == values[0],
+                "pop and shift on a view");
+    TEST_ASSERT(xc_array_is_shared(rt, view3) && xc_array_get(rt, arr, 0) == values[0] &&
+                xc_array_get(rt, arr, 99) == values[99], "pop and shift leave the shared block alone");
+    xc_array_push(rt, view3, values[3]);
+    TEST_ASSERT(xc_array_length(rt, view3) == 99 && xc_array_get(rt, view3, 98) == values[3] &&
+                xc_array_get(rt, arr, 99) == values[99], "push after pop copies first");
+    
+    /* concat：两段视图，按索引读取不需要合并 */
+    xc_object_t *left = xc_array_slice(rt, arr, 0, 60);
+    xc_object_t *right = xc_array_slice(rt, arr, 140, 200);
+    xc_object_t *joined = xc_array_concat(rt, left, right);
+    TEST_ASSERT(xc_array_length(rt, joined) == 120 && xc_array_get(rt, joined, 59) == values[59] &&
+                xc_array_get(rt, joined, 60) == values[140], "Concat view indexes both segments");
+    xc_object_t *middle = xc_array_slice(rt, joined, 70, 110);
+    TEST_ASSERT(xc_array_is_shared(rt, joined) && xc_array_is_shared(rt, middle),
+                "Slice inside one segment stays a view");
+    TEST_ASSERT(xc_array_get(rt, middle, 0) == values[1] && xc_array_get(rt, middle, 39) == values[189],
+                "Slice of a concat view reads the right elements");
+    xc_object_t *text = xc_array_join(rt, xc_array_slice(rt, joined, 58, 62), xc_string_create(rt, ","));
+    TEST_ASSERT(strcmp(xc_string_value(rt, text), "58,59,140,141") == 0, "Slice across both segments");
+    TEST_ASSERT(xc_array_index_of(rt, joined, values[179]) == 99, "index_of over a concat view");
+    
+    xc_array_push(rt, joined, values[4]);
+    TEST_ASSERT(xc_array_length(rt, joined) == 121 && xc_array_get(rt, joined, 120) == values[4] &&
+                xc_array_get(rt, joined, 60) == values[140] && xc_array_length(rt, right) == 60,
+                "Pushing onto a concat view flattens it");
+    
+    xc_array_sort(rt, xc_array_concat(rt, right, left), NULL);
+    TEST_ASSERT(xc_array_get(rt, left, 0) == values[0] && xc_array_get(rt, right, 0) == values[140],
+                "Sorting a concat view leaves its operands unchanged");
+    
+    /* 回收父数组只释放它持有的引用，共享块留给仍然存活的视图 */
+    xc_gc_enable(rt);
+    xc_gc_add_root(rt, &view2);
+    xc_gc_run(rt);
+    TEST_ASSERT(xc_array_length(rt, view2) == 100 && xc_number_value(rt, xc_array_get(rt, view2, 0)) == 100 &&
+                xc_number_value(rt, xc_array_get(rt, view2, 99)) == 199,
+                "View survives the collection of its parent");
+    xc_gc_remove_root(rt, &view2);
+    
+    /* 共享时 pop 留下的旧槽：父数组回收后再越过长度写入，中间的槽应为 null */
+    xc_gc_disable(rt);
+    xc_object_t *owner = xc_array_create(rt);
+    for (int i = 0; i < 64; i++) {
+        xc_array_push(rt, owner, xc_number_create(rt, i + 0.5));
+    }
+    xc_object_t *popped = xc_array_slice(rt, owner, 0, 63);
+    xc_array_pop(rt, popped);
+    xc_array_pop(rt, popped);
+    xc_array_pop(rt, popped);
+    xc_gc_add_root(rt, &popped);
+    owner = NULL;
+    xc_gc_enable(rt);
+    xc_gc_run(rt);
+    xc_array_set(rt, popped, 62, values[5]);
+    TEST_ASSERT(xc_array_length(rt, popped) == 63 && xc_array_get(rt, popped, 60) == NULL &&
+                xc_array_get(rt, popped, 61) == NULL && xc_array_get(rt, popped, 62) == values[5],
+                "Setting past the end after a shared pop leaves no stale slots");
+    xc_gc_remove_root(rt, &popped);
+    test_end("Array Copy-on-Write Views");
+}
+
 void run_array_tests() {
     rt = xc_singleton();
     printf("Running XC Array Tests\n");
@@ -30,6 +723,13 @@ void run_array_tests() {
     
     // 调用简化的数组测试函数
     test_array_simple();
+    test_array_queue();
+    test_array_views();
+    test_array_typed();
+    test_array_kernels();
+    test_array_sort();
+    test_array_iterator();
+    test_array_parallel();
     
     printf("Array tests completed!\n");
 }
@@ -461,6 +461,212 @@ static void test_exception_rethrow(void) {
     test_end("Exception Rethrow");
 }
 
+/* 错误结果测试函数 */
+static xc_val raised_error = NULL;
+static int finally_runs = 0;
+
+static xc_val result_ok_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return rt->new(XC_TYPE_STRING, "ok");
+}
+
+static xc_val result_raise_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_raise(rt, raised_error);
+}
+
+static xc_val result_catch_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return (argc > 0 && argv[0] == raised_error) ? rt->new(XC_TYPE_STRING, "caught") : NULL;
+}
+
+static xc_val result_finally_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    finally_runs++;
+    return NULL;
+}
+
+/* 错误结果（无 setjmp）测试 */
+static void test_error_result(void) {
+    test_start("Error Result");
+    xc_gc_disable(rt);
+    
+    raised_error = rt->new(XC_TYPE_EXCEPTION, "raised");
+    xc_val ok_func = rt->new(XC_TYPE_FUNC, result_ok_func, NULL);
+    xc_val raise_func = rt->new(XC_TYPE_FUNC, result_raise_func, NULL);
+    xc_val catch_func = rt->new(XC_TYPE_FUNC, result_catch_func, NULL);
+    xc_val finally_func = rt->new(XC_TYPE_FUNC, result_finally_func, NULL);
+    
+    xc_val result = xc_try_result(rt, ok_func, catch_func, finally_func);
+    TEST_ASSERT(rt->is(result, XC_TYPE_STRING) && strcmp(xc_string_value(rt, result), "ok") == 0,
+                "Try result returned without error");
+    TEST_ASSERT(finally_runs == 1, "Finally runs on success");
+    
+    result = xc_try_result(rt, raise_func, catch_func, NULL);
+    TEST_ASSERT(rt->is(result, XC_TYPE_STRING) && strcmp(xc_string_value(rt, result), "caught") == 0,
+                "Catch receives the raised exception");
+    TEST_ASSERT(xc_pending_exception(rt) == NULL, "Handled error leaves nothing pending");
+    
+    result = xc_try_result(rt, raise_func, NULL, finally_func);
+    TEST_ASSERT(XC_IS_ERROR(result), "Unhandled error propagates as XC_ERROR");
+    TEST_ASSERT(finally_runs == 2, "Finally runs on error");
+    TEST_ASSERT(xc_take_pending_exception(rt) == raised_error, "Propagated exception stays pending");
+    TEST_ASSERT(xc_pending_exception(rt) == NULL, "Taking the exception clears it");
+    
+    result = xc_try_result(rt, raise_func, raise_func, NULL);
+    TEST_ASSERT(XC_IS_ERROR(result) && xc_take_pending_exception(rt) == raised_error,
+                "Error raised in catch propagates");
+    
+    result = rt->try_catch_finally(raise_func, catch_func, NULL);
+    TEST_ASSERT(rt->is(result, XC_TYPE_STRING) && strcmp(xc_string_value(rt, result), "caught") == 0,
+                "try_catch_finally catches error results");
+    
+    xc_gc_enable(rt);
+    test_end("Error Result");
+}
+
+/* 栈跟踪测试函数：在调用帧内创建异常 */
+static int trace_test_type = XC_EXCEPTION_TYPE_ERROR;
+
+static xc_val trace_raise_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_raise(rt, xc_exception_create(rt, trace_test_type, "traced"));
+}
+
+static xc_val trace_catch_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return argv[0];
+}
+
+/* 延迟栈跟踪测试 */
+static void test_lazy_stack_trace(void) {
+    test_start("Lazy Stack Trace");
+    xc_gc_disable(rt);
+    
+    xc_val raise_func = rt->new(XC_TYPE_FUNC, trace_raise_func, NULL);
+    xc_val catch_func = rt->new(XC_TYPE_FUNC, trace_catch_func, NULL);
+    
+    xc_exception_t *exc = (xc_exception_t *)xc_try_result(rt, raise_func, catch_func, NULL);
+    TEST_ASSERT(rt->is((xc_val)exc, XC_TYPE_EXCEPTION), "Caught the traced exception");
+    TEST_ASSERT(exc->stack_trace == NULL, "Trace is not formatted at creation");
+    
+    xc_stack_trace_t *trace = xc_exception_get_stack_trace(rt, (xc_object_t *)exc);
+    TEST_ASSERT(trace && trace->count >= 2, "Trace symbolized on demand");
+    TEST_ASSERT(trace && strcmp(trace->entries[0].function, "<function>") == 0, "Innermost frame first");
+    TEST_ASSERT(trace && strcmp(trace->entries[1].function, "try_catch_finally") == 0, "Enclosing try frame");
+    TEST_ASSERT(xc_exception_get_stack_trace(rt, (xc_object_t *)exc) == trace, "Symbolized trace is cached");
+    char *text = xc_stack_trace_to_string(rt, trace);
+    TEST_ASSERT(text && strstr(text, "at try_catch_finally ("), "Trace formats as text");
+    free(text);
+    
+    xc_exception_set_trace_enabled(rt, XC_EXCEPTION_TYPE_RANGE, false);
+    trace_test_type = XC_EXCEPTION_TYPE_RANGE;
+    exc = (xc_exception_t *)xc_try_result(rt, raise_func, catch_func, NULL);
+    TEST_ASSERT(exc && exc->trace_depth == 0, "Disabled type skips the snapshot");
+    TEST_ASSERT(xc_exception_get_stack_trace(rt, (xc_object_t *)exc) == NULL, "Disabled type has no trace");
+    xc_exception_set_trace_enabled(rt, XC_EXCEPTION_TYPE_RANGE, true);
+    trace_test_type = XC_EXCEPTION_TYPE_ERROR;
+    
+    xc_gc_enable(rt);
+    test_end("Lazy Stack Trace");
+}
+
+/* 池化异常测试函数 */
+static xc_val pooled_raise_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_raise(rt, xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_RANGE, "pooled"));
+}
+
+static xc_val pooled_catch_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return rt->new(XC_TYPE_STRING, "handled");
+}
+
+static xc_val pooled_release_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    xc_exception_release(rt, argv[0]);
+    return rt->new(XC_TYPE_STRING, "handled");
+}
+
+/* 包装后重新抛出：捕获的池化异常成为新异常的 cause */
+static xc_val pooled_wrap_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_raise(rt, xc_exception_create_with_cause(rt, XC_EXCEPTION_TYPE_ERROR, "outer", argv[0]));
+}
+
+static xc_val pooled_raise, pooled_wrap;
+
+static xc_val pooled_rethrow_func(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return rt->try_catch_finally(pooled_raise, pooled_wrap, NULL);
+}
+
+/* 预分配与池化异常测试 */
+static void test_exception_pool(void) {
+    test_start("Exception Pool");
+    xc_gc_disable(rt);
+    
+    xc_exception_t *exc = (xc_exception_t *)xc_exception_create(rt, XC_EXCEPTION_TYPE_ERROR, "short");
+    TEST_ASSERT(exc->message == exc->inline_message && strcmp(exc->message, "short") == 0,
+                "Short message stored inline");
+    char long_message[XC_EXCEPTION_MESSAGE_INLINE * 2];
+    memset(long_message, 'x', sizeof(long_message) - 1);
+    long_message[sizeof(long_message) - 1] = '\0';
+    exc = (xc_exception_t *)xc_exception_create(rt, XC_EXCEPTION_TYPE_ERROR, long_message);
+    TEST_ASSERT(exc->message != exc->inline_message && strcmp(exc->message, long_message) == 0,
+                "Long message kept in full");
+    
+    xc_object_t *oom = xc_exception_reserved(rt, XC_EXCEPTION_TYPE_MEMORY);
+    TEST_ASSERT(oom && xc_exception_get_type(rt, oom) == XC_EXCEPTION_TYPE_MEMORY, "Reserved OOM exception");
+    TEST_ASSERT(strcmp(xc_exception_get_message(rt, oom), "Out of memory") == 0, "Reserved OOM message");
+    TEST_ASSERT(xc_exception_reserved(rt, XC_EXCEPTION_TYPE_MEMORY) == oom, "Reserved exception is reused");
+    TEST_ASSERT(xc_exception_reserved(rt, XC_EXCEPTION_TYPE_STACK_OVERFLOW) != NULL, "Reserved stack overflow");
+    TEST_ASSERT(xc_exception_reserved(rt, XC_EXCEPTION_TYPE_RANGE) == NULL, "No reserved range error");
+    
+    xc_object_t *pooled = xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_RANGE, "first");
+    TEST_ASSERT(((xc_exception_t *)pooled)->flags & XC_EXCEPTION_POOLED, "Pooled flag set");
+    xc_exception_release(rt, pooled);
+    xc_object_t *again = xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_TYPE, "second");
+    TEST_ASSERT(again == pooled, "Released exception is recycled");
+    TEST_ASSERT(xc_exception_get_type(rt, again) == XC_EXCEPTION_TYPE_TYPE &&
+                strcmp(xc_exception_get_message(rt, again), "second") == 0, "Recycled exception reinitialized");
+    xc_exception_release(rt, again);
+    
+    xc_val raise_func = rt->new(XC_TYPE_FUNC, pooled_raise_func, NULL);
+    xc_val catch_func = rt->new(XC_TYPE_FUNC, pooled_catch_func, NULL);
+    xc_val release_func = rt->new(XC_TYPE_FUNC, pooled_release_func, NULL);
+    xc_val wrap_func = rt->new(XC_TYPE_FUNC, pooled_wrap_func, NULL);
+    xc_val keep_func = rt->new(XC_TYPE_FUNC, trace_catch_func, NULL);
+    xc_try_result(rt, raise_func, catch_func, NULL);
+    xc_object_t *other = xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_RANGE, "x");
+    TEST_ASSERT(other != pooled && strcmp(xc_exception_get_message(rt, pooled), "pooled") == 0,
+                "Handling does not recycle the exception");
+    xc_exception_release(rt, other);
+    xc_exception_release(rt, pooled);
+    
+    xc_try_result(rt, raise_func, release_func, NULL);
+    other = xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_RANGE, "x");
+    TEST_ASSERT(other == pooled, "Exception released by the handler returns to the pool");
+    xc_exception_release(rt, other);
+    
+    /* 两种 try 都不能回收作为 cause 传出去的异常 */
+    xc_val wrapped = xc_try_result(rt, raise_func, wrap_func, NULL);
+    xc_object_t *outer = xc_take_pending_exception(rt);
+    xc_object_t *unrelated = xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_TYPE, "unrelated");
+    TEST_ASSERT(XC_IS_ERROR(wrapped) && xc_exception_get_cause(rt, outer) == pooled &&
+                unrelated != pooled && strcmp(xc_exception_get_message(rt, pooled), "pooled") == 0,
+                "Cause of a rethrown error is not recycled (xc_try_result)");
+    xc_exception_release(rt, unrelated);
+    xc_exception_release(rt, pooled);
+    
+    pooled_raise = raise_func;
+    pooled_wrap = wrap_func;
+    outer = rt->try_catch_finally(rt->new(XC_TYPE_FUNC, pooled_rethrow_func, NULL), keep_func, NULL);
+    unrelated = xc_exception_create_pooled(rt, XC_EXCEPTION_TYPE_TYPE, "unrelated");
+    TEST_ASSERT(outer && xc_exception_get_cause(rt, outer) == pooled && unrelated != pooled &&
+                strcmp(xc_exception_get_message(rt, pooled), "pooled") == 0,
+                "Cause of a rethrown error is not recycled (try_catch_finally)");
+    xc_exception_release(rt, unrelated);
+    xc_exception_release(rt, pooled);
+    
+    xc_val kept = xc_try_result(rt, raise_func, keep_func, NULL);
+    TEST_ASSERT(kept == pooled && strcmp(xc_exception_get_message(rt, kept), "pooled") == 0,
+                "Exception returned by the handler is not recycled");
+    xc_exception_release(rt, kept);
+    
+    xc_gc_enable(rt);
+    test_end("Exception Pool");
+}
+
 /* 注册所有异常测试 */
 void register_exception_tests(void) {
     test_register("exception.basic_try_catch", test_basic_try_catch, "exception",
@@ -473,6 +679,12 @@ void register_exception_tests(void) {
                  "Test uncaught exception handling");
     test_register("exception.rethrow", test_exception_rethrow, "exception",
                  "Test exception rethrowing");
+    test_register("exception.error_result", test_error_result, "exception",
+                 "Test setjmp-free error results");
+    test_register("exception.lazy_trace", test_lazy_stack_trace, "exception",
+                 "Test lazy stack trace capture");
+    test_register("exception.pool", test_exception_pool, "exception",
+                 "Test preallocated and pooled exceptions");
 }
 
 /* 运行异常测试套件 */
@@ -40,6 +40,180 @@ static void test_object_delete(void) {
     test_end("Object Delete");
 }
 
+/* 测试通过 dot 访问属性和方法 */
+static void test_object_dot(void) {
+    test_start("Object Dot");
+
+    xc_val obj = rt->new(XC_TYPE_OBJECT);
+    xc_val name = rt->new(XC_TYPE_STRING, "xc");
+    rt->dot(obj, "name", name);
+    TEST_ASSERT(rt->dot(obj, "name", NULL) == name, "Dot set/get writes through to the object");
+    TEST_ASSERT(rt->dot(obj, "missing", NULL) == NULL, "Dot get returns NULL for missing key");
+
+    /* Reading a method twice returns the same bound function */
+    xc_val array = rt->new(XC_TYPE_ARRAY, 0);
+    rt->call(array, "push", name);
+    xc_val length1 = rt->dot(array, "length", NULL);
+    xc_val length2 = rt->dot(array, "length", NULL);
+    TEST_ASSERT(length1 && rt->is(length1, XC_TYPE_FUNC), "Method read returns a function");
+    TEST_ASSERT(length1 == length2, "Bound method is cached");
+    TEST_ASSERT((size_t)rt->invoke(length1, 0) == 1, "Bound method keeps its receiver");
+
+    test_end("Object Dot");
+}
+
+/* foreach 回调：按插入顺序拼接键名 */
+static void collect_keys(xc_runtime_t *rt, const char *key, xc_object_t *value, void *user_data) {
+    strcat((char *)user_data, key);
+}
+
+/* 测试隐藏类（shape）和内联缓存 */
+static void test_object_shapes(void) {
+    test_start("Object Shapes");
+
+    xc_object_t *a = xc_object_create(rt);
+    xc_object_t *b = xc_object_create(rt);
+    xc_object_t *one = xc_number_create(rt, 1);
+    xc_object_t *two = xc_number_create(rt, 2);
+    xc_object_set(rt, a, "x", one);
+    xc_object_set(rt, a, "y", two);
+    xc_object_set(rt, b, "x", two);
+    xc_object_set(rt, b, "y", one);
+    TEST_ASSERT(((xc_object_data_t *)a)->shape == ((xc_object_data_t *)b)->shape,
+                "Objects with the same key order share a shape");
+    TEST_ASSERT(xc_object_get(rt, b, "y") == one, "Slot values are per object");
+
+    /* Inline caches hit on the shared shape */
+    xc_inline_cache_t ic = {0};
+    TEST_ASSERT(xc_object_get_cached(rt, a, "y", &ic) == two, "Cached get (miss)");
+    TEST_ASSERT(xc_object_get_cached(rt, b, "y", &ic) == one, "Cached get (hit)");
+    TEST_ASSERT(ic.shape == ((xc_object_data_t *)b)->shape, "Inline cache records the shape");
+
+    xc_inline_cache_t set_ic = {0};
+    xc_object_t *c = xc_object_create(rt);
+    xc_object_t *d = xc_object_create(rt);
+    xc_object_set_cached(rt, c, "z", one, &set_ic);
+    xc_object_set_cached(rt, d, "z", two, &set_ic);
+    TEST_ASSERT(xc_object_get(rt, d, "z") == two, "Cached transition adds the key");
+    TEST_ASSERT(((xc_object_data_t *)c)->shape == ((xc_object_data_t *)d)->shape,
+                "Cached transition reuses the shape");
+
+    /* Grow past the inline slots, delete and iterate in insertion order */
+    const char *keys[] = {"k0", "k1", "k2", "k3", "k4", "k5", "k6", "k7", "k8", "k9"};
+    xc_object_t *big = xc_object_create(rt);
+    for (int i = 0; i < 10; i++) {
+        xc_object_set(rt, big, keys[i], xc_number_create(rt, i));
+    }
+    TEST_ASSERT_EQUAL((size_t)10, xc_object_count(rt, big), "All properties stored");
+    TEST_ASSERT(xc_number_value(rt, xc_object_get(rt, big, "k9")) == 9, "Out-of-line slot value");
+    TEST_ASSERT(xc_object_delete(rt, big, "k3"), "Delete in the middle");
+    TEST_ASSERT(((xc_object_data_t *)big)->dict != NULL, "Delete moves the object to dictionary mode");
+    TEST_ASSERT(xc_number_value(rt, xc_object_get(rt, big, "k4")) == 4, "Later keys are still found");
+    xc_object_set(rt, big, "k3", one);
+
+    char order[64] = "";
+    xc_object_foreach(rt, big, collect_keys, order);
+    TEST_ASSERT(strcmp(order, "k0k1k2k4k5k6k7k8k9k3") == 0, "foreach follows insertion order");
+
+    /* A shape takes a bounded number of transitions; later keys use dictionaries */
+    xc_object_t *fanout[XC_SHAPE_MAX_TRANSITIONS + 8];
+    bool readable = true;
+    for (int i = 0; i < XC_SHAPE_MAX_TRANSITIONS + 8; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "u%d", i);
+        fanout[i] = xc_object_create(rt);
+        xc_object_set(rt, fanout[i], "fanout", one);
+        xc_object_set(rt, fanout[i], key, xc_number_create(rt, i));
+        readable = readable && xc_number_value(rt, xc_object_get(rt, fanout[i], key)) == i &&
+                   xc_object_get(rt, fanout[i], "fanout") == one;
+    }
+    TEST_ASSERT(readable, "Properties readable on both sides of the cap");
+    TEST_ASSERT(((xc_object_data_t *)fanout[0])->dict == NULL, "Early transitions use shapes");
+    TEST_ASSERT(((xc_object_data_t *)fanout[XC_SHAPE_MAX_TRANSITIONS])->dict != NULL,
+                "Transition past the cap switches to dictionary mode");
+    TEST_ASSERT(((xc_object_data_t *)fanout[0])->shape->parent->child_count == XC_SHAPE_MAX_TRANSITIONS,
+                "Transition count stops at the cap");
+
+    test_end("Object Shapes");
+}
+
+/* foreach 回调：统计属性个数并检查插入顺序 */
+typedef struct {
+    int count;
+    bool ordered;
+} dict_order_t;
+
+static void check_dict_order(xc_runtime_t *rt, const char *key, xc_object_t *value, void *user_data) {
+    dict_order_t *order = (dict_order_t *)user_data;
+    char expected[16];
+    snprintf(expected, sizeof(expected), "p%d", order->count * 2 + 1);
+    if (strcmp(key, expected) != 0) {
+        order->ordered = false;
+    }
+    order->count++;
+}
+
+/* 测试大对象切换到字典模式 */
+static void test_object_dictionary(void) {
+    test_start("Object Dictionary");
+
+    xc_object_t *obj = xc_object_create(rt);
+    xc_object_t *one = xc_number_create(rt, 1);
+    char key[16];
+    for (int i = 0; i < XC_OBJECT_DICT_THRESHOLD; i++) {
+        snprintf(key, sizeof(key), "p%d", i);
+        xc_object_set(rt, obj, key, one);
+    }
+    TEST_ASSERT(((xc_object_data_t *)obj)->dict == NULL, "Small objects keep using shapes");
+
+    /* 10000 keys: one extra key switches to dictionary mode, the rest grow it */
+    const int total = 10000;
+    for (int i = XC_OBJECT_DICT_THRESHOLD; i < total; i++) {
+        snprintf(key, sizeof(key), "p%d", i);
+        xc_object_set(rt, obj, key, one);
+    }
+    TEST_ASSERT(((xc_object_data_t *)obj)->dict != NULL, "Large objects switch to dictionary mode");
+    TEST_ASSERT_EQUAL((size_t)total, xc_object_count(rt, obj), "All properties stored");
+
+    xc_object_t *two = xc_number_create(rt, 2);
+    xc_object_set(rt, obj, "p5000", two);
+    TEST_ASSERT(xc_object_get(rt, obj, "p5000") == two, "Update in dictionary mode");
+    TEST_ASSERT(xc_object_get(rt, obj, "p3") == one, "Keys moved from the shape are found");
+    TEST_ASSERT(!xc_object_has(rt, obj, "p10000"), "Missing key is absent");
+
+    /* Delete every even key, then check lookups and iteration order */
+    bool deleted = true;
+    for (int i = 0; i < total; i += 2) {
+        snprintf(key, sizeof(key), "p%d", i);
+        deleted = deleted && xc_object_delete(rt, obj, key);
+    }
+    TEST_ASSERT(deleted, "Delete in dictionary mode");
+    TEST_ASSERT_EQUAL((size_t)(total / 2), xc_object_count(rt, obj), "Count after delete");
+
+    bool found = true;
+    for (int i = 1; i < total; i += 2) {
+        snprintf(key, sizeof(key), "p%d", i);
+        found = found && xc_object_has(rt, obj, key);
+    }
+    TEST_ASSERT(found, "Remaining keys survive backward-shift deletion");
+    TEST_ASSERT(!xc_object_has(rt, obj, "p4000"), "Deleted key is absent");
+
+    dict_order_t order = {0, true};
+    xc_object_foreach(rt, obj, check_dict_order, &order);
+    TEST_ASSERT(order.ordered && order.count == total / 2, "foreach keeps insertion order");
+
+    /* Re-adding reuses the freed entries */
+    xc_object_set(rt, obj, "p0", two);
+    TEST_ASSERT(xc_object_get(rt, obj, "p0") == two, "Re-add after delete");
+
+    /* Inline caches fall back to the dictionary */
+    xc_inline_cache_t ic = {0};
+    TEST_ASSERT(xc_object_get_cached(rt, obj, "p1", &ic) == one, "Cached get in dictionary mode");
+    TEST_ASSERT(ic.shape == NULL, "Dictionary-mode objects are not cached");
+
+    test_end("Object Dictionary");
+}
+
 /* 注册测试 */
 void register_object_tests(void) {
     rt = xc_singleton();
@@ -47,4 +221,10 @@ void register_object_tests(void) {
                  "Test object methods and operations");
     test_register("object.delete", test_object_delete, "object",
                  "Test object property deletion");
+    test_register("object.dot", test_object_dot, "object",
+                 "Test property access through dot");
+    test_register("object.shapes", test_object_shapes, "object",
+                 "Test hidden classes and inline caches");
+    test_register("object.dictionary", test_object_dictionary, "object",
+                 "Test dictionary mode for large objects");
 }
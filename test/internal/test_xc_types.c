@@ -188,6 +188,81 @@ static void test_number_operations(void) {
     test_end("Number Operations");
 }
 
+/* 数值与文本互转：最短往返格式化和快速解析 */
+static void test_number_text(void) {
+    test_start("Number Text");
+    
+    static const struct { double value; const char *text; } cases[] = {
+        {0.1, "0.1"}, {0.3, "0.3"}, {2.0 / 3, "0.6666666666666666"}, {100, "100"},
+        {-1.5, "-1.5"}, {-0.0, "0"}, {1e21, "1e+21"}, {1.5e-7, "1.5e-7"},
+        {0.000001, "0.000001"}, {5e-324, "5e-324"}, {1.7976931348623157e308, "1.7976931348623157e+308"},
+        {1e23, "1e+23"}, {123e20, "1.23e+22"}, {7.4512e22, "7.4512e+22"}, {9.7867e20, "978670000000000000000"}
+    };
+    char buf[XC_NUMBER_FORMAT_SIZE];
+    bool formatted = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t len = xc_number_format(cases[i].value, buf);
+        formatted = formatted && strcmp(buf, cases[i].text) == 0 && len == strlen(buf);
+    }
+    TEST_ASSERT(formatted, "Doubles format as the shortest JavaScript-style text");
+    xc_number_format(0.0 / 0.0, buf);
+    TEST_ASSERT(strcmp(buf, "NaN") == 0, "NaN formats as NaN");
+    xc_number_format(-1.0 / 0.0, buf);
+    TEST_ASSERT(strcmp(buf, "-Infinity") == 0, "-Infinity formats as -Infinity");
+    
+    /* Random bit patterns: format -> parse gives back the same double, and agrees with strtod */
+    uint64_t state = 88172645463325252ULL;
+    bool round_trip = true;
+    for (int i = 0; i < 100000; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double value;
+        memcpy(&value, &state, sizeof(value));
+        if (value != value || value - value != 0) {
+            continue;
+        }
+        size_t len = xc_number_format(value, buf);
+        double parsed;
+        double expected = strtod(buf, NULL);
+        round_trip = round_trip && xc_number_parse(buf, len, &parsed) == len &&
+                     memcmp(&parsed, &value, sizeof(value)) == 0 &&
+                     memcmp(&expected, &value, sizeof(value)) == 0;
+    }
+    TEST_ASSERT(round_trip, "Formatted doubles round-trip through the parser");
+    
+    /* Parser edge cases against strtod */
+    static const char *inputs[] = {
+        "1e23", "123456789012345678901234567890", "2.2250738585072014e-308", "4.9e-324",
+        "9007199254740993", ".5", "5.", "1e-400", "1e400", "0x10", "-0"
+    };
+    bool parsed_ok = true;
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        double value, expected = strtod(inputs[i], NULL);
+        parsed_ok = parsed_ok && xc_number_parse(inputs[i], strlen(inputs[i]), &value) == strlen(inputs[i]) &&
+                    memcmp(&value, &expected, sizeof(value)) == 0;
+    }
+    TEST_ASSERT(parsed_ok, "Parser matches strtod on edge cases");
+    double value;
+    TEST_ASSERT_EQUAL((size_t)1, xc_number_parse("1e", 2, &value), "Dangling exponent is not consumed");
+    TEST_ASSERT_EQUAL((size_t)0, xc_number_parse("abc", 3, &value), "Non-numbers consume nothing");
+    
+    /* Use sites: conversion, join, toString */
+    xc_object_t *num = xc_number_create(rt, 0.1);
+    xc_object_t *str = xc_string_concat(rt, xc_string_create(rt, "x="), num);
+    TEST_ASSERT(strcmp(xc_string_value(rt, str), "x=0.1") == 0, "concat uses the formatter");
+    xc_object_t *arr = xc_array_create(rt);
+    xc_array_push(rt, arr, xc_number_create(rt, 1.0 / 3));
+    xc_array_push(rt, arr, xc_number_create(rt, 1e21));
+    xc_object_t *joined = xc_array_join(rt, arr, xc_string_create(rt, ","));
+    TEST_ASSERT(strcmp(xc_string_value(rt, joined), "0.3333333333333333,1e+21") == 0, "join uses the formatter");
+    str = (xc_object_t *)rt->call(num, "toString");
+    TEST_ASSERT(str && strcmp(xc_string_value(rt, str), "0.1") == 0, "Numbers have toString");
+    TEST_ASSERT(xc_to_number(rt, xc_string_create(rt, " 2.5e3")) == 2500, "xc_to_number parses strings");
+    
+    test_end("Number Text");
+}
+
 /* String type tests */
 static void test_string_simple(void) {
     test_start("String Simple Test");
@@ -261,6 +336,565 @@ static void test_string_operations(void) {
     test_end("String Operations");
 }
 
+/* 字符串驻留测试 */
+static void test_string_intern(void) {
+    test_start("String Intern");
+    
+    xc_object_t *a = xc_string_intern(rt, "name");
+    xc_object_t *b = xc_string_intern(rt, "name");
+    xc_object_t *c = xc_string_intern_len(rt, "name_tail", 4);
+    TEST_ASSERT_NOT_NULL(a, "Interned string created");
+    TEST_ASSERT(a == b && a == c, "Same content interns to the same object");
+    TEST_ASSERT(xc_string_is_interned(rt, a), "Interned flag set");
+    
+    xc_object_t *plain = xc_string_create(rt, "name");
+    TEST_ASSERT(!xc_string_is_interned(rt, plain), "Plain strings are not interned");
+    TEST_ASSERT(xc_string_hash(rt, plain) == xc_string_hash(rt, a), "Hash depends only on content");
+    TEST_ASSERT(xc_string_equal(rt, plain, a), "Plain and interned strings compare equal");
+    TEST_ASSERT(!xc_string_equal(rt, a, xc_string_intern(rt, "other")), "Different interned strings differ");
+    
+    /* Enough distinct keys to grow the table */
+    char key[16];
+    bool stable = true;
+    for (int i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        xc_object_t *s = xc_string_intern(rt, key);
+        stable = stable && strcmp(xc_string_value(rt, s), key) == 0;
+    }
+    TEST_ASSERT(stable, "Interned strings keep their content");
+    TEST_ASSERT(xc_string_intern(rt, "name") == a, "Entries survive table growth");
+    
+    /* The table is weak: rooted entries survive a collection, collected ones leave it */
+    xc_gc_add_root(rt, &a);
+    xc_string_intern(rt, "collected");
+    xc_gc_run(rt);
+    TEST_ASSERT(xc_string_intern(rt, "name") == a, "Rooted interned string survives");
+    xc_object_t *again = xc_string_intern(rt, "collected");
+    TEST_ASSERT(strcmp(xc_string_value(rt, again), "collected") == 0, "Interning after the entry was collected");
+    xc_gc_remove_root(rt, &a);
+    
+    test_end("String Intern");
+}
+
+/* 字符串拼接（rope）和构建器测试 */
+static void test_string_builder(void) {
+    test_start("String Builder");
+    
+    /* Repeated concat builds a rope that is flattened on first read */
+    xc_object_t *piece = xc_string_create(rt, "0123456789");
+    xc_object_t *str = xc_string_create(rt, "");
+    for (int i = 0; i < 1000; i++) {
+        str = xc_string_concat(rt, str, piece);
+    }
+    TEST_ASSERT_EQUAL((size_t)10000, xc_string_length(rt, str), "Rope length without flattening");
+    
+    /* Only the unflattened rope is rooted: the marker keeps its halves alive */
+    xc_gc_add_root(rt, &str);
+    xc_gc_run(rt);
+    xc_gc_remove_root(rt, &str);
+    const char *value = xc_string_value(rt, str);
+    TEST_ASSERT(strlen(value) == 10000 && strncmp(value + 9990, "0123456789", 10) == 0,
+                "Rope flattens to the full text");
+    TEST_ASSERT(xc_string_value(rt, str) == value, "Flattening happens once");
+    TEST_ASSERT(xc_string_equal(rt, str, xc_string_concat(rt, str, xc_string_create(rt, ""))),
+                "Rope compares by content");
+    
+    /* Builder */
+    xc_string_builder_t sb;
+    xc_string_builder_init(&sb, 0);
+    for (int i = 0; i < 1000; i++) {
+        xc_string_builder_append(&sb, "ab");
+    }
+    xc_string_builder_append_char(&sb, '!');
+    xc_string_builder_append_string(rt, &sb, piece);
+    xc_object_t *built = xc_string_builder_finish(rt, &sb);
+    TEST_ASSERT_EQUAL((size_t)2011, xc_string_length(rt, built), "Builder length");
+    TEST_ASSERT(strcmp(xc_string_value(rt, built) + 1998, "ab!0123456789") == 0, "Builder content");
+    TEST_ASSERT(sb.data == NULL, "Finish hands the buffer to the string");
+    
+    /* Join writes straight into the result */
+    xc_val array = rt->new(XC_TYPE_ARRAY, 0);
+    rt->call(array, "push", xc_string_create(rt, "a"));
+    rt->call(array, "push", xc_number_create(rt, 2));
+    rt->call(array, "push", xc_boolean_create(rt, true));
+    xc_object_t *joined = xc_array_join(rt, array, xc_string_create(rt, ", "));
+    TEST_ASSERT(strcmp(xc_string_value(rt, joined), "a, 2, true") == 0, "Join result");
+    
+    test_end("String Builder");
+}
+
+/* 子串视图测试 */
+static void test_string_slice(void) {
+    test_start("String Slice");
+    
+    char text[200];
+    for (int i = 0; i < 199; i++) {
+        text[i] = 'a' + i % 26;
+    }
+    text[199] = '\0';
+    xc_object_t *parent = xc_string_create(rt, text);
+    
+    /* A middle slice shares the parent's characters */
+    xc_object_t *mid = xc_string_slice(rt, parent, 10, 100);
+    TEST_ASSERT_EQUAL((size_t)100, xc_string_length(rt, mid), "Slice length");
+    TEST_ASSERT(xc_string_data(rt, mid) == xc_string_data(rt, parent) + 10, "Slice shares parent storage");
+    TEST_ASSERT(strncmp(xc_string_data(rt, mid), text + 10, 100) == 0, "Slice content");
+    
+    /* A slice of a slice points at the original parent */
+    xc_object_t *inner = xc_string_slice(rt, mid, 40, 50);
+    TEST_ASSERT(xc_string_data(rt, inner) == xc_string_data(rt, parent) + 50, "Nested slices share storage");
+    
+    /* Slices compare and hash by content */
+    xc_object_t *copy = xc_string_create_len(rt, text + 10, 100);
+    TEST_ASSERT(xc_string_equal(rt, mid, copy), "Slice equals a copy");
+    TEST_ASSERT(xc_string_hash(rt, mid) == xc_string_hash(rt, copy), "Slice hash");
+    
+    /* Reading as a C string copies out the view, once */
+    const char *value = xc_string_value(rt, mid);
+    TEST_ASSERT(strlen(value) == 100 && strncmp(value, text + 10, 100) == 0, "Slice as C string");
+    TEST_ASSERT(xc_string_value(rt, mid) == value, "C string is cached");
+    
+    /* A suffix slice is already terminated and stays a view */
+    xc_object_t *tail = xc_string_slice(rt, parent, 150, 1000);
+    TEST_ASSERT_EQUAL((size_t)49, xc_string_length(rt, tail), "Slice is clamped to the parent");
+    TEST_ASSERT(xc_string_value(rt, tail) == xc_string_data(rt, parent) + 150, "Suffix slice reads in place");
+    
+    /* Short slices are copied */
+    xc_object_t *small = xc_string_slice(rt, parent, 5, 3);
+    TEST_ASSERT(strcmp(xc_string_value(rt, small), "fgh") == 0, "Short slice content");
+    TEST_ASSERT(xc_string_data(rt, small) != xc_string_data(rt, parent) + 5, "Short slice is compacted");
+    
+    /* Only the slice is rooted: the marker keeps its parent alive through a collection */
+    xc_object_t *view = xc_string_slice(rt, xc_string_create(rt, text), 20, 100);
+    xc_gc_add_root(rt, &view);
+    xc_gc_run(rt);
+    TEST_ASSERT(strncmp(xc_string_data(rt, view), text + 20, 100) == 0, "Slice keeps its parent alive");
+    xc_gc_remove_root(rt, &view);
+    
+    test_end("String Slice");
+}
+
+/* 字符串 SIMD 内核测试：每个级别的结果都要和标量版本一致 */
+static void test_string_kernels(void) {
+    test_start("String Kernels");
+    
+    /* 300 bytes so every vector width has full blocks and a tail */
+    char text[301];
+    for (int i = 0; i < 300; i++) {
+        text[i] = "abcXYZ, 019"[i % 11];
+    }
+    memcpy(text + 280, "Needle", 6);
+    text[300] = '\0';
+    
+    int best = xc_simd_get_level();
+    bool consistent = true;
+    for (int level = XC_SIMD_SCALAR; level <= best; level++) {
+        xc_simd_set_level(level);
+        xc_object_t *str = xc_string_create(rt, text);
+        consistent = consistent &&
+            xc_string_index_of(rt, str, xc_string_create(rt, "Needle")) == 280 &&
+            xc_string_index_of(rt, str, xc_string_create(rt, "Z, 0")) == 5 &&
+            xc_string_index_of(rt, str, xc_string_create(rt, "needle")) == -1 &&
+            xc_string_index_of(rt, str, xc_string_create(rt, "9")) == 10 &&
+            xc_array_length(rt, xc_string_split(rt, str, xc_string_create(rt, ", "))) == 27;
+        
+        xc_object_t *lower = xc_string_to_lower(rt, str);
+        xc_object_t *upper = xc_string_to_upper(rt, str);
+        consistent = consistent &&
+            strncmp(xc_string_value(rt, lower), "abcxyz, 019", 11) == 0 &&
+            strncmp(xc_string_value(rt, upper), "ABCXYZ, 019", 11) == 0 &&
+            strncmp(xc_string_value(rt, upper) + 280, "NEEDLE", 6) == 0;
+        
+        xc_object_t *other = xc_string_create(rt, text);
+        consistent = consistent && xc_string_equal(rt, str, other) &&
+                     xc_compare(rt, str, lower) < 0;
+    }
+    xc_simd_set_level(best);
+    TEST_ASSERT(consistent, "Search, split, case mapping and compare agree at every SIMD level");
+    
+    /* Split parts */
+    xc_val parts = rt->call(rt->new(XC_TYPE_STRING, "a,bb,,c"), "split", rt->new(XC_TYPE_STRING, ","));
+    TEST_ASSERT(parts && xc_array_length(rt, parts) == 4, "split keeps empty parts");
+    TEST_ASSERT(parts && strcmp(xc_string_value(rt, xc_array_get(rt, parts, 1)), "bb") == 0, "split part content");
+    
+    /* 切出的片数超过回收阈值：GC 开启，切分途中会回收，只有输入是根 */
+    char *many = malloc(30000 * 2);
+    for (int i = 0; i < 30000; i++) {
+        many[2 * i] = 'a' + i % 26;
+        many[2 * i + 1] = ',';
+    }
+    many[2 * 30000 - 1] = '\0';
+    xc_object_t *source = xc_string_create(rt, many);
+    free(many);
+    xc_gc_add_root(rt, &source);
+    size_t cycles = xc_gc_get_stats(rt).gc_cycles;
+    xc_object_t *pieces = xc_string_split(rt, source, xc_string_create(rt, ","));
+    TEST_ASSERT(xc_gc_get_stats(rt).gc_cycles > cycles, "Large split collects while it runs");
+    TEST_ASSERT_EQUAL((size_t)30000, xc_array_length(rt, pieces), "Large split keeps every part");
+    TEST_ASSERT(strcmp(xc_string_value(rt, xc_array_get(rt, pieces, 29999)), "v") == 0 &&
+                strcmp(xc_string_value(rt, xc_array_get(rt, pieces, 27)), "b") == 0, "Large split part content");
+    xc_gc_remove_root(rt, &source);
+    
+    xc_val includes = rt->call(rt->new(XC_TYPE_STRING, "hello world"), "includes", rt->new(XC_TYPE_STRING, "o w"));
+    TEST_ASSERT(includes && xc_boolean_value(rt, includes), "includes method");
+    xc_val index = rt->call(rt->new(XC_TYPE_STRING, "hello world"), "indexOf", rt->new(XC_TYPE_STRING, "world"));
+    TEST_ASSERT(index && xc_number_value(rt, index) == 6, "indexOf method");
+    
+    /* UTF-8 */
+    const char *utf8 = "h\xC3\xA9llo \xE4\xB8\x96\xE7\x95\x8C \xF0\x9F\x98\x80";
+    xc_object_t *u = xc_string_create(rt, utf8);
+    TEST_ASSERT(xc_string_is_valid_utf8(rt, u), "Valid UTF-8 accepted");
+    TEST_ASSERT_EQUAL((size_t)10, xc_string_code_point_length(rt, u), "Code point length");
+    TEST_ASSERT(!xc_string_is_valid_utf8(rt, xc_string_create(rt, "ab\xC0\xAF")), "Overlong rejected");
+    TEST_ASSERT(!xc_string_is_valid_utf8(rt, xc_string_create(rt, "\xED\xA0\x80")), "Surrogate rejected");
+    TEST_ASSERT(!xc_string_is_valid_utf8(rt, xc_string_create(rt, "abc\xE4\xB8")), "Truncated sequence rejected");
+    
+    test_end("String Kernels");
+}
+
+/* Closure handler: adds its argument to captured slot 0 and counts calls in slot 1 */
+static xc_val closure_add(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    xc_object_t *self = xc_function_current(rt);
+    double base = xc_number_value(rt, XC_CAPTURE(self, 0));
+    double calls = xc_number_value(rt, XC_CAPTURE(self, 1));
+    XC_CAPTURE(self, 1) = xc_number_create(rt, calls + 1);
+    return xc_number_create(rt, base + (argc > 0 ? xc_number_value(rt, argv[0]) : 0));
+}
+
+static xc_val closure_thrower(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    rt->throw(xc_exception_create(rt, XC_EXCEPTION_TYPE_ERROR, "thrown"));
+    return NULL;
+}
+
+static xc_val closure_catcher(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return argv[0];
+}
+
+/* try 块里的 handler 用 longjmp 抛出后，外层 handler 仍然读到自己 */
+static xc_val closure_try(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    xc_object_t *self = xc_function_current(rt);
+    rt->try_catch_finally(XC_CAPTURE(self, 0), XC_CAPTURE(self, 1), NULL);
+    return xc_function_current(rt);
+}
+
+static void test_function_closure(void) {
+    test_start("Function Closure");
+    xc_gc_disable(rt);
+    
+    xc_object_t *captures[2] = { xc_number_create(rt, 40), xc_number_create(rt, 0) };
+    xc_object_t *fn = xc_function_create_closure(rt, closure_add, 2, captures);
+    TEST_ASSERT(fn && xc_is_function(rt, fn), "Closure is a function");
+    TEST_ASSERT_EQUAL((size_t)2, xc_function_capture_count(rt, fn), "Capture count");
+    TEST_ASSERT(xc_function_get_capture(rt, fn, 0) == captures[0], "Captured slot 0");
+    TEST_ASSERT(xc_function_get_capture(rt, fn, 2) == NULL, "Out of range slot reads NULL");
+    
+    xc_object_t *arg = xc_number_create(rt, 2);
+    xc_object_t *result = xc_function_call(rt, fn, NULL, 1, &arg);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 42, "Handler reads captured slot");
+    result = xc_function_invoke(fn, NULL, 1, (xc_val *)&arg);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 42, "invoke reads captured slot");
+    TEST_ASSERT(xc_number_value(rt, xc_function_get_capture(rt, fn, 1)) == 2, "Handler writes captured slot");
+    TEST_ASSERT(xc_function_current(rt) == NULL, "Current function restored after call");
+    
+    xc_function_set_capture(rt, fn, 0, xc_number_create(rt, 1));
+    result = xc_function_call(rt, fn, NULL, 1, &arg);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 3, "set_capture updates slot");
+    
+    xc_object_t *empty = xc_function_create_closure(rt, closure_add, 3, NULL);
+    TEST_ASSERT(xc_function_get_capture(rt, empty, 2) == NULL, "NULL captures start empty");
+    TEST_ASSERT_EQUAL((size_t)0, xc_function_capture_count(rt, xc_function_create(rt, closure_add, NULL)),
+                      "Plain functions have no captures");
+    
+    xc_object_t *handlers[2] = { xc_function_create(rt, closure_thrower, NULL),
+                                 xc_function_create(rt, closure_catcher, NULL) };
+    xc_object_t *try_fn = xc_function_create_closure(rt, closure_try, 2, handlers);
+    TEST_ASSERT(xc_function_call(rt, try_fn, NULL, 0, NULL) == try_fn, "Current function restored after a throw");
+    TEST_ASSERT(xc_function_current(rt) == NULL, "Current function cleared after the outer call");
+    
+    xc_gc_enable(rt);
+    test_end("Function Closure");
+}
+
+#define VM_EMIT(vm, ...) xc_vm_emit(rt, vm, (xc_instruction_t){__VA_ARGS__})
+
+static xc_val vm_double_native(xc_runtime_t *rt, xc_val this_obj, int argc, xc_val *argv) {
+    return xc_number_create(rt, xc_number_value(rt, argv[0]) * 2);
+}
+
+static void test_vm_interpreter(void) {
+    test_start("VM Interpreter");
+    xc_gc_disable(rt);
+    
+    /* sum = 0; for (i = 0; i < 100; i++) sum += i; */
+    xc_object_t *vm = xc_vm_create(16);
+    TEST_ASSERT(vm && vm->type_id == XC_TYPE_VM, "VM created");
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 0)});
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 0)});
+    VM_EMIT(vm, OP_STORE, {.var = {1, 0}});
+    int loop = VM_EMIT(vm, OP_LOAD, {.var = {1, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 100)});
+    VM_EMIT(vm, OP_LT);
+    int exit_jump = VM_EMIT(vm, OP_JMP_IF_FALSE);
+    VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_LOAD, {.var = {1, 0}});
+    VM_EMIT(vm, OP_ADD);
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    VM_EMIT(vm, OP_LOAD, {.var = {1, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 1)});
+    VM_EMIT(vm, OP_ADD);
+    VM_EMIT(vm, OP_STORE, {.var = {1, 0}});
+    VM_EMIT(vm, OP_JMP, {.i32 = loop});
+    int done = VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_RET);
+    xc_vm_set_jump(rt, vm, exit_jump, done);
+    xc_val result = xc_vm_run(rt, vm);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 4950, "Loop sums 0..99");
+    TEST_ASSERT(xc_vm_result(rt, vm) == result, "Result is kept on the VM");
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 4950, "Second run gives the same result");
+    size_t bytes = 0;
+    TEST_ASSERT(xc_vm_bytecode(rt, vm, &bytes) != NULL, "Bytecode encoded");
+    TEST_ASSERT(bytes < (size_t)((xc_vm_t *)vm)->code_size * 3, "Encoding averages under 3 bytes per instruction");
+    xc_object_t *one = xc_number_create(rt, 1);
+    int before = ((xc_vm_t *)vm)->constant_count;
+    VM_EMIT(vm, OP_LINE_NUM, {.i32 = 12});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = one});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = one});
+    VM_EMIT(vm, OP_POP);
+    VM_EMIT(vm, OP_POP);
+    TEST_ASSERT_EQUAL(before + 1, ((xc_vm_t *)vm)->constant_count, "Repeated constant shares a pool slot");
+    size_t grown = 0;
+    xc_vm_bytecode(rt, vm, &grown);
+    TEST_ASSERT_EQUAL(bytes + 6, grown, "Line hints take no bytes");
+    
+    /* 全局变量、属性和调用：point.x = double(base) - 1 */
+    vm = xc_vm_create(0);
+    xc_vm_set_global(rt, vm, "base", xc_number_create(rt, 21));
+    xc_vm_set_global(rt, vm, "double", xc_function_create(rt, vm_double_native, NULL));
+    VM_EMIT(vm, OP_NEW_OBJECT);
+    VM_EMIT(vm, OP_DUP);
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "double"});
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "base"});
+    VM_EMIT(vm, OP_CALL, {.i32 = 1});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 1)});
+    VM_EMIT(vm, OP_SUB);
+    VM_EMIT(vm, OP_SET_PROP, {.str = "x"});
+    VM_EMIT(vm, OP_GET_PROP, {.str = "x"});
+    VM_EMIT(vm, OP_DUP);
+    VM_EMIT(vm, OP_STORE_GLOBAL, {.str = "answer"});
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 41, "Globals, call and properties");
+    TEST_ASSERT(xc_number_value(rt, xc_object_get(rt, ((xc_vm_t *)vm)->global, "answer")) == 41,
+                "STORE_GLOBAL writes the global object");
+    
+    /* try { throw "boom" } catch (e) { return e } */
+    vm = xc_vm_create(0);
+    int try_at = VM_EMIT(vm, OP_TRY_BEGIN);
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_string_create(rt, "boom")});
+    VM_EMIT(vm, OP_THROW);
+    VM_EMIT(vm, OP_TRY_END);
+    int catch_at = VM_EMIT(vm, OP_RET);
+    xc_vm_set_jump(rt, vm, try_at, catch_at);
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(result && strcmp(xc_string_value(rt, result), "boom") == 0, "Thrown value reaches catch");
+    
+    /* 未捕获的类型错误以 XC_ERROR 返回 */
+    vm = xc_vm_create(0);
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_string_create(rt, "a")});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 1)});
+    VM_EMIT(vm, OP_SUB);
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(XC_IS_ERROR(result), "Uncaught error returns XC_ERROR");
+    xc_object_t *exc = xc_take_pending_exception(rt);
+    TEST_ASSERT(exc && xc_exception_get_type(rt, exc) == XC_EXCEPTION_TYPE_TYPE, "TypeError is pending");
+    
+    /* 栈下溢在执行前被拒绝 */
+    vm = xc_vm_create(0);
+    VM_EMIT(vm, OP_ADD);
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(XC_IS_ERROR(result), "Invalid bytecode is rejected");
+    xc_take_pending_exception(rt);
+    
+    /* 方法接口 */
+    vm = rt->new(XC_TYPE_VM, 8);
+    xc_object_t *ins[2] = { xc_number_create(rt, OP_PUSH_VAL), xc_number_create(rt, 10) };
+    rt->call(vm, "addInstruction", xc_array_create_with_values(rt, ins, 2));
+    ins[1] = xc_number_create(rt, 20);
+    rt->call(vm, "addInstruction", xc_array_create_with_values(rt, ins, 2));
+    ins[0] = xc_number_create(rt, OP_ADD);
+    rt->call(vm, "addInstruction", xc_array_create_with_values(rt, ins, 1));
+    rt->call(vm, "execute", NULL);
+    result = rt->call(vm, "getResult", NULL);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 30, "addInstruction and execute");
+    rt->call(vm, "reset", NULL);
+    TEST_ASSERT(rt->call(vm, "getResult", NULL) == NULL, "reset clears the result");
+    
+    xc_gc_enable(rt);
+    test_end("VM Interpreter");
+}
+
+/* 同一段代码在两种模式下的结果 */
+static double vm_run_both(xc_object_t *vm, double *stack_result) {
+    xc_vm_set_mode(rt, vm, XC_VM_MODE_STACK);
+    xc_val result = xc_vm_run(rt, vm);
+    *stack_result = result && !XC_IS_ERROR(result) ? xc_number_value(rt, result) : -1;
+    xc_vm_set_mode(rt, vm, XC_VM_MODE_REGISTER);
+    result = xc_vm_run(rt, vm);
+    return result && !XC_IS_ERROR(result) ? xc_number_value(rt, result) : -1;
+}
+
+static void test_vm_registers(void) {
+    test_start("VM Register Mode");
+    xc_gc_disable(rt);
+    double expected;
+    
+    /* 栈上还引用着局部变量旧值时改写它：x = 5; x + (x = x + 1) */
+    xc_object_t *vm = xc_vm_create(0);
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 5)});
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 1)});
+    VM_EMIT(vm, OP_ADD);
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_ADD);
+    TEST_ASSERT(vm_run_both(vm, &expected) == 11 && expected == 11, "Stale local value is kept");
+    
+    /* DUP、SWAP 和连续参数：[3, 2 - 1, (2 - 1) * 2][2] */
+    vm = xc_vm_create(0);
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 3)});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 1)});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 2)});
+    VM_EMIT(vm, OP_SWAP);
+    VM_EMIT(vm, OP_SUB);
+    VM_EMIT(vm, OP_DUP);
+    VM_EMIT(vm, OP_DUP);
+    VM_EMIT(vm, OP_ADD);
+    VM_EMIT(vm, OP_NEW_ARRAY, {.i32 = 3});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 2)});
+    VM_EMIT(vm, OP_GET_ELEM);
+    TEST_ASSERT(vm_run_both(vm, &expected) == 2 && expected == 2, "DUP, SWAP and NEW_ARRAY");
+    
+    /* 循环：寄存器代码的指令数少于栈代码 */
+    vm = xc_vm_create(0);
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 0)});
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    int loop = VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 10)});
+    VM_EMIT(vm, OP_LT);
+    int exit_jump = VM_EMIT(vm, OP_JMP_IF_FALSE);
+    VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 1)});
+    VM_EMIT(vm, OP_ADD);
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    VM_EMIT(vm, OP_JMP, {.i32 = loop});
+    xc_vm_set_jump(rt, vm, exit_jump, VM_EMIT(vm, OP_LOAD, {.var = {0, 0}}));
+    TEST_ASSERT(vm_run_both(vm, &expected) == 10 && expected == 10, "Loop result matches");
+    /* MOVE r0, 0; LT t0, r0, 10; JMP_IF_FALSE t0; ADD r0, r0, 1; JMP; RET r0 */
+    TEST_ASSERT_EQUAL(6, ((xc_vm_t *)vm)->reg_instr_count, "Loop translates to 6 register instructions");
+    
+    /* 调用的返回值留在栈上参与后续计算 */
+    vm = xc_vm_create(0);
+    xc_vm_set_global(rt, vm, "double", xc_function_create(rt, vm_double_native, NULL));
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 1)});
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "double"});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 4)});
+    VM_EMIT(vm, OP_CALL, {.i32 = 1});
+    VM_EMIT(vm, OP_ADD);
+    TEST_ASSERT(vm_run_both(vm, &expected) == 9 && expected == 9, "Call result in register");
+    
+    /* 开着 GC 跑分配数字的循环：i = 0.25; while (i < 100000.25) i = i + 0.5
+     * 只有 VM 是根，栈、局部变量、寄存器和常量池靠 vm_marker 保活 */
+    xc_gc_enable(rt);
+    vm = xc_vm_create(0);
+    xc_gc_add_root(rt, &vm);
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 0.25)});
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    loop = VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 100000.25)});
+    VM_EMIT(vm, OP_LT);
+    exit_jump = VM_EMIT(vm, OP_JMP_IF_FALSE);
+    VM_EMIT(vm, OP_LOAD, {.var = {0, 0}});
+    VM_EMIT(vm, OP_PUSH_VAL, {.val = xc_number_create(rt, 0.5)});
+    VM_EMIT(vm, OP_ADD);
+    VM_EMIT(vm, OP_STORE, {.var = {0, 0}});
+    VM_EMIT(vm, OP_JMP, {.i32 = loop});
+    xc_vm_set_jump(rt, vm, exit_jump, VM_EMIT(vm, OP_LOAD, {.var = {0, 0}}));
+    size_t freed = xc_gc_get_stats(rt).total_freed;
+    TEST_ASSERT(vm_run_both(vm, &expected) == 100000.25 && expected == 100000.25,
+                "Allocating loop survives collections in both modes");
+    TEST_ASSERT(xc_gc_get_stats(rt).total_freed > freed, "Loop temporaries were collected");
+    xc_gc_remove_root(rt, &vm);
+    
+    test_end("VM Register Mode");
+}
+
+static void test_vm_quicken(void) {
+    test_start("VM Quickening");
+    xc_gc_disable(rt);
+    
+    /* r = a + b; r < b; c[0]，操作数来自全局变量，两次运行之间换类型 */
+    xc_object_t *vm = xc_vm_create(0);
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "a"});
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "b"});
+    VM_EMIT(vm, OP_ADD);
+    VM_EMIT(vm, OP_STORE_GLOBAL, {.str = "r"});
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "a"});
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "b"});
+    VM_EMIT(vm, OP_LT);
+    VM_EMIT(vm, OP_STORE_GLOBAL, {.str = "less"});
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "c"});
+    VM_EMIT(vm, OP_LOAD_GLOBAL, {.str = "k"});
+    VM_EMIT(vm, OP_GET_ELEM);
+    
+    xc_object_t *global = ((xc_vm_t *)vm)->global;
+    xc_object_t *items[1] = { xc_number_create(rt, 7) };
+    xc_vm_set_global(rt, vm, "a", xc_number_create(rt, 1));
+    xc_vm_set_global(rt, vm, "b", xc_number_create(rt, 2));
+    xc_vm_set_global(rt, vm, "c", xc_array_create_with_values(rt, items, 1));
+    xc_vm_set_global(rt, vm, "k", xc_number_create(rt, 0));
+    TEST_ASSERT(xc_vm_bytecode(rt, vm, NULL) != NULL, "VM prepared");
+    xc_vm_t *v = (xc_vm_t *)vm;
+    uint8_t *generic = (uint8_t *)malloc((size_t)v->regcode_size);
+    memcpy(generic, v->regcode, (size_t)v->regcode_size);
+    
+    xc_val result = xc_vm_run(rt, vm);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 7, "Array element read");
+    TEST_ASSERT(xc_number_value(rt, xc_object_get(rt, global, "r")) == 3, "Numeric add");
+    TEST_ASSERT(xc_boolean_value(rt, xc_object_get(rt, global, "less")), "Numeric compare");
+    TEST_ASSERT(memcmp(generic, v->regcode, (size_t)v->regcode_size) != 0, "Instructions quickened in place");
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 7, "Quickened code gives the same result");
+    
+    /* 守卫失败后退回通用形式 */
+    xc_object_t *obj = xc_object_create(rt);
+    xc_object_set(rt, obj, "x", xc_number_create(rt, 9));
+    xc_vm_set_global(rt, vm, "a", xc_string_create(rt, "b"));
+    xc_vm_set_global(rt, vm, "b", xc_string_create(rt, "c"));
+    xc_vm_set_global(rt, vm, "c", obj);
+    xc_vm_set_global(rt, vm, "k", xc_string_create(rt, "x"));
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(result && xc_number_value(rt, result) == 9, "Object element after deopt");
+    TEST_ASSERT(strcmp(xc_string_value(rt, xc_object_get(rt, global, "r")), "bc") == 0, "String concat after deopt");
+    TEST_ASSERT(xc_boolean_value(rt, xc_object_get(rt, global, "less")), "String compare after deopt");
+    TEST_ASSERT(memcmp(generic, v->regcode, (size_t)v->regcode_size) == 0, "Instructions back to generic form");
+    
+    /* 类型错误仍然报告 */
+    xc_vm_set_global(rt, vm, "a", xc_number_create(rt, 1));
+    xc_vm_set_global(rt, vm, "b", xc_number_create(rt, 2));
+    xc_vm_run(rt, vm);
+    xc_vm_set_global(rt, vm, "b", xc_string_create(rt, "c"));
+    result = xc_vm_run(rt, vm);
+    TEST_ASSERT(XC_IS_ERROR(result), "Mixed operands still raise TypeError");
+    xc_take_pending_exception(rt);
+    
+    free(generic);
+    xc_gc_enable(rt);
+    test_end("VM Quickening");
+}
+
 /* Register null tests */
 void register_null_tests(void) {
     test_register("null.simple", test_null_simple, "types", 
@@ -281,6 +915,8 @@ void register_number_tests(void) {
                  "Test number type basic functionality");
     test_register("number.operations", test_number_operations, "types",
                  "Test number arithmetic operations");
+    test_register("number.text", test_number_text, "types",
+                 "Test number formatting and parsing");
 }
 
 /* Register string tests */
@@ -289,6 +925,30 @@ void register_string_tests(void) {
                  "Test string type basic functionality");
     test_register("string.operations", test_string_operations, "types",
                  "Test string operations");
+    test_register("string.intern", test_string_intern, "types",
+                 "Test string interning and cached hashes");
+    test_register("string.builder", test_string_builder, "types",
+                 "Test ropes, string builder and join");
+    test_register("string.slice", test_string_slice, "types",
+                 "Test substring views");
+    test_register("string.kernels", test_string_kernels, "types",
+                 "Test SIMD string search, case mapping and UTF-8");
+}
+
+/* Register function tests */
+void register_function_tests(void) {
+    test_register("function.closure", test_function_closure, "types",
+                 "Test closure captured-variable slots");
+}
+
+/* Register vm tests */
+void register_vm_tests(void) {
+    test_register("vm.interpreter", test_vm_interpreter, "types",
+                 "Test bytecode interpreter");
+    test_register("vm.registers", test_vm_registers, "types",
+                 "Test register translation against stack execution");
+    test_register("vm.quicken", test_vm_quicken, "types",
+                 "Test in-place type specialization and deopt");
 }
 
 /* Forward declarations */
@@ -304,6 +964,8 @@ void test_xc_types(void) {
     register_boolean_tests();
     register_number_tests();
     register_string_tests();
+    register_function_tests();
+    register_vm_tests();
     
     /* Run the tests in the "types" category */
     test_run_category("types");